@@ -5,6 +5,8 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <cstdint>
 #include "imgui_include.h"
 
 namespace LocalTether::Core {
@@ -25,7 +27,11 @@ public:
     int GetWindowHeight() const { return height; }
 
 
-    void Quit() { running = false; }
+    void Quit() { running = false; RequestRedraw(); }
+
+    // Wakes an idle Run() loop for one more frame. Safe from any thread; repeated requests
+    // before the frame is drawn collapse into one.
+    static void RequestRedraw();
     
 
     void SetRenderCallback(std::function<void()> callback) { renderCallback = callback; }
@@ -43,6 +49,10 @@ private:
     void ProcessEvents();
 
     void StartFrame();
+
+    // Blocks until there is a reason to draw: an SDL event, RequestRedraw(), a frame still owed
+    // after recent activity, or the idle refresh timeout. Events are left for ProcessEvents.
+    void WaitForActivity();
     
   
     void Render();
@@ -69,6 +79,17 @@ private:
     bool running = false;
 
     bool os_drag_active_ = false; 
+
+    // ui.power_saving=false restores the old render-every-vsync loop.
+    bool powerSaving_ = true;
+    uint32_t idleRefreshMs_ = 1000;     // ui.idle_refresh_ms
+    uint32_t unfocusedFrameMs_ = 100;   // 1000 / ui.unfocused_fps
+    // ImGui settles hover and layout changes over a couple of frames after each event.
+    static constexpr int FRAMES_AFTER_ACTIVITY = 3;
+    int framesOwed_ = FRAMES_AFTER_ACTIVITY;
+    uint32_t lastFrameTicks_ = 0;
+    uint32_t redrawEventType_ = 0;
+    std::atomic<bool> redrawPending_{false};
     
 
     std::function<void()> renderCallback;
@@ -0,0 +1,86 @@
+#pragma once
+#include "network/Message.h"
+#include <array>
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+namespace LocalTether::Input {
+
+    // Host-side virtual desktop, KVM style: receivers are placed on the edges of the host's own
+    // screen ("layout.left", "layout.right", "layout.top", "layout.bottom" name a receiver
+    // client). The cursor is tracked from MOUSE_RELATIVE deltas, and resynced from the real
+    // pointer while it is on the host screen. There nothing is forwarded; once it crosses an edge
+    // with a neighbour every payload goes to that receiver only, motion rewritten as absolute
+    // positions on the receiver's resolution. Returning is only possible through the edge facing
+    // the host.
+    //
+    // Receivers are announced and removed on the network thread; route() runs on the capture
+    // thread and only needs one atomic load per edge check.
+    class DesktopLayout {
+    public:
+        static constexpr uint32_t HOME = 0;
+
+        enum class Edge : uint8_t { Left = 0, Right = 1, Top = 2, Bottom = 3 };
+
+        struct Routed {
+            // Receiver client id the payload belongs to, or HOME to keep it local.
+            uint32_t target = HOME;
+            // Set when this payload moved the cursor onto another screen; previous is where it was.
+            bool switched = false;
+            uint32_t previous = HOME;
+        };
+
+        static bool isEnabledInConfig();
+
+        // Reads the edge names from config and starts on the host screen. Returns false when no
+        // edge is configured.
+        bool configure(uint16_t homeWidth, uint16_t homeHeight);
+        bool isConfigured() const { return configured_; }
+
+        void setReceiverScreen(uint32_t clientId, const std::string& name, uint16_t width, uint16_t height);
+        void renameClient(uint32_t clientId, const std::string& name);
+        void removeClient(uint32_t clientId);
+
+        // Capture thread only. Rewrites mouse motion for the active receiver in place.
+        Routed route(Network::InputPayload& payload);
+        // Capture thread only. Moves the tracked cursor to the real pointer, in host screen
+        // pixels; ignored while the cursor is on a receiver.
+        void syncHomeCursor(double x, double y);
+        uint32_t activeTarget() const { return active_; }
+        // Capture thread only. Tracked position on the active screen, in its pixels.
+        double cursorX() const { return cursorX_; }
+        double cursorY() const { return cursorY_; }
+        void reset();
+
+    private:
+        static constexpr size_t EDGE_COUNT = 4;
+
+        static uint64_t pack(uint32_t clientId, uint16_t width, uint16_t height) {
+            return (static_cast<uint64_t>(clientId) << 32) | (static_cast<uint64_t>(width) << 16) | height;
+        }
+        static uint32_t packedId(uint64_t packed) { return static_cast<uint32_t>(packed >> 32); }
+        static uint16_t packedWidth(uint64_t packed) { return static_cast<uint16_t>(packed >> 16); }
+        static uint16_t packedHeight(uint64_t packed) { return static_cast<uint16_t>(packed); }
+
+        void enter(size_t edge, uint64_t neighbour, double along);
+        void returnHome(double along);
+        void writeAbsolute(Network::InputPayload& payload) const;
+
+        bool configured_ = false;
+        uint16_t homeWidth_ = 0;
+        uint16_t homeHeight_ = 0;
+        std::array<std::string, EDGE_COUNT> edgeNames_;
+        // 0 while no receiver with the configured name is connected.
+        std::array<std::atomic<uint64_t>, EDGE_COUNT> edges_{};
+
+        // Capture-thread state.
+        uint32_t active_ = HOME;
+        size_t activeEdge_ = 0;
+        double width_ = 0.0;
+        double height_ = 0.0;
+        double cursorX_ = 0.0;
+        double cursorY_ = 0.0;
+    };
+
+}
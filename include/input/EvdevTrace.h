@@ -0,0 +1,73 @@
+#pragma once
+#ifndef _WIN32
+#include "network/Message.h"
+#include <linux/input.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Line-based recording of raw evdev streams, used to replay the helper's capture and
+// injection path without hardware or root. Format (one record per line):
+//   localtether-evdev-trace 1
+//   screen <width> <height>
+//   device <slot> <touch_pointer> <touchpad_system> <has_abs_x> <x_min> <x_max> <has_abs_y> <y_min> <y_max> <name...>
+//   ev <timestamp_us> <slot> <type> <code> <value>
+
+namespace LocalTether::Input::EvdevTrace {
+
+    constexpr int FORMAT_VERSION = 1;
+
+    struct DeviceInfo {
+        uint32_t slot = 0;
+        std::string name;
+        bool isTouchPointer = false;
+        bool isTouchpadSystem = false;
+        bool hasAbsX = false;
+        bool hasAbsY = false;
+        int32_t absXMin = 0;
+        int32_t absXMax = 0;
+        int32_t absYMin = 0;
+        int32_t absYMax = 0;
+    };
+
+    struct Event {
+        uint64_t timestampUs = 0;
+        uint32_t slot = 0;
+        uint16_t type = 0;
+        uint16_t code = 0;
+        int32_t value = 0;
+    };
+
+    struct Trace {
+        int screenWidth = 0;
+        int screenHeight = 0;
+        std::vector<DeviceInfo> devices;
+        std::vector<Event> events;
+    };
+
+    class Writer {
+    public:
+        ~Writer() { close(); }
+        // Takes ownership of fd, a file the caller already opened for writing; the writer never
+        // opens paths itself, since the helper that records runs as root.
+        bool open(int fd, int screenWidth, int screenHeight);
+        bool isOpen() const { return out_ != nullptr; }
+        void writeDevice(const DeviceInfo& device);
+        void writeEvent(uint32_t slot, const struct input_event& ev);
+        void close();
+
+    private:
+        FILE* out_ = nullptr;
+    };
+
+    bool readTrace(const std::string& path, Trace& trace, std::string& error);
+
+    // One line per payload; stable across runs so it can be checked in as a golden file.
+    std::string formatPayload(const Network::InputPayload& payload);
+    bool writeGolden(const std::string& path, const std::vector<Network::InputPayload>& payloads);
+    // Returns true when the payload stream matches; otherwise describes the first difference.
+    bool compareGolden(const std::string& path, const std::vector<Network::InputPayload>& payloads, std::string& difference);
+
+}
+#endif
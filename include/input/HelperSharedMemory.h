@@ -0,0 +1,94 @@
+#pragma once
+#ifndef _WIN32
+#include "network/Message.h"
+#include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Layout of the segment the input helper publishes. Besides the pid and socket path the app
+// uses to find it, the segment carries two single-producer/single-consumer rings so input
+// payloads bypass the socket: helper->app for captured events and app->helper for
+// SimulateInput. The Unix socket is still used for control commands and as a fallback.
+
+namespace LocalTether::Input::HelperIpc {
+
+    constexpr const char* SHM_NAME = "/localtether_shm_helper_info";
+    // Bumped whenever the layout below changes so a stale segment is never misread.
+    constexpr uint32_t LAYOUT_MAGIC = 0x4c545234;
+
+    constexpr size_t SLOT_SIZE = 256;
+    constexpr uint32_t SLOT_COUNT = 256;
+    constexpr size_t SLOT_CAPACITY = SLOT_SIZE - sizeof(uint32_t);
+    static_assert((SLOT_COUNT & (SLOT_COUNT - 1)) == 0, "SLOT_COUNT must be a power of two");
+    // Set in RingSlot::length when the next slot holds more key events of the same payload.
+    constexpr uint32_t SLOT_CONTINUES = 0x80000000u;
+
+    struct RingSlot {
+        uint32_t length;
+        uint8_t data[SLOT_CAPACITY];
+    };
+
+    // head and tail are free-running counters; each side writes only its own index.
+    struct SpscRing {
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        // Futex word bumped by the producer when the consumer announced it is about to sleep.
+        alignas(64) std::atomic<uint32_t> wakeSeq;
+        std::atomic<uint32_t> consumerWaiting;
+        // Payloads the producer gave up on because the ring stayed full.
+        std::atomic<uint32_t> dropped;
+        alignas(64) RingSlot slots[SLOT_COUNT];
+    };
+
+    // Helper->app samples of how long injected payloads took from the app queueing them to the
+    // uinput write, filled only while latency tracing is on. Full means the sample is dropped.
+    constexpr uint32_t LATENCY_SAMPLE_COUNT = 256;
+    static_assert((LATENCY_SAMPLE_COUNT & (LATENCY_SAMPLE_COUNT - 1)) == 0, "LATENCY_SAMPLE_COUNT must be a power of two");
+
+    struct LatencyRing {
+        alignas(64) std::atomic<uint32_t> head;
+        alignas(64) std::atomic<uint32_t> tail;
+        uint32_t samplesUs[LATENCY_SAMPLE_COUNT];
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "ring indices must be lock-free to be shared between processes");
+
+    void resetRing(SpscRing& ring);
+
+    // Producer side. A payload too large for one slot is split by key events across
+    // consecutive slots, published together and marked with SLOT_CONTINUES. Returns false if
+    // the ring has no room.
+    bool pushPayload(SpscRing& ring, const Network::InputPayload& payload);
+
+    // Consumer side. Appends every published payload to out, rejoining split ones, and returns
+    // how many were read.
+    size_t drain(SpscRing& ring, std::vector<Network::InputPayload>& out);
+
+    // Sleeps on the ring's futex until the producer publishes or the timeout expires.
+    void waitForData(SpscRing& ring, std::chrono::milliseconds timeout);
+
+    // Forces a sleeping consumer awake, e.g. on shutdown.
+    void wakeConsumer(SpscRing& ring);
+
+    void resetLatencyRing(LatencyRing& ring);
+    bool pushLatencySample(LatencyRing& ring, uint32_t sampleUs);
+    size_t drainLatencySamples(LatencyRing& ring, std::vector<uint32_t>& out);
+
+}
+
+struct HelperSharedData {
+    pid_t helper_pid;
+    char socket_path[256];
+    bool ready;
+    uint32_t layout_magic;
+    // Set by the app once it has mapped the segment read/write; until then the helper uses the socket.
+    std::atomic<uint32_t> app_attached;
+    LocalTether::Input::HelperIpc::SpscRing to_app;
+    LocalTether::Input::HelperIpc::SpscRing to_helper;
+    LocalTether::Input::HelperIpc::LatencyRing inject_latency;
+};
+
+#endif
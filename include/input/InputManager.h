@@ -1,9 +1,14 @@
 #pragma once
 
 #include "network/Message.h" 
+#include "input/KeyState.h"
 #include <vector>
+#include <string>
+#include <optional>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <thread>
 #include "utils/Logger.h"
 #include "utils/Config.h"
 #include "utils/KeycodeConverter.h"
@@ -33,7 +38,35 @@ public:
     }
 
     virtual std::vector<LocalTether::Network::InputPayload> pollEvents() = 0;
+    // Blocks until new events may be available or the timeout passes. Backends that can be
+    // woken by their event source override this; the default simply sleeps.
+    virtual void waitForEvents(std::chrono::milliseconds timeout) {
+        std::this_thread::sleep_for(timeout);
+    }
     virtual void simulateInput( LocalTether::Network::InputPayload payload,uint16_t hostScreenWidth, uint16_t hostScreenHeight) = 0;
+    // Switches capture to MOUSE_RELATIVE payloads once the session negotiated it. Backends
+    // that can only capture absolute positions ignore it; receivers handle both kinds.
+    virtual void setRelativeMouseMode(bool enabled) {
+        relative_mouse_mode_.store(enabled, std::memory_order_relaxed);
+    }
+    bool isRelativeMouseMode() const {
+        return relative_mouse_mode_.load(std::memory_order_relaxed);
+    }
+    // Lets captured input reach the local desktop too while payloads keep flowing; used while
+    // the desktop layout cursor is on the host's own screen. Backends that cannot ignore it.
+    virtual void setLocalPassthrough(bool enabled) {
+        local_passthrough_.store(enabled, std::memory_order_relaxed);
+    }
+    bool isLocalPassthrough() const {
+        return local_passthrough_.load(std::memory_order_relaxed);
+    }
+    // Keys physically held on the capture side, used for KeyStateSnapshot. Returns nothing when
+    // the backend does not capture (receivers) or cannot track it; no snapshots are sent then.
+    virtual std::optional<KeyState> capturedKeyState() const { return std::nullopt; }
+    // "input.mouse_mode" is "absolute" (default) or "relative"; only the host's setting matters.
+    static bool relativeMouseModeRequested() {
+        return LocalTether::Utils::Config::Live().relativeMouseMode;
+    }
     virtual void setPauseKeyCombo(const std::vector<uint8_t>& combo) = 0;
     virtual std::vector<uint8_t> getPauseKeyCombo() const = 0;
 
@@ -47,6 +80,8 @@ public:
     
     std::vector<uint8_t> pause_key_combo_;
     static std::atomic<bool> input_globally_paused_; 
+    std::atomic<bool> relative_mouse_mode_{false};
+    std::atomic<bool> local_passthrough_{false};
 
     std::atomic<float> m_lastSimulatedRelativeX{-1.0f};
     std::atomic<float> m_lastSimulatedRelativeY{-1.0f};
@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace LocalTether::Input {
+
+    // Pressed/released state for all 256 virtual-key codes in four machine words. Used on the
+    // capture and injection hot paths and as the wire form of KeyStateSnapshot messages.
+    class KeyState {
+    public:
+        static constexpr size_t BYTE_SIZE = 32;
+
+        bool test(uint8_t vk) const {
+            return (words_[vk >> 6] >> (vk & 63)) & 1u;
+        }
+
+        // Returns true if the key's state actually changed.
+        bool set(uint8_t vk, bool pressed) {
+            uint64_t& word = words_[vk >> 6];
+            const uint64_t mask = uint64_t{1} << (vk & 63);
+            const uint64_t before = word;
+            word = pressed ? (word | mask) : (word & ~mask);
+            return word != before;
+        }
+
+        void reset() { words_ = {}; }
+
+        bool any() const {
+            return (words_[0] | words_[1] | words_[2] | words_[3]) != 0;
+        }
+
+        bool operator==(const KeyState& other) const { return words_ == other.words_; }
+        bool operator!=(const KeyState& other) const { return words_ != other.words_; }
+
+        // Little-endian bit order: bit (vk % 8) of byte (vk / 8).
+        std::array<uint8_t, BYTE_SIZE> toBytes() const {
+            std::array<uint8_t, BYTE_SIZE> bytes{};
+            for (size_t i = 0; i < BYTE_SIZE; ++i) {
+                bytes[i] = static_cast<uint8_t>(words_[i / 8] >> ((i % 8) * 8));
+            }
+            return bytes;
+        }
+
+        static KeyState fromBytes(const uint8_t* data, size_t length) {
+            KeyState state;
+            for (size_t i = 0; i < BYTE_SIZE && i < length; ++i) {
+                state.words_[i / 8] |= uint64_t{data[i]} << ((i % 8) * 8);
+            }
+            return state;
+        }
+
+        // Calls fn(vk, pressedInTarget) for every key whose state differs from target.
+        template <class Fn>
+        void forEachDifference(const KeyState& target, Fn&& fn) const {
+            for (size_t w = 0; w < words_.size(); ++w) {
+                uint64_t diff = words_[w] ^ target.words_[w];
+                for (unsigned bit = 0; diff != 0; ++bit, diff >>= 1) {
+                    if (diff & 1u) {
+                        uint8_t vk = static_cast<uint8_t>(w * 64 + bit);
+                        fn(vk, target.test(vk));
+                    }
+                }
+            }
+        }
+
+    private:
+        std::array<uint64_t, 4> words_{};
+    };
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 #ifndef _WIN32
 #include "input/InputManager.h"
+#include "input/HelperSharedMemory.h"
 #include "utils/KeycodeConverter.h"
 #include "utils/Logger.h"
 #include <vector>
@@ -12,9 +13,7 @@
 #include <asio/local/stream_protocol.hpp>
 #include <sys/types.h>
 #include <unistd.h>   
-#include <unordered_set>  
-
-struct HelperSharedData;  
+#include "input/KeyState.h"
 
 namespace LocalTether::Input {
 
@@ -27,7 +26,12 @@ public:
     void stop() override;
 
     std::vector<LocalTether::Network::InputPayload> pollEvents() override;
+    void waitForEvents(std::chrono::milliseconds timeout) override;
     void simulateInput(LocalTether::Network::InputPayload payload, uint16_t hostScreenWidth, uint16_t hostScreenHeight) override;
+    void setRelativeMouseMode(bool enabled) override;
+    void setLocalPassthrough(bool enabled) override;
+    // Only valid on the thread that calls pollEvents().
+    std::optional<KeyState> capturedKeyState() const override;
 
     void setInputPaused(bool paused);
     bool isInputPaused() const;
@@ -66,7 +70,9 @@ private:
         ResumeStream = 3, 
         Shutdown = 4,
         GrabDevices = 5,  
-        UngrabDevices = 6  
+        UngrabDevices = 6,
+        SetMouseMode = 7,  // one byte: 1 for relative capture, 0 for absolute
+        SetLatencyTrace = 8 // one byte: 1 to stamp captured payloads with their read time
     };
     void sendCommandToHelper(IPCCommandType cmdType, const std::vector<uint8_t>& data = {});
     void sendPayloadToHelper(IPCCommandType cmdType, const LocalTether::Network::InputPayload& payload);
@@ -75,11 +81,12 @@ private:
     bool open_and_map_shared_memory();
     void close_and_unmap_shared_memory();
     bool read_info_from_shared_memory(pid_t& out_pid, std::string& out_socket_path);
+    bool attach_shared_rings();
 
     void checkAndTogglePauseCombo();
 
      
-    std::unordered_set<uint8_t> m_currently_pressed_vk_codes;  
+    KeyState m_currently_pressed_keys;
     bool m_combo_was_active_last_poll = false;  
 
     std::atomic<bool> running_{false};
@@ -90,9 +97,17 @@ private:
     pid_t helper_actual_pid_ = -1; 
     std::string actual_helper_socket_path_; 
 
-    const char* shm_name_ = "/localtether_shm_helper_info"; 
+    const char* shm_name_ = HelperIpc::SHM_NAME; 
     int shm_fd_ = -1;                                      
     HelperSharedData* shared_data_ptr_ = nullptr;          
+    bool shm_writable_ = false;
+    // True while input payloads flow through the shared-memory rings instead of the socket.
+    std::atomic<bool> rings_active_{false};
+    // How long a key or scroll payload waits for room in a full simulation ring before it is
+    // sent over the socket instead.
+    static constexpr std::chrono::milliseconds RING_FULL_WAIT{20};
+    // Latency tracing state last sent to the helper; cleared on connect since a new helper starts off.
+    std::atomic<bool> helper_latency_trace_{false};
 
     asio::io_context ipc_io_context_;
     asio::local::stream_protocol::socket ipc_socket_;
@@ -1,7 +1,27 @@
 #pragma once
 
 #ifndef _WIN32
+#include "input/EvdevTrace.h"
+#include <vector>
+#include <cstddef>
+
 namespace LocalTether::Input {
     int runInputHelperMode(int argc, char ** argv);
+
+    struct TraceReplayStats {
+        size_t events = 0;
+        size_t payloads = 0;
+        double seconds = 0.0;
+        double eventsPerSecond = 0.0;
+        // Per report: first evdev event fed until the payload was encoded, decoded and injected.
+        double meanLatencyUs = 0.0;
+        double p99LatencyUs = 0.0;
+    };
+
+    // Drives a recorded trace through the helper's capture and injection logic in-process.
+    bool replayEvdevTrace(const EvdevTrace::Trace& trace, std::vector<Network::InputPayload>& captured, TraceReplayStats& stats);
+
+    // --replay-input-trace <trace> [--golden <file>] [--update-golden] [--iterations <n>] [--relative]
+    int runInputTraceMode(int argc, char ** argv);
 }
 #endif
@@ -0,0 +1,74 @@
+#pragma once
+#include "network/Message.h"
+#include <chrono>
+#include <deque>
+#include <optional>
+#include <cstdint>
+
+namespace LocalTether::Input {
+
+    // Receiver-side playout buffer for absolute mouse positions. Positions are held for a short
+    // playout delay and re-sampled at a steady rate by linear interpolation on a de-jittered
+    // timeline,
+    // so network jitter no longer shows up as cursor stutter. When the buffer runs dry the last
+    // velocity is extrapolated for a bounded time. Keys, buttons, scroll and relative motion
+    // are never delayed; the caller flushes the buffer before injecting them so they land at
+    // the position the host saw.
+    class MotionJitterBuffer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr std::chrono::microseconds MIN_DELAY{4000};
+        static constexpr std::chrono::microseconds MAX_DELAY{60000};
+        static constexpr std::chrono::milliseconds PLAYOUT_INTERVAL{4};
+
+        // "input.jitter_buffer" (default false).
+        static bool isEnabledInConfig();
+
+        // True if payload is a pure position update that may be delayed.
+        bool accepts(const Network::InputPayload& payload) const;
+        void push(const Network::InputPayload& payload, Clock::time_point arrival);
+
+        // The position to inject at now, or nothing if it has not moved since the last sample.
+        std::optional<Network::InputPayload> sample(Clock::time_point now);
+
+        // Drops buffered history ahead of a payload that bypasses the buffer and returns the
+        // newest position if it has not been injected yet.
+        std::optional<Network::InputPayload> flushBefore(const Network::InputPayload& bypassing);
+
+        // Sizes the delay from the link's RTT deviation, clamped to [MIN_DELAY, MAX_DELAY].
+        void updateDelayFromRtt(double rttVarianceMs);
+        std::chrono::microseconds playoutDelay() const { return delay_; }
+
+        bool empty() const { return samples_.empty(); }
+        void reset();
+
+    private:
+        struct Sample {
+            // Smoothed presentation time, not the raw arrival time.
+            Clock::time_point stamp;
+            float x;
+            float y;
+        };
+
+        Network::InputPayload makePayload(float x, float y) const;
+        void rememberVelocity(const Sample& a, const Sample& b);
+
+        std::deque<Sample> samples_;
+        std::chrono::microseconds delay_{MIN_DELAY};
+        Network::InputSourceDeviceType lastSource_ = Network::InputSourceDeviceType::MOUSE_ABSOLUTE;
+        uint8_t lastButtons_ = 0;
+        float lastEmittedX_ = -1.0f;
+        float lastEmittedY_ = -1.0f;
+        // Screen fractions per second along the most recent segment.
+        double velocityX_ = 0.0;
+        double velocityY_ = 0.0;
+        bool velocityValid_ = false;
+
+        Clock::time_point lastArrival_{};
+        Clock::time_point lastStamp_{};
+        Clock::duration cadence_{Clock::duration::zero()};
+        bool hasLastArrival_ = false;
+    };
+
+}
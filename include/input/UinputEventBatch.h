@@ -0,0 +1,32 @@
+#pragma once
+#ifndef _WIN32
+#include <linux/input.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace LocalTether::Input {
+
+    // Collects input_event records for one or more payloads and hands them to the uinput
+    // device in a single write() instead of one syscall per key, axis and sync.
+    class UinputEventBatch {
+    public:
+        explicit UinputEventBatch(size_t reserveEvents = 64) { events_.reserve(reserveEvents); }
+
+        void add(uint16_t type, uint16_t code, int32_t value);
+        void sync() { add(EV_SYN, SYN_REPORT, 0); }
+
+        bool empty() const { return events_.empty(); }
+        size_t size() const { return events_.size(); }
+
+        // Writes everything collected so far to fd and clears the batch. Returns false on a
+        // write error; events the kernel did not accept are dropped either way.
+        bool flush(int fd);
+        void clear() { events_.clear(); }
+
+    private:
+        std::vector<struct input_event> events_;
+    };
+
+}
+#endif
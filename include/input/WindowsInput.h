@@ -17,7 +17,7 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
-#include <unordered_set>
+#include "input/KeyState.h"
 #include <queue>
 #include <cmath>
 #include <array> 
@@ -44,6 +44,7 @@ public:
 
     void setPauseKeyCombo(const std::vector<uint8_t>& combo) override;
     std::vector<uint8_t> getPauseKeyCombo() const override;
+    std::optional<KeyState> capturedKeyState() const override;
 
     bool isRunning() const override {
         return m_running.load(std::memory_order_relaxed);
@@ -69,10 +70,16 @@ private:
     std::vector<LocalTether::Network::InputPayload> m_received_payloads_queue; 
     std::mutex m_payload_queue_mutex; 
 
-    std::unordered_set<BYTE> m_hook_pressed_keys; 
+    KeyState m_hook_pressed_keys; 
+    // Guards m_hook_pressed_keys against capturedKeyState() readers off the hook thread.
+    mutable std::mutex m_hook_pressed_keys_mutex;
     bool m_hook_combo_was_active_last_check = false;
     mutable std::mutex m_pause_key_combo_mutex_;
 
+    // Fractional mickeys of MOUSE_RELATIVE payloads not yet injected.
+    float m_relativeCarryX = 0.0f;
+    float m_relativeCarryY = 0.0f;
+
     float m_virtualRelativeX = 0.5f; 
     float m_virtualRelativeY = 0.5f;
     POINT m_lastHookAbsCoords = {-1, -1}; 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Message.h"
+#include "network/RttEstimator.h"
+#include "input/MotionJitterBuffer.h"
+#include "input/DesktopLayout.h"
 #include "utils/Logger.h"
 #include "input/InputManager.h"  
 #include <optional>
@@ -13,11 +16,14 @@
 #include <utils/KeycodeConverter.h>
 #include <vector> 
 #include <cstdint>
+#include <unordered_map>
 
 #include <cereal/archives/binary.hpp> 
 #include <sstream>
 #include "ui/FlowPanels.h" 
 #include "ui/panels/FileExplorerPanel.h"
+#include "utils/WorkerPool.h"
+#include "utils/TransferCompression.h"
 
 namespace LocalTether::Network {
 
@@ -71,6 +77,9 @@ public:
     void sendChatMessage(const std::string& chatMessage);
     void sendCommand(const std::string& command);
     void requestFile(const std::string& filename);
+    // Fetches every listed path; directories are expanded recursively by the server.
+    void requestFiles(const std::vector<std::string>& paths);
+    void requestDirectory(const std::string& relativeDirectory);
 
     LocalTether::Input::InputManager* getInputManager() const;
 
@@ -87,6 +96,10 @@ private:
     void handleTcpConnect(const std::error_code& error, const asio::ip::tcp::endpoint& endpoint);
     
     void handleFileError(const Message& msg);
+    void handleFileDelta(const Message& msg);
+    void handleFileSignature(const Message& msg);
+    void sendFullUpload(const std::string& localFilePath, const std::string& serverRelativePath, const std::string& fileNameOnServer);
+    void storeCachedFile(const std::string& relativePath, const std::vector<char>& fileContent);
 
     void doSslHandshake();
     void handleSslHandshake(const std::error_code& error);
@@ -109,6 +122,16 @@ private:
     void stopInputLogging();
     void inputLoop();
 
+    // Receiver side: routes a payload through the motion jitter buffer when it is enabled.
+    void deliverInput(const InputPayload& payload);
+    void schedulePlayout();
+    void scheduleKeepAlive();
+
+    // Host side: enables the desktop layout when layout.* is configured and capture is relative.
+    void configureDesktopLayout();
+    // Capture thread: hands held keys over when the layout cursor changes screens.
+    void switchLayoutTarget(uint32_t previous, uint32_t target);
+
     asio::io_context& io_context_;
     asio::ip::tcp::resolver resolver_;
     
@@ -133,6 +156,13 @@ private:
     std::mutex writeMutex_;
     std::atomic<bool> writing_{false};
 
+    // "relativePath\0fileName" -> local source path, for uploads waiting on server signatures.
+    std::unordered_map<std::string, std::string> pendingDeltaUploads_;
+    std::mutex pendingUploadsMutex_;
+
+    std::atomic<uint32_t> sessionCapabilities_{CapabilityNone};
+    LocalTether::Utils::TransferCompression::ThroughputEstimator linkThroughput_;
+
     ConnectHandler connectHandler_;
     DisconnectHandler disconnectHandler_;
     MessageHandler messageHandler_;  
@@ -144,10 +174,30 @@ private:
     std::atomic<bool> loggingInput_{false};
     uint16_t localScreenWidth_{0};   
     uint16_t localScreenHeight_{0};  
+    // Top-left of display 0 in global pointer coordinates.
+    int localScreenX_{0};
+    int localScreenY_{0};
     uint16_t hostScreenWidth_{0};    
     uint16_t hostScreenHeight_{0};   
 
+    // KeepAlive probes feed the RTT estimate that sizes the jitter buffer; both timers and the
+    // buffer are only touched on the io thread.
+    asio::steady_timer keepAliveTimer_;
+    asio::steady_timer playoutTimer_;
+    RttEstimator rtt_;
+    LocalTether::Input::MotionJitterBuffer motionBuffer_;
+    bool motionBufferEnabled_{false};
+
+    // Receiver side: keys this client has injected and not yet released (io thread only).
+    LocalTether::Input::KeyState injectedKeys_;
+    static constexpr std::chrono::seconds KEY_STATE_SNAPSHOT_INTERVAL{2};
+
+    // Host side: receivers are announced on the io thread, route() runs on the input thread.
+    LocalTether::Input::DesktopLayout layout_;
+    std::atomic<bool> layoutActive_{false};
 
+    // Declared last so it is drained and joined before the members its jobs touch are destroyed.
+    std::unique_ptr<LocalTether::Utils::WorkerPool> fileWriterPool_;
       
 
 };
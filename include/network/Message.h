@@ -2,12 +2,15 @@
 #include <vector>
 #include <string>
 #include <cstdint>
-#include "ui/panels/FileExplorerPanel.h"
+#include <array>
+#include "storage/FileMetadata.h"
+#include "utils/DeltaSync.h"
 
 
 #include <cereal/cereal.hpp>  
 #include <cereal/types/vector.hpp>  
 #include <cereal/types/string.hpp>
+#include <cereal/types/array.hpp>
  
 namespace LocalTether::Network {
 
@@ -26,6 +29,14 @@ enum class MessageType : uint8_t {
         FileData,        
         FileResponse,    
         FileError,
+        FileSignatureRequest,
+        FileSignature,
+        FileDeltaRequest,
+        FileDelta,
+        FileDeltaUpload,
+        FileBatchRequest,
+        Compressed,
+        KeyStateSnapshot,
         Unknown
     };
 
@@ -52,6 +63,14 @@ struct KeyEvent {
     }  
 };
 
+// Feature bits exchanged in the handshake; the server replies with the subset both sides support.
+enum SessionCapability : uint32_t {
+    CapabilityNone = 0,
+    CapabilityZstdTransfer = 1u << 0,
+    // Host sends MOUSE_RELATIVE deltas and hi-res wheel instead of absolute positions.
+    CapabilityRelativeMouse = 1u << 1
+};
+
 struct HandshakePayload {
     ClientRole role;
     std::string clientName;
@@ -59,6 +78,7 @@ struct HandshakePayload {
     uint32_t clientId = 0;
     uint16_t hostScreenWidth = 0; 
     uint16_t hostScreenHeight = 0;
+    uint32_t capabilities = CapabilityNone;
 
     template <class Archive>
     void serialize(Archive & ar) {
@@ -67,7 +87,8 @@ struct HandshakePayload {
            CEREAL_NVP(password), 
            CEREAL_NVP(clientId), 
            CEREAL_NVP(hostScreenWidth), 
-           CEREAL_NVP(hostScreenHeight)
+           CEREAL_NVP(hostScreenHeight),
+           CEREAL_NVP(capabilities)
            );
     }
 };
@@ -75,7 +96,9 @@ struct HandshakePayload {
 enum class InputSourceDeviceType : uint8_t {
     UNKNOWN = 0,
     MOUSE_ABSOLUTE = 2,     
-    TRACKPAD_ABSOLUTE = 3 
+    TRACKPAD_ABSOLUTE = 3,
+    // Motion is carried in deltaX/deltaY (pixels, fractional) rather than relativeX/relativeY.
+    MOUSE_RELATIVE = 4
 };
 
 struct InputPayload {
@@ -87,6 +110,19 @@ struct InputPayload {
     uint8_t mouseButtons = 0;         
     int16_t scrollDeltaX = 0;
     int16_t scrollDeltaY = 0;
+    float deltaX = 0.0f;
+    float deltaY = 0.0f;
+    // Wheel in 1/120 notch units (REL_WHEEL_HI_RES / WHEEL_DELTA); 0 means use scrollDelta only.
+    int16_t scrollHiResX = 0;
+    int16_t scrollHiResY = 0;
+    // Receiver chosen by the host's desktop layout; 0 means every receiver the routing table
+    // gives this source. Network only, never written to the helper IPC.
+    uint32_t targetClientId = 0;
+    // Per-stage timestamps while latency tracing is on (see utils/LatencyStats.h); empty otherwise.
+    std::vector<uint64_t> latencyStampsUs;
+    // Local steady-clock time the payload crossed the helper IPC: the evdev read on capture, the
+    // app queueing it on injection. Helper IPC only, never sent over the network.
+    uint64_t ipcStampUs = 0;
 
     template <class Archive>
     void serialize(Archive & ar) {
@@ -97,7 +133,36 @@ struct InputPayload {
            CEREAL_NVP(relativeY), 
            CEREAL_NVP(mouseButtons), 
            CEREAL_NVP(scrollDeltaX), 
-           CEREAL_NVP(scrollDeltaY));
+           CEREAL_NVP(scrollDeltaY),
+           CEREAL_NVP(deltaX),
+           CEREAL_NVP(deltaY),
+           CEREAL_NVP(scrollHiResX),
+           CEREAL_NVP(scrollHiResY),
+           CEREAL_NVP(targetClientId),
+           CEREAL_NVP(latencyStampsUs));
+    }
+};
+
+// Every key the host currently holds, one bit per virtual-key code (see input/KeyState.h).
+struct KeyStateSnapshotPayload {
+    std::array<uint8_t, 32> pressed{};
+    // Same meaning as InputPayload::targetClientId.
+    uint32_t targetClientId = 0;
+
+    template <class Archive>
+    void serialize(Archive & ar) {
+        ar(CEREAL_NVP(pressed), CEREAL_NVP(targetClientId));
+    }
+};
+
+// Round-trip probe: the client stamps senderTimeUs, the server echoes it back with its own clock.
+struct KeepAlivePayload {
+    uint64_t senderTimeUs = 0;
+    uint64_t echoTimeUs = 0;
+
+    template <class Archive>
+    void serialize(Archive & ar) {
+        ar(CEREAL_NVP(senderTimeUs), CEREAL_NVP(echoTimeUs));
     }
 };
 
@@ -109,6 +174,15 @@ struct FileRequestPayload {
     std::string filename;
 };
 
+struct FileBatchRequestPayload {
+    std::vector<std::string> paths;  
+
+    template <class Archive>
+    void serialize(Archive & ar) {
+        ar(CEREAL_NVP(paths));
+    }
+};
+
 struct FileDataPayload {
     std::string filename;
     std::vector<uint8_t> chunkData;
@@ -146,6 +220,8 @@ public:
 
      
     std::vector<uint8_t> serialize() const;
+    // Header declares body_.size() + trailerLength; the caller streams the trailer bytes right after.
+    std::vector<uint8_t> serializeWithTrailer(uint64_t trailerLength) const;
      
     bool decodeHeader(const uint8_t* buffer, size_t bufferSize);  
      
@@ -156,16 +232,21 @@ public:
     InputPayload getInputPayload() const;  
     HandshakePayload getHandshakePayload() const;  
     
-    LocalTether::UI::Panels::FileMetadata getFileSystemMetadataPayload() const;
+    LocalTether::Storage::FileMetadata getFileSystemMetadataPayload() const;
 
        
     static Message createHandshake(const HandshakePayload& payload, uint32_t clientId);
     static Message createInput(const InputPayload& payload, uint32_t clientId);
     static Message createChat(const std::string& message, uint32_t clientId);
+    static Message createKeepAlive(const KeepAlivePayload& payload, uint32_t clientId);
+    KeepAlivePayload getKeepAlivePayload() const;
+    static Message createKeyStateSnapshot(const KeyStateSnapshotPayload& payload, uint32_t clientId);
+    KeyStateSnapshotPayload getKeyStateSnapshotPayload() const;
     static Message createCommand(const std::string& command, uint32_t clientId);
     static Message createFileRequest(const std::string& filename, uint32_t clientId);  
     static Message createFileUpload(const std::string& serverRelativePath, const std::string& fileNameOnServer, const std::vector<char>& fileContent, uint32_t senderId) ;
     static Message createFileResponse(const std::string& relativePath, const std::vector<char>& fileContent, uint32_t senderId);
+    static Message createFileResponsePrefix(const std::string& relativePath, uint32_t senderId);
     static Message createFileError(const std::string& errorMessage, const std::string& relatedPath, uint32_t senderId);
     
     std::string getServerRelativePathFromUpload() const;
@@ -176,12 +257,31 @@ public:
 
     std::string getRelativePathFromFileResponse() const;
 
-    static Message createFileSystemUpdate(const LocalTether::UI::Panels::FileMetadata& rootNode, uint32_t senderClientId);
+    // Wraps an already compressed envelope (see utils/TransferCompression.h).
+    static Message createCompressed(const std::vector<uint8_t>& envelope, uint32_t senderId);
+    // Restores the original message from a Compressed envelope; false if the envelope is corrupt.
+    bool decompressTo(Message& inner) const;
+
+    static Message createFileBatchRequest(const FileBatchRequestPayload& payload, uint32_t clientId);
+    FileBatchRequestPayload getFileBatchRequestPayload() const;
+
+    static Message createFileSignatureRequest(const std::string& serverRelativePath, const std::string& fileNameOnServer, uint32_t senderId);
+    static Message createFileSignature(const std::string& serverRelativePath, const std::string& fileNameOnServer, const LocalTether::Utils::DeltaSync::FileSignature& signature, uint32_t senderId);
+    static Message createFileDeltaRequest(const std::string& relativePath, const LocalTether::Utils::DeltaSync::FileSignature& cachedSignature, uint32_t senderId);
+    static Message createFileDelta(const std::string& relativePath, const LocalTether::Utils::DeltaSync::FileDelta& delta, uint32_t senderId);
+    static Message createFileDeltaUpload(const std::string& serverRelativePath, const std::string& fileNameOnServer, const LocalTether::Utils::DeltaSync::FileDelta& delta, uint32_t senderId);
+
+    LocalTether::Utils::DeltaSync::FileSignature getFileSignaturePayload() const;
+    LocalTether::Utils::DeltaSync::FileDelta getFileDeltaPayload() const;
+
+    static Message createFileSystemUpdate(const LocalTether::Storage::FileMetadata& rootNode, uint32_t senderClientId);
      
     static std::string messageTypeToString(MessageType type);
 
 
 private:
+    size_t offsetAfterFields(size_t fieldCount) const;
+
     MessageType type_;
     uint32_t clientId_;  
     uint64_t bodySize_;  
@@ -0,0 +1,21 @@
+#pragma once
+#include "network/Message.h"
+#include <cstddef>
+
+namespace LocalTether::Network::NetworkMetrics {
+
+    // Message and byte counters shared by Session (server side) and Client. Each message is
+    // counted once per hop under its wire type; Compressed envelopes and the file messages
+    // also feed the file transfer byte counter.
+    void countReceived(MessageType type, size_t bytes);
+    void countSent(MessageType type, size_t bytes);
+
+    enum class InputStage {
+        Captured,   // polled on the host
+        Relayed,    // forwarded by the server
+        Injected    // handed to the input backend on a receiver
+    };
+
+    void countInput(InputStage stage);
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace LocalTether::Network {
+
+    class Session;
+
+    // Which receivers each input source (a Host session) drives. Tables are immutable: the
+    // server builds a new one under its session lock whenever membership or assignments change
+    // and swaps it in atomically, so forwarding Input reads it without taking any lock.
+    class RoutingTable {
+    public:
+        using Targets = std::vector<std::shared_ptr<Session>>;
+
+        // The mutable inputs a table is built from. Receivers without an entry in
+        // receiverSource follow the primary host. A source with a focus entry drives only that
+        // receiver out of the ones it owns, which is what the route hotkey cycles through.
+        struct Assignments {
+            uint32_t primarySource = 0;
+            std::unordered_map<uint32_t, uint32_t> receiverSource;
+            std::unordered_map<uint32_t, uint32_t> sourceFocus;
+        };
+
+        static std::shared_ptr<const RoutingTable> build(const std::vector<std::shared_ptr<Session>>& sessions,
+                                                         const Assignments& assignments);
+
+        bool isSource(uint32_t clientId) const { return owned_.count(clientId) != 0; }
+        // Sessions input from sourceId is forwarded to; empty for unknown sources.
+        const Targets& targetsFor(uint32_t sourceId) const;
+        // Every receiver the source owns, ignoring focus, in client id order.
+        const std::vector<uint32_t>& receiversOf(uint32_t sourceId) const;
+        // The source driving receiverId, or 0 when it is not routed.
+        uint32_t sourceOf(uint32_t receiverId) const;
+        // receiverId's session if sourceId owns it and it accepts input, ignoring focus. Used for
+        // payloads the host's desktop layout addressed to one receiver.
+        std::shared_ptr<Session> ownedReceiver(uint32_t sourceId, uint32_t receiverId) const;
+        std::vector<uint32_t> sources() const;
+
+    private:
+        std::unordered_map<uint32_t, Targets> targets_;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> owned_;
+        std::unordered_map<uint32_t, uint32_t> sourceOf_;
+        std::unordered_map<uint32_t, std::shared_ptr<Session>> enabled_;
+    };
+
+}
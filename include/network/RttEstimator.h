@@ -0,0 +1,46 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace LocalTether::Network {
+
+    // Smoothed round-trip time and its mean deviation from KeepAlive echoes (RFC 6298 weights).
+    // Samples arrive on the io thread; the smoothed values may be read from any thread.
+    class RttEstimator {
+    public:
+        static uint64_t nowUs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        void addSample(double rttMs);
+        // Estimates remote clock minus local clock from one echo, NTP style. The offset kept is
+        // the one from the lowest-RTT probe among the last few, where queueing skews it least.
+        void addClockSample(uint64_t sentUs, uint64_t remoteUs, uint64_t receivedUs);
+        void reset();
+
+        double smoothedRttMs() const { return srttMs_.load(std::memory_order_relaxed); }
+        double rttVarianceMs() const { return rttVarMs_.load(std::memory_order_relaxed); }
+        uint32_t sampleCount() const { return samples_.load(std::memory_order_relaxed); }
+        int64_t clockOffsetUs() const { return clockOffsetUs_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> srttMs_{0.0};
+        std::atomic<double> rttVarMs_{0.0};
+        std::atomic<uint32_t> samples_{0};
+
+        static constexpr size_t CLOCK_WINDOW = 8;
+        struct ClockSample {
+            uint64_t rttUs;
+            int64_t offsetUs;
+        };
+        // Only touched from the io thread.
+        std::array<ClockSample, CLOCK_WINDOW> clockSamples_{};
+        size_t clockSampleCount_ = 0;
+        size_t clockSampleNext_ = 0;
+        std::atomic<int64_t> clockOffsetUs_{0};
+    };
+
+}
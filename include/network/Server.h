@@ -1,19 +1,23 @@
 #pragma once
 
 #include "Message.h"
+#include "RoutingTable.h"
 
 #include <string>
 #include <memory>
 #include <vector>
 #include <functional>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <algorithm> 
 #include <optional>
 #include "utils/KeycodeConverter.h"
+#include "utils/MappedFile.h"
+#include "utils/Metrics.h"
+#include "utils/WorkerPool.h"
 
-#include "ui/panels/FileExplorerPanel.h"  
-#include "ui/FlowPanels.h" 
+#include "storage/StorageService.h"
 #include <fstream>
 #include <filesystem>
 #define ASIO_ENABLE_SSL
@@ -56,7 +60,6 @@ public:
     void setErrorHandler(ErrorHandler handler);
 
     void broadcast(const Message& message);
-    void broadcastToReceivers(const Message& message);
     void broadcastExcept(const Message& message, std::shared_ptr<Session> exceptSession);
 
     size_t getConnectionCount() const;
@@ -64,6 +67,8 @@ public:
 
     std::vector<std::shared_ptr<Session>> getSessions() const;
     uint32_t getHostClientId() const;
+    // Current routing snapshot; never null once the server is constructed.
+    std::shared_ptr<const RoutingTable> getRoutingTable() const;
     
     std::string password;
     bool localNetworkOnly;
@@ -71,11 +76,19 @@ public:
     uint32_t hostScreenWidth_ = 0;
     uint32_t hostScreenHeight_ = 0;
 
-     void setFileExplorerPanel(LocalTether::UI::Panels::FileExplorerPanel* fePanel);
+    // Shared file store. Created from storage.root (or server_storage next to the app) in the
+    // constructor; setStorage swaps it before start(), e.g. for a store somewhere else.
+    LocalTether::Storage::StorageService& getStorage() const { return *storage_; }
+    void setStorage(std::shared_ptr<LocalTether::Storage::StorageService> storage);
     
 private:
     
     void doAccept();
+    // Constructor stages; each records itself in StartupProgress and sets lastError_ on failure.
+    bool openAcceptor();
+    bool configureSsl(bool filesReady);
+    // Logs and exports (localtether_startup_ms) how long the server took to start accepting.
+    void reportStartupTime();
     
     void handleMessage(std::shared_ptr<Session> session, const Message& message);
     void handleDisconnect(std::shared_ptr<Session> session);
@@ -89,12 +102,21 @@ private:
      
     void notifyClientJoined(std::shared_ptr<Session> session);
     void notifyClientLeft(std::shared_ptr<Session> session);
+
+    // targetClientId is the receiver a host's desktop layout picked, or 0 for the routed set.
+    void forwardInput(std::shared_ptr<Session> source, const Message& message, uint32_t targetClientId);
+    void announceReceiverScreens(std::shared_ptr<Session> joined);
+    // Rebuilds the routing table from sessions_ and routeAssignments_; takes sessions_mutex_.
+    void rebuildRoutingTable();
+    bool processRouteCommand(std::shared_ptr<Session> session, const std::string& commandText);
     
      
     asio::io_context& io_context_;
     asio::ip::tcp::acceptor acceptor_;
     uint16_t port_;
     asio::ssl::context ssl_context_;
+    std::chrono::steady_clock::time_point constructedAt_;
+    bool startupReported_ = false;
     
 
      
@@ -102,6 +124,9 @@ private:
     mutable std::mutex sessions_mutex_;
     uint32_t nextClientId_ = 1; 
     uint32_t hostClientId_ = 0;
+    // Guarded by sessions_mutex_; routingTable_ is only accessed through std::atomic_load/store.
+    RoutingTable::Assignments routeAssignments_;
+    std::shared_ptr<const RoutingTable> routingTable_;
 
     std::atomic<bool> running_{false};
     std::atomic<ServerState> state_{ServerState::Stopped};
@@ -110,9 +135,28 @@ private:
     ErrorHandler errorHandler_;
 
     void processFileUpload(std::shared_ptr<Session> session, const Message& message);
-
-    std::string serverRootStoragePath_;  
-    LocalTether::UI::Panels::FileExplorerPanel* fileExplorerPanel_ = nullptr;
+    void processFileBatchRequest(std::shared_ptr<Session> session, const Message& message);
+    void processFileDeltaRequest(std::shared_ptr<Session> session, const Message& message);
+    void processFileSignatureRequest(std::shared_ptr<Session> session, const Message& message);
+    void processFileDeltaUpload(std::shared_ptr<Session> session, const Message& message);
+    void commitUploadedFile(std::shared_ptr<Session> session, const std::string& serverRelativePath, const std::string& fileNameOnServer, std::vector<char> fileContent);
+    void sendMappedFile(std::shared_ptr<Session> session, const std::string& relativePath, std::shared_ptr<const LocalTether::Utils::MappedFile> mappedFile);
+    uint32_t localCapabilities() const;
+    bool resolveStoragePath(const std::string& relativePath, std::filesystem::path& resolvedPath) const;
+
+    std::shared_ptr<LocalTether::Storage::StorageService> storage_;
+    // Compresses outgoing files and stores uploads off the io thread; sends are keyed per
+    // session so a session's files still go out in request order, stores per destination.
+    // Sessions stop reading file messages while it is saturated.
+    std::shared_ptr<LocalTether::Utils::WorkerPool> transferPool_;
+    // Pushes every rebuilt tree to the connected clients.
+    void broadcastFileTree(std::shared_ptr<const LocalTether::Storage::FileMetadata> tree);
+
+    // Replies to the primary host's "stats" command with the metrics registry as Prometheus text.
+    void sendStats(std::shared_ptr<Session> session);
+    // Per-session byte counts and queue depths, read when metrics are rendered.
+    void collectSessionMetrics(std::vector<LocalTether::Utils::MetricSample>& samples) const;
+    uint64_t metricsCollectorToken_ = 0;
 
 };
 
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace LocalTether::Network {
+
+    // Entry point for `LocalTether --server`: runs the relay and its file store with no window
+    // until SIGINT/SIGTERM. Settings come from server.port, server.password,
+    // server.local_only and storage.root in the config file; the command line overrides them:
+    //   --port <n> --password <p> --storage <dir> --public
+    int runServerMode(int argc, char** argv);
+
+}
@@ -3,6 +3,9 @@
 
 #include "Message.h"
 #include "utils/Logger.h"
+#include "utils/MappedFile.h"
+#include "utils/TransferCompression.h"
+#include "utils/WorkerPool.h"
 #define ASIO_ENABLE_SSL  
 #include <asio.hpp>
 #include <asio/ssl.hpp>  
@@ -31,7 +34,14 @@ public:
 
     void start(MessageHandler msgHandler, DisconnectHandler discHandler);
     void send(const Message& msg);
+    // Sends prefixMessage with the mapped file appended to its body, writing straight from the mapping.
+    void sendWithMappedBody(const Message& prefixMessage, std::shared_ptr<const LocalTether::Utils::MappedFile> mappedBody);
+    // Runs callback on the io thread once everything queued so far has been written, right away
+    // if nothing is. Dropped if the session closes first.
+    void whenWritesDrained(std::function<void()> callback);
     void close();
+    // Reading pauses after a file message while this pool is saturated and resumes once it drains.
+    void setTransferThrottle(std::weak_ptr<LocalTether::Utils::WorkerPool> pool);
 
     uint32_t getClientId() const { return clientId_; }
     std::string getClientAddress() const;
@@ -40,12 +50,32 @@ public:
     void setRole(ClientRole role) { role_ = role; }
     std::string getClientName() const { return clientName_; }
     void setClientName(const std::string& name) { clientName_ = name; }
+    bool isActive() const { return active_.load(std::memory_order_relaxed); }
     bool isAppHandshakeComplete() const { return appHandshakeComplete_.load(); }
     void setAppHandshakeComplete(bool status) { appHandshakeComplete_.store(status); }
 
     bool getCanReceiveInput() const { return canReceiveInput_; }
     void setCanReceiveInput(bool canReceive) { canReceiveInput_ = canReceive; }
+
+    uint32_t getCapabilities() const { return capabilities_.load(); }
+    void setCapabilities(uint32_t capabilities) { capabilities_.store(capabilities); }
+    // Resolution the client reported in its handshake.
+    uint16_t getScreenWidth() const { return screenWidth_.load(); }
+    uint16_t getScreenHeight() const { return screenHeight_.load(); }
+    void setScreenSize(uint16_t width, uint16_t height) { screenWidth_.store(width); screenHeight_.store(height); }
+    double getLinkBytesPerSecond() const { return linkThroughput_.bytesPerSecond(); }
+    uint64_t getBytesReceived() const { return bytesReceived_.load(std::memory_order_relaxed); }
+    uint64_t getBytesSent() const { return bytesSent_.load(std::memory_order_relaxed); }
+    // Buffers queued for this session, including the one being written.
+    size_t getWriteQueueDepth() const { return writeQueueDepth_.load(std::memory_order_relaxed); }
 private:
+    struct OutgoingBuffer {
+        std::vector<uint8_t> bytes;
+        std::shared_ptr<const LocalTether::Utils::MappedFile> mappedBody;
+    };
+
+    void enqueueWrite(OutgoingBuffer buffer);
+
     void doSslHandshake();
     void handleSslHandshake(const std::error_code& error);
 
@@ -54,10 +84,14 @@ private:
     void handleAppHandshakeResponseBody(const std::error_code& error, size_t bytes_transferred);
 
     void doRead();
+    // Called once a message has been handled: reads the next one now or once the transfer pool drains.
+    void readNext(MessageType handledType);
     void handleReadHeader(const std::error_code& error, size_t bytes_transferred);
     void handleReadBody(const std::error_code& error, size_t bytes_transferred);
 
     void doWrite();
+    // Streams a mapped body a chunk at a time through mappedChunk_, starting at offset.
+    void writeMappedBody(std::shared_ptr<OutgoingBuffer> data, size_t offset);
     void handleWrite(const std::error_code& error, size_t bytes_transferred);
 
     void doClose(const std::string& reason = "normal closure");
@@ -72,9 +106,17 @@ private:
     Message currentReadMessage_;        
      
 
-    std::queue<std::vector<uint8_t>> writeQueue_;
+    std::queue<OutgoingBuffer> writeQueue_;
+    // Staging for the chunk of a mapped body currently being written; only touched by the write chain.
+    std::vector<uint8_t> mappedChunk_;
     std::mutex writeMutex_;
     std::atomic<bool> writing_{false};
+    std::atomic<size_t> writeQueueDepth_{0};
+    // Set once the queue passes net.write_queue_high_watermark, cleared below half of it, so
+    // a slow peer is logged once per episode. Guarded by writeMutex_.
+    bool writeQueueBacklogged_ = false;
+    // Waiting for the write queue to empty. Guarded by writeMutex_.
+    std::vector<std::function<void()>> drainedCallbacks_;
     std::atomic<bool> active_{false}; 
     std::atomic<bool> sslHandshakeComplete_{false};
     std::atomic<bool> appHandshakeComplete_{false};
@@ -85,6 +127,13 @@ private:
     std::string remoteAddressString_;
 
     std::atomic<bool> canReceiveInput_{true};
+    std::atomic<uint32_t> capabilities_{CapabilityNone};
+    std::atomic<uint16_t> screenWidth_{0};
+    std::atomic<uint16_t> screenHeight_{0};
+    LocalTether::Utils::TransferCompression::ThroughputEstimator linkThroughput_;
+    std::atomic<uint64_t> bytesReceived_{0};
+    std::atomic<uint64_t> bytesSent_{0};
+    std::weak_ptr<LocalTether::Utils::WorkerPool> transferThrottle_;
 };
 
 }  
\ No newline at end of file
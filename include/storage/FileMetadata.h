@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/chrono.hpp>
+
+namespace LocalTether::Storage {
+
+    enum class FileSyncState {
+        SyncedWithServer,
+        LocalCacheOnly,
+        ServerOnly
+    };
+
+    // One node of the shared file tree, as sent in FileSystemUpdate. syncState and
+    // isCachedLocally are client-side bookkeeping and are not serialized.
+    struct FileMetadata {
+        std::string name;
+        std::string fullPath;
+        std::string relativePath;
+        bool isDirectory = false;
+        uintmax_t size = 0;
+        std::chrono::system_clock::time_point modifiedTime;
+        std::vector<FileMetadata> children;
+
+        FileSyncState syncState = FileSyncState::ServerOnly;
+        bool isCachedLocally = false;
+
+        template<class Archive>
+        void serialize(Archive & archive) {
+            archive(CEREAL_NVP(name), CEREAL_NVP(fullPath), CEREAL_NVP(relativePath),
+                    CEREAL_NVP(isDirectory), CEREAL_NVP(size),
+                    CEREAL_NVP(modifiedTime), CEREAL_NVP(children));
+        }
+    };
+
+}
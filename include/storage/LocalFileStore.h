@@ -0,0 +1,43 @@
+#pragma once
+#include "storage/StorageService.h"
+#include <atomic>
+#include <mutex>
+
+namespace LocalTether::Storage {
+
+    // StorageService over a plain directory on this machine.
+    class LocalFileStore : public StorageService {
+    public:
+        explicit LocalFileStore(std::filesystem::path root);
+
+        // storage.root from Config if set, otherwise server_storage under the data directory.
+        static std::filesystem::path defaultRoot();
+
+        // Builds the tree for root the way FileSystemUpdate expects it: directories first,
+        // then by name, in-flight atomic writes left out.
+        static FileMetadata scanTree(const std::filesystem::path& root);
+
+        std::filesystem::path root() const override { return root_; }
+        bool resolve(const std::string& relativePath, std::filesystem::path& resolvedPath) const override;
+        bool resolveFile(const std::string& relativeDir, const std::string& fileName,
+                         std::filesystem::path& resolvedPath) const override;
+        bool writeFile(const std::string& relativeDir, const std::string& fileName,
+                       const char* data, size_t size, std::string* error = nullptr) override;
+        std::shared_ptr<const FileMetadata> tree() const override;
+        uint64_t version() const override { return version_.load(std::memory_order_acquire); }
+        void rescan() override;
+        void setChangeListener(ChangeListener listener) override;
+
+    private:
+        std::filesystem::path root_;
+        std::filesystem::path canonicalRoot_;
+
+        mutable std::mutex mutex_;
+        std::shared_ptr<const FileMetadata> tree_;
+        ChangeListener listener_;
+        std::atomic<uint64_t> version_{0};
+        // Serializes whole rebuilds so a slow scan cannot overwrite a newer one.
+        std::mutex scanMutex_;
+    };
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "storage/FileMetadata.h"
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace LocalTether::Storage {
+
+    // Where the relay keeps shared files. Server owns one and only talks to it through this
+    // interface, so it runs the same with or without the GUI; the host's File Explorer reads
+    // the tree from here instead of scanning the directory itself.
+    class StorageService {
+    public:
+        // Called after every rebuild of the tree, on the thread that caused it.
+        using ChangeListener = std::function<void(std::shared_ptr<const FileMetadata>)>;
+
+        virtual ~StorageService() = default;
+
+        virtual std::filesystem::path root() const = 0;
+
+        // Maps a client-supplied relative path into the store. False if it would land outside
+        // root().
+        virtual bool resolve(const std::string& relativePath, std::filesystem::path& resolvedPath) const = 0;
+
+        // Maps relativeDir/fileName into the store. fileName must be a plain name: separators,
+        // "..", absolute paths and anything that resolves outside relativeDir are refused.
+        virtual bool resolveFile(const std::string& relativeDir, const std::string& fileName,
+                                 std::filesystem::path& resolvedPath) const = 0;
+
+        // Atomically replaces relativeDir/fileName, creating directories as needed, then
+        // rebuilds the tree.
+        virtual bool writeFile(const std::string& relativeDir, const std::string& fileName,
+                               const char* data, size_t size, std::string* error = nullptr) = 0;
+
+        // Latest tree; never null. Cheap to call, the snapshot is shared.
+        virtual std::shared_ptr<const FileMetadata> tree() const = 0;
+
+        // Bumped on every rebuild, so pollers can skip unchanged trees.
+        virtual uint64_t version() const = 0;
+
+        // Rebuilds the tree after changes made behind the store's back (e.g. the host
+        // renaming files in the File Explorer) and notifies the listener.
+        virtual void rescan() = 0;
+
+        virtual void setChangeListener(ChangeListener listener) = 0;
+    };
+
+}
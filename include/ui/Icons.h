@@ -25,4 +25,5 @@
 #define ICON_FA_PLAY           u8"\uf04b"
 #define ICON_FA_ARROW_LEFT    u8"\uf060"
 #define ICON_FA_SEARCH         u8"\uf002"
-#define ICON_FA_PLUG           u8"\uf1e6"
\ No newline at end of file
+#define ICON_FA_PLUG           u8"\uf1e6"
+#define ICON_FA_COPY           u8"\uf0c5"
\ No newline at end of file
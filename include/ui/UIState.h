@@ -17,6 +17,7 @@ namespace LocalTether::UI {
     extern bool show_console;
     extern bool show_properties;
     extern bool show_controls_panel;
+    extern bool show_metrics_panel;
 
     extern std::mutex g_mutex;
 
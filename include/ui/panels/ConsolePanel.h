@@ -1,8 +1,11 @@
 #pragma once
 #include "imgui_include.h"
+#include "utils/Logger.h"
 #include <vector>
+#include <deque>
 #include <string>
 #include <ctime>
+#include <cstdint>
 
 namespace LocalTether::UI::Panels {
     class ConsolePanel {
@@ -20,8 +23,19 @@ namespace LocalTether::UI::Panels {
     private:
 
         void ProcessCommand(const std::string& command);
-        
+        // Pulls only the lines logged since the last frame; returns how many arrived.
+        size_t FetchNewLines();
+
+        struct Line {
+            std::string text;
+            ImVec4 color;
+        };
+        static constexpr size_t MAX_LINES = 10000;
 
         char input[256] = "";
+        std::deque<Line> lines_;
+        uint64_t nextSequence_ = 0;
+        std::vector<LocalTether::Utils::LogEntry> fetched_;
+        bool scrollToBottom_ = false;
     };
 }
\ No newline at end of file
@@ -31,6 +31,7 @@ private:
     
      
     void ShowPauseKeySettings(LocalTether::Input::InputManager* inputManager);
+    void ShowLatencyStats();
 
      
     std::string comboToString(const std::vector<uint8_t>& combo);
@@ -8,11 +8,7 @@
 #include <filesystem>
 
 #include "ui/UIState.h"
-
-#include <cereal/cereal.hpp>
-#include <cereal/types/vector.hpp>
-#include <cereal/types/string.hpp>
-#include <cereal/types/chrono.hpp>
+#include "storage/FileMetadata.h"
 
 
 namespace LocalTether::Network {
@@ -25,39 +21,9 @@ namespace LocalTether::Network {
 
 namespace LocalTether::UI::Panels {
 
-    enum class FileSyncState {
-        SyncedWithServer, 
-        LocalCacheOnly,   
-        ServerOnly        
-    };
-
-    std::filesystem::path get_executable_directory();
-    std::filesystem::path find_ancestor_directory(const std::filesystem::path& start_path, const std::string& target_dir_name, int max_depth);
-
-
-    struct FileMetadata {
-        std::string name;
-        std::string fullPath;      
-        std::string relativePath;  
-        bool isDirectory = false;
-        uintmax_t size = 0;
-        std::chrono::system_clock::time_point modifiedTime;
-        std::vector<FileMetadata> children;
-        
-        
-        FileSyncState syncState = FileSyncState::ServerOnly; 
-        bool isCachedLocally = false;                      
-
-        template<class Archive>
-        void serialize(Archive & archive) {
-            
-            
-            archive(CEREAL_NVP(name), CEREAL_NVP(fullPath), CEREAL_NVP(relativePath),
-                    CEREAL_NVP(isDirectory), CEREAL_NVP(size),
-                    CEREAL_NVP(modifiedTime), CEREAL_NVP(children));
-        }
-    };
-    
+    // The tree types live with the storage service so the relay can use them without the UI.
+    using FileSyncState = LocalTether::Storage::FileSyncState;
+    using FileMetadata = LocalTether::Storage::FileMetadata;
 
 
     class FileExplorerPanel {
@@ -72,14 +38,13 @@ namespace LocalTether::UI::Panels {
         void HandleExternalFileDrop(const std::string& dropped_file_path);
         void ClearExternalDragState();
 
+        // On the host this rescans the server's store, which pushes the new tree to clients.
         void RefreshView();
-
-        
-        void BroadcastFileSystemUpdate();
         
     private:
         std::string rootStoragePath_;
         FileMetadata rootNode_; 
+        uint64_t shownStorageVersion_ = 0;
         
          
         std::string selectedPath_; 
@@ -104,7 +69,6 @@ namespace LocalTether::UI::Panels {
 
          
         void InitializeStorage(); 
-        void ScanDirectoryRecursive(const std::filesystem::path& dirPath, FileMetadata& parentNode);
         void DrawFileSystemNode(FileMetadata& node, const std::string& current_node_path_prefix);
         
          
@@ -0,0 +1,29 @@
+#pragma once
+#include "imgui_include.h"
+#include "utils/Metrics.h"
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace LocalTether::UI::Panels {
+
+class MetricsPanel {
+public:
+    void Show(bool* p_open = nullptr);
+
+private:
+    // Takes a new snapshot at most once per REFRESH_INTERVAL and derives per-second rates from
+    // the counter deltas since the previous one.
+    void Refresh();
+
+    static constexpr std::chrono::milliseconds REFRESH_INTERVAL{1000};
+
+    std::vector<LocalTether::Utils::MetricSample> samples_;
+    std::unordered_map<std::string, double> rates_;        // name{labels} -> per second
+    std::unordered_map<std::string, double> lastValues_;   // name{labels} -> counter value
+    std::chrono::steady_clock::time_point lastRefresh_{};
+    char filter_[64] = "";
+};
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <filesystem>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Crash-safe replacement of a file: data goes to a hidden temp file next to the
+// destination and is renamed over it only once fully written, so readers (and
+// the tree scan) only ever see the old contents or the complete new ones.
+
+namespace LocalTether::Utils {
+
+    enum class DurabilityPolicy {
+        None,   // rename only; contents may be lost on power failure but never torn
+        File,   // fsync the file data before the rename
+        Full    // additionally fsync the parent directory so the rename itself is durable
+    };
+
+    // Reads "storage.durability" (none|file|full), defaulting to file.
+    DurabilityPolicy durabilityPolicyFromConfig();
+
+    // Temp files carry this prefix so directory scans can skip in-flight writes.
+    constexpr const char* ATOMIC_TEMP_PREFIX = ".lt-partial-";
+    bool isAtomicTempFile(const std::string& fileName);
+
+    class AtomicFileWriter {
+    public:
+        AtomicFileWriter(const std::filesystem::path& destination, DurabilityPolicy policy);
+        ~AtomicFileWriter();
+
+        AtomicFileWriter(const AtomicFileWriter&) = delete;
+        AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+        // Creates the temp file and reserves expectedSize bytes up front to avoid fragmentation
+        // and surface ENOSPC before any data is written.
+        bool open(uint64_t expectedSize);
+        bool write(const char* data, size_t length);
+        // Flushes per policy and renames into place, keeping the permissions of the file it
+        // replaces. Blocks on fsync, so keep it off io threads. The writer is finished afterwards
+        // either way.
+        bool commit();
+        // Drops the temp file; called automatically if the writer is destroyed uncommitted.
+        void abort();
+
+        const std::string& lastError() const { return lastError_; }
+
+        // Convenience for the common whole-buffer case.
+        static bool writeFile(const std::filesystem::path& destination, const char* data, size_t length,
+                              DurabilityPolicy policy, std::string* error = nullptr);
+
+    private:
+        bool fail(const std::string& what);
+        void closeHandle();
+
+        std::filesystem::path destination_;
+        std::filesystem::path tempPath_;
+        DurabilityPolicy policy_;
+        uint64_t written_ = 0;
+        uint64_t reserved_ = 0;
+        std::string lastError_;
+#ifdef _WIN32
+        void* handle_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+    };
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <type_traits>
+#include <optional>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+// Compact on-disk log format, selected with log.format=binary. Producers copy the raw
+// arguments of an LT_LOG_* call instead of formatting them; the format string is written
+// once per file and referenced by id. tools/logdecode turns a file back into text.
+//
+// File:    "LTLOG\0\0\1" then frames, each starting with a FrameKind byte (little endian):
+//   Session  u64 start time (us since epoch); forget every format id seen so far
+//   Format   u32 id, u32 length, text
+//   Record   u64 time (us since epoch), u8 level, u32 format id (0 = args hold plain text),
+//            u32 length, args
+// Args:    a tag byte (ArgTag) followed by the value; strings are u32 length + bytes.
+
+namespace LocalTether::Utils::BinaryLog {
+
+    constexpr char FILE_MAGIC[8] = {'L', 'T', 'L', 'O', 'G', '\0', '\0', '\1'};
+    // Ids are handed out once per LT_LOG_* call site, so a larger one means a corrupt file.
+    constexpr uint32_t MAX_FORMAT_ID = 1u << 20;
+
+    enum class FrameKind : uint8_t {
+        Session = 1,
+        Format = 2,
+        Record = 3
+    };
+
+    enum class ArgTag : uint8_t {
+        Int = 1,
+        UInt = 2,
+        Double = 3,
+        Bool = 4,
+        String = 5
+    };
+
+    template <typename T>
+    void appendRaw(std::string& out, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    inline void appendString(std::string& out, std::string_view text) {
+        out += static_cast<char>(ArgTag::String);
+        appendRaw(out, static_cast<uint32_t>(text.size()));
+        out += text;
+    }
+
+    template <typename T>
+    void encodeArg(std::string& out, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            out += static_cast<char>(ArgTag::Bool);
+            out += static_cast<char>(value ? 1 : 0);
+        } else if constexpr (std::is_same_v<T, char>) {
+            appendString(out, std::string_view(&value, 1));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            out += static_cast<char>(ArgTag::Int);
+            appendRaw(out, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            out += static_cast<char>(ArgTag::UInt);
+            appendRaw(out, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_enum_v<T>) {
+            encodeArg(out, static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            appendString(out, std::string_view(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            out += static_cast<char>(ArgTag::Double);
+            appendRaw(out, static_cast<double>(value));
+        } else {
+            std::ostringstream stream;
+            stream << value;
+            appendString(out, stream.str());
+        }
+    }
+
+    template <typename... Args>
+    std::string encodeArgs(const Args&... args) {
+        std::string out;
+        out.reserve(sizeof...(Args) * 9);
+        (encodeArg(out, args), ...);
+        return out;
+    }
+
+    // Renders encoded args into format the same way formatLog would; malformed args end the
+    // substitution early rather than failing the whole line.
+    std::string render(std::string_view format, std::string_view args);
+
+    struct Frame {
+        FrameKind kind;
+        uint64_t timeUs = 0;
+        uint8_t level = 0;
+        uint32_t formatId = 0;
+        std::string_view body;   // format text or record args
+    };
+
+    // Parses the frame starting at data[offset] and advances offset past it. nullopt means a
+    // truncated or unknown frame, e.g. the tail of a file still being written.
+    std::optional<Frame> readFrame(std::string_view data, size_t& offset);
+
+}
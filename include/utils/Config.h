@@ -1,17 +1,24 @@
 #pragma once
+#include "utils/ConfigSchema.h"
 #include <string>
 #include <unordered_map>
 #include <any>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <cstdint>
 
-//not used yet
-
 namespace LocalTether::Utils {
     class Config {
     public:
         static Config& GetInstance();
         
 
+        // Replaces every value with the file's contents and publishes a new Live() snapshot.
         bool LoadFromFile();
         bool SaveToFile();
         
@@ -22,18 +29,50 @@ namespace LocalTether::Utils {
         template<typename T>
         T Get(const std::string& key, const T& defaultValue);
 
+        int Get(const ConfigKey<int>& key) { return Get<int>(std::string(key.name), key.defaultValue); }
+        float Get(const ConfigKey<float>& key) { return Get<float>(std::string(key.name), key.defaultValue); }
+        bool Get(const ConfigKey<bool>& key) { return Get<bool>(std::string(key.name), key.defaultValue); }
+        std::string Get(const ConfigKey<std::string_view>& key) {
+            return Get<std::string>(std::string(key.name), std::string(key.defaultValue));
+        }
+
         bool HasKey(const std::string& key);
 
+        // Hot-path tunables: one acquire load, no lock, no lookup. Holds the built-in defaults
+        // until the file is first loaded (the first GetInstance()). The reference stays valid
+        // for the life of the process, but only reflects the config at the time of the call.
+        static const ConfigSnapshot& Live() { return *live_.load(std::memory_order_acquire); }
+
+        // Polls the config file every config.reload_interval_ms and reloads it when it
+        // changes. Safe to call more than once.
+        void StartWatching();
+        void StopWatching();
+
         static const std::string& GetPauseComboKey();
         static const std::string& GetDefaultConfigFilePath();
         
     private:
         Config();
-        ~Config() = default;
+        ~Config();
         
         Config(const Config&) = delete;
         Config& operator=(const Config&) = delete;
+
+        void PublishSnapshot();
+        void WatchLoop(std::chrono::milliseconds interval);
         
+        std::mutex valuesMutex_;
         std::unordered_map<std::string, std::any> values;
+
+        static std::atomic<const ConfigSnapshot*> live_;
+        std::mutex publishMutex_;
+        // Every snapshot ever published. Readers may still hold a reference to an old one, and
+        // reloads are rare, so they are kept instead of reclaimed.
+        std::vector<std::unique_ptr<const ConfigSnapshot>> snapshots_;
+
+        std::mutex watchMutex_;
+        std::condition_variable watchWake_;
+        bool watchStopping_ = false;
+        std::thread watchThread_;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "utils/Logger.h"
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// Every key localtether_config.cfg understands, with its type and default in one place, plus the
+// subset that hot paths read through Config::Live().
+
+namespace LocalTether::Utils {
+
+    // A key and its default. T is int, float, bool or std::string_view (read back as
+    // std::string); Config::Get(key) picks the right type, so call sites cannot disagree on it.
+    template <typename T>
+    struct ConfigKey {
+        std::string_view name;
+        T defaultValue;
+    };
+
+    namespace ConfigKeys {
+        inline constexpr ConfigKey<std::string_view> LogLevel{"log.level", "trace"};
+        inline constexpr ConfigKey<std::string_view> LogFormat{"log.format", "text"};
+        inline constexpr ConfigKey<int> LogMaxFileBytes{"log.max_file_bytes", 0};
+        inline constexpr ConfigKey<int> LogMaxFiles{"log.max_files", 3};
+
+        inline constexpr ConfigKey<std::string_view> InputMouseMode{"input.mouse_mode", "absolute"};
+        inline constexpr ConfigKey<bool> InputJitterBuffer{"input.jitter_buffer", false};
+        inline constexpr ConfigKey<bool> InputLatencyTrace{"input.latency_trace", false};
+        inline constexpr ConfigKey<std::string_view> InputTraceRecordPath{"input.trace_record_path", ""};
+        // Longest the input loop waits for new events before polling again.
+        inline constexpr ConfigKey<int> InputPollWaitMs{"input.poll_wait_ms", 10};
+        // Smallest pointer move (fraction of the screen) the Windows polling capture sends.
+        inline constexpr ConfigKey<float> InputRelativeDeadzone{"input.relative_deadzone", 0.002f};
+
+        inline constexpr ConfigKey<bool> TransferCompression{"transfer.compression", true};
+        inline constexpr ConfigKey<std::string_view> StorageDurability{"storage.durability", "file"};
+        inline constexpr ConfigKey<std::string_view> StorageRoot{"storage.root", ""};
+        // Queued outgoing messages per session before a slow peer is logged; 0 turns it off.
+        inline constexpr ConfigKey<int> NetWriteQueueHighWatermark{"net.write_queue_high_watermark", 512};
+
+        inline constexpr ConfigKey<int> ServerPort{"server.port", 8080};
+        // Where the server's TLS key and certificate are kept; empty means "tls" in the data
+        // directory.
+        inline constexpr ConfigKey<std::string_view> TlsDir{"tls.dir", ""};
+        inline constexpr ConfigKey<bool> ServerLocalOnly{"server.local_only", true};
+        inline constexpr ConfigKey<std::string_view> ServerPassword{"server.password", ""};
+
+        inline constexpr ConfigKey<int> MetricsDumpIntervalS{"metrics.dump_interval_s", 0};
+        inline constexpr ConfigKey<std::string_view> MetricsDumpPath{"metrics.dump_path", "metrics.prom"};
+
+        inline constexpr ConfigKey<bool> UiPowerSaving{"ui.power_saving", true};
+        inline constexpr ConfigKey<int> UiIdleRefreshMs{"ui.idle_refresh_ms", 1000};
+        inline constexpr ConfigKey<int> UiUnfocusedFps{"ui.unfocused_fps", 10};
+
+        // How often the config file is checked for edits; 0 turns live reload off.
+        inline constexpr ConfigKey<int> ConfigReloadIntervalMs{"config.reload_interval_ms", 1000};
+    }
+
+    // Tunables read on hot paths, parsed once per load. A reload publishes a new snapshot as a
+    // whole, so a reader sees either all old or all new values.
+    struct ConfigSnapshot {
+        LogLevel logLevel = LogLevel::Trace;
+        bool logBinary = false;
+        uint64_t logMaxFileBytes = 0;
+        uint32_t logMaxFiles = static_cast<uint32_t>(ConfigKeys::LogMaxFiles.defaultValue);
+
+        bool relativeMouseMode = false;
+        bool jitterBuffer = ConfigKeys::InputJitterBuffer.defaultValue;
+        int inputPollWaitMs = ConfigKeys::InputPollWaitMs.defaultValue;
+        float relativeDeadzone = ConfigKeys::InputRelativeDeadzone.defaultValue;
+
+        bool transferCompression = ConfigKeys::TransferCompression.defaultValue;
+        size_t writeQueueHighWatermark = static_cast<size_t>(ConfigKeys::NetWriteQueueHighWatermark.defaultValue);
+    };
+
+}
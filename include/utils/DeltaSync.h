@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+#include <cereal/types/string.hpp>
+
+// rsync-style block delta. The side holding the old copy sends block signatures,
+// the side holding the new copy answers with copy-block and literal ops.
+
+namespace LocalTether::Utils::DeltaSync {
+
+    // Files below this size are always sent whole; the signature round trip costs more than it saves.
+    constexpr uint64_t MIN_DELTA_FILE_SIZE = 64 * 1024;
+    constexpr uint32_t MIN_BLOCK_SIZE = 2 * 1024;
+    constexpr uint32_t MAX_BLOCK_SIZE = 128 * 1024;
+
+    struct BlockSignature {
+        uint32_t weak = 0;
+        uint64_t strong = 0;
+
+        template <class Archive>
+        void serialize(Archive & ar) {
+            ar(CEREAL_NVP(weak), CEREAL_NVP(strong));
+        }
+    };
+
+    struct FileSignature {
+        uint32_t blockSize = 0;
+        uint64_t fileSize = 0;
+        std::vector<BlockSignature> blocks;
+
+        bool empty() const { return blocks.empty(); }
+
+        template <class Archive>
+        void serialize(Archive & ar) {
+            ar(CEREAL_NVP(blockSize), CEREAL_NVP(fileSize), CEREAL_NVP(blocks));
+        }
+    };
+
+    enum class DeltaOpType : uint8_t {
+        CopyBlocks = 0,
+        Literal = 1
+    };
+
+    struct DeltaOp {
+        DeltaOpType type = DeltaOpType::Literal;
+        uint32_t blockIndex = 0;
+        uint32_t blockCount = 0;
+        std::vector<char> literal;
+
+        template <class Archive>
+        void serialize(Archive & ar) {
+            ar(CEREAL_NVP(type), CEREAL_NVP(blockIndex), CEREAL_NVP(blockCount), CEREAL_NVP(literal));
+        }
+    };
+
+    struct FileDelta {
+        uint32_t blockSize = 0;
+        uint64_t targetSize = 0;
+        std::vector<uint8_t> targetDigest;  // SHA-256 of the reconstructed file
+        std::vector<DeltaOp> ops;
+
+        uint64_t literalBytes() const;
+        uint64_t encodedSizeEstimate() const;
+
+        template <class Archive>
+        void serialize(Archive & ar) {
+            ar(CEREAL_NVP(blockSize), CEREAL_NVP(targetSize), CEREAL_NVP(targetDigest), CEREAL_NVP(ops));
+        }
+    };
+
+    uint32_t chooseBlockSize(uint64_t fileSize);
+    uint32_t weakChecksum(const char* data, size_t length);
+    uint64_t strongChecksum(const char* data, size_t length);
+    std::vector<uint8_t> fileDigest(const char* data, size_t length);
+
+    FileSignature computeSignature(const char* data, size_t length, uint32_t blockSize = 0);
+
+    // Signatures come from the peer. Valid means empty (no usable base), or a block size within
+    // MIN/MAX_BLOCK_SIZE and exactly one block per blockSize bytes of fileSize.
+    bool isValidSignature(const FileSignature& signature);
+
+    // An invalid baseSignature is treated as empty, so the whole file becomes one literal.
+    FileDelta computeDelta(const FileSignature& baseSignature, const char* data, size_t length);
+
+    // Rebuilds the target from base + delta into out; fails if the result does not match
+    // targetDigest, or as soon as it would grow past targetSize (itself capped at the largest
+    // message body).
+    bool applyDelta(const char* base, size_t baseLength, const FileDelta& delta, std::vector<char>& out);
+
+    // True when sending the delta is meaningfully cheaper than sending the whole file.
+    bool isDeltaWorthwhile(const FileDelta& delta, uint64_t fullSize);
+
+    bool readWholeFile(const std::filesystem::path& path, std::vector<char>& out);
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace LocalTether::Utils {
+
+    // HDR-style histogram of microsecond latencies: values below 128 us are counted exactly,
+    // larger ones in log-linear buckets of 64 per power of two, so every recorded value keeps
+    // better than 1.6% precision up to about 38 hours. Recording is lock-free from any thread.
+    class LatencyHistogram {
+    public:
+        void record(uint64_t valueUs);
+        void reset();
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t minUs() const;
+        uint64_t maxUs() const { return max_.load(std::memory_order_relaxed); }
+        uint64_t sumUs() const { return sum_.load(std::memory_order_relaxed); }
+        double meanUs() const;
+        // Smallest recorded bucket value with at least the given fraction (0..1) of samples at or below it.
+        uint64_t percentileUs(double fraction) const;
+
+    private:
+        static constexpr unsigned SUB_BUCKET_BITS = 7;
+        static constexpr uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+        static constexpr uint64_t HALF_BUCKET_COUNT = SUB_BUCKET_COUNT / 2;
+        static constexpr unsigned MAX_SHIFT = 30;
+        static constexpr size_t BUCKET_COUNT = SUB_BUCKET_COUNT + MAX_SHIFT * HALF_BUCKET_COUNT;
+
+        static size_t indexFor(uint64_t valueUs);
+        // Highest value that maps to index, so percentiles never under-report.
+        static uint64_t valueAt(size_t index);
+
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> min_{UINT64_MAX};
+        std::atomic<uint64_t> max_{0};
+    };
+
+}
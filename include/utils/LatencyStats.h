@@ -0,0 +1,72 @@
+#pragma once
+#include "utils/LatencyHistogram.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace LocalTether::Utils {
+
+    // Points an input payload is stamped at while "input.latency_trace" is on. The stamps travel
+    // in InputPayload::latencyStampsUs, one slot per stage, converted to the server's steady
+    // clock (via the KeepAlive offset estimate) before they leave each machine; 0 = not stamped.
+    enum class LatencyStage : uint8_t {
+        HelperRead = 0,     // evdev read in the capture helper
+        IpcDelivery,        // payload taken off the helper IPC by the app
+        Poll,               // returned from InputManager::pollEvents
+        Send,               // Client::sendInput
+        ServerRelay,        // forwarded by the server
+        ReceiverHandle,     // Client::handleMessage on the receiver
+        HelperInject,       // uinput write in the receiver's helper
+        Count
+    };
+
+    constexpr size_t LATENCY_STAGE_COUNT = static_cast<size_t>(LatencyStage::Count);
+
+    // Per-stage histograms of the time spent since the previous stamped stage, plus the whole
+    // capture-to-receiver path. HelperInject is measured on the receiver alone, from the app
+    // queueing the payload to the helper's uinput write, and is not part of the end-to-end row.
+    class LatencyStats {
+    public:
+        struct Summary {
+            std::string name;
+            uint64_t count;
+            uint64_t minUs;
+            uint64_t p50Us;
+            uint64_t p90Us;
+            uint64_t p99Us;
+            uint64_t maxUs;
+            double meanUs;
+        };
+
+        static LatencyStats& GetInstance();
+
+        static uint64_t nowUs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+        static const char* stageName(LatencyStage stage);
+
+        bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+        void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+        // Records every stamped stage of a trace that reached the receiver.
+        void recordTrace(const std::vector<uint64_t>& stampsUs);
+        void record(LatencyStage stage, uint64_t durationUs);
+
+        std::vector<Summary> summaries() const;
+        bool exportCsv(const std::string& path) const;
+        void reset();
+
+    private:
+        LatencyStats();
+
+        std::atomic<bool> enabled_{false};
+        // One per stage, then end to end.
+        std::array<LatencyHistogram, LATENCY_STAGE_COUNT + 1> histograms_;
+    };
+
+}
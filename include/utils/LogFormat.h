@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <type_traits>
+#include <charconv>
+#include <cstddef>
+
+namespace LocalTether::Utils {
+
+    namespace LogFormatDetail {
+        template <typename T>
+        void appendArg(std::string& out, const T& value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                out += value ? "true" : "false";
+            } else if constexpr (std::is_same_v<T, char>) {
+                out += value;
+            } else if constexpr (std::is_integral_v<T>) {
+                char buffer[24];
+                auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                out.append(buffer, result.ptr);
+            } else if constexpr (std::is_enum_v<T>) {
+                appendArg(out, static_cast<std::underlying_type_t<T>>(value));
+            } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                out += std::string_view(value);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                out += std::to_string(value);
+            } else {
+                std::ostringstream stream;
+                stream << value;
+                out += stream.str();
+            }
+        }
+
+        inline void formatInto(std::string& out, std::string_view format) {
+            out += format;
+        }
+
+        template <typename First, typename... Rest>
+        void formatInto(std::string& out, std::string_view format, const First& first, const Rest&... rest) {
+            size_t placeholder = format.find("{}");
+            if (placeholder == std::string_view::npos) {
+                out += format;
+                return;
+            }
+            out += format.substr(0, placeholder);
+            appendArg(out, first);
+            formatInto(out, format.substr(placeholder + 2), rest...);
+        }
+    }
+
+    // Replaces each "{}" in format with the next argument, in order. Surplus arguments are
+    // ignored and surplus placeholders are left as they are.
+    template <typename... Args>
+    std::string formatLog(std::string_view format, const Args&... args) {
+        std::string out;
+        out.reserve(format.size() + 16 * sizeof...(Args));
+        LogFormatDetail::formatInto(out, format, args...);
+        return out;
+    }
+
+}
@@ -1,9 +1,17 @@
 #pragma once
+#include "utils/MpscQueue.h"
+#include "utils/LogFormat.h"
+#include "utils/BinaryLog.h"
 #include <string>
 #include <vector>
 #include <memory>
 #include <mutex>
 #include <fstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#include <cstdint>
 
 namespace LocalTether::Utils {
     enum class LogLevel {
@@ -14,24 +22,77 @@ namespace LocalTether::Utils {
         Error,
         Critical
     };
+
+    // One formatted line of the in-memory history. Sequence numbers increase by one per line
+    // for the life of the process, so a reader can ask for only what it has not seen yet.
+    struct LogEntry {
+        uint64_t sequence = 0;
+        LogLevel level = LogLevel::Info;
+        std::string text;
+    };
+
+    // Format id of one LT_LOG_* call site, assigned on its first use while logging in binary.
+    struct LogSite {
+        std::atomic<uint32_t> formatId{0};
+    };
+
+    // "trace", "debug", "info", "warning", "error" or "critical"; anything else gives fallback.
+    LogLevel parseLogLevel(const std::string& name, LogLevel fallback);
     
+    // Log calls only timestamp the message and push it onto a bounded lock-free queue; a
+    // background thread formats, keeps the console history and writes stdout and the log file
+    // in batches, flushing once per batch. When the queue is full, messages below Error are
+    // dropped (and counted in the log), while Error and Critical wait briefly for room.
+    // The file is application.log, or application.ltlog in the binary format (BinaryLog.h),
+    // rotated to .1 .. .N once it passes the configured size. In the binary format the writer
+    // formats nothing but the Warning and above lines it echoes to stdout; the history keeps
+    // raw records and renders them when read.
     class Logger {
     public:
         static Logger& GetInstance();
 
-        void Log(const std::string& message, LogLevel level = LogLevel::Info);
-        void Debug(const std::string& message);
-        void Info(const std::string& message);
-        void Warning(const std::string& message);
-        void Error(const std::string& message);
-        void Critical(const std::string& message);
-        void Trace(const std::string& message);
+        void Log(std::string message, LogLevel level = LogLevel::Info);
+        void Debug(std::string message);
+        void Info(std::string message);
+        void Warning(std::string message);
+        void Error(std::string message);
+        // Also waits for the message to be written, so it survives a crash right after.
+        void Critical(std::string message);
+        void Trace(std::string message);
        
         std::vector<std::string> GetLogs();
+        // Appends the retained lines with sequence >= sequence to out and returns the sequence
+        // the next line will get. Lines that already fell out of the history are skipped.
+        uint64_t GetLogsSince(uint64_t sequence, std::vector<LogEntry>& out);
 
         static std::string getKeyName(uint8_t vkCode);
 
+        // Forgets the history; later GetLogsSince calls only return lines logged after this.
         void Clear();
+        // Blocks until everything logged so far has been written, or the timeout expires.
+        void Flush(std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+        // Messages below the level are discarded. The LT_LOG_* macros check it before
+        // building the message, so disabled call sites cost one relaxed load.
+        void SetLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+        LogLevel GetLevel() const { return level_.load(std::memory_order_relaxed); }
+        bool IsEnabled(LogLevel level) const { return level >= level_.load(std::memory_order_relaxed); }
+        uint64_t DroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+        // Applied by the writer before its next batch. maxFileBytes 0 disables rotation.
+        void ConfigureOutput(bool binary, uint64_t maxFileBytes, uint32_t maxFiles);
+        bool IsBinary() const { return binary_.load(std::memory_order_relaxed); }
+
+        // Binary path of the LT_LOG_* macros: copies the arguments and leaves formatting to the writer.
+        template <typename... Args>
+        void LogBinary(LogLevel level, LogSite& site, std::string_view format, const Args&... args) {
+            uint32_t formatId = site.formatId.load(std::memory_order_relaxed);
+            if (formatId == 0) {
+                formatId = InternFormat(format);
+                site.formatId.store(formatId, std::memory_order_relaxed);
+            }
+            Enqueue(Record{std::chrono::system_clock::now(), level, BinaryLog::encodeArgs(args...), formatId});
+        }
         
     private:
         Logger();
@@ -40,14 +101,115 @@ namespace LocalTether::Utils {
         
         Logger(const Logger&) = delete;
         Logger& operator=(const Logger&) = delete;
+
+        struct Record {
+            std::chrono::system_clock::time_point time;
+            LogLevel level = LogLevel::Info;
+            // Plain text, or encoded args when formatId is set.
+            std::string message;
+            uint32_t formatId = 0;
+        };
+
+        struct HistoryEntry {
+            uint64_t sequence = 0;
+            Record record;
+        };
+
+        struct OutputSettings {
+            bool binary = false;
+            uint64_t maxFileBytes = 0;
+            uint32_t maxFiles = 0;
+        };
+        static constexpr size_t QUEUE_CAPACITY = 8192;
+        static constexpr size_t HISTORY_CAPACITY = 10000;
+
+        void Enqueue(Record record);
+        uint32_t InternFormat(std::string_view format);
+        std::string FormatText(uint32_t formatId);
+
+        void WriterLoop();
+        // Writer thread only (or under outputMutex_ once it has stopped), like everything below.
+        void WriteBatch(std::vector<Record>& batch);
+        void OpenLogFile();
+        void RotateLogFile();
+        void WriteFileRecord(const Record& record);
         
-        std::vector<std::string> logs;
+        // Ring of the last HISTORY_CAPACITY records; entry n lives at logs[n % HISTORY_CAPACITY].
+        std::vector<HistoryEntry> logs;
+        uint64_t nextSequence_ = 0;
+        uint64_t firstRetained_ = 0;
         std::mutex mutex;
         std::ofstream logFile;
+        std::string logPath_;
+        uint64_t fileBytes_ = 0;
+        OutputSettings output_;
+        // Format ids already defined in the current binary file.
+        std::vector<bool> formatsInFile_;
+        // Writer's copy of formats_, so rendering does not take formatsMutex_ per line.
+        std::vector<std::string> formatCache_;
+
+        std::atomic<bool> binary_{false};
+        std::atomic<bool> outputChanged_{false};
+        std::mutex settingsMutex_;
+        OutputSettings pendingOutput_;
+
+        // Index = format id; id 0 is reserved for plain text.
+        std::vector<std::string> formats_{std::string()};
+        std::mutex formatsMutex_;
+
+        MpscQueue<Record, QUEUE_CAPACITY> queue_;
+        std::thread writer_;
+        std::atomic<bool> writerRunning_{false};
+        std::atomic<bool> stopping_{false};
+        std::atomic<bool> writerWaiting_{false};
+        std::mutex wakeMutex_;
+        std::condition_variable wake_;
+        std::condition_variable written_;
+        std::atomic<uint64_t> enqueued_{0};
+        std::atomic<uint64_t> writtenCount_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<LogLevel> level_{LogLevel::Trace};
+        uint64_t droppedReported_ = 0;
+        // Serialises direct writes once the writer thread is gone.
+        std::mutex outputMutex_;
         
-        std::string FormatMessage(const std::string& message, LogLevel level);
+        // Writer thread: uses formatCache_.
+        std::string FormatMessage(const Record& record);
+        // Any thread: looks the format up under formatsMutex_.
+        std::string RenderRecord(const Record& record);
+        static std::string FormatLine(const Record& record, std::string_view format);
         
    
-        std::string LogLevelToString(LogLevel level);
+        static std::string LogLevelToString(LogLevel level);
     };
-}
\ No newline at end of file
+}
+
+// Call sites below this level (0 = Trace .. 5 = Critical) are compiled out entirely.
+#ifndef LOCALTETHER_LOG_MIN_LEVEL
+#define LOCALTETHER_LOG_MIN_LEVEL 0
+#endif
+
+// LT_LOG_INFO("Client {} sent {} bytes", id, size): the arguments are only evaluated and
+// formatted when the level is enabled at both compile time and run time. The format must be
+// a string literal; in the binary format it is stored once and the arguments are copied raw.
+#define LT_LOG(level, ...)                                                                          \
+    do {                                                                                            \
+        if constexpr (static_cast<int>(level) >= LOCALTETHER_LOG_MIN_LEVEL) {                       \
+            auto& lt_logger_ = ::LocalTether::Utils::Logger::GetInstance();                         \
+            if (lt_logger_.IsEnabled(level)) {                                                      \
+                if (lt_logger_.IsBinary()) {                                                        \
+                    static ::LocalTether::Utils::LogSite lt_site_;                                  \
+                    lt_logger_.LogBinary(level, lt_site_, __VA_ARGS__);                             \
+                } else {                                                                            \
+                    lt_logger_.Log(::LocalTether::Utils::formatLog(__VA_ARGS__), level);            \
+                }                                                                                   \
+            }                                                                                       \
+        }                                                                                           \
+    } while (0)
+
+#define LT_LOG_TRACE(...) LT_LOG(::LocalTether::Utils::LogLevel::Trace, __VA_ARGS__)
+#define LT_LOG_DEBUG(...) LT_LOG(::LocalTether::Utils::LogLevel::Debug, __VA_ARGS__)
+#define LT_LOG_INFO(...) LT_LOG(::LocalTether::Utils::LogLevel::Info, __VA_ARGS__)
+#define LT_LOG_WARNING(...) LT_LOG(::LocalTether::Utils::LogLevel::Warning, __VA_ARGS__)
+#define LT_LOG_ERROR(...) LT_LOG(::LocalTether::Utils::LogLevel::Error, __VA_ARGS__)
+#define LT_LOG_CRITICAL(...) LT_LOG(::LocalTether::Utils::LogLevel::Critical, __VA_ARGS__)
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <filesystem>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace LocalTether::Utils {
+
+    // Read-only memory mapping of a whole file. Mappings are shared: opening a path that is
+    // already mapped (same size and mtime) hands back the existing mapping, so several
+    // sessions pulling the same file read from one set of page-cache pages.
+    //
+    // On POSIX a file that shrinks while mapped would raise SIGBUS on the first read past its new
+    // end. A process-wide handler swaps a zero page in for the missing one and marks the mapping
+    // truncated, so readers finish, then check truncated() before trusting what they read.
+    // Windows refuses to truncate a mapped file, so there it is always false.
+    class MappedFile {
+    public:
+        static std::shared_ptr<const MappedFile> Open(const std::filesystem::path& path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+        const std::string& path() const { return path_; }
+        bool truncated() const { return truncated_.load(std::memory_order_acquire); }
+        // Copies [offset, offset + length) out of the mapping; false if the file was truncated
+        // by the time the copy finished, in which case out holds zeros for the missing part.
+        bool copyTo(size_t offset, size_t length, char* out) const;
+
+    private:
+        MappedFile() = default;
+        bool map(const std::filesystem::path& path);
+
+        std::string path_;
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        std::filesystem::file_time_type modifiedTime_{};
+        mutable std::atomic<bool> truncated_{false};
+
+#ifdef _WIN32
+        void* fileHandle_ = nullptr;
+        void* mappingHandle_ = nullptr;
+#else
+        int guardSlot_ = -1;
+#endif
+    };
+
+}
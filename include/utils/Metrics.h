@@ -0,0 +1,138 @@
+#pragma once
+#include "utils/LatencyHistogram.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Process-wide counters, gauges and histograms. Hot paths look a metric up once (registration
+// takes a lock) and keep the reference; updating it afterwards is a relaxed atomic. The whole set
+// renders as Prometheus text for the "stats" command, the Metrics panel and the periodic dump
+// configured by metrics.dump_interval_s / metrics.dump_path.
+
+namespace LocalTether::Utils {
+
+    // Monotonic count. Each thread adds into its own cache line, so counters bumped from the io
+    // thread and the input thread at once do not contend; reading sums the shards.
+    class Counter {
+    public:
+        void add(uint64_t amount = 1) {
+            shards_[shardIndex()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+        uint64_t value() const;
+
+    private:
+        static constexpr size_t SHARD_COUNT = 16;
+        static size_t shardIndex();
+
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> value{0};
+        };
+        std::array<Shard, SHARD_COUNT> shards_;
+    };
+
+    // Point-in-time value that can go up and down, e.g. a queue depth.
+    class Gauge {
+    public:
+        void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+        void add(int64_t amount) { value_.fetch_add(amount, std::memory_order_relaxed); }
+        int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> value_{0};
+    };
+
+    enum class MetricKind {
+        Counter,
+        Gauge,
+        Summary   // a LatencyHistogram, exported as quantiles plus _sum and _count
+    };
+
+    struct MetricSample {
+        std::string name;
+        std::string help;
+        std::string labels;   // rendered label set without braces, e.g. type="Input"
+        MetricKind kind = MetricKind::Counter;
+        double value = 0;     // counters and gauges
+        // Summaries only, in microseconds.
+        uint64_t count = 0;
+        uint64_t sumUs = 0;
+        uint64_t p50Us = 0;
+        uint64_t p90Us = 0;
+        uint64_t p99Us = 0;
+        uint64_t maxUs = 0;
+    };
+
+    class MetricsRegistry {
+    public:
+        // Appends samples for values that live elsewhere (per-session byte counts, queue
+        // depths). Runs on every snapshot, from whichever thread asked for it; removeCollector
+        // waits for a running call to finish.
+        using Collector = std::function<void(std::vector<MetricSample>&)>;
+
+        static MetricsRegistry& GetInstance();
+
+        // Returns the metric for name + labels, creating it on first use. References stay valid
+        // for the life of the process.
+        Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+        Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+        LatencyHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+        // Returns a token for removeCollector.
+        uint64_t addCollector(Collector collector);
+        void removeCollector(uint64_t token);
+
+        // Formats key="value" with the value escaped for the exposition format.
+        static std::string label(const std::string& key, const std::string& value);
+
+        std::vector<MetricSample> snapshot() const;
+        std::string renderPrometheus() const;
+
+        // Writes renderPrometheus() to metrics.dump_path every metrics.dump_interval_s seconds
+        // (0 or unset disables it). Safe to call more than once.
+        void startPeriodicDump();
+        void stopPeriodicDump();
+
+        ~MetricsRegistry();
+
+    private:
+        MetricsRegistry() = default;
+
+        template <typename T>
+        struct Series {
+            std::string name;
+            std::string help;
+            std::string labels;
+            std::unique_ptr<T> metric;
+        };
+
+        template <typename T>
+        T& findOrCreate(std::vector<Series<T>>& series, const std::string& name, const std::string& help,
+                        const std::string& labels);
+
+        void dumpLoop(std::string path, std::chrono::seconds interval);
+
+        mutable std::mutex mutex_;
+        std::vector<Series<Counter>> counters_;
+        std::vector<Series<Gauge>> gauges_;
+        std::vector<Series<LatencyHistogram>> histograms_;
+        mutable std::mutex collectorsMutex_;
+        std::map<uint64_t, Collector> collectors_;
+        uint64_t nextCollectorToken_ = 1;
+
+        std::mutex dumpMutex_;
+        std::condition_variable dumpWake_;
+        bool dumpStopping_ = false;
+        std::thread dumpThread_;
+    };
+
+}
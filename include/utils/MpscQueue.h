@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace LocalTether::Utils {
+
+    // Bounded lock-free queue for many producers and one consumer (Vyukov's sequenced slots).
+    // Producers claim a slot with one CAS and publish it by bumping its sequence, so a full
+    // queue is reported to the caller instead of blocking; only the consumer may pop.
+    template <typename T, size_t Capacity>
+    class MpscQueue {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        MpscQueue() {
+            for (size_t i = 0; i < Capacity; ++i) {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        bool tryPush(T&& value) {
+            size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& slot = slots_[pos & (Capacity - 1)];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                if (diff == 0) {
+                    if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        slot.value = std::move(value);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Consumer only.
+        bool tryPop(T& out) {
+            Slot& slot = slots_[dequeuePos_ & (Capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) {
+                return false;
+            }
+            out = std::move(slot.value);
+            slot.sequence.store(dequeuePos_ + Capacity, std::memory_order_release);
+            ++dequeuePos_;
+            return true;
+        }
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::array<Slot, Capacity> slots_;
+        alignas(64) std::atomic<size_t> enqueuePos_{0};
+        alignas(64) size_t dequeuePos_ = 0;
+    };
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <filesystem>
+#include <string>
+
+namespace LocalTether::Utils {
+
+    // Directory holding the running executable; falls back to current_path() if the platform
+    // query fails.
+    std::filesystem::path executableDirectory();
+
+    // Walks up from startPath (at most maxDepth levels) looking for a directory named
+    // targetName. Returns an empty path if none is found.
+    std::filesystem::path findAncestorDirectory(const std::filesystem::path& startPath, const std::string& targetName, int maxDepth);
+
+    // Base for server_storage, client_file_cache and friends: the LocalTether checkout when
+    // running from a build tree, otherwise the executable directory.
+    std::filesystem::path dataDirectory();
+
+    // True when path is root or lies below it, compared component by component so a sibling
+    // such as "<root>_other" does not count. Both should already be canonical.
+    bool isPathWithin(const std::filesystem::path& path, const std::filesystem::path& root);
+
+}
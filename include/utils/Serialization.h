@@ -6,8 +6,24 @@
 
 namespace LocalTether::Utils {
 
+// Bytes serializeInputPayload writes before the key events (including their u32 count) and for
+// each key event, derived from the member types it copies.
+constexpr size_t INPUT_PAYLOAD_FIXED_SIZE =
+    sizeof(Network::InputPayload::isMouseEvent) + sizeof(Network::InputPayload::relativeX) +
+    sizeof(Network::InputPayload::relativeY) + sizeof(Network::InputPayload::mouseButtons) +
+    sizeof(Network::InputPayload::scrollDeltaX) + sizeof(Network::InputPayload::scrollDeltaY) +
+    sizeof(Network::InputPayload::sourceDeviceType) + sizeof(Network::InputPayload::deltaX) +
+    sizeof(Network::InputPayload::deltaY) + sizeof(Network::InputPayload::scrollHiResX) +
+    sizeof(Network::InputPayload::scrollHiResY) + sizeof(Network::InputPayload::ipcStampUs) +
+    sizeof(uint32_t);
+constexpr size_t INPUT_PAYLOAD_KEY_SIZE = sizeof(Network::KeyEvent::keyCode) + sizeof(Network::KeyEvent::isPressed);
+
 std::vector<uint8_t> serializeInputPayload(const Network::InputPayload& payload);
 
+// Same encoding written straight into out, for callers that already own the storage. Returns the
+// number of bytes written, or 0 if the payload needs more than capacity.
+size_t serializeInputPayloadInto(const Network::InputPayload& payload, uint8_t* out, size_t capacity);
+
 std::optional<Network::InputPayload> deserializeInputPayload(const uint8_t* data, size_t length);
 
 }
\ No newline at end of file
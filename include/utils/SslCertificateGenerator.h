@@ -2,21 +2,31 @@
 #define SSL_CERTIFICATE_GENERATOR_H
 
 #include <string>
+#include <filesystem>
 
 namespace LocalTether::Utils {
 
 class SslCertificateGenerator {
 public:
-    
+    // The key and certificate live under tls.dir (default: "tls" in the data directory), so
+    // every launch reuses them whatever the working directory.
+    static std::string DefaultKeyPath();
+    static std::string DefaultCertPath();
+
+    // Creates whichever of the two is missing. Ephemeral DH groups come from OpenSSL's built-in
+    // set (SSL_CTX_set_dh_auto), so no DH parameters are generated.
     static bool EnsureSslFiles(
-        const std::string& keyPath = "server.key",
-        const std::string& certPath = "server.crt",
-        const std::string& dhParamsPath = "dh.pem");
+        const std::string& keyPath = DefaultKeyPath(),
+        const std::string& certPath = DefaultCertPath());
+
+    // Runs EnsureSslFiles on a background thread, so the files are usually ready by the time
+    // someone hosts. Only the first call does anything.
+    static void PrepareInBackground();
 
 private:
-    static bool generatePrivateKey(const std::string& keyPath, int bits = 2048);
+    static std::filesystem::path tlsDirectory();
+    static bool generatePrivateKey(const std::string& keyPath);
     static bool generateCertificate(const std::string& certPath, const std::string& keyPath, int days = 365);
-    static bool generateDhParams(const std::string& dhParamsPath, int bits = 2048);
     static void logOpenSslErrors(const std::string& contextMessage);
 };
 
@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace LocalTether::Utils {
+
+    // Stages of bringing a server up. Listen, Tls and Storage run concurrently; the server
+    // accepts connections once all three are done.
+    enum class StartupStage : uint8_t {
+        Listen = 0,   // bind and listen on the port
+        Tls,          // load or create the key and certificate, configure the TLS context
+        Storage,      // create the file store and index its tree
+        Count
+    };
+
+    constexpr size_t STARTUP_STAGE_COUNT = static_cast<size_t>(StartupStage::Count);
+
+    enum class StageStatus : uint8_t {
+        Pending,
+        Running,
+        Done,
+        Failed
+    };
+
+    // Progress of the most recent server start, written by whichever thread runs a stage and
+    // read by the UI every frame; each stage is a pair of atomics, so no lock is needed.
+    class StartupProgress {
+    public:
+        struct StageState {
+            StageStatus status;
+            uint32_t elapsedMs;   // so far while Running, final once Done or Failed
+        };
+
+        static StartupProgress& GetInstance();
+        static const char* stageName(StartupStage stage);
+
+        // Marks every stage Pending and restarts the clock for totalElapsedMs().
+        void reset();
+        void begin(StartupStage stage);
+        void finish(StartupStage stage, bool ok);
+
+        StageState state(StartupStage stage) const;
+        uint32_t totalElapsedMs() const;
+
+    private:
+        StartupProgress() = default;
+
+        static uint64_t nowMs();
+
+        struct Slot {
+            std::atomic<StageStatus> status{StageStatus::Pending};
+            std::atomic<uint64_t> startedMs{0};
+            std::atomic<uint64_t> finishedMs{0};
+        };
+        std::array<Slot, STARTUP_STAGE_COUNT> slots_;
+        std::atomic<uint64_t> resetMs_{0};
+    };
+
+}
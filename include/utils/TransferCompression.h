@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Chunk-wise zstd compression for file transfer bodies.
+// Envelope layout: [innerType:1][codec:1][rawSize:8] followed by chunks of
+// [rawLen:4][storedLen:4][bytes]; a chunk with storedLen == rawLen is stored uncompressed.
+
+namespace LocalTether::Utils::TransferCompression {
+
+    constexpr uint8_t CODEC_ZSTD = 1;
+    constexpr size_t CHUNK_SIZE = 256 * 1024;
+    constexpr size_t ENVELOPE_HEADER_SIZE = 1 + 1 + 8;
+    // The envelope is built in memory before it can be framed, so larger bodies go out uncompressed.
+    constexpr size_t MAX_COMPRESS_SIZE = 64 * 1024 * 1024;
+
+    struct ByteSpan {
+        const char* data;
+        size_t size;
+    };
+
+    bool isEnabled();
+
+    // Size limits, extension blacklist, then a level-1 trial compression of a few samples spread over the data.
+    bool shouldCompress(const std::string& fileName, const char* data, size_t size);
+
+    // Cheaper levels on fast links, stronger ones when the link is the bottleneck.
+    int chooseLevel(double linkBytesPerSecond);
+
+    std::vector<uint8_t> compressBody(uint8_t innerType, const std::vector<ByteSpan>& parts, int level);
+    // Fails without allocating when the envelope claims more than maxRawSize bytes.
+    bool decompressBody(const std::vector<uint8_t>& envelope, uint8_t& innerType, std::vector<uint8_t>& rawBody,
+                        uint64_t maxRawSize);
+
+    // EWMA of observed write throughput; only writes large enough to be meaningful are sampled.
+    class ThroughputEstimator {
+    public:
+        void writeStarted();
+        void writeCompleted(size_t bytes);
+        double bytesPerSecond() const { return bytesPerSecond_.load(std::memory_order_relaxed); }
+
+    private:
+        std::chrono::steady_clock::time_point startedAt_{};
+        std::atomic<double> bytesPerSecond_{0.0};
+    };
+
+}
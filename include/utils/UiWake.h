@@ -0,0 +1,13 @@
+#pragma once
+
+namespace LocalTether::Utils::UiWake {
+
+    // Lets background threads (logger, network) tell an idle UI loop that something it shows
+    // has changed, without depending on the UI. The handler must be cheap and thread-safe;
+    // nullptr uninstalls it.
+    using Handler = void (*)();
+
+    void setHandler(Handler handler);
+    void notify();
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <cstddef>
+
+namespace LocalTether::Utils {
+
+    // Fixed set of worker threads draining a job queue. submit() never blocks, so it is safe
+    // on an io thread; producers that can pause (a socket reader) check saturated() and resume
+    // from whenBelowLimit() instead of buffering without limit.
+    class WorkerPool {
+    public:
+        using Job = std::function<void()>;
+        using Callback = std::function<void()>;
+
+        WorkerPool(size_t threadCount, size_t maxQueuedJobs);
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        // Jobs sharing a non-empty key run one at a time in submission order (e.g. writes to
+        // the same path); jobs without a key, or with different keys, run in parallel.
+        void submit(Job job, const std::string& key = {});
+        // True while maxQueuedJobs or more jobs are waiting.
+        bool saturated() const;
+        // Runs callback once the backlog is below maxQueuedJobs: right away if it already is,
+        // otherwise on the worker thread that gets it there. Dropped if the pool shuts down first.
+        void whenBelowLimit(Callback callback);
+        // Blocks until every submitted job has finished.
+        void waitIdle();
+        void shutdown();
+
+    private:
+        struct QueuedJob {
+            Job job;
+            std::string key;
+        };
+
+        void workerMain();
+        // Both take mutex_ held.
+        size_t backlogLocked() const { return jobs_.size() + keyedWaiting_; }
+        std::vector<Callback> takeCallbacksIfBelowLimitLocked();
+
+        std::vector<std::thread> workers_;
+        std::deque<QueuedJob> jobs_;
+        // Jobs waiting for an earlier job with the same key; a key is present while one of its
+        // jobs is queued or running.
+        std::unordered_map<std::string, std::deque<Job>> keyed_;
+        size_t keyedWaiting_ = 0;
+        std::vector<Callback> belowLimitCallbacks_;
+        size_t maxQueuedJobs_;
+        size_t activeJobs_ = 0;
+        bool stopping_ = false;
+
+        mutable std::mutex mutex_;
+        std::condition_variable jobAvailable_;
+        std::condition_variable idle_;
+    };
+
+}
@@ -1,9 +1,12 @@
 #include "core/SDLApp.h"
 #include "ui/StyleManager.h"
 #include "utils/Logger.h"
+#include "utils/Config.h"
+#include "utils/UiWake.h"
 #include "ui/Icons.h"
 #include <iostream>
 #include <filesystem>  
+#include <algorithm>
 #include "ui/FlowPanels.h"
 #include "ui/panels/FileExplorerPanel.h"
 
@@ -22,6 +25,11 @@ SDLApp::~SDLApp() {
 }
 
 bool SDLApp::Initialize() {
+    auto& config = Utils::Config::GetInstance();
+    powerSaving_ = config.Get(Utils::ConfigKeys::UiPowerSaving);
+    idleRefreshMs_ = static_cast<uint32_t>(std::max(16, config.Get(Utils::ConfigKeys::UiIdleRefreshMs)));
+    unfocusedFrameMs_ = static_cast<uint32_t>(1000 / std::clamp(config.Get(Utils::ConfigKeys::UiUnfocusedFps), 1, 240));
+
      
     std::cout << "Available SDL video drivers:" << std::endl;
     for (int i = 0; i < SDL_GetNumVideoDrivers(); i++) {
@@ -142,6 +150,9 @@ bool SDLApp::Initialize() {
     ImGui_ImplSDL2_InitForOpenGL(window, gl_context);
     ImGui_ImplOpenGL3_Init("#version 150");
 
+    redrawEventType_ = SDL_RegisterEvents(1);
+    Utils::UiWake::setHandler(&SDLApp::RequestRedraw);
+
     running = true;
     return true;
 }
@@ -155,6 +166,9 @@ void SDLApp::Run() {
     }
 
     while (running) {
+        if (powerSaving_) {
+            WaitForActivity();
+        }
          
         if (os_drag_active_) {
             int mouse_x, mouse_y;
@@ -170,6 +184,26 @@ void SDLApp::Run() {
         }
 
         ProcessEvents();  
+        if (!running) {
+            break;
+        }
+
+        // Nothing is visible, so there is nothing to draw until the window comes back.
+        if (SDL_GetWindowFlags(window) & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_HIDDEN)) {
+            if (!powerSaving_) {
+                SDL_Delay(unfocusedFrameMs_);
+            }
+            continue;
+        }
+        // Vsync paces focused frames; in the background, events such as log lines are batched
+        // into at most ui.unfocused_fps frames.
+        if (powerSaving_ && SDL_GetKeyboardFocus() == nullptr) {
+            uint32_t sinceLastFrame = SDL_GetTicks() - lastFrameTicks_;
+            if (sinceLastFrame < unfocusedFrameMs_) {
+                SDL_Delay(unfocusedFrameMs_ - sinceLastFrame);
+            }
+        }
+
         StartFrame();     
         
         if (renderCallback) {
@@ -177,14 +211,50 @@ void SDLApp::Run() {
         }
         
         Render();  
+        lastFrameTicks_ = SDL_GetTicks();
     }
     
     Cleanup();
 }
 
+void SDLApp::RequestRedraw() {
+    SDLApp* app = instance;
+    if (!app || app->redrawEventType_ == 0 || app->redrawEventType_ == static_cast<uint32_t>(-1)) {
+        return;
+    }
+    if (app->redrawPending_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    SDL_Event event{};
+    event.type = app->redrawEventType_;
+    SDL_PushEvent(&event);
+}
+
+void SDLApp::WaitForActivity() {
+    // External drags only report the drop, so the hover feedback needs every frame.
+    if (os_drag_active_) {
+        return;
+    }
+    if (framesOwed_ > 0) {
+        --framesOwed_;
+        return;
+    }
+    int timeoutMs = static_cast<int>(idleRefreshMs_);
+    if (io && io->WantTextInput) {
+        timeoutMs = std::min(timeoutMs, 500);   // keep the text caret blinking
+    }
+    if (SDL_WaitEventTimeout(nullptr, timeoutMs)) {
+        framesOwed_ = FRAMES_AFTER_ACTIVITY;
+    }
+}
+
 void SDLApp::ProcessEvents() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
+        if (event.type == redrawEventType_) {
+            redrawPending_.store(false, std::memory_order_release);
+            continue;
+        }
         ImGui_ImplSDL2_ProcessEvent(&event);
         if (event.type == SDL_QUIT)
             running = false;
@@ -259,6 +329,7 @@ void SDLApp::Render() {
 }
 
 void SDLApp::Cleanup() {
+    Utils::UiWake::setHandler(nullptr);
     if (gl_context) {
         ImGui_ImplOpenGL3_Shutdown();
         ImGui_ImplSDL2_Shutdown();
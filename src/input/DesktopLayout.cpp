@@ -0,0 +1,174 @@
+#include "input/DesktopLayout.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+
+namespace LocalTether::Input {
+
+namespace {
+    const char* const EDGE_KEYS[] = {"layout.left", "layout.right", "layout.top", "layout.bottom"};
+
+    size_t facingEdge(size_t edge) {
+        return edge ^ 1u;
+    }
+}
+
+bool DesktopLayout::isEnabledInConfig() {
+    auto& config = Utils::Config::GetInstance();
+    for (const char* key : EDGE_KEYS) {
+        if (!config.Get<std::string>(key, "").empty()) return true;
+    }
+    return false;
+}
+
+bool DesktopLayout::configure(uint16_t homeWidth, uint16_t homeHeight) {
+    auto& config = Utils::Config::GetInstance();
+    configured_ = false;
+    for (size_t edge = 0; edge < EDGE_COUNT; ++edge) {
+        edgeNames_[edge] = config.Get<std::string>(EDGE_KEYS[edge], "");
+        edges_[edge].store(0, std::memory_order_relaxed);
+        configured_ = configured_ || !edgeNames_[edge].empty();
+    }
+    homeWidth_ = homeWidth;
+    homeHeight_ = homeHeight;
+    reset();
+    return configured_ && homeWidth_ > 0 && homeHeight_ > 0;
+}
+
+void DesktopLayout::setReceiverScreen(uint32_t clientId, const std::string& name, uint16_t width, uint16_t height) {
+    if (!configured_ || width == 0 || height == 0) return;
+    for (size_t edge = 0; edge < EDGE_COUNT; ++edge) {
+        if (!edgeNames_[edge].empty() && edgeNames_[edge] == name) {
+            edges_[edge].store(pack(clientId, width, height), std::memory_order_release);
+            Utils::Logger::GetInstance().Info("DesktopLayout: " + std::string(EDGE_KEYS[edge]) + " is client " +
+                                              std::to_string(clientId) + " (" + std::to_string(width) + "x" +
+                                              std::to_string(height) + ").");
+        }
+    }
+}
+
+void DesktopLayout::renameClient(uint32_t clientId, const std::string& name) {
+    if (!configured_) return;
+    for (size_t edge = 0; edge < EDGE_COUNT; ++edge) {
+        uint64_t packed = edges_[edge].load(std::memory_order_relaxed);
+        if (packed == 0 || packedId(packed) != clientId) continue;
+        if (edgeNames_[edge] != name) {
+            edges_[edge].store(0, std::memory_order_release);
+        }
+        // The renamed client keeps its resolution, so it can take any edge now naming it.
+        for (size_t other = 0; other < EDGE_COUNT; ++other) {
+            if (edgeNames_[other] == name) {
+                edges_[other].store(packed, std::memory_order_release);
+            }
+        }
+        return;
+    }
+}
+
+void DesktopLayout::removeClient(uint32_t clientId) {
+    for (auto& edge : edges_) {
+        uint64_t packed = edge.load(std::memory_order_relaxed);
+        if (packed != 0 && packedId(packed) == clientId) {
+            edge.store(0, std::memory_order_release);
+        }
+    }
+}
+
+void DesktopLayout::reset() {
+    active_ = HOME;
+    width_ = homeWidth_;
+    height_ = homeHeight_;
+    cursorX_ = width_ / 2.0;
+    cursorY_ = height_ / 2.0;
+}
+
+void DesktopLayout::syncHomeCursor(double x, double y) {
+    if (active_ != HOME) return;
+    cursorX_ = std::clamp(x, 0.0, std::max(0.0, width_ - 1.0));
+    cursorY_ = std::clamp(y, 0.0, std::max(0.0, height_ - 1.0));
+}
+
+void DesktopLayout::enter(size_t edge, uint64_t neighbour, double along) {
+    active_ = packedId(neighbour);
+    activeEdge_ = edge;
+    width_ = packedWidth(neighbour);
+    height_ = packedHeight(neighbour);
+    // Land just inside the border facing the host; the shared axis keeps its proportion.
+    switch (static_cast<Edge>(edge)) {
+        case Edge::Left:   cursorX_ = width_ - 1.0; cursorY_ = along * height_; break;
+        case Edge::Right:  cursorX_ = 0.0;          cursorY_ = along * height_; break;
+        case Edge::Top:    cursorY_ = height_ - 1.0; cursorX_ = along * width_; break;
+        case Edge::Bottom: cursorY_ = 0.0;          cursorX_ = along * width_; break;
+    }
+}
+
+void DesktopLayout::returnHome(double along) {
+    size_t edge = activeEdge_;
+    active_ = HOME;
+    width_ = homeWidth_;
+    height_ = homeHeight_;
+    switch (static_cast<Edge>(edge)) {
+        case Edge::Left:   cursorX_ = 0.0;          cursorY_ = along * height_; break;
+        case Edge::Right:  cursorX_ = width_ - 1.0; cursorY_ = along * height_; break;
+        case Edge::Top:    cursorY_ = 0.0;          cursorX_ = along * width_; break;
+        case Edge::Bottom: cursorY_ = height_ - 1.0; cursorX_ = along * width_; break;
+    }
+}
+
+void DesktopLayout::writeAbsolute(Network::InputPayload& payload) const {
+    payload.sourceDeviceType = Network::InputSourceDeviceType::MOUSE_ABSOLUTE;
+    payload.relativeX = static_cast<float>(cursorX_ / std::max(1.0, width_ - 1.0));
+    payload.relativeY = static_cast<float>(cursorY_ / std::max(1.0, height_ - 1.0));
+    payload.deltaX = 0.0f;
+    payload.deltaY = 0.0f;
+}
+
+DesktopLayout::Routed DesktopLayout::route(Network::InputPayload& payload) {
+    Routed result;
+    result.previous = active_;
+
+    // The receiver we are on may have left; fall back to the host screen at its edge.
+    if (active_ != HOME) {
+        uint64_t packed = edges_[activeEdge_].load(std::memory_order_acquire);
+        if (packed == 0 || packedId(packed) != active_) {
+            bool vertical = activeEdge_ >= static_cast<size_t>(Edge::Top);
+            returnHome(vertical ? cursorX_ / width_ : cursorY_ / height_);
+        }
+    }
+
+    if (payload.isMouseEvent && payload.sourceDeviceType == Network::InputSourceDeviceType::MOUSE_RELATIVE) {
+        cursorX_ += payload.deltaX;
+        cursorY_ += payload.deltaY;
+
+        // Which border, if any, the cursor was pushed past. Only the one facing the host leads
+        // anywhere from a receiver.
+        size_t crossed = EDGE_COUNT;
+        if (cursorX_ < 0.0) crossed = static_cast<size_t>(Edge::Left);
+        else if (cursorX_ > width_ - 1.0) crossed = static_cast<size_t>(Edge::Right);
+        else if (cursorY_ < 0.0) crossed = static_cast<size_t>(Edge::Top);
+        else if (cursorY_ > height_ - 1.0) crossed = static_cast<size_t>(Edge::Bottom);
+
+        cursorX_ = std::clamp(cursorX_, 0.0, std::max(0.0, width_ - 1.0));
+        cursorY_ = std::clamp(cursorY_, 0.0, std::max(0.0, height_ - 1.0));
+
+        if (crossed != EDGE_COUNT) {
+            bool vertical = crossed >= static_cast<size_t>(Edge::Top);
+            double along = vertical ? cursorX_ / width_ : cursorY_ / height_;
+            if (active_ == HOME) {
+                uint64_t neighbour = edges_[crossed].load(std::memory_order_acquire);
+                if (neighbour != 0) enter(crossed, neighbour, along);
+            } else if (crossed == facingEdge(activeEdge_)) {
+                returnHome(along);
+            }
+        }
+
+        if (active_ != HOME) writeAbsolute(payload);
+    }
+
+    result.target = active_;
+    result.switched = active_ != result.previous;
+    return result;
+}
+
+}
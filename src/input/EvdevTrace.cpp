@@ -0,0 +1,173 @@
+#ifndef _WIN32
+#include "input/EvdevTrace.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <unistd.h>
+
+namespace LocalTether::Input::EvdevTrace {
+
+bool Writer::open(int fd, int screenWidth, int screenHeight) {
+    close();
+    out_ = fdopen(fd, "w");
+    if (!out_) {
+        ::close(fd);
+        return false;
+    }
+    std::fprintf(out_, "localtether-evdev-trace %d\n", FORMAT_VERSION);
+    std::fprintf(out_, "screen %d %d\n", screenWidth, screenHeight);
+    return true;
+}
+
+void Writer::writeDevice(const DeviceInfo& device) {
+    if (!out_) return;
+    std::fprintf(out_, "device %u %d %d %d %d %d %d %d %d %s\n", device.slot, device.isTouchPointer, device.isTouchpadSystem,
+                 device.hasAbsX, device.absXMin, device.absXMax, device.hasAbsY, device.absYMin, device.absYMax,
+                 device.name.c_str());
+}
+
+void Writer::writeEvent(uint32_t slot, const struct input_event& ev) {
+    if (!out_) return;
+    uint64_t timestampUs = static_cast<uint64_t>(ev.input_event_sec) * 1000000ull + static_cast<uint64_t>(ev.input_event_usec);
+    std::fprintf(out_, "ev %llu %u %u %u %d\n", static_cast<unsigned long long>(timestampUs), slot,
+                 static_cast<unsigned>(ev.type), static_cast<unsigned>(ev.code), ev.value);
+}
+
+void Writer::close() {
+    if (out_) {
+        std::fclose(out_);
+        out_ = nullptr;
+    }
+}
+
+bool readTrace(const std::string& path, Trace& trace, std::string& error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    trace = Trace();
+    std::string line;
+    size_t lineNumber = 0;
+    bool sawHeader = false;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string kind;
+        fields >> kind;
+
+        if (kind == "localtether-evdev-trace") {
+            int version = 0;
+            fields >> version;
+            if (version != FORMAT_VERSION) {
+                error = "unsupported trace version " + std::to_string(version);
+                return false;
+            }
+            sawHeader = true;
+        } else if (kind == "screen") {
+            fields >> trace.screenWidth >> trace.screenHeight;
+        } else if (kind == "device") {
+            DeviceInfo device;
+            fields >> device.slot >> device.isTouchPointer >> device.isTouchpadSystem
+                   >> device.hasAbsX >> device.absXMin >> device.absXMax
+                   >> device.hasAbsY >> device.absYMin >> device.absYMax;
+            std::getline(fields >> std::ws, device.name);
+            if (!fields && !fields.eof()) {
+                error = "malformed device record on line " + std::to_string(lineNumber);
+                return false;
+            }
+            trace.devices.push_back(device);
+        } else if (kind == "ev") {
+            Event ev;
+            fields >> ev.timestampUs >> ev.slot >> ev.type >> ev.code >> ev.value;
+            if (!fields) {
+                error = "malformed event record on line " + std::to_string(lineNumber);
+                return false;
+            }
+            trace.events.push_back(ev);
+        } else {
+            error = "unknown record '" + kind + "' on line " + std::to_string(lineNumber);
+            return false;
+        }
+    }
+
+    if (!sawHeader) {
+        error = "missing trace header";
+        return false;
+    }
+    for (const Event& ev : trace.events) {
+        bool known = false;
+        for (const DeviceInfo& device : trace.devices) {
+            if (device.slot == ev.slot) { known = true; break; }
+        }
+        if (!known) {
+            error = "event references unknown device slot " + std::to_string(ev.slot);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string formatPayload(const Network::InputPayload& payload) {
+    std::ostringstream out;
+    out << "keys=";
+    for (size_t i = 0; i < payload.keyEvents.size(); ++i) {
+        if (i) out << ',';
+        out << static_cast<int>(payload.keyEvents[i].keyCode) << (payload.keyEvents[i].isPressed ? '+' : '-');
+    }
+    char position[64];
+    std::snprintf(position, sizeof(position), "%.6f,%.6f", payload.relativeX, payload.relativeY);
+    out << " mouse=" << payload.isMouseEvent
+        << " pos=" << position
+        << " buttons=" << static_cast<int>(payload.mouseButtons)
+        << " scroll=" << payload.scrollDeltaX << ',' << payload.scrollDeltaY
+        << " src=" << static_cast<int>(payload.sourceDeviceType);
+    if (payload.sourceDeviceType == Network::InputSourceDeviceType::MOUSE_RELATIVE) {
+        char delta[64];
+        std::snprintf(delta, sizeof(delta), "%.4f,%.4f", payload.deltaX, payload.deltaY);
+        out << " delta=" << delta << " hires=" << payload.scrollHiResX << ',' << payload.scrollHiResY;
+    }
+    return out.str();
+}
+
+bool writeGolden(const std::string& path, const std::vector<Network::InputPayload>& payloads) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) return false;
+    for (const auto& payload : payloads) {
+        out << formatPayload(payload) << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool compareGolden(const std::string& path, const std::vector<Network::InputPayload>& payloads, std::string& difference) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        difference = "cannot open golden file " + path;
+        return false;
+    }
+    std::string expected;
+    size_t index = 0;
+    while (std::getline(in, expected)) {
+        if (index >= payloads.size()) {
+            difference = "payload " + std::to_string(index) + " missing, expected: " + expected;
+            return false;
+        }
+        std::string actual = formatPayload(payloads[index]);
+        if (actual != expected) {
+            difference = "payload " + std::to_string(index) + "\n  expected: " + expected + "\n  actual:   " + actual;
+            return false;
+        }
+        ++index;
+    }
+    if (index != payloads.size()) {
+        difference = std::to_string(payloads.size() - index) + " unexpected extra payloads, first: " + formatPayload(payloads[index]);
+        return false;
+    }
+    return true;
+}
+
+}
+#endif
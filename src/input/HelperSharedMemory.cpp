@@ -0,0 +1,186 @@
+#ifndef _WIN32
+#include "input/HelperSharedMemory.h"
+#include "utils/Serialization.h"
+#include "utils/Logger.h"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <optional>
+
+namespace LocalTether::Input::HelperIpc {
+
+namespace {
+    constexpr size_t SERIALIZED_HEADER_SIZE = Utils::INPUT_PAYLOAD_FIXED_SIZE;
+    constexpr size_t MAX_KEYS_PER_SLOT = (SLOT_CAPACITY - SERIALIZED_HEADER_SIZE) / Utils::INPUT_PAYLOAD_KEY_SIZE;
+    // Both processes read these slots, so a change to the payload encoding is a layout change.
+    static_assert(SERIALIZED_HEADER_SIZE == 39 && Utils::INPUT_PAYLOAD_KEY_SIZE == 2,
+                  "serializeInputPayload's encoding changed: bump LAYOUT_MAGIC and update this check");
+    static_assert(MAX_KEYS_PER_SLOT > 0, "a slot must hold the payload header and at least one key event");
+    static_assert(SLOT_CAPACITY < SLOT_CONTINUES, "SLOT_CONTINUES must not overlap a real length");
+
+    // The segment is shared with another process, so these must not be FUTEX_PRIVATE.
+    long futexWait(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::milliseconds timeout) {
+        struct timespec ts;
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+        ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+
+    void futexWake(std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    uint32_t writeSlot(RingSlot& slot, const Network::InputPayload& payload) {
+        return static_cast<uint32_t>(Utils::serializeInputPayloadInto(payload, slot.data, SLOT_CAPACITY));
+    }
+}
+
+void resetRing(SpscRing& ring) {
+    ring.head.store(0, std::memory_order_relaxed);
+    ring.tail.store(0, std::memory_order_relaxed);
+    ring.wakeSeq.store(0, std::memory_order_relaxed);
+    ring.consumerWaiting.store(0, std::memory_order_relaxed);
+    ring.dropped.store(0, std::memory_order_relaxed);
+}
+
+bool pushPayload(SpscRing& ring, const Network::InputPayload& payload) {
+    const size_t keyCount = payload.keyEvents.size();
+    const size_t slotsNeeded = keyCount <= MAX_KEYS_PER_SLOT ? 1 : (keyCount + MAX_KEYS_PER_SLOT - 1) / MAX_KEYS_PER_SLOT;
+
+    const uint32_t head = ring.head.load(std::memory_order_relaxed);
+    const uint32_t tail = ring.tail.load(std::memory_order_acquire);
+    const uint32_t used = head - tail;
+    if (used > SLOT_COUNT || SLOT_COUNT - used < slotsNeeded) {
+        return false;
+    }
+
+    if (slotsNeeded == 1) {
+        RingSlot& slot = ring.slots[head & (SLOT_COUNT - 1)];
+        slot.length = writeSlot(slot, payload);
+    } else {
+        // The first part carries the mouse state, the rest only key events. Reused so a split
+        // does not allocate once its key vector has grown; each ring has one producer thread.
+        static thread_local Network::InputPayload part;
+        for (size_t i = 0; i < slotsNeeded; ++i) {
+            if (i == 0) {
+                part = payload;
+            } else if (i == 1) {
+                part = Network::InputPayload{};
+            }
+            const size_t offset = i * MAX_KEYS_PER_SLOT;
+            const size_t count = std::min(MAX_KEYS_PER_SLOT, keyCount - offset);
+            part.keyEvents.assign(payload.keyEvents.begin() + offset, payload.keyEvents.begin() + offset + count);
+
+            RingSlot& slot = ring.slots[(head + i) & (SLOT_COUNT - 1)];
+            slot.length = writeSlot(slot, part) | (i + 1 < slotsNeeded ? SLOT_CONTINUES : 0);
+        }
+    }
+
+    // seq_cst pairs with the consumer's store to consumerWaiting in waitForData, so either the
+    // consumer sees the new head before sleeping or we see it waiting and wake it.
+    ring.head.store(head + static_cast<uint32_t>(slotsNeeded), std::memory_order_seq_cst);
+    if (ring.consumerWaiting.load(std::memory_order_seq_cst)) {
+        ring.wakeSeq.fetch_add(1, std::memory_order_release);
+        futexWake(ring.wakeSeq);
+    }
+    return true;
+}
+
+size_t drain(SpscRing& ring, std::vector<Network::InputPayload>& out) {
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    const uint32_t head = ring.head.load(std::memory_order_acquire);
+    // head is written by the other process (for to_helper, the unprivileged app), so a value
+    // more than a ring ahead is corrupt: skip to it rather than loop over billions of slots.
+    if (head - tail > SLOT_COUNT) {
+        Utils::Logger::GetInstance().Warning("HelperIpc: Input ring head is " + std::to_string(head - tail) +
+                                             " slots ahead of its tail, dropping its contents.");
+        ring.tail.store(head, std::memory_order_release);
+        return 0;
+    }
+    size_t count = 0;
+    // The parts of a split payload are published with one head store, so a drain never stops
+    // partway through them.
+    std::optional<Network::InputPayload> pending;
+    bool partsValid = true;
+    for (; tail != head; ++tail) {
+        const RingSlot& slot = ring.slots[tail & (SLOT_COUNT - 1)];
+        const bool continues = (slot.length & SLOT_CONTINUES) != 0;
+        const uint32_t length = slot.length & ~SLOT_CONTINUES;
+        std::optional<Network::InputPayload> part;
+        if (length > 0 && length <= SLOT_CAPACITY) {
+            part = Utils::deserializeInputPayload(slot.data, length);
+        }
+        if (!part) {
+            partsValid = false;
+        } else if (!pending) {
+            pending = std::move(part);
+        } else {
+            pending->keyEvents.insert(pending->keyEvents.end(), part->keyEvents.begin(), part->keyEvents.end());
+        }
+        if (continues) {
+            continue;
+        }
+        // A payload with an unreadable part is dropped whole rather than injected half-typed.
+        if (pending && partsValid) {
+            out.push_back(std::move(*pending));
+            ++count;
+        }
+        pending.reset();
+        partsValid = true;
+    }
+    ring.tail.store(tail, std::memory_order_release);
+    return count;
+}
+
+void waitForData(SpscRing& ring, std::chrono::milliseconds timeout) {
+    const uint32_t seq = ring.wakeSeq.load(std::memory_order_acquire);
+    ring.consumerWaiting.store(1, std::memory_order_seq_cst);
+    if (ring.head.load(std::memory_order_seq_cst) == ring.tail.load(std::memory_order_relaxed)) {
+        futexWait(ring.wakeSeq, seq, timeout);
+    }
+    ring.consumerWaiting.store(0, std::memory_order_relaxed);
+}
+
+void wakeConsumer(SpscRing& ring) {
+    ring.wakeSeq.fetch_add(1, std::memory_order_release);
+    futexWake(ring.wakeSeq);
+}
+
+void resetLatencyRing(LatencyRing& ring) {
+    ring.head.store(0, std::memory_order_relaxed);
+    ring.tail.store(0, std::memory_order_relaxed);
+}
+
+bool pushLatencySample(LatencyRing& ring, uint32_t sampleUs) {
+    const uint32_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= LATENCY_SAMPLE_COUNT) {
+        return false;
+    }
+    ring.samplesUs[head & (LATENCY_SAMPLE_COUNT - 1)] = sampleUs;
+    ring.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+size_t drainLatencySamples(LatencyRing& ring, std::vector<uint32_t>& out) {
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    const uint32_t head = ring.head.load(std::memory_order_acquire);
+    if (head - tail > LATENCY_SAMPLE_COUNT) {
+        Utils::Logger::GetInstance().Warning("HelperIpc: Latency ring head is " + std::to_string(head - tail) +
+                                             " samples ahead of its tail, dropping its contents.");
+        ring.tail.store(head, std::memory_order_release);
+        return 0;
+    }
+    size_t count = 0;
+    for (; tail != head; ++tail, ++count) {
+        out.push_back(ring.samplesUs[tail & (LATENCY_SAMPLE_COUNT - 1)]);
+    }
+    ring.tail.store(tail, std::memory_order_release);
+    return count;
+}
+
+}
+#endif
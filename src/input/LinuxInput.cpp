@@ -1,8 +1,10 @@
 #ifndef _WIN32
 #include "input/LinuxInput.h"
+#include "input/HelperSharedMemory.h"
 #include "network/Message.h"
 #include "utils/Logger.h"
 #include "utils/Serialization.h"
+#include "utils/LatencyStats.h"
 #include <SDL.h>  
 
 #include <iostream>
@@ -24,17 +26,21 @@
 #include <limits.h>
 #endif
 
- 
-struct HelperSharedData {
-    pid_t helper_pid;
-    char socket_path[256];  
-    bool ready;
-};
-
 namespace LT = LocalTether;
 
 namespace LocalTether::Input {
 
+namespace {
+    // Opens a latency trace on a payload the helper stamped with its evdev read time.
+    void stampHelperDelivery(LT::Network::InputPayload& payload, uint64_t deliveredUs) {
+        if (payload.ipcStampUs == 0) return;
+        payload.latencyStampsUs.assign(LT::Utils::LATENCY_STAGE_COUNT, 0);
+        payload.latencyStampsUs[static_cast<size_t>(LT::Utils::LatencyStage::HelperRead)] = payload.ipcStampUs;
+        payload.latencyStampsUs[static_cast<size_t>(LT::Utils::LatencyStage::IpcDelivery)] = deliveredUs;
+        payload.ipcStampUs = 0;
+    }
+}
+
 void LinuxInput::helperInitializationRoutine() {
     m_init_in_progress_.store(true, std::memory_order_relaxed);
     LT::Utils::Logger::GetInstance().Info("LinuxInput: Helper initialization routine started.");
@@ -110,13 +116,28 @@ bool LinuxInput::open_and_map_shared_memory() {
         return true;
     }
 
-    shm_fd_ = shm_open(shm_name_, O_RDONLY, 0); 
+    // Read/write is needed for the rings; a segment we can only read still gives us the socket path.
+    shm_writable_ = true;
+    shm_fd_ = shm_open(shm_name_, O_RDWR, 0);
+    if (shm_fd_ == -1 && errno == EACCES) {
+        shm_writable_ = false;
+        shm_fd_ = shm_open(shm_name_, O_RDONLY, 0);
+    }
     if (shm_fd_ == -1) {
         LT::Utils::Logger::GetInstance().Debug("LinuxInput: shm_open failed (may not exist yet): " + std::string(strerror(errno)));
         return false;
     }
 
-    shared_data_ptr_ = (HelperSharedData*)mmap(NULL, sizeof(HelperSharedData), PROT_READ, MAP_SHARED, shm_fd_, 0);  
+    // The helper sizes the segment right after creating it; mapping past its end would fault on access.
+    struct stat shm_stat;
+    if (fstat(shm_fd_, &shm_stat) == -1 || shm_stat.st_size < static_cast<off_t>(sizeof(HelperSharedData))) {
+        LT::Utils::Logger::GetInstance().Debug("LinuxInput: SHM segment not sized yet or from an incompatible build.");
+        close(shm_fd_);
+        shm_fd_ = -1;
+        return false;
+    }
+
+    shared_data_ptr_ = (HelperSharedData*)mmap(NULL, sizeof(HelperSharedData), shm_writable_ ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, shm_fd_, 0);  
     if (shared_data_ptr_ == MAP_FAILED) {
         LT::Utils::Logger::GetInstance().Error("LinuxInput: mmap failed: " + std::string(strerror(errno)));
         close(shm_fd_);
@@ -130,6 +151,9 @@ bool LinuxInput::open_and_map_shared_memory() {
 
 
 void LinuxInput::close_and_unmap_shared_memory() {
+    if (rings_active_.exchange(false) && shared_data_ptr_ && shared_data_ptr_ != MAP_FAILED) {
+        shared_data_ptr_->app_attached.store(0, std::memory_order_release);
+    }
     if (shared_data_ptr_ && shared_data_ptr_ != MAP_FAILED) {
         munmap(shared_data_ptr_, sizeof(HelperSharedData));
         shared_data_ptr_ = nullptr;
@@ -152,6 +176,20 @@ bool LinuxInput::read_info_from_shared_memory(pid_t& out_pid, std::string& out_s
     return false;
 }
 
+bool LinuxInput::attach_shared_rings() {
+    if (!shm_writable_ || !shared_data_ptr_ || shared_data_ptr_ == MAP_FAILED ||
+        shared_data_ptr_->layout_magic != HelperIpc::LAYOUT_MAGIC) {
+        LT::Utils::Logger::GetInstance().Info("LinuxInput: Shared rings unavailable, input payloads will use the helper socket.");
+        return false;
+    }
+    // Skip whatever an earlier app instance left unread so stale input is never replayed.
+    shared_data_ptr_->to_app.tail.store(shared_data_ptr_->to_app.head.load(std::memory_order_acquire), std::memory_order_release);
+    shared_data_ptr_->app_attached.store(1, std::memory_order_release);
+    rings_active_.store(true, std::memory_order_release);
+    LT::Utils::Logger::GetInstance().Info("LinuxInput: Attached to helper shared-memory rings.");
+    return true;
+}
+
 bool LinuxInput::launchHelperProcess() {
     if (open_and_map_shared_memory()) {
         pid_t existing_pid = 0;
@@ -181,15 +219,26 @@ bool LinuxInput::launchHelperProcess() {
     std::string uid_str = std::to_string(uid);
     std::string screenWidthStr = std::to_string(clientScreenWidth_);
     std::string screenHeightStr = std::to_string(clientScreenHeight_);
+    // Optional raw evdev recording for --replay-input-trace; empty disables it.
+    std::string tracePath = LT::Utils::Config::GetInstance().Get(LT::Utils::ConfigKeys::InputTraceRecordPath);
+    if (!tracePath.empty()) {
+        std::error_code ec;
+        auto absolutePath = std::filesystem::absolute(tracePath, ec);
+        if (!ec) tracePath = absolutePath.string();
+        // The helper only creates the file fresh (O_EXCL), so clear our previous recording here,
+        // unprivileged; a symlink is removed itself, not its target.
+        std::filesystem::remove(tracePath, ec);
+    }
 
     LT::Utils::Logger::GetInstance().Info("LinuxInput: Launching helper: pkexec " + exePath +
                                          " --input-helper-mode " + uid_str + " " + username +
-                                         " " + screenWidthStr + " " + screenHeightStr);
+                                         " " + screenWidthStr + " " + screenHeightStr +
+                                         (tracePath.empty() ? "" : " " + tracePath));
     pkexec_pid_ = fork();
     if (pkexec_pid_ == 0) {  
         prctl(PR_SET_PDEATHSIG, SIGHUP);  
         execlp("pkexec", "pkexec", exePath.c_str(), "--input-helper-mode",
-               uid_str.c_str(), username, screenWidthStr.c_str(), screenHeightStr.c_str(), (char*)nullptr);
+               uid_str.c_str(), username, screenWidthStr.c_str(), screenHeightStr.c_str(), tracePath.c_str(), (char*)nullptr);
         LT::Utils::Logger::GetInstance().Error("LinuxInput: execlp pkexec failed: " + std::string(strerror(errno)));
         _exit(127);
     } else if (pkexec_pid_ < 0) {
@@ -260,6 +309,7 @@ bool LinuxInput::connectToHelper() {
 
             ipc_socket_.connect(asio::local::stream_protocol::endpoint(actual_helper_socket_path_));
             helper_connected_.store(true, std::memory_order_relaxed);
+            helper_latency_trace_.store(false, std::memory_order_relaxed);
             LT::Utils::Logger::GetInstance().Info("LinuxInput: Connected to input helper (PID: " +
                                                 std::to_string(helper_actual_pid_) +
                                                 " via socket " + actual_helper_socket_path_ + ").");
@@ -288,15 +338,22 @@ bool LinuxInput::connectToHelper() {
                 LT::Utils::Logger::GetInstance().Info("LinuxInput: IPC thread finished.");
             });
 
+            attach_shared_rings();
+
             if(is_host_mode_) {
-                LT::Utils::Logger::GetInstance().Info("LinuxInput: Host mode detected. Grabbing devices from helper.");
-                sendCommandToHelper(IPCCommandType::GrabDevices);
+                if (!isLocalPassthrough()) {
+                    LT::Utils::Logger::GetInstance().Info("LinuxInput: Host mode detected. Grabbing devices from helper.");
+                    sendCommandToHelper(IPCCommandType::GrabDevices);
+                }
+                if (isRelativeMouseMode()) {
+                    sendCommandToHelper(IPCCommandType::SetMouseMode, {1});
+                }
             } else {
                 LT::Utils::Logger::GetInstance().Info("LinuxInput: Client mode detected. Ungrabbing devices from helper.");
             }
             
+            // The mapping stays until stop(): it carries the rings, not just the connection info.
             readFromHelperLoop();
-            close_and_unmap_shared_memory();  
             return true;
         } catch (const std::system_error& e) {
             if (i == max_retries - 1) {
@@ -434,9 +491,7 @@ void LinuxInput::readFromHelperLoop() {
                     auto maybePayload = LT::Utils::deserializeInputPayload(
                         reinterpret_cast<const uint8_t*>(ipc_read_buffer_.data()), bytes_transferred);
                     if (maybePayload) {
-                         
-                        
-                        
+                        stampHelperDelivery(*maybePayload, LT::Utils::LatencyStats::nowUs());
                         std::lock_guard<std::mutex> lock(queue_mutex_);
                         received_payloads_queue_.push_back(*maybePayload);
                     } else {
@@ -473,19 +528,19 @@ void LinuxInput::checkAndTogglePauseCombo() {
     for (uint8_t key_vk_code_in_combo : InputManager::pause_key_combo_) {
         bool key_found = false;
         if (key_vk_code_in_combo == VK_CONTROL) {
-            if (m_currently_pressed_vk_codes.count(VK_LCONTROL) || m_currently_pressed_vk_codes.count(VK_RCONTROL)) {
+            if (m_currently_pressed_keys.test(VK_LCONTROL) || m_currently_pressed_keys.test(VK_RCONTROL)) {
                 key_found = true;
             }
         } else if (key_vk_code_in_combo == VK_SHIFT) {
-            if (m_currently_pressed_vk_codes.count(VK_LSHIFT) || m_currently_pressed_vk_codes.count(VK_RSHIFT)) {
+            if (m_currently_pressed_keys.test(VK_LSHIFT) || m_currently_pressed_keys.test(VK_RSHIFT)) {
                 key_found = true;
             }
         } else if (key_vk_code_in_combo == VK_MENU) { 
-            if (m_currently_pressed_vk_codes.count(VK_LMENU) || m_currently_pressed_vk_codes.count(VK_RMENU)) {
+            if (m_currently_pressed_keys.test(VK_LMENU) || m_currently_pressed_keys.test(VK_RMENU)) {
                 key_found = true;
             }
         } else {
-            if (m_currently_pressed_vk_codes.count(key_vk_code_in_combo)) {
+            if (m_currently_pressed_keys.test(key_vk_code_in_combo)) {
                 key_found = true;
             }
         }
@@ -522,20 +577,31 @@ std::vector<LT::Network::InputPayload> LinuxInput::pollEvents() {
             helper_payloads.swap(received_payloads_queue_); 
         }
     }
-
-    if (!InputManager::pause_key_combo_.empty()) {
-        for (const auto& payload : helper_payloads) {
-            for (const auto& keyEvent : payload.keyEvents) {
-                if (keyEvent.isPressed) {
-                   
-                    if (m_currently_pressed_vk_codes.find(keyEvent.keyCode) == m_currently_pressed_vk_codes.end()) {
-                        m_currently_pressed_vk_codes.insert(keyEvent.keyCode);
-                    }
-                } else {
-                    m_currently_pressed_vk_codes.erase(keyEvent.keyCode);
-                }
+    if (rings_active_.load(std::memory_order_acquire)) {
+        size_t socketCount = helper_payloads.size();
+        if (HelperIpc::drain(shared_data_ptr_->to_app, helper_payloads) > 0) {
+            const uint64_t deliveredUs = LT::Utils::LatencyStats::nowUs();
+            for (size_t i = socketCount; i < helper_payloads.size(); ++i) {
+                stampHelperDelivery(helper_payloads[i], deliveredUs);
             }
         }
+    }
+
+    bool tracing = LT::Utils::LatencyStats::GetInstance().isEnabled();
+    if (is_host_mode_ && helper_latency_trace_.load(std::memory_order_relaxed) != tracing &&
+        helper_connected_.load(std::memory_order_relaxed)) {
+        helper_latency_trace_.store(tracing, std::memory_order_relaxed);
+        sendCommandToHelper(IPCCommandType::SetLatencyTrace, {static_cast<uint8_t>(tracing ? 1 : 0)});
+    }
+
+    // Tracked even while paused so the resume snapshot reflects what is physically held.
+    for (const auto& payload : helper_payloads) {
+        for (const auto& keyEvent : payload.keyEvents) {
+            m_currently_pressed_keys.set(keyEvent.keyCode, keyEvent.isPressed);
+        }
+    }
+
+    if (!InputManager::pause_key_combo_.empty()) {
         checkAndTogglePauseCombo();
     } else {
        
@@ -556,6 +622,14 @@ std::vector<LT::Network::InputPayload> LinuxInput::pollEvents() {
 }
 
 
+void LinuxInput::waitForEvents(std::chrono::milliseconds timeout) {
+    if (rings_active_.load(std::memory_order_acquire)) {
+        HelperIpc::waitForData(shared_data_ptr_->to_app, timeout);
+    } else {
+        InputManager::waitForEvents(timeout);
+    }
+}
+
 void LinuxInput::sendCommandToHelper(IPCCommandType cmdType, const std::vector<uint8_t>& data) {
     if (!helper_connected_ || !ipc_socket_.is_open() || !running_) {
         return;
@@ -586,10 +660,78 @@ void LinuxInput::simulateInput( LT::Network::InputPayload payload, uint16_t host
     }
     
     LT::Network::InputPayload payloadForHelper = payload; 
+    payloadForHelper.latencyStampsUs.clear();
+
+    // The helper reports how long traced payloads take to reach uinput through a side ring
+    // (shared memory only; the socket fallback goes unmeasured).
+    if (!payload.latencyStampsUs.empty()) {
+        payloadForHelper.ipcStampUs = LT::Utils::LatencyStats::nowUs();
+    }
+    if (rings_active_.load(std::memory_order_acquire)) {
+        static thread_local std::vector<uint32_t> injectSamplesUs;
+        injectSamplesUs.clear();
+        HelperIpc::drainLatencySamples(shared_data_ptr_->inject_latency, injectSamplesUs);
+        for (uint32_t sample : injectSamplesUs) {
+            LT::Utils::LatencyStats::GetInstance().record(LT::Utils::LatencyStage::HelperInject, sample);
+        }
+
+        if (!HelperIpc::pushPayload(shared_data_ptr_->to_helper, payloadForHelper)) {
+            // Only pure motion may be dropped: a lost key release would hold the key down here
+            // until the next key-state snapshot. Give the helper a moment to make room so the
+            // payload keeps its place behind the queued ones, then fall back to the socket.
+            const bool carriesEvents = !payloadForHelper.keyEvents.empty() || payloadForHelper.scrollDeltaX != 0 ||
+                                       payloadForHelper.scrollDeltaY != 0 || payloadForHelper.scrollHiResX != 0 ||
+                                       payloadForHelper.scrollHiResY != 0;
+            if (carriesEvents) {
+                const auto deadline = std::chrono::steady_clock::now() + RING_FULL_WAIT;
+                while (std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    if (HelperIpc::pushPayload(shared_data_ptr_->to_helper, payloadForHelper)) {
+                        return;
+                    }
+                }
+                LT::Utils::Logger::GetInstance().Warning("LinuxInput: Simulation ring still full, sending key/scroll payload over the helper socket.");
+                sendPayloadToHelper(IPCCommandType::SimulateInput, payloadForHelper);
+                return;
+            }
+            uint32_t dropped = shared_data_ptr_->to_helper.dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+            if ((dropped & (dropped - 1)) == 0) {
+                LT::Utils::Logger::GetInstance().Warning("LinuxInput: Simulation ring full, dropped payloads so far: " + std::to_string(dropped));
+            }
+        }
+        return;
+    }
     
     sendPayloadToHelper(IPCCommandType::SimulateInput, payloadForHelper);
 }
 
+std::optional<KeyState> LinuxInput::capturedKeyState() const {
+    if (!is_host_mode_ || !helper_connected_.load(std::memory_order_relaxed)) {
+        return std::nullopt;
+    }
+    return m_currently_pressed_keys;
+}
+
+void LinuxInput::setRelativeMouseMode(bool enabled) {
+    InputManager::setRelativeMouseMode(enabled);
+    // If the helper is not up yet, connectToHelper sends the mode once it is.
+    if (is_host_mode_) {
+        sendCommandToHelper(IPCCommandType::SetMouseMode, {static_cast<uint8_t>(enabled ? 1 : 0)});
+    }
+}
+
+void LinuxInput::setLocalPassthrough(bool enabled) {
+    if (isLocalPassthrough() == enabled) {
+        return;
+    }
+    InputManager::setLocalPassthrough(enabled);
+    // The helper keeps capturing either way; only the exclusive grab follows the layout, and a
+    // pause keeps the devices released regardless.
+    if (is_host_mode_ && !local_pause_active_.load(std::memory_order_relaxed)) {
+        sendCommandToHelper(enabled ? IPCCommandType::UngrabDevices : IPCCommandType::GrabDevices);
+    }
+}
+
 void LinuxInput::setInputPaused(bool paused) {
     if (local_pause_active_.load(std::memory_order_relaxed) == paused) {
         return; 
@@ -603,7 +745,9 @@ void LinuxInput::setInputPaused(bool paused) {
             sendCommandToHelper(IPCCommandType::UngrabDevices);
             LT::Utils::Logger::GetInstance().Info("LinuxInput: Input processing PAUSED. Commanding helper.");
         } else {
-            sendCommandToHelper(IPCCommandType::GrabDevices);
+            if (!isLocalPassthrough()) {
+                sendCommandToHelper(IPCCommandType::GrabDevices);
+            }
             LT::Utils::Logger::GetInstance().Info("LinuxInput: Input processing RESUMED. Commanding helper.");
         }
     }
@@ -615,7 +759,6 @@ bool LinuxInput::isInputPaused() const {
 
 void LinuxInput::setPauseKeyCombo(const std::vector<uint8_t>& combo) {
     InputManager::pause_key_combo_ = combo; 
-    m_currently_pressed_vk_codes.clear();  
     
     bool old_combo_was_active = m_combo_was_active_last_poll;
     m_combo_was_active_last_poll = false;  
@@ -1,9 +1,14 @@
 #ifndef _WIN32
 #include "input/LinuxInputHelper.h"
+#include "input/HelperSharedMemory.h"
+#include "input/UinputEventBatch.h"
+#include "input/KeyState.h"
+#include "input/EvdevTrace.h"
 #include "utils/Logger.h"
 #include "network/Message.h"
 #include "utils/KeycodeConverter.h"
 #include "utils/Serialization.h"
+#include "utils/LatencyStats.h"
 #include <asio.hpp>
 #include <asio/local/stream_protocol.hpp>
 #include <libevdev/libevdev.h>
@@ -21,34 +26,41 @@
 #include <fstream>
 #include <filesystem>
 #include <linux/input-event-codes.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <pwd.h>
-#include <map>
+#include <grp.h>
 #include <optional>
 #include <algorithm>
 #include <array>
 #include <sys/ioctl.h>
+#include <chrono>
+#include <iomanip>
 
 namespace LT = LocalTether;
 
-struct HelperSharedData {
-    pid_t helper_pid;
-    char socket_path[256];
-    bool ready;
-};
-
 enum class IPCCommandType : uint8_t {
     SimulateInput = 1,
     PauseStream = 2,
     ResumeStream = 3,
     Shutdown = 4,
     GrabDevices = 5,
-    UngrabDevices = 6
+    UngrabDevices = 6,
+    SetMouseMode = 7,
+    SetLatencyTrace = 8
 };
 
-const char* SHM_NAME = "/localtether_shm_helper_info";
+// Older kernel headers predate the high-resolution wheel axes (Linux 5.0).
+#ifndef REL_WHEEL_HI_RES
+#define REL_WHEEL_HI_RES 0x0b
+#endif
+#ifndef REL_HWHEEL_HI_RES
+#define REL_HWHEEL_HI_RES 0x0c
+#endif
+static constexpr int WHEEL_HI_RES_PER_NOTCH = 120;
+
+const char* SHM_NAME = LT::Input::HelperIpc::SHM_NAME;
 static HelperSharedData* g_shared_data_ptr = nullptr;
 static int g_shm_fd = -1;
 
@@ -58,8 +70,34 @@ static std::atomic<bool> g_helper_running = true;
 static asio::io_context* g_ipc_io_context_ptr = nullptr;
 static asio::local::stream_protocol::socket* g_main_app_socket_ptr = nullptr;
 
-static std::vector<struct libevdev*> g_evdev_devices;
-static std::vector<int> g_evdev_fds;
+// Everything the poll loop needs to know about one evdev device, kept together so the
+// per-event path indexes a dense array instead of looking up several maps by fd.
+struct DeviceState {
+    struct libevdev* dev = nullptr;
+    int fd = -1;
+    bool is_virtual = false;
+
+    bool has_abs_x = false;
+    bool has_abs_y = false;
+    struct input_absinfo abs_x_info = {};
+    struct input_absinfo abs_y_info = {};
+
+    bool is_touch_pointer = false;
+    bool is_part_of_touchpad_system = false;
+    bool touch_is_active = false;
+    std::optional<std::pair<int32_t, int32_t>> initial_raw_abs_at_touch_start;
+    std::optional<std::pair<int32_t, int32_t>> screen_coords_at_touch_start;
+    std::optional<int32_t> pending_abs_x;
+    std::optional<int32_t> pending_abs_y;
+    // Screen offset of the current touch already reported as relative motion.
+    double touch_reported_dx = 0.0;
+    double touch_reported_dy = 0.0;
+};
+
+static std::vector<DeviceState> g_devices;
+static std::vector<struct pollfd> g_device_pollfds;
+// Only written from the polling thread; opened when the app asks for a recording.
+static LT::Input::EvdevTrace::Writer g_trace_writer;
 static struct libevdev_uinput* g_uinput_device = nullptr;
 
 static int g_client_screen_width = 0;
@@ -77,21 +115,21 @@ static uint8_t g_helper_last_sent_mouse_buttons = 0;
 
 static bool g_helper_mouse_state_initialized = false;
 
-static std::map<int, struct input_absinfo> g_abs_x_info_map;
-static std::map<int, struct input_absinfo> g_abs_y_info_map;
-
 static const int HELPER_MOUSE_DEADZONE_SQUARED = 2 * 2;
 
-static std::map<int, bool> g_device_is_touch_pointer;
-static std::map<int, bool> g_device_is_part_of_touchpad_system;
-static std::map<int, bool> g_device_touch_is_active;
-static std::map<int, std::optional<std::pair<int32_t, int32_t>>> g_device_initial_raw_abs_at_touch_start;
-static std::map<int, std::optional<std::pair<int32_t, int32_t>>> g_device_screen_coords_at_touch_start;
-static std::map<int, std::optional<int32_t>> g_pending_abs_x_for_fd;
-static std::map<int, std::optional<int32_t>> g_pending_abs_y_for_fd;
+// Set over IPC when the session negotiated relative mouse motion; read by the polling thread.
+static std::atomic<bool> g_relative_mouse_mode{false};
+// Set over IPC while the app collects latency traces; captured payloads then carry their read time.
+static std::atomic<bool> g_latency_trace{false};
+
+// Remainders of MOUSE_RELATIVE injection. Only one injection path (ring or socket) is live at
+// a time, so these are not shared between threads.
+static float g_inject_carry_x = 0.0f;
+static float g_inject_carry_y = 0.0f;
+static int g_inject_wheel_carry_x = 0;
+static int g_inject_wheel_carry_y = 0;
 
-static constexpr size_t VK_KEY_STATE_ARRAY_SIZE = (256 / 8);
-static std::array<uint8_t, VK_KEY_STATE_ARRAY_SIZE> g_helper_vk_key_states_bitmask;
+static LT::Input::KeyState g_helper_key_state;
 
 static std::atomic<float> g_h_lastSimulatedRelativeX{-1.0f};
 static std::atomic<float> g_h_lastSimulatedRelativeY{-1.0f};
@@ -164,25 +202,11 @@ static void helper_process_simulated_mouse_coordinates(float payloadX, float pay
 
 static void update_helper_vk_key_state(uint8_t vk_code, bool pressed) {
     if (vk_code == 0) return;
-    size_t byte_index = vk_code / 8;
-    size_t bit_index = vk_code % 8;
-    if (byte_index < VK_KEY_STATE_ARRAY_SIZE) {
-        if (pressed) {
-            g_helper_vk_key_states_bitmask[byte_index] |= (1 << bit_index);
-        } else {
-            g_helper_vk_key_states_bitmask[byte_index] &= ~(1 << bit_index);
-        }
-    }
+    g_helper_key_state.set(vk_code, pressed);
 }
 
 static bool is_helper_vk_key_pressed(uint8_t vk_code) {
-    if (vk_code == 0) return false;
-    size_t byte_index = vk_code / 8;
-    size_t bit_index = vk_code % 8;
-    if (byte_index < VK_KEY_STATE_ARRAY_SIZE) {
-        return (g_helper_vk_key_states_bitmask[byte_index] & (1 << bit_index)) != 0;
-    }
-    return false;
+    return vk_code != 0 && g_helper_key_state.test(vk_code);
 }
 
 static inline int32_t scale_abs_value_to_screen(int32_t value, const struct input_absinfo* absinfo, int32_t screen_dim) {
@@ -216,7 +240,7 @@ void cleanup_shared_memory() {
     }
 }
 
-bool setup_shared_memory() {
+bool setup_shared_memory(uid_t owner_uid) {
     shm_unlink(SHM_NAME);
 
     g_shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
@@ -233,8 +257,56 @@ bool setup_shared_memory() {
         LT::Utils::Logger::GetInstance().Error("Input Helper: mmap failed: " + std::string(strerror(errno)));
         close(g_shm_fd); shm_unlink(SHM_NAME); return false;
     }
-    memset(g_shared_data_ptr, 0, sizeof(HelperSharedData));
+    memset(static_cast<void*>(g_shared_data_ptr), 0, sizeof(HelperSharedData));
     g_shared_data_ptr->ready = false;
+    LT::Input::HelperIpc::resetRing(g_shared_data_ptr->to_app);
+    LT::Input::HelperIpc::resetRing(g_shared_data_ptr->to_helper);
+    LT::Input::HelperIpc::resetLatencyRing(g_shared_data_ptr->inject_latency);
+    g_shared_data_ptr->app_attached.store(0, std::memory_order_relaxed);
+    g_shared_data_ptr->layout_magic = LT::Input::HelperIpc::LAYOUT_MAGIC;
+
+    // The app maps the rings read/write, so hand the segment to the invoking user instead of relying on the umask.
+    if (getuid() == 0 && owner_uid != 0) {
+        struct passwd *pw = getpwuid(owner_uid);
+        if (!pw || fchown(g_shm_fd, owner_uid, pw->pw_gid) == -1) {
+            LT::Utils::Logger::GetInstance().Warning("Input Helper: fchown SHM failed, app will fall back to the socket: " + std::string(strerror(errno)));
+        }
+    }
+    if (fchmod(g_shm_fd, S_IRUSR | S_IWUSR) == -1) {
+        LT::Utils::Logger::GetInstance().Warning("Input Helper: fchmod SHM failed: " + std::string(strerror(errno)));
+    }
+    return true;
+}
+
+static bool app_rings_attached() {
+    return g_shared_data_ptr && g_shared_data_ptr != MAP_FAILED &&
+           g_shared_data_ptr->app_attached.load(std::memory_order_acquire) != 0;
+}
+
+// Captured payloads go through the shared ring once the app has attached to it, otherwise over the socket.
+static bool send_payload_to_app(const LT::Network::InputPayload& payload, asio::local::stream_protocol::socket& target_socket) {
+    if (app_rings_attached()) {
+        // The app drains on every wakeup, so a full ring only lasts a moment; give it a few tries before dropping.
+        for (int attempt = 0; attempt < 20; ++attempt) {
+            if (LT::Input::HelperIpc::pushPayload(g_shared_data_ptr->to_app, payload)) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(250));
+        }
+        uint32_t dropped = g_shared_data_ptr->to_app.dropped.fetch_add(1, std::memory_order_relaxed) + 1;
+        if ((dropped & (dropped - 1)) == 0) {
+            LT::Utils::Logger::GetInstance().Warning("Input Helper: Event ring full, dropped payloads so far: " + std::to_string(dropped));
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> buffer = LT::Utils::serializeInputPayload(payload);
+    asio::error_code ec_write;
+    size_t bytes_written = asio::write(target_socket, asio::buffer(buffer), ec_write);
+    if (ec_write) {
+        LT::Utils::Logger::GetInstance().Error("Input Helper: IPC write error: " + ec_write.message() + ". Bytes written: " + std::to_string(bytes_written));
+        return false;
+    }
     return true;
 }
 
@@ -248,78 +320,45 @@ void write_info_to_shared_memory() {
 }
 
 static void grab_or_ungrab_all_devices(bool grab) {
-    if (g_evdev_fds.empty()) {
+    if (g_devices.empty()) {
         LT::Utils::Logger::GetInstance().Info("Input Helper: No devices to " + std::string(grab ? "grab" : "ungrab") + ".");
         g_are_devices_grabbed.store(false, std::memory_order_relaxed);
         return;
     }
 
-    LT::Utils::Logger::GetInstance().Info(std::string("Input Helper: Attempting to ") + (grab ? "GRAB" : "UNGRAB") + " " + std::to_string(g_evdev_fds.size()) + " devices.");
+    LT::Utils::Logger::GetInstance().Info(std::string("Input Helper: Attempting to ") + (grab ? "GRAB" : "UNGRAB") + " " + std::to_string(g_devices.size()) + " devices.");
     int success_count = 0;
     int fail_count = 0;
-     
+    int skipped_count = 0;
 
-    for (int fd_idx = 0; fd_idx < g_evdev_fds.size(); ++fd_idx) {
-        int fd = g_evdev_fds[fd_idx];
-        struct libevdev* temp_dev = nullptr;
-        if (fd_idx < g_evdev_devices.size()) {  
-             temp_dev = g_evdev_devices[fd_idx];
+    for (const DeviceState& device : g_devices) {
+        if (device.is_virtual) {
+            LT::Utils::Logger::GetInstance().Info("Input Helper: Skipping " + std::string(grab ? "grab" : "ungrab") + " for virtual device: " + std::string(libevdev_get_name(device.dev)));
+            skipped_count++;
+            continue;
         }
 
-        if (temp_dev) {
-            const char* current_dev_name = libevdev_get_name(temp_dev);
-            if (current_dev_name && strcmp(current_dev_name, "LocalTether Virtual Input") == 0) {
-                LT::Utils::Logger::GetInstance().Info("Input Helper: Skipping " + std::string(grab ? "grab" : "ungrab") + " for virtual device: " + std::string(current_dev_name));
-                continue;  
-            }
-        }
-        
-        if (ioctl(fd, EVIOCGRAB, grab ? 1 : 0) == 0) {
+        if (ioctl(device.fd, EVIOCGRAB, grab ? 1 : 0) == 0) {
             success_count++;
         } else {
-            std::string dev_name_str = "unknown device";
-            if (temp_dev) {
-                const char* name = libevdev_get_name(temp_dev);
-                if (name) dev_name_str = name;
-            }
-            LT::Utils::Logger::GetInstance().Warning("Input Helper: Failed to " + std::string(grab ? "grab" : "ungrab") + " device fd " + std::to_string(fd) + " (" + dev_name_str + "): " + strerror(errno));
+            const char* name = libevdev_get_name(device.dev);
+            std::string dev_name_str = name ? name : "unknown device";
+            LT::Utils::Logger::GetInstance().Warning("Input Helper: Failed to " + std::string(grab ? "grab" : "ungrab") + " device fd " + std::to_string(device.fd) + " (" + dev_name_str + "): " + strerror(errno));
             fail_count++;
         }
     }
 
-    if (success_count > 0 || g_evdev_fds.empty()) {  
+    if (success_count > 0) {
          g_are_devices_grabbed.store(grab, std::memory_order_relaxed);
-    } else if (fail_count > 0 && success_count == 0 && !g_evdev_fds.empty()) {
-         
-         
     }
 
-
     if (fail_count == 0 && success_count > 0) {
         LT::Utils::Logger::GetInstance().Info(std::string("Input Helper: Successfully ") + (grab ? "grabbed" : "ungrabbed") + " all " + std::to_string(success_count) + " targeted devices.");
     } else if (success_count > 0 && fail_count > 0) {
         LT::Utils::Logger::GetInstance().Warning(std::string("Input Helper: Partially ") + (grab ? "grabbed" : "ungrabbed") + " targeted devices. Success: " + std::to_string(success_count) + ", Failed: " + std::to_string(fail_count));
-    } else if (fail_count > 0 && success_count == 0 && !g_evdev_fds.empty()){
-          
-        bool all_skipped = true;
-        for (int i = 0; i < g_evdev_fds.size(); ++i) {
-            if (i < g_evdev_devices.size()) {
-                const char* name = libevdev_get_name(g_evdev_devices[i]);
-                if (!name || strcmp(name, "LocalTether Virtual Input") != 0) {
-                    all_skipped = false;
-                    break;
-                }
-            } else {
-                all_skipped = false;  
-                break;
-            }
-        }
-        if (!all_skipped) {
-            LT::Utils::Logger::GetInstance().Error(std::string("Input Helper: Failed to ") + (grab ? "grab" : "ungrab") + " any targeted devices.");
-        } else if (g_evdev_fds.empty()){
-             LT::Utils::Logger::GetInstance().Info("Input Helper: No devices to " + std::string(grab ? "grab" : "ungrab") + ".");
-        }
-    } else if (success_count == 0 && fail_count == 0 && !g_evdev_fds.empty()) {
+    } else if (fail_count > 0 && success_count == 0) {
+        LT::Utils::Logger::GetInstance().Error(std::string("Input Helper: Failed to ") + (grab ? "grab" : "ungrab") + " any targeted devices.");
+    } else if (skipped_count > 0) {
         LT::Utils::Logger::GetInstance().Info("Input Helper: All devices were skipped (e.g. only virtual device present or matched). No grab/ungrab action taken on physical devices.");
     }
 }
@@ -338,13 +377,12 @@ void cleanup_helper_resources() {
         libevdev_uinput_destroy(g_uinput_device);
         g_uinput_device = nullptr;
     }
-    for (struct libevdev* dev : g_evdev_devices) {
-        int fd = libevdev_get_fd(dev);
-        libevdev_free(dev);
-        if (fd >= 0) close(fd);
+    for (DeviceState& device : g_devices) {
+        libevdev_free(device.dev);
+        if (device.fd >= 0) close(device.fd);
     }
-    g_evdev_devices.clear();
-    g_evdev_fds.clear();
+    g_devices.clear();
+    g_device_pollfds.clear();
 
     if (!G_ACTUAL_SOCKET_PATH.empty()) {
         std::error_code ec_fs;
@@ -353,6 +391,7 @@ void cleanup_helper_resources() {
              LT::Utils::Logger::GetInstance().Warning("Input Helper: Failed to remove socket file " + G_ACTUAL_SOCKET_PATH + ": " + ec_fs.message());
         }
     }
+    g_trace_writer.close();
     cleanup_shared_memory();
     LT::Utils::Logger::GetInstance().Info("Input Helper: Resources cleaned up.");
 }
@@ -367,16 +406,9 @@ bool initialize_input_devices() {
     struct udev_list_entry *devices = udev_enumerate_get_list_entry(enumerate);
     struct udev_list_entry *dev_list_entry;
 
-    g_helper_vk_key_states_bitmask.fill(0);
-    g_abs_x_info_map.clear();
-    g_abs_y_info_map.clear();
-    g_device_is_touch_pointer.clear();
-    g_device_is_part_of_touchpad_system.clear();
-    g_device_touch_is_active.clear();
-    g_device_initial_raw_abs_at_touch_start.clear();
-    g_device_screen_coords_at_touch_start.clear();
-    g_pending_abs_x_for_fd.clear();
-    g_pending_abs_y_for_fd.clear();
+    g_helper_key_state.reset();
+    g_devices.clear();
+    g_device_pollfds.clear();
 
     if (g_client_screen_width > 0 && g_client_screen_height > 0) {
         g_helper_abs_x = g_client_screen_width / 2;
@@ -431,45 +463,39 @@ bool initialize_input_devices() {
                               (libevdev_has_event_code(ev_dev, EV_REL, REL_WHEEL) || libevdev_has_event_code(ev_dev, EV_REL, REL_HWHEEL));
 
             if (has_keys || has_rel_motion || has_abs_motion || has_scroll) {
-                g_evdev_devices.push_back(ev_dev);
-                g_evdev_fds.push_back(fd);
-                LT::Utils::Logger::GetInstance().Info("Input Helper: Polling device: " + std::string(devnode) + " (" + libevdev_get_name(ev_dev) + ")");
-
-                if (libevdev_has_event_code(ev_dev, EV_ABS, ABS_X)) {
-                    const struct input_absinfo *absinfo = libevdev_get_abs_info(ev_dev, ABS_X);
-                    if (absinfo) g_abs_x_info_map[fd] = *absinfo;
+                DeviceState device;
+                device.dev = ev_dev;
+                device.fd = fd;
+                const char* dev_name = libevdev_get_name(ev_dev);
+                device.is_virtual = dev_name && strcmp(dev_name, "LocalTether Virtual Input") == 0;
+                LT::Utils::Logger::GetInstance().Info("Input Helper: Polling device: " + std::string(devnode) + " (" + (dev_name ? dev_name : "") + ")");
+
+                // Prefer the single-touch axes; fall back to the multitouch ones for surfaces that only report those.
+                if (const struct input_absinfo* absinfo = libevdev_has_event_code(ev_dev, EV_ABS, ABS_X) ? libevdev_get_abs_info(ev_dev, ABS_X)
+                                                         : libevdev_has_event_code(ev_dev, EV_ABS, ABS_MT_POSITION_X) ? libevdev_get_abs_info(ev_dev, ABS_MT_POSITION_X) : nullptr) {
+                    device.abs_x_info = *absinfo;
+                    device.has_abs_x = true;
                 }
-                if (libevdev_has_event_code(ev_dev, EV_ABS, ABS_Y)) {
-                    const struct input_absinfo *absinfo = libevdev_get_abs_info(ev_dev, ABS_Y);
-                    if (absinfo) g_abs_y_info_map[fd] = *absinfo;
-                }
-                if (libevdev_has_event_code(ev_dev, EV_ABS, ABS_MT_POSITION_X) && g_abs_x_info_map.find(fd) == g_abs_x_info_map.end()) {
-                    const struct input_absinfo *absinfo = libevdev_get_abs_info(ev_dev, ABS_MT_POSITION_X);
-                    if (absinfo) g_abs_x_info_map[fd] = *absinfo;
-                }
-                if (libevdev_has_event_code(ev_dev, EV_ABS, ABS_MT_POSITION_Y) && g_abs_y_info_map.find(fd) == g_abs_y_info_map.end()) {
-                    const struct input_absinfo *absinfo = libevdev_get_abs_info(ev_dev, ABS_MT_POSITION_Y);
-                    if (absinfo) g_abs_y_info_map[fd] = *absinfo;
+                if (const struct input_absinfo* absinfo = libevdev_has_event_code(ev_dev, EV_ABS, ABS_Y) ? libevdev_get_abs_info(ev_dev, ABS_Y)
+                                                         : libevdev_has_event_code(ev_dev, EV_ABS, ABS_MT_POSITION_Y) ? libevdev_get_abs_info(ev_dev, ABS_MT_POSITION_Y) : nullptr) {
+                    device.abs_y_info = *absinfo;
+                    device.has_abs_y = true;
                 }
 
                 bool is_udev_touchpad = (id_touchpad_prop_val && strcmp(id_touchpad_prop_val, "1") == 0);
-                bool dev_has_abs_xy_for_surface = (g_abs_x_info_map.count(fd) && g_abs_y_info_map.count(fd));
                 bool dev_has_btn_touch_for_surface = libevdev_has_event_code(ev_dev, EV_KEY, BTN_TOUCH);
 
-                if (dev_has_abs_xy_for_surface && dev_has_btn_touch_for_surface) {
-                    g_device_is_touch_pointer[fd] = true;
-                    g_device_is_part_of_touchpad_system[fd] = true;
+                if (device.has_abs_x && device.has_abs_y && dev_has_btn_touch_for_surface) {
+                    device.is_touch_pointer = true;
+                    device.is_part_of_touchpad_system = true;
                     LT::Utils::Logger::GetInstance().Debug("Input Helper: Device " + std::string(devnode) + " registered as a touch pointer surface.");
-                } else {
-                    g_device_is_touch_pointer[fd] = false;
-                    if (is_udev_touchpad) {
-                        g_device_is_part_of_touchpad_system[fd] = true;
-                        LT::Utils::Logger::GetInstance().Debug("Input Helper: Device " + std::string(devnode) + " identified as part of touchpad system by udev.");
-                    } else {
-                        g_device_is_part_of_touchpad_system[fd] = false;
-                    }
+                } else if (is_udev_touchpad) {
+                    device.is_part_of_touchpad_system = true;
+                    LT::Utils::Logger::GetInstance().Debug("Input Helper: Device " + std::string(devnode) + " identified as part of touchpad system by udev.");
                 }
-                g_device_touch_is_active[fd] = false;
+
+                g_devices.push_back(device);
+                g_device_pollfds.push_back({fd, POLLIN, 0});
             } else {
                 libevdev_free(ev_dev); close(fd);
             }
@@ -513,6 +539,8 @@ bool initialize_input_devices() {
     libevdev_enable_event_code(uinput_template_dev, EV_REL, REL_Y, nullptr);
     libevdev_enable_event_code(uinput_template_dev, EV_REL, REL_WHEEL, nullptr);
     libevdev_enable_event_code(uinput_template_dev, EV_REL, REL_HWHEEL, nullptr);
+    libevdev_enable_event_code(uinput_template_dev, EV_REL, REL_WHEEL_HI_RES, nullptr);
+    libevdev_enable_event_code(uinput_template_dev, EV_REL, REL_HWHEEL_HI_RES, nullptr);
 
     libevdev_enable_event_type(uinput_template_dev, EV_ABS);
     struct input_absinfo abs_info_x_virt = {0}, abs_info_y_virt = {0};
@@ -537,24 +565,114 @@ bool initialize_input_devices() {
     return true;
 }
 
-void poll_events_once_and_send(asio::local::stream_protocol::socket& target_socket) {
-    if (g_evdev_fds.empty()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(20));
-        return;
+// Opens the recording with the requesting user's credentials rather than root's, so the path
+// (which comes from the user's config) can only name a file that user could create anyway.
+// O_EXCL|O_NOFOLLOW refuses an existing file or a symlink instead of truncating its target; the
+// app removes its own previous recording before starting the helper. The file is created owned by
+// the user, so nothing is chowned.
+static int open_trace_file_as_user(const std::string& path, uid_t owner_uid) {
+    const int flags = O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC;
+    if (geteuid() != 0 || owner_uid == 0) {
+        return open(path.c_str(), flags, 0644);
+    }
+    struct passwd *pw = getpwuid(owner_uid);
+    if (!pw) {
+        errno = EPERM;
+        return -1;
+    }
+    gid_t owner_gid = pw->pw_gid;
+
+    int group_count = getgroups(0, nullptr);
+    std::vector<gid_t> saved_groups(group_count > 0 ? group_count : 0);
+    if (group_count > 0 && getgroups(group_count, saved_groups.data()) == -1) {
+        return -1;
+    }
+    gid_t saved_egid = getegid();
+    if (setgroups(1, &owner_gid) == -1) {
+        return -1;
+    }
+    if (setegid(owner_gid) == -1) {
+        int saved_errno = errno;
+        setgroups(saved_groups.size(), saved_groups.data());
+        errno = saved_errno;
+        return -1;
     }
+    int fd = -1;
+    int saved_errno = 0;
+    if (seteuid(owner_uid) == -1) {
+        saved_errno = errno;
+    } else {
+        fd = open(path.c_str(), flags, 0644);
+        saved_errno = errno;
+        if (seteuid(0) == -1) {
+            // Still running as the user; carrying on as root is impossible, so stop here.
+            LT::Utils::Logger::GetInstance().Critical("Input Helper: Cannot restore root after opening trace file.");
+            _exit(1);
+        }
+    }
+    setegid(saved_egid);
+    setgroups(saved_groups.size(), saved_groups.data());
+    errno = saved_errno;
+    return fd;
+}
 
-    fd_set read_fds; FD_ZERO(&read_fds); int max_fd = 0;
-    for (int fd : g_evdev_fds) { FD_SET(fd, &read_fds); if (fd > max_fd) max_fd = fd; }
-    struct timeval tv = {0, 20000};
+static void start_trace_recording(const std::string& path, uid_t owner_uid) {
+    int fd = open_trace_file_as_user(path, owner_uid);
+    if (fd == -1 || !g_trace_writer.open(fd, g_client_screen_width, g_client_screen_height)) {
+        LT::Utils::Logger::GetInstance().Warning("Input Helper: Could not open evdev trace file " + path +
+                                                 (fd == -1 ? ": " + std::string(strerror(errno)) : ""));
+        return;
+    }
+    for (size_t slot = 0; slot < g_devices.size(); ++slot) {
+        const DeviceState& device = g_devices[slot];
+        LT::Input::EvdevTrace::DeviceInfo info;
+        info.slot = static_cast<uint32_t>(slot);
+        const char* name = libevdev_get_name(device.dev);
+        info.name = name ? name : "";
+        info.isTouchPointer = device.is_touch_pointer;
+        info.isTouchpadSystem = device.is_part_of_touchpad_system;
+        info.hasAbsX = device.has_abs_x;
+        info.absXMin = device.abs_x_info.minimum;
+        info.absXMax = device.abs_x_info.maximum;
+        info.hasAbsY = device.has_abs_y;
+        info.absYMin = device.abs_y_info.minimum;
+        info.absYMax = device.abs_y_info.maximum;
+        g_trace_writer.writeDevice(info);
+    }
+    LT::Utils::Logger::GetInstance().Info("Input Helper: Recording evdev trace to " + path);
+}
 
-    int ret = select(max_fd + 1, &read_fds, nullptr, nullptr, &tv);
-    if (ret <= 0) return;
+// State gathered between SYN_REPORTs while draining devices in one poll cycle.
+struct ReportAccumulator {
+    LT::Network::InputPayload payload;
+    bool raw_mouse_moved = false;
+    bool raw_mouse_button_changed = false;
+    // Relative-mode motion in screen pixels and wheel in 1/120 notches since the last report.
+    double rel_dx = 0.0;
+    double rel_dy = 0.0;
+    int wheel_hi_res_x = 0;
+    int wheel_hi_res_y = 0;
+
+    bool has_content() const {
+        return !payload.keyEvents.empty() || payload.isMouseEvent;
+    }
 
-    LT::Network::InputPayload current_payload;
-    bool events_accumulated = false;
-    bool raw_mouse_moved_this_cycle = false;
-    bool raw_mouse_button_changed_this_cycle = false;
+    // Keeps the key event buffer's capacity so steady-state polling does not allocate.
+    void reset() {
+        std::vector<LT::Network::KeyEvent> keys = std::move(payload.keyEvents);
+        keys.clear();
+        payload = LT::Network::InputPayload();
+        payload.keyEvents = std::move(keys);
+        raw_mouse_moved = false;
+        raw_mouse_button_changed = false;
+        rel_dx = 0.0;
+        rel_dy = 0.0;
+        wheel_hi_res_x = 0;
+        wheel_hi_res_y = 0;
+    }
+};
 
+static void ensure_helper_mouse_state_initialized() {
     if (!g_helper_mouse_state_initialized && g_client_screen_width > 0 && g_client_screen_height > 0) {
         g_helper_abs_x = g_client_screen_width / 2;
         g_helper_abs_y = g_client_screen_height / 2;
@@ -562,252 +680,306 @@ void poll_events_once_and_send(asio::local::stream_protocol::socket& target_sock
         g_helper_last_sent_abs_y = g_helper_abs_y;
         g_helper_mouse_state_initialized = true;
     }
+}
 
-    for (size_t i = 0; i < g_evdev_fds.size(); ++i) {
-        if (FD_ISSET(g_evdev_fds[i], &read_fds)) {
-            struct input_event ev;
-            int rc;
-            int current_fd = g_evdev_fds[i];
-
-            g_pending_abs_x_for_fd[current_fd] = std::nullopt;
-            g_pending_abs_y_for_fd[current_fd] = std::nullopt;
-
-            while ((rc = libevdev_next_event(g_evdev_devices[i], LIBEVDEV_READ_FLAG_NORMAL, &ev)) == LIBEVDEV_READ_STATUS_SUCCESS) {
-                events_accumulated = true;
-
-                if (ev.type == EV_KEY) {
-                    uint8_t vk_code = LT::Utils::KeycodeConverter::evdevToVk(ev.code);
-                    bool is_touch_pointer_dev = g_device_is_touch_pointer.count(current_fd) && g_device_is_touch_pointer[current_fd];
-                    bool event_is_pressed_state = (ev.value == 1 || ev.value == 2);
-
-                    if (is_touch_pointer_dev && ev.code == BTN_TOUCH) {
-                        if (event_is_pressed_state) {
-                            g_device_touch_is_active[current_fd] = true;
-                            g_device_initial_raw_abs_at_touch_start[current_fd] = std::nullopt;
-                            g_device_screen_coords_at_touch_start[current_fd] = {g_helper_abs_x, g_helper_abs_y};
-                        } else {
-                            g_device_touch_is_active[current_fd] = false;
-                        }
-                    } else if (vk_code != 0) {
-                        bool currently_pressed_in_helper_state = is_helper_vk_key_pressed(vk_code);
-                        if (event_is_pressed_state && !currently_pressed_in_helper_state) {
-                            current_payload.keyEvents.push_back({vk_code, true});
-                            update_helper_vk_key_state(vk_code, true);
-                        } else if (!event_is_pressed_state && currently_pressed_in_helper_state) {
-                            current_payload.keyEvents.push_back({vk_code, false});
-                            update_helper_vk_key_state(vk_code, false);
-                        }
-
-                        uint8_t old_buttons = g_helper_mouse_buttons_state;
-                        if (ev.code == BTN_LEFT) { if (event_is_pressed_state) g_helper_mouse_buttons_state |= 0x01; else g_helper_mouse_buttons_state &= ~0x01; }
-                        else if (ev.code == BTN_RIGHT) { if (event_is_pressed_state) g_helper_mouse_buttons_state |= 0x02; else g_helper_mouse_buttons_state &= ~0x02; }
-                        else if (ev.code == BTN_MIDDLE) { if (event_is_pressed_state) g_helper_mouse_buttons_state |= 0x04; else g_helper_mouse_buttons_state &= ~0x04; }
-                        if (old_buttons != g_helper_mouse_buttons_state) {
-                            raw_mouse_button_changed_this_cycle = true;
-                        }
-                    }
-                } else if (ev.type == EV_REL) {
-                    if (g_helper_mouse_state_initialized) {
-                        if (ev.code == REL_X) {
-                            g_helper_abs_x += ev.value;
-                            raw_mouse_moved_this_cycle = true;
-                            g_last_processed_abs_move_was_trackpad = false;
-                        }
-                        else if (ev.code == REL_Y) {
-                            g_helper_abs_y += ev.value;
-                            raw_mouse_moved_this_cycle = true;
-                            g_last_processed_abs_move_was_trackpad = false;
-                         }
-                    }
-                    if (ev.code == REL_WHEEL) { current_payload.scrollDeltaY += static_cast<int16_t>(ev.value); }
-                    else if (ev.code == REL_HWHEEL) { current_payload.scrollDeltaX += static_cast<int16_t>(ev.value); }
-
-                } else if (ev.type == EV_ABS) {
-                    if (g_helper_mouse_state_initialized) {
-                        bool is_touch_pointer_dev = g_device_is_touch_pointer.count(current_fd) && g_device_is_touch_pointer[current_fd];
-                        bool touch_is_active_for_dev = g_device_touch_is_active.count(current_fd) && g_device_touch_is_active[current_fd];
-                        bool abs_event_caused_move = false;
-                        if (is_touch_pointer_dev && touch_is_active_for_dev) {
-                            if (ev.code == ABS_X || (ev.code == ABS_MT_POSITION_X && g_abs_x_info_map.count(current_fd))) {
-                                g_pending_abs_x_for_fd[current_fd] = ev.value;
-                            } else if (ev.code == ABS_Y || (ev.code == ABS_MT_POSITION_Y && g_abs_y_info_map.count(current_fd))) {
-                                g_pending_abs_y_for_fd[current_fd] = ev.value;
-                            }
-                        } else {
-                            if (ev.code == ABS_X || (ev.code == ABS_MT_POSITION_X && g_abs_x_info_map.count(current_fd))) {
-                                 const auto it = g_abs_x_info_map.find(current_fd);
-                                 if (it != g_abs_x_info_map.end()) {
-                                    int32_t old_abs_x = g_helper_abs_x;
-                                    g_helper_abs_x = scale_abs_value_to_screen(ev.value, &it->second, g_client_screen_width);
-                                    if (g_helper_abs_x != old_abs_x) {
-                                        raw_mouse_moved_this_cycle = true;
-                                        abs_event_caused_move = true;
-                                    }
-                                 }
-                            } else if (ev.code == ABS_Y || (ev.code == ABS_MT_POSITION_Y && g_abs_y_info_map.count(current_fd))) {
-                                const auto it = g_abs_y_info_map.find(current_fd);
-                                if (it != g_abs_y_info_map.end()) {
-                                   int32_t old_abs_y = g_helper_abs_y;
-                                   g_helper_abs_y = scale_abs_value_to_screen(ev.value, &it->second, g_client_screen_height);
-                                   if (g_helper_abs_y != old_abs_y) {
-                                       raw_mouse_moved_this_cycle = true;
-                                       abs_event_caused_move = true;
-                                   }
-                                }
-                            }
-                        }
-                        if (abs_event_caused_move) {
-                           g_last_processed_abs_move_was_trackpad = is_touch_pointer_dev;
-                        }
-                    }
-                }
+static bool report_has_mouse_button_key(const LT::Network::InputPayload& payload) {
+    for (const auto& ke : payload.keyEvents) {
+        if (LT::Utils::KeycodeConverter::isVkMouseButton(ke.keyCode)) return true;
+    }
+    return false;
+}
 
-                if (ev.type == EV_SYN && ev.code == SYN_REPORT && events_accumulated) {
-                    bool is_touch_pointer_dev_syn = g_device_is_touch_pointer.count(current_fd) && g_device_is_touch_pointer[current_fd];
-                    bool touch_is_active_for_dev_syn = g_device_touch_is_active.count(current_fd) && g_device_touch_is_active[current_fd];
-
-                    if (is_touch_pointer_dev_syn && touch_is_active_for_dev_syn &&
-                        g_pending_abs_x_for_fd.count(current_fd) && g_pending_abs_x_for_fd[current_fd].has_value() &&
-                        g_pending_abs_y_for_fd.count(current_fd) && g_pending_abs_y_for_fd[current_fd].has_value()) {
-
-                        int32_t current_raw_dev_x = g_pending_abs_x_for_fd[current_fd].value();
-                        int32_t current_raw_dev_y = g_pending_abs_y_for_fd[current_fd].value();
-
-                        if (!g_device_initial_raw_abs_at_touch_start[current_fd].has_value()) {
-                            g_device_initial_raw_abs_at_touch_start[current_fd] = {current_raw_dev_x, current_raw_dev_y};
-                        } else {
-                            int32_t initial_raw_x = g_device_initial_raw_abs_at_touch_start[current_fd]->first;
-                            int32_t initial_raw_y = g_device_initial_raw_abs_at_touch_start[current_fd]->second;
-
-                            int32_t raw_delta_x = current_raw_dev_x - initial_raw_x;
-                            int32_t raw_delta_y = current_raw_dev_y - initial_raw_y;
-
-                            double screen_delta_x = 0.0, screen_delta_y = 0.0;
-                            const auto& abs_x_info = g_abs_x_info_map[current_fd];
-                            const auto& abs_y_info = g_abs_y_info_map[current_fd];
-
-                            if (abs_x_info.maximum > abs_x_info.minimum && (g_client_screen_width -1) > 0) {
-                                screen_delta_x = static_cast<double>(raw_delta_x) /
-                                                   (abs_x_info.maximum - abs_x_info.minimum) *
-                                                   (g_client_screen_width - 1);
-                            }
-                            if (abs_y_info.maximum > abs_y_info.minimum && (g_client_screen_height -1) > 0) {
-                                screen_delta_y = static_cast<double>(raw_delta_y) /
-                                                   (abs_y_info.maximum - abs_y_info.minimum) *
-                                                   (g_client_screen_height - 1);
-                            }
-
-                            if (g_device_screen_coords_at_touch_start[current_fd].has_value()) {
-                                int32_t old_abs_x = g_helper_abs_x;
-                                int32_t old_abs_y = g_helper_abs_y;
-                                g_helper_abs_x = g_device_screen_coords_at_touch_start[current_fd]->first + static_cast<int32_t>(screen_delta_x);
-                                g_helper_abs_y = g_device_screen_coords_at_touch_start[current_fd]->second + static_cast<int32_t>(screen_delta_y);
-                                 if (g_helper_abs_x != old_abs_x || g_helper_abs_y != old_abs_y) {
-                                    raw_mouse_moved_this_cycle = true;
-                                    g_last_processed_abs_move_was_trackpad = true;
-                                }
-                            }
-                        }
-                    }
-                    g_pending_abs_x_for_fd[current_fd] = std::nullopt;
-                    g_pending_abs_y_for_fd[current_fd] = std::nullopt;
+// Relative mode: every report with motion is sent as-is, without the absolute deadzone.
+// The tracked absolute position is still kept current so switching modes does not jump.
+static void build_relative_report(ReportAccumulator& acc) {
+    LT::Network::InputPayload& payload = acc.payload;
+    bool moved = acc.rel_dx != 0.0 || acc.rel_dy != 0.0;
 
-                    if (raw_mouse_moved_this_cycle && g_helper_mouse_state_initialized) {
-                        g_helper_abs_x = std::max(0, std::min(g_helper_abs_x, static_cast<int32_t>(g_client_screen_width - 1)));
-                        g_helper_abs_y = std::max(0, std::min(g_helper_abs_y, static_cast<int32_t>(g_client_screen_height - 1)));
-                    }
+    // Wheels without a hi-res axis only report notches.
+    if (acc.wheel_hi_res_y == 0) acc.wheel_hi_res_y = payload.scrollDeltaY * WHEEL_HI_RES_PER_NOTCH;
+    if (acc.wheel_hi_res_x == 0) acc.wheel_hi_res_x = payload.scrollDeltaX * WHEEL_HI_RES_PER_NOTCH;
+    payload.scrollHiResY = static_cast<int16_t>(std::max(-32768, std::min(32767, acc.wheel_hi_res_y)));
+    payload.scrollHiResX = static_cast<int16_t>(std::max(-32768, std::min(32767, acc.wheel_hi_res_x)));
 
-                    bool mouse_moved_significantly_this_report = false;
-                    if (raw_mouse_moved_this_cycle && g_helper_mouse_state_initialized) {
-                        int dx = g_helper_abs_x - g_helper_last_sent_abs_x;
-                        int dy = g_helper_abs_y - g_helper_last_sent_abs_y;
-                        if ((dx * dx + dy * dy) >= HELPER_MOUSE_DEADZONE_SQUARED) {
-                            mouse_moved_significantly_this_report = true;
-                        }
-                    }
+    payload.isMouseEvent = moved || acc.raw_mouse_button_changed || payload.scrollHiResX != 0 || payload.scrollHiResY != 0 ||
+                           report_has_mouse_button_key(payload);
+    if (!payload.isMouseEvent) return;
 
-                    bool mouse_buttons_changed_this_report = raw_mouse_button_changed_this_cycle;
-                    bool send_mouse_update_this_report = mouse_moved_significantly_this_report || mouse_buttons_changed_this_report;
+    payload.sourceDeviceType = LT::Network::InputSourceDeviceType::MOUSE_RELATIVE;
+    payload.deltaX = static_cast<float>(acc.rel_dx);
+    payload.deltaY = static_cast<float>(acc.rel_dy);
+    payload.mouseButtons = g_helper_mouse_buttons_state;
 
-                    bool key_event_is_mouse_button = false;
-                    for(const auto& ke : current_payload.keyEvents) {
-                        if (LT::Utils::KeycodeConverter::isVkMouseButton(ke.keyCode)) {
-                            key_event_is_mouse_button = true; break;
-                        }
-                    }
+    if (acc.raw_mouse_moved && g_helper_mouse_state_initialized) {
+        g_helper_last_sent_abs_x = g_helper_abs_x;
+        g_helper_last_sent_abs_y = g_helper_abs_y;
+    }
+    if (acc.raw_mouse_button_changed) {
+        g_helper_last_sent_mouse_buttons = g_helper_mouse_buttons_state;
+    }
+}
 
-                    current_payload.isMouseEvent = (current_payload.scrollDeltaX != 0 || current_payload.scrollDeltaY != 0 ||
-                                                    send_mouse_update_this_report || key_event_is_mouse_button);
-
-                    if (current_payload.isMouseEvent) {
-                        bool current_device_is_touchpad_system_component = g_device_is_part_of_touchpad_system.count(current_fd) &&
-                                                                          g_device_is_part_of_touchpad_system[current_fd];
-
-                        if ((g_last_processed_abs_move_was_trackpad && raw_mouse_moved_this_cycle) ||
-                            (current_device_is_touchpad_system_component && mouse_buttons_changed_this_report)
-                           ) {
-                            current_payload.sourceDeviceType = LT::Network::InputSourceDeviceType::TRACKPAD_ABSOLUTE;
-                        } else {
-                            current_payload.sourceDeviceType = LT::Network::InputSourceDeviceType::MOUSE_ABSOLUTE;
-                        }
-
-                        if (send_mouse_update_this_report && g_helper_mouse_state_initialized && g_client_screen_width > 0 && g_client_screen_height > 0) {
-                            current_payload.relativeX = static_cast<float>(g_helper_abs_x) / std::max(1, (g_client_screen_width -1));
-                            current_payload.relativeY = static_cast<float>(g_helper_abs_y) / std::max(1, (g_client_screen_height-1));
-                            current_payload.relativeX = std::max(0.0f, std::min(1.0f, current_payload.relativeX));
-                            current_payload.relativeY = std::max(0.0f, std::min(1.0f, current_payload.relativeY));
-
-                            g_helper_last_sent_abs_x = g_helper_abs_x;
-                            g_helper_last_sent_abs_y = g_helper_abs_y;
-                        }
-                        current_payload.mouseButtons = g_helper_mouse_buttons_state;
-                        if (mouse_buttons_changed_this_report) {
-                            g_helper_last_sent_mouse_buttons = g_helper_mouse_buttons_state;
-                        }
-                    }
+// Folds one evdev event from device into acc. Returns true when a SYN_REPORT completed a
+// report; the caller then sends acc.payload if it has content and resets acc.
+static bool process_device_event(DeviceState& device, const struct input_event& ev, ReportAccumulator& acc) {
+    if (ev.type == EV_KEY) {
+        uint8_t vk_code = LT::Utils::KeycodeConverter::evdevToVk(ev.code);
+        bool event_is_pressed_state = (ev.value == 1 || ev.value == 2);
+
+        if (device.is_touch_pointer && ev.code == BTN_TOUCH) {
+            if (event_is_pressed_state) {
+                device.touch_is_active = true;
+                device.initial_raw_abs_at_touch_start = std::nullopt;
+                device.touch_reported_dx = 0.0;
+                device.touch_reported_dy = 0.0;
+                device.screen_coords_at_touch_start = std::make_pair(g_helper_abs_x, g_helper_abs_y);
+            } else {
+                device.touch_is_active = false;
+            }
+        } else if (vk_code != 0) {
+            bool currently_pressed_in_helper_state = is_helper_vk_key_pressed(vk_code);
+            if (event_is_pressed_state && !currently_pressed_in_helper_state) {
+                acc.payload.keyEvents.push_back({vk_code, true});
+                update_helper_vk_key_state(vk_code, true);
+            } else if (!event_is_pressed_state && currently_pressed_in_helper_state) {
+                acc.payload.keyEvents.push_back({vk_code, false});
+                update_helper_vk_key_state(vk_code, false);
+            }
 
-                    if (!current_payload.keyEvents.empty() || current_payload.isMouseEvent) {
-                        std::vector<uint8_t> buffer = LT::Utils::serializeInputPayload(current_payload);
-                        asio::error_code ec_write;
-                        size_t bytes_written = asio::write(target_socket, asio::buffer(buffer), ec_write);
-                        if (ec_write) {
-                            LT::Utils::Logger::GetInstance().Error("Input Helper: IPC write error: " + ec_write.message() + ". Bytes written: " + std::to_string(bytes_written));
-                            g_helper_running = false; return;
-                        }
+            uint8_t old_buttons = g_helper_mouse_buttons_state;
+            if (ev.code == BTN_LEFT) { if (event_is_pressed_state) g_helper_mouse_buttons_state |= 0x01; else g_helper_mouse_buttons_state &= ~0x01; }
+            else if (ev.code == BTN_RIGHT) { if (event_is_pressed_state) g_helper_mouse_buttons_state |= 0x02; else g_helper_mouse_buttons_state &= ~0x02; }
+            else if (ev.code == BTN_MIDDLE) { if (event_is_pressed_state) g_helper_mouse_buttons_state |= 0x04; else g_helper_mouse_buttons_state &= ~0x04; }
+            if (old_buttons != g_helper_mouse_buttons_state) {
+                acc.raw_mouse_button_changed = true;
+            }
+        }
+    } else if (ev.type == EV_REL) {
+        if (ev.code == REL_X) acc.rel_dx += ev.value;
+        else if (ev.code == REL_Y) acc.rel_dy += ev.value;
+        if (g_helper_mouse_state_initialized) {
+            if (ev.code == REL_X) {
+                g_helper_abs_x += ev.value;
+                acc.raw_mouse_moved = true;
+                g_last_processed_abs_move_was_trackpad = false;
+            }
+            else if (ev.code == REL_Y) {
+                g_helper_abs_y += ev.value;
+                acc.raw_mouse_moved = true;
+                g_last_processed_abs_move_was_trackpad = false;
+             }
+        }
+        if (ev.code == REL_WHEEL) { acc.payload.scrollDeltaY += static_cast<int16_t>(ev.value); }
+        else if (ev.code == REL_HWHEEL) { acc.payload.scrollDeltaX += static_cast<int16_t>(ev.value); }
+        else if (ev.code == REL_WHEEL_HI_RES) { acc.wheel_hi_res_y += ev.value; }
+        else if (ev.code == REL_HWHEEL_HI_RES) { acc.wheel_hi_res_x += ev.value; }
+
+    } else if (ev.type == EV_ABS) {
+        if (g_helper_mouse_state_initialized) {
+            bool is_x_axis = ev.code == ABS_X || (ev.code == ABS_MT_POSITION_X && device.has_abs_x);
+            bool is_y_axis = ev.code == ABS_Y || (ev.code == ABS_MT_POSITION_Y && device.has_abs_y);
+            bool abs_event_caused_move = false;
+            if (device.is_touch_pointer && device.touch_is_active) {
+                if (is_x_axis) {
+                    device.pending_abs_x = ev.value;
+                } else if (is_y_axis) {
+                    device.pending_abs_y = ev.value;
+                }
+            } else {
+                if (is_x_axis && device.has_abs_x) {
+                    int32_t old_abs_x = g_helper_abs_x;
+                    g_helper_abs_x = scale_abs_value_to_screen(ev.value, &device.abs_x_info, g_client_screen_width);
+                    if (g_helper_abs_x != old_abs_x) {
+                        acc.rel_dx += g_helper_abs_x - old_abs_x;
+                        acc.raw_mouse_moved = true;
+                        abs_event_caused_move = true;
                     }
-
-                    current_payload = LT::Network::InputPayload();
-                    events_accumulated = false;
-                    raw_mouse_moved_this_cycle = false;
-                    raw_mouse_button_changed_this_cycle = false;
+                } else if (is_y_axis && device.has_abs_y) {
+                   int32_t old_abs_y = g_helper_abs_y;
+                   g_helper_abs_y = scale_abs_value_to_screen(ev.value, &device.abs_y_info, g_client_screen_height);
+                   if (g_helper_abs_y != old_abs_y) {
+                       acc.rel_dy += g_helper_abs_y - old_abs_y;
+                       acc.raw_mouse_moved = true;
+                       abs_event_caused_move = true;
+                   }
                 }
             }
-            if (rc == LIBEVDEV_READ_STATUS_SYNC) { }
-            else if (rc != LIBEVDEV_READ_STATUS_SUCCESS && rc != -EAGAIN) {
-                LT::Utils::Logger::GetInstance().Warning("Input Helper: libevdev_next_event error on fd " + std::to_string(current_fd) + ": " + strerror(-rc));
+            if (abs_event_caused_move) {
+               g_last_processed_abs_move_was_trackpad = device.is_touch_pointer;
             }
         }
     }
-}
 
-void simulate_input_event(LT::Network::InputPayload payload) {
+    if (!(ev.type == EV_SYN && ev.code == SYN_REPORT)) {
+        return false;
+    }
 
-    if (!g_uinput_device) {
-        LT::Utils::Logger::GetInstance().Warning("Simulating: uinput device not available.");
-        
+    if (device.is_touch_pointer && device.touch_is_active && device.pending_abs_x && device.pending_abs_y) {
+        int32_t current_raw_dev_x = *device.pending_abs_x;
+        int32_t current_raw_dev_y = *device.pending_abs_y;
+
+        if (!device.initial_raw_abs_at_touch_start) {
+            device.initial_raw_abs_at_touch_start = std::make_pair(current_raw_dev_x, current_raw_dev_y);
+        } else {
+            int32_t raw_delta_x = current_raw_dev_x - device.initial_raw_abs_at_touch_start->first;
+            int32_t raw_delta_y = current_raw_dev_y - device.initial_raw_abs_at_touch_start->second;
+
+            double screen_delta_x = 0.0, screen_delta_y = 0.0;
+            const auto& abs_x_info = device.abs_x_info;
+            const auto& abs_y_info = device.abs_y_info;
+
+            if (abs_x_info.maximum > abs_x_info.minimum && (g_client_screen_width -1) > 0) {
+                screen_delta_x = static_cast<double>(raw_delta_x) /
+                                   (abs_x_info.maximum - abs_x_info.minimum) *
+                                   (g_client_screen_width - 1);
+            }
+            if (abs_y_info.maximum > abs_y_info.minimum && (g_client_screen_height -1) > 0) {
+                screen_delta_y = static_cast<double>(raw_delta_y) /
+                                   (abs_y_info.maximum - abs_y_info.minimum) *
+                                   (g_client_screen_height - 1);
+            }
+
+            // Relative mode reports the unrounded offset, so slow swipes are not lost to truncation.
+            if (screen_delta_x != device.touch_reported_dx || screen_delta_y != device.touch_reported_dy) {
+                acc.rel_dx += screen_delta_x - device.touch_reported_dx;
+                acc.rel_dy += screen_delta_y - device.touch_reported_dy;
+                device.touch_reported_dx = screen_delta_x;
+                device.touch_reported_dy = screen_delta_y;
+                acc.raw_mouse_moved = true;
+            }
+
+            if (device.screen_coords_at_touch_start) {
+                int32_t old_abs_x = g_helper_abs_x;
+                int32_t old_abs_y = g_helper_abs_y;
+                g_helper_abs_x = device.screen_coords_at_touch_start->first + static_cast<int32_t>(screen_delta_x);
+                g_helper_abs_y = device.screen_coords_at_touch_start->second + static_cast<int32_t>(screen_delta_y);
+                 if (g_helper_abs_x != old_abs_x || g_helper_abs_y != old_abs_y) {
+                    acc.raw_mouse_moved = true;
+                    g_last_processed_abs_move_was_trackpad = true;
+                }
+            }
+        }
+    }
+    device.pending_abs_x = std::nullopt;
+    device.pending_abs_y = std::nullopt;
+
+    if (acc.raw_mouse_moved && g_helper_mouse_state_initialized) {
+        g_helper_abs_x = std::max(0, std::min(g_helper_abs_x, static_cast<int32_t>(g_client_screen_width - 1)));
+        g_helper_abs_y = std::max(0, std::min(g_helper_abs_y, static_cast<int32_t>(g_client_screen_height - 1)));
+    }
+
+    if (g_relative_mouse_mode.load(std::memory_order_relaxed)) {
+        build_relative_report(acc);
+        return true;
+    }
+
+    bool mouse_moved_significantly_this_report = false;
+    if (acc.raw_mouse_moved && g_helper_mouse_state_initialized) {
+        int dx = g_helper_abs_x - g_helper_last_sent_abs_x;
+        int dy = g_helper_abs_y - g_helper_last_sent_abs_y;
+        if ((dx * dx + dy * dy) >= HELPER_MOUSE_DEADZONE_SQUARED) {
+            mouse_moved_significantly_this_report = true;
+        }
+    }
+
+    bool mouse_buttons_changed_this_report = acc.raw_mouse_button_changed;
+    bool send_mouse_update_this_report = mouse_moved_significantly_this_report || mouse_buttons_changed_this_report;
+
+    bool key_event_is_mouse_button = report_has_mouse_button_key(acc.payload);
+
+    LT::Network::InputPayload& payload = acc.payload;
+    payload.isMouseEvent = (payload.scrollDeltaX != 0 || payload.scrollDeltaY != 0 ||
+                            send_mouse_update_this_report || key_event_is_mouse_button);
+
+    if (payload.isMouseEvent) {
+        if ((g_last_processed_abs_move_was_trackpad && acc.raw_mouse_moved) ||
+            (device.is_part_of_touchpad_system && mouse_buttons_changed_this_report)
+           ) {
+            payload.sourceDeviceType = LT::Network::InputSourceDeviceType::TRACKPAD_ABSOLUTE;
+        } else {
+            payload.sourceDeviceType = LT::Network::InputSourceDeviceType::MOUSE_ABSOLUTE;
+        }
+
+        if (send_mouse_update_this_report && g_helper_mouse_state_initialized && g_client_screen_width > 0 && g_client_screen_height > 0) {
+            payload.relativeX = static_cast<float>(g_helper_abs_x) / std::max(1, (g_client_screen_width -1));
+            payload.relativeY = static_cast<float>(g_helper_abs_y) / std::max(1, (g_client_screen_height-1));
+            payload.relativeX = std::max(0.0f, std::min(1.0f, payload.relativeX));
+            payload.relativeY = std::max(0.0f, std::min(1.0f, payload.relativeY));
+
+            g_helper_last_sent_abs_x = g_helper_abs_x;
+            g_helper_last_sent_abs_y = g_helper_abs_y;
+        }
+        payload.mouseButtons = g_helper_mouse_buttons_state;
+        if (mouse_buttons_changed_this_report) {
+            g_helper_last_sent_mouse_buttons = g_helper_mouse_buttons_state;
+        }
+    }
+    return true;
+}
+
+void poll_events_once_and_send(asio::local::stream_protocol::socket& target_socket) {
+    if (g_devices.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
         return;
     }
 
+    int ret = poll(g_device_pollfds.data(), g_device_pollfds.size(), 20);
+    if (ret <= 0) return;
+    const uint64_t read_stamp_us = g_latency_trace.load(std::memory_order_relaxed) ? LT::Utils::LatencyStats::nowUs() : 0;
+
+    ensure_helper_mouse_state_initialized();
+
+    static ReportAccumulator acc;
+    acc.reset();
+    for (size_t slot = 0; slot < g_devices.size(); ++slot) {
+        if (!(g_device_pollfds[slot].revents & POLLIN)) continue;
+
+        DeviceState& device = g_devices[slot];
+        device.pending_abs_x = std::nullopt;
+        device.pending_abs_y = std::nullopt;
+
+        struct input_event ev;
+        int rc;
+        while ((rc = libevdev_next_event(device.dev, LIBEVDEV_READ_FLAG_NORMAL, &ev)) == LIBEVDEV_READ_STATUS_SUCCESS) {
+            if (g_trace_writer.isOpen()) {
+                g_trace_writer.writeEvent(static_cast<uint32_t>(slot), ev);
+            }
+            if (process_device_event(device, ev, acc)) {
+                acc.payload.ipcStampUs = read_stamp_us;
+                if (acc.has_content() && !send_payload_to_app(acc.payload, target_socket)) {
+                    g_helper_running = false; return;
+                }
+                acc.reset();
+            }
+        }
+        if (rc == LIBEVDEV_READ_STATUS_SYNC) { }
+        else if (rc != LIBEVDEV_READ_STATUS_SUCCESS && rc != -EAGAIN) {
+            LT::Utils::Logger::GetInstance().Warning("Input Helper: libevdev_next_event error on fd " + std::to_string(device.fd) + ": " + strerror(-rc));
+        }
+    }
+}
+
+// Appends one payload's events, terminated by its own SYN_REPORT, to the batch.
+static void append_simulated_events(LT::Input::UinputEventBatch& batch, LT::Network::InputPayload payload) {
     for (const auto& keyEvent : payload.keyEvents) {
         uint16_t evdev_code = LT::Utils::KeycodeConverter::vkToEvdev(keyEvent.keyCode);
         if (evdev_code != 0) {
-            libevdev_uinput_write_event(g_uinput_device, EV_KEY, evdev_code, keyEvent.isPressed ? 1 : 0);
+            batch.add(EV_KEY, evdev_code, keyEvent.isPressed ? 1 : 0);
         } else {
             LT::Utils::Logger::GetInstance().Warning("Simulating: No evdev_code for vk_code: " + LT::Utils::Logger::getKeyName(keyEvent.keyCode) + " (" + std::to_string(keyEvent.keyCode) + ")");
         }
     }
 
-    if (payload.isMouseEvent && payload.relativeX != -1.0f && payload.relativeY != -1.0f) {
+    if (payload.isMouseEvent && payload.sourceDeviceType == LT::Network::InputSourceDeviceType::MOUSE_RELATIVE) {
+        g_inject_carry_x += payload.deltaX;
+        g_inject_carry_y += payload.deltaY;
+        int32_t step_x = static_cast<int32_t>(g_inject_carry_x);
+        int32_t step_y = static_cast<int32_t>(g_inject_carry_y);
+        g_inject_carry_x -= static_cast<float>(step_x);
+        g_inject_carry_y -= static_cast<float>(step_y);
+        if (step_x != 0) batch.add(EV_REL, REL_X, step_x);
+        if (step_y != 0) batch.add(EV_REL, REL_Y, step_y);
+    } else if (payload.isMouseEvent && payload.relativeX != -1.0f && payload.relativeY != -1.0f) {
         if (g_client_screen_width > 0 && g_client_screen_height > 0) {
 
             float processedSimX, processedSimY;
@@ -821,22 +993,164 @@ void simulate_input_event(LT::Network::InputPayload payload) {
             target_abs_x = std::max(0, std::min(target_abs_x, static_cast<int32_t>(g_client_screen_width - 1)));
             target_abs_y = std::max(0, std::min(target_abs_y, static_cast<int32_t>(g_client_screen_height - 1)));
 
-            libevdev_uinput_write_event(g_uinput_device, EV_ABS, ABS_X, target_abs_x);
-            libevdev_uinput_write_event(g_uinput_device, EV_ABS, ABS_Y, target_abs_y);
+            batch.add(EV_ABS, ABS_X, target_abs_x);
+            batch.add(EV_ABS, ABS_Y, target_abs_y);
         } else {
             LT::Utils::Logger::GetInstance().Warning("Simulating: Screen dimensions unknown in helper, cannot scale relative mouse move.");
         }
     }
 
-    if (payload.scrollDeltaY != 0) {
-        libevdev_uinput_write_event(g_uinput_device, EV_REL, REL_WHEEL, payload.scrollDeltaY);
+    // Hi-res consumers use the fine axis; legacy ones only see whole notches once the carry fills up.
+    if (payload.scrollHiResY != 0) {
+        batch.add(EV_REL, REL_WHEEL_HI_RES, payload.scrollHiResY);
+        g_inject_wheel_carry_y += payload.scrollHiResY;
+        int notches = g_inject_wheel_carry_y / WHEEL_HI_RES_PER_NOTCH;
+        g_inject_wheel_carry_y -= notches * WHEEL_HI_RES_PER_NOTCH;
+        if (notches != 0) batch.add(EV_REL, REL_WHEEL, notches);
+    } else if (payload.scrollDeltaY != 0) {
+        batch.add(EV_REL, REL_WHEEL, payload.scrollDeltaY);
+    }
+    if (payload.scrollHiResX != 0) {
+        batch.add(EV_REL, REL_HWHEEL_HI_RES, payload.scrollHiResX);
+        g_inject_wheel_carry_x += payload.scrollHiResX;
+        int notches = g_inject_wheel_carry_x / WHEEL_HI_RES_PER_NOTCH;
+        g_inject_wheel_carry_x -= notches * WHEEL_HI_RES_PER_NOTCH;
+        if (notches != 0) batch.add(EV_REL, REL_HWHEEL, notches);
+    } else if (payload.scrollDeltaX != 0) {
+        batch.add(EV_REL, REL_HWHEEL, payload.scrollDeltaX);
+    }
+
+    batch.sync();
+}
+
+// Injects a run of payloads with a single write() to the uinput device.
+void simulate_input_events(std::vector<LT::Network::InputPayload>& payloads) {
+    if (!g_uinput_device) {
+        LT::Utils::Logger::GetInstance().Warning("Simulating: uinput device not available.");
+        return;
     }
-    if (payload.scrollDeltaX != 0) {
-        libevdev_uinput_write_event(g_uinput_device, EV_REL, REL_HWHEEL, payload.scrollDeltaX);
+
+    // One buffer per injecting thread (ring or socket path), reused so the hot path does not allocate.
+    static thread_local LT::Input::UinputEventBatch batch;
+    static thread_local std::vector<uint64_t> queued_stamps_us;
+    queued_stamps_us.clear();
+    for (auto& payload : payloads) {
+        if (payload.ipcStampUs != 0) queued_stamps_us.push_back(payload.ipcStampUs);
+        append_simulated_events(batch, std::move(payload));
     }
+    batch.flush(libevdev_uinput_get_fd(g_uinput_device));
+
+    if (!queued_stamps_us.empty() && app_rings_attached()) {
+        const uint64_t now_us = LT::Utils::LatencyStats::nowUs();
+        for (uint64_t stamp : queued_stamps_us) {
+            uint64_t elapsed = now_us > stamp ? now_us - stamp : 0;
+            LT::Input::HelperIpc::pushLatencySample(g_shared_data_ptr->inject_latency,
+                                                    static_cast<uint32_t>(std::min<uint64_t>(elapsed, UINT32_MAX)));
+        }
+    }
+}
 
-    libevdev_uinput_write_event(g_uinput_device, EV_SYN, SYN_REPORT, 0);
+void simulate_input_event(LT::Network::InputPayload payload) {
+    std::vector<LT::Network::InputPayload> single;
+    single.push_back(std::move(payload));
+    simulate_input_events(single);
+}
 
+// Resets the capture and injection state and installs the trace's devices in place of real ones.
+static void load_trace_devices(const LT::Input::EvdevTrace::Trace& trace) {
+    g_client_screen_width = trace.screenWidth;
+    g_client_screen_height = trace.screenHeight;
+    g_helper_key_state.reset();
+    g_helper_mouse_buttons_state = 0;
+    g_helper_last_sent_mouse_buttons = 0;
+    g_last_processed_abs_move_was_trackpad = false;
+    g_helper_mouse_state_initialized = false;
+    helper_reset_simulation_state();
+    g_inject_carry_x = g_inject_carry_y = 0.0f;
+    g_inject_wheel_carry_x = g_inject_wheel_carry_y = 0;
+
+    g_devices.clear();
+    uint32_t maxSlot = 0;
+    for (const auto& info : trace.devices) maxSlot = std::max(maxSlot, info.slot);
+    g_devices.resize(trace.devices.empty() ? 0 : maxSlot + 1);
+    for (const auto& info : trace.devices) {
+        DeviceState& device = g_devices[info.slot];
+        device.is_touch_pointer = info.isTouchPointer;
+        device.is_part_of_touchpad_system = info.isTouchpadSystem;
+        device.has_abs_x = info.hasAbsX;
+        device.abs_x_info.minimum = info.absXMin;
+        device.abs_x_info.maximum = info.absXMax;
+        device.has_abs_y = info.hasAbsY;
+        device.abs_y_info.minimum = info.absYMin;
+        device.abs_y_info.maximum = info.absYMax;
+    }
+}
+
+bool replayEvdevTrace(const LT::Input::EvdevTrace::Trace& trace, std::vector<LT::Network::InputPayload>& captured, TraceReplayStats& stats) {
+    load_trace_devices(trace);
+    ensure_helper_mouse_state_initialized();
+
+    // Injection goes to /dev/null so the uinput write cost is modelled without a real device.
+    int sinkFd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (sinkFd < 0) return false;
+    LT::Input::UinputEventBatch batch;
+
+    std::vector<double> reportLatenciesUs;
+    ReportAccumulator acc;
+    acc.reset();
+    captured.clear();
+
+    using Clock = std::chrono::steady_clock;
+    const auto replayStart = Clock::now();
+    auto reportStart = replayStart;
+    bool reportOpen = false;
+
+    for (const auto& traced : trace.events) {
+        struct input_event ev = {};
+        ev.input_event_sec = static_cast<decltype(ev.input_event_sec)>(traced.timestampUs / 1000000ull);
+        ev.input_event_usec = static_cast<decltype(ev.input_event_usec)>(traced.timestampUs % 1000000ull);
+        ev.type = traced.type;
+        ev.code = traced.code;
+        ev.value = traced.value;
+
+        if (!reportOpen) {
+            reportStart = Clock::now();
+            reportOpen = true;
+        }
+        if (!process_device_event(g_devices[traced.slot], ev, acc)) {
+            continue;
+        }
+        if (acc.has_content()) {
+            // Same path a payload takes in production: IPC codec, then the receiver's uinput batch.
+            std::vector<uint8_t> wire = LT::Utils::serializeInputPayload(acc.payload);
+            auto decoded = LT::Utils::deserializeInputPayload(wire.data(), wire.size());
+            if (decoded) {
+                captured.push_back(*decoded);
+                append_simulated_events(batch, std::move(*decoded));
+                batch.flush(sinkFd);
+            }
+            reportLatenciesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - reportStart).count());
+        }
+        acc.reset();
+        reportOpen = false;
+    }
+
+    stats.seconds = std::chrono::duration<double>(Clock::now() - replayStart).count();
+    close(sinkFd);
+
+    stats.events = trace.events.size();
+    stats.payloads = captured.size();
+    stats.eventsPerSecond = stats.seconds > 0.0 ? static_cast<double>(stats.events) / stats.seconds : 0.0;
+    stats.meanLatencyUs = 0.0;
+    stats.p99LatencyUs = 0.0;
+    if (!reportLatenciesUs.empty()) {
+        double total = 0.0;
+        for (double latency : reportLatenciesUs) total += latency;
+        stats.meanLatencyUs = total / reportLatenciesUs.size();
+        std::sort(reportLatenciesUs.begin(), reportLatenciesUs.end());
+        stats.p99LatencyUs = reportLatenciesUs[std::min(reportLatenciesUs.size() - 1, reportLatenciesUs.size() * 99 / 100)];
+    }
+    return true;
 }
 
 void handle_ipc_command(const char* data, size_t length, asio::local::stream_protocol::socket& source_socket) {
@@ -865,6 +1179,18 @@ void handle_ipc_command(const char* data, size_t length, asio::local::stream_pro
         case IPCCommandType::UngrabDevices:
             grab_or_ungrab_all_devices(false);
             break;
+        case IPCCommandType::SetMouseMode: {
+            bool relative = length > 1 && data[1] != 0;
+            g_relative_mouse_mode.store(relative, std::memory_order_relaxed);
+            LT::Utils::Logger::GetInstance().Info(std::string("Input Helper: Mouse capture mode set to ") + (relative ? "relative." : "absolute."));
+            break;
+        }
+        case IPCCommandType::SetLatencyTrace: {
+            bool enabled = length > 1 && data[1] != 0;
+            g_latency_trace.store(enabled, std::memory_order_relaxed);
+            LT::Utils::Logger::GetInstance().Info(std::string("Input Helper: Latency tracing ") + (enabled ? "enabled." : "disabled."));
+            break;
+        }
         case IPCCommandType::Shutdown:
             LT::Utils::Logger::GetInstance().Info("Input Helper: Shutdown command received.");
             g_helper_running = false;
@@ -891,7 +1217,7 @@ int runInputHelperMode(int argc, char **argv) {
                                          ", User: " + original_username + " (" + std::to_string(original_user_uid) + ")" +
                                          ", Screen: " + std::to_string(g_client_screen_width) + "x" + std::to_string(g_client_screen_height) + ") ---");
 
-    if (!setup_shared_memory()) { return 1; }
+    if (!setup_shared_memory(original_user_uid)) { return 1; }
 
     signal(SIGINT, helper_signal_handler);
     signal(SIGTERM, helper_signal_handler);
@@ -901,6 +1227,9 @@ int runInputHelperMode(int argc, char **argv) {
     if (!initialize_input_devices()) {
         cleanup_helper_resources(); return 1;
     }
+    if (argc > 6 && argv[6][0] != '\0') {
+        start_trace_recording(argv[6], original_user_uid);
+    }
 
     G_ACTUAL_SOCKET_PATH = "/tmp/localtether_helper_" + std::string(original_username) + "_" + std::to_string(getpid());
 
@@ -910,6 +1239,7 @@ int runInputHelperMode(int argc, char **argv) {
     g_main_app_socket_ptr = &main_app_socket;
 
     std::thread input_polling_thread_obj;
+    std::thread ring_injector_thread_obj;
 
     try {
         std::filesystem::remove(G_ACTUAL_SOCKET_PATH);
@@ -947,6 +1277,19 @@ int runInputHelperMode(int argc, char **argv) {
             LT::Utils::Logger::GetInstance().Info("Input Helper: Input polling thread finished.");
         });
 
+        // SimulateInput payloads arriving through the shared ring are injected here, off the socket thread.
+        ring_injector_thread_obj = std::thread([]() {
+            std::vector<LT::Network::InputPayload> pending;
+            while (g_helper_running.load(std::memory_order_relaxed)) {
+                LT::Input::HelperIpc::waitForData(g_shared_data_ptr->to_helper, std::chrono::milliseconds(100));
+                pending.clear();
+                LT::Input::HelperIpc::drain(g_shared_data_ptr->to_helper, pending);
+                if (!pending.empty()) {
+                    simulate_input_events(pending);
+                }
+            }
+        });
+
         helper_reset_simulation_state();
         std::array<char, 2048> ipc_read_buffer_local;
         while (g_helper_running.load(std::memory_order_relaxed)) {
@@ -979,11 +1322,79 @@ int runInputHelperMode(int argc, char **argv) {
     if (input_polling_thread_obj.joinable()) {
         input_polling_thread_obj.join();
     }
+    if (ring_injector_thread_obj.joinable()) {
+        LT::Input::HelperIpc::wakeConsumer(g_shared_data_ptr->to_helper);
+        ring_injector_thread_obj.join();
+    }
 
     cleanup_helper_resources();
     LT::Utils::Logger::GetInstance().Info("--- Input Helper Mode Terminated ---");
     return 0;
 }
 
+int runInputTraceMode(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --replay-input-trace <trace> [--golden <file>] [--update-golden] [--iterations <n>] [--relative]" << std::endl;
+        return 2;
+    }
+    std::string tracePath = argv[2];
+    std::string goldenPath;
+    bool updateGolden = false;
+    int iterations = 1;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--golden" && i + 1 < argc) goldenPath = argv[++i];
+        else if (arg == "--update-golden") updateGolden = true;
+        else if (arg == "--iterations" && i + 1 < argc) iterations = std::max(1, atoi(argv[++i]));
+        else if (arg == "--relative") g_relative_mouse_mode.store(true);
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    LT::Input::EvdevTrace::Trace trace;
+    std::string error;
+    if (!LT::Input::EvdevTrace::readTrace(tracePath, trace, error)) {
+        std::cerr << "Failed to read trace: " << error << std::endl;
+        return 2;
+    }
+
+    // Every iteration starts from a clean state, so the payload stream must be identical each time.
+    std::vector<LT::Network::InputPayload> captured;
+    TraceReplayStats best{};
+    for (int i = 0; i < iterations; ++i) {
+        TraceReplayStats stats{};
+        if (!replayEvdevTrace(trace, captured, stats)) {
+            std::cerr << "Replay failed." << std::endl;
+            return 2;
+        }
+        if (i == 0 || stats.eventsPerSecond > best.eventsPerSecond) best = stats;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "events=" << best.events << " payloads=" << best.payloads
+              << " events_per_sec=" << best.eventsPerSecond
+              << " latency_mean_us=" << best.meanLatencyUs
+              << " latency_p99_us=" << best.p99LatencyUs << std::endl;
+
+    if (goldenPath.empty()) return 0;
+    if (updateGolden) {
+        if (!LT::Input::EvdevTrace::writeGolden(goldenPath, captured)) {
+            std::cerr << "Failed to write golden file " << goldenPath << std::endl;
+            return 2;
+        }
+        std::cout << "Golden output written to " << goldenPath << std::endl;
+        return 0;
+    }
+    std::string difference;
+    if (!LT::Input::EvdevTrace::compareGolden(goldenPath, captured, difference)) {
+        std::cerr << "Golden mismatch: " << difference << std::endl;
+        return 1;
+    }
+    std::cout << "Golden output matches." << std::endl;
+    return 0;
+}
+
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "input/MotionJitterBuffer.h"
+#include "utils/Config.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace LocalTether::Input {
+
+namespace {
+    // Allowed drift past the newest sample before the cursor holds still.
+    constexpr std::chrono::microseconds MAX_EXTRAPOLATION{30000};
+    // Changes smaller than this (about a tenth of a pixel on a 4K screen) are not re-injected.
+    constexpr float POSITION_EPSILON = 0.00003f;
+    // Enough history for interpolation even at 1 kHz input with the largest delay.
+    constexpr size_t MAX_SAMPLES = 128;
+    // Longer pauses mean the pointer stopped; the next movement starts a fresh cadence.
+    constexpr std::chrono::milliseconds MAX_CADENCE_GAP{100};
+
+    float lerp(float a, float b, double t) {
+        return static_cast<float>(a + (b - a) * t);
+    }
+}
+
+bool MotionJitterBuffer::isEnabledInConfig() {
+    return Utils::Config::Live().jitterBuffer;
+}
+
+bool MotionJitterBuffer::accepts(const Network::InputPayload& payload) const {
+    return payload.isMouseEvent &&
+           payload.keyEvents.empty() &&
+           payload.sourceDeviceType != Network::InputSourceDeviceType::MOUSE_RELATIVE &&
+           payload.relativeX >= 0.0f && payload.relativeY >= 0.0f &&
+           payload.scrollDeltaX == 0 && payload.scrollDeltaY == 0 &&
+           payload.scrollHiResX == 0 && payload.scrollHiResY == 0 &&
+           payload.mouseButtons == lastButtons_;
+}
+
+void MotionJitterBuffer::push(const Network::InputPayload& payload, Clock::time_point arrival) {
+    // Arrival times carry the network jitter. Each sample is instead placed on a timeline that
+    // follows the sender's average cadence and only drifts slowly towards actual arrivals.
+    Clock::time_point stamp = arrival;
+    if (hasLastArrival_) {
+        auto gap = arrival - lastArrival_;
+        if (gap > MAX_CADENCE_GAP || gap < Clock::duration::zero()) {
+            cadence_ = Clock::duration::zero();
+        } else {
+            cadence_ = cadence_ == Clock::duration::zero() ? gap : (cadence_ * 7 + gap) / 8;
+            Clock::time_point predicted = lastStamp_ + cadence_;
+            stamp = predicted + (arrival - predicted) / 8;
+            auto slack = std::chrono::duration_cast<Clock::duration>(delay_) / 2;
+            stamp = std::clamp(stamp, arrival - slack, arrival + slack);
+            stamp = std::max(stamp, lastStamp_);
+        }
+    }
+    lastArrival_ = arrival;
+    lastStamp_ = stamp;
+    hasLastArrival_ = true;
+
+    samples_.push_back({stamp, payload.relativeX, payload.relativeY});
+    lastSource_ = payload.sourceDeviceType;
+    if (samples_.size() > MAX_SAMPLES) {
+        samples_.pop_front();
+    }
+}
+
+Network::InputPayload MotionJitterBuffer::makePayload(float x, float y) const {
+    Network::InputPayload payload;
+    payload.isMouseEvent = true;
+    payload.sourceDeviceType = lastSource_;
+    payload.relativeX = std::clamp(x, 0.0f, 1.0f);
+    payload.relativeY = std::clamp(y, 0.0f, 1.0f);
+    payload.mouseButtons = lastButtons_;
+    return payload;
+}
+
+std::optional<Network::InputPayload> MotionJitterBuffer::sample(Clock::time_point now) {
+    if (samples_.empty()) return std::nullopt;
+
+    const Clock::time_point renderTime = now - delay_;
+    if (renderTime < samples_.front().stamp) return std::nullopt;
+
+    // Keep exactly one sample at or before renderTime as the interpolation start, remembering
+    // the velocity of each segment passed so an underrun can continue along it.
+    while (samples_.size() > 1 && samples_[1].stamp <= renderTime) {
+        rememberVelocity(samples_[0], samples_[1]);
+        samples_.pop_front();
+    }
+
+    float x;
+    float y;
+    if (samples_.size() > 1) {
+        const Sample& a = samples_[0];
+        const Sample& b = samples_[1];
+        rememberVelocity(a, b);
+        double span = std::chrono::duration<double>(b.stamp - a.stamp).count();
+        double t = span > 0.0 ? std::chrono::duration<double>(renderTime - a.stamp).count() / span : 1.0;
+        x = lerp(a.x, b.x, t);
+        y = lerp(a.y, b.y, t);
+    } else {
+        // Underrun: continue along the last segment's velocity for a bounded time.
+        const Sample& last = samples_.back();
+        x = last.x;
+        y = last.y;
+        auto overrun = std::min<Clock::duration>(renderTime - last.stamp, MAX_EXTRAPOLATION);
+        if (velocityValid_ && overrun > Clock::duration::zero()) {
+            double seconds = std::chrono::duration<double>(overrun).count();
+            x = static_cast<float>(x + velocityX_ * seconds);
+            y = static_cast<float>(y + velocityY_ * seconds);
+        }
+    }
+
+    if (std::fabs(x - lastEmittedX_) < POSITION_EPSILON && std::fabs(y - lastEmittedY_) < POSITION_EPSILON) {
+        return std::nullopt;
+    }
+    lastEmittedX_ = x;
+    lastEmittedY_ = y;
+    return makePayload(x, y);
+}
+
+void MotionJitterBuffer::rememberVelocity(const Sample& a, const Sample& b) {
+    double span = std::chrono::duration<double>(b.stamp - a.stamp).count();
+    // Back-to-back arrivals from a burst say nothing about speed.
+    if (span < 0.001) return;
+    velocityX_ = (b.x - a.x) / span;
+    velocityY_ = (b.y - a.y) / span;
+    velocityValid_ = true;
+}
+
+std::optional<Network::InputPayload> MotionJitterBuffer::flushBefore(const Network::InputPayload& bypassing) {
+    std::optional<Network::InputPayload> pending;
+    if (!samples_.empty()) {
+        const Sample& newest = samples_.back();
+        if (std::fabs(newest.x - lastEmittedX_) >= POSITION_EPSILON || std::fabs(newest.y - lastEmittedY_) >= POSITION_EPSILON) {
+            pending = makePayload(newest.x, newest.y);
+        }
+        lastEmittedX_ = newest.x;
+        lastEmittedY_ = newest.y;
+        samples_.clear();
+    }
+    // A bypassing payload with its own position supersedes whatever was buffered.
+    if (bypassing.isMouseEvent && bypassing.relativeX >= 0.0f && bypassing.relativeY >= 0.0f &&
+        bypassing.sourceDeviceType != Network::InputSourceDeviceType::MOUSE_RELATIVE) {
+        lastEmittedX_ = bypassing.relativeX;
+        lastEmittedY_ = bypassing.relativeY;
+    }
+    if (bypassing.isMouseEvent) {
+        lastButtons_ = bypassing.mouseButtons;
+    }
+    velocityValid_ = false;
+    hasLastArrival_ = false;
+    return pending;
+}
+
+void MotionJitterBuffer::updateDelayFromRtt(double rttVarianceMs) {
+    // Four deviations cover nearly all arrival spread; one playout tick is added on top.
+    auto target = std::chrono::microseconds(static_cast<int64_t>(rttVarianceMs * 4000.0)) +
+                  std::chrono::duration_cast<std::chrono::microseconds>(PLAYOUT_INTERVAL);
+    delay_ = std::clamp(target, MIN_DELAY, MAX_DELAY);
+}
+
+void MotionJitterBuffer::reset() {
+    samples_.clear();
+    lastButtons_ = 0;
+    lastEmittedX_ = -1.0f;
+    lastEmittedY_ = -1.0f;
+    velocityValid_ = false;
+    hasLastArrival_ = false;
+    cadence_ = Clock::duration::zero();
+}
+
+}
@@ -0,0 +1,49 @@
+#ifndef _WIN32
+#include "input/UinputEventBatch.h"
+#include "utils/Logger.h"
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace LocalTether::Input {
+
+void UinputEventBatch::add(uint16_t type, uint16_t code, int32_t value) {
+    // uinput stamps events itself, so the time fields are left zeroed.
+    struct input_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.code = code;
+    ev.value = value;
+    events_.push_back(ev);
+}
+
+bool UinputEventBatch::flush(int fd) {
+    if (events_.empty()) return true;
+
+    const char* data = reinterpret_cast<const char*>(events_.data());
+    size_t remaining = events_.size() * sizeof(struct input_event);
+    bool ok = true;
+    while (remaining > 0) {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            Utils::Logger::GetInstance().Warning("UinputEventBatch: write of " + std::to_string(events_.size()) +
+                                                 " events failed: " + std::string(strerror(errno)));
+            ok = false;
+            break;
+        }
+        if (written == 0) {
+            ok = false;
+            break;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    events_.clear();
+    return ok;
+}
+
+}
+#endif
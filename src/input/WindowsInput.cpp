@@ -66,7 +66,10 @@ bool WindowsInput::start() {
     resetSimulationState();  
 
     if (m_is_host_mode) {
-        m_hook_pressed_keys.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_hook_pressed_keys_mutex);
+            m_hook_pressed_keys.reset();
+        }
         m_hook_combo_was_active_last_check = false;
         m_virtualRelativeX = 0.5f;
         m_virtualRelativeY = 0.5f;
@@ -301,9 +304,9 @@ std::vector<LocalTether::Network::InputPayload> WindowsInput::pollEvents() {
                 if (m_lastSentRelativeX_polling == -1.0f || m_lastSentRelativeY_polling == -1.0f || m_firstPoll) {
                     significant_move = true;
                 } else {
-                    constexpr float RELATIVE_DEADZONE = 0.002f;
-                    if (std::abs(rel_x - m_lastSentRelativeX_polling) > RELATIVE_DEADZONE ||
-                        std::abs(rel_y - m_lastSentRelativeY_polling) > RELATIVE_DEADZONE) {
+                    const float deadzone = LocalTether::Utils::Config::Live().relativeDeadzone;
+                    if (std::abs(rel_x - m_lastSentRelativeX_polling) > deadzone ||
+                        std::abs(rel_y - m_lastSentRelativeY_polling) > deadzone) {
                         significant_move = true;
                     }
                 }
@@ -450,7 +453,7 @@ LRESULT CALLBACK WindowsInput::LowLevelKeyboardProc(int nCode, WPARAM wParam, LP
                     }
                 }
                 
-            } else {
+            } else if (!s_instance_ptr->isLocalPassthrough()) {
                  
                 return 1;
             }
@@ -490,7 +493,7 @@ LRESULT CALLBACK WindowsInput::LowLevelMouseProc(int nCode, WPARAM wParam, LPARA
                     }
                 }
                 
-            } else {
+            } else if (!s_instance_ptr->isLocalPassthrough()) {
                  
                 return 1;
             }
@@ -499,22 +502,22 @@ LRESULT CALLBACK WindowsInput::LowLevelMouseProc(int nCode, WPARAM wParam, LPARA
     return CallNextHookEx(m_hMouseHook, nCode, wParam, lParam);
 }
 
+std::optional<KeyState> WindowsInput::capturedKeyState() const {
+    if (!m_is_host_mode || !m_hook_thread_running.load(std::memory_order_relaxed)) {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(m_hook_pressed_keys_mutex);
+    return m_hook_pressed_keys;
+}
+
 void WindowsInput::ProcessKeyFromHook(BYTE vkCode, bool isPressed, DWORD scanCode, bool isExtended) {
      
      
     if (vkCode == 0) return;
-    bool stateChanged = false;
-
-    if (isPressed) {
-        if (m_hook_pressed_keys.find(vkCode) == m_hook_pressed_keys.end()) {
-            m_hook_pressed_keys.insert(vkCode);
-            stateChanged = true;
-        }
-    } else {
-        if (m_hook_pressed_keys.count(vkCode)) {
-            m_hook_pressed_keys.erase(vkCode);
-            stateChanged = true;
-        }
+    bool stateChanged;
+    {
+        std::lock_guard<std::mutex> lock(m_hook_pressed_keys_mutex);
+        stateChanged = m_hook_pressed_keys.set(vkCode, isPressed);
     }
 
     if(InputManager::input_globally_paused_.load(std::memory_order_relaxed)){
@@ -676,19 +679,19 @@ void WindowsInput::CheckPauseComboFromHook() {
         for (uint8_t defined_key : current_pause_keys_definition) {
             bool defined_key_satisfied = false;
             if (defined_key == VK_CONTROL) {
-                if (m_hook_pressed_keys.count(VK_LCONTROL) || m_hook_pressed_keys.count(VK_RCONTROL) || m_hook_pressed_keys.count(VK_CONTROL)) {
+                if (m_hook_pressed_keys.test(VK_LCONTROL) || m_hook_pressed_keys.test(VK_RCONTROL) || m_hook_pressed_keys.test(VK_CONTROL)) {
                     defined_key_satisfied = true;
                 }
             } else if (defined_key == VK_SHIFT) {
-                if (m_hook_pressed_keys.count(VK_LSHIFT) || m_hook_pressed_keys.count(VK_RSHIFT) || m_hook_pressed_keys.count(VK_SHIFT)) {
+                if (m_hook_pressed_keys.test(VK_LSHIFT) || m_hook_pressed_keys.test(VK_RSHIFT) || m_hook_pressed_keys.test(VK_SHIFT)) {
                     defined_key_satisfied = true;
                 }
             } else if (defined_key == VK_MENU) {
-                if (m_hook_pressed_keys.count(VK_LMENU) || m_hook_pressed_keys.count(VK_RMENU) || m_hook_pressed_keys.count(VK_MENU)) {
+                if (m_hook_pressed_keys.test(VK_LMENU) || m_hook_pressed_keys.test(VK_RMENU) || m_hook_pressed_keys.test(VK_MENU)) {
                     defined_key_satisfied = true;
                 }
             } else {
-                if (m_hook_pressed_keys.count(defined_key)) {
+                if (m_hook_pressed_keys.test(defined_key)) {
                     defined_key_satisfied = true;
                 }
             }
@@ -836,7 +839,21 @@ void WindowsInput::simulateInput(LocalTether::Network::InputPayload payload, uin
         mouseEventSim.type = INPUT_MOUSE;
         bool mouseEventGenerated = false;
 
-        if (payload.relativeX != -1.0f && payload.relativeY != -1.0f) {
+        if (payload.sourceDeviceType == LocalTether::Network::InputSourceDeviceType::MOUSE_RELATIVE) {
+            // Plain MOUSEEVENTF_MOVE takes whole mickeys, so the fractional part carries over.
+            m_relativeCarryX += payload.deltaX;
+            m_relativeCarryY += payload.deltaY;
+            LONG stepX = static_cast<LONG>(m_relativeCarryX);
+            LONG stepY = static_cast<LONG>(m_relativeCarryY);
+            m_relativeCarryX -= static_cast<float>(stepX);
+            m_relativeCarryY -= static_cast<float>(stepY);
+            if (stepX != 0 || stepY != 0) {
+                mouseEventSim.mi.dx = stepX;
+                mouseEventSim.mi.dy = stepY;
+                mouseEventSim.mi.dwFlags |= MOUSEEVENTF_MOVE;
+                mouseEventGenerated = true;
+            }
+        } else if (payload.relativeX != -1.0f && payload.relativeY != -1.0f) {
             float processedSimX, processedSimY;
             InputManager::processSimulatedMouseCoordinates(payload.relativeX, payload.relativeY, payload.sourceDeviceType, processedSimX, processedSimY);
              
@@ -870,12 +887,21 @@ void WindowsInput::simulateInput(LocalTether::Network::InputPayload payload, uin
         INPUT scrollInput = {0};  
         scrollInput.type = INPUT_MOUSE;
 
-        if (payload.scrollDeltaY != 0) {
+        // Hi-res wheel values are already in WHEEL_DELTA fractions, which SendInput accepts as is.
+        if (payload.scrollHiResY != 0) {
+            scrollInput.mi.mouseData = static_cast<DWORD>(payload.scrollHiResY);
+            scrollInput.mi.dwFlags |= MOUSEEVENTF_WHEEL;
+            scrollEventGenerated = true;
+        } else if (payload.scrollDeltaY != 0) {
             scrollInput.mi.mouseData = static_cast<DWORD>(payload.scrollDeltaY);
             scrollInput.mi.dwFlags |= MOUSEEVENTF_WHEEL;
             scrollEventGenerated = true;
         }
-        if (payload.scrollDeltaX != 0) {
+        if (payload.scrollHiResX != 0) {
+            scrollInput.mi.mouseData = static_cast<DWORD>(payload.scrollHiResX);
+            scrollInput.mi.dwFlags |= MOUSEEVENTF_HWHEEL;
+            scrollEventGenerated = true;
+        } else if (payload.scrollDeltaX != 0) {
             scrollInput.mi.mouseData = static_cast<DWORD>(payload.scrollDeltaX);  
             scrollInput.mi.dwFlags |= MOUSEEVENTF_HWHEEL;
             scrollEventGenerated = true;
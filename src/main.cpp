@@ -6,8 +6,12 @@
 #include "ui/panels/FileExplorerPanel.h"
 #include "ui/panels/ControlsPanel.h"
 #include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include "utils/Config.h"
+#include "utils/SslCertificateGenerator.h"
 #include "input/InputManager.h"
 #include "input/LinuxInputHelper.h"
+#include "network/ServerDaemon.h"
 
 #define ASIO_ENABLE_SSL
 #include <asio.hpp>
@@ -36,6 +40,9 @@ int main(int argc, char** argv) {
         LocalTether::Utils::Logger::GetInstance().Log("Input helper mode starting", LocalTether::Utils::LogLevel::Info);
         return LocalTether::Input::runInputHelperMode(argc, argv); 
     }
+    if (argc > 1 && std::string(argv[1]) == "--replay-input-trace") {
+        return LocalTether::Input::runInputTraceMode(argc, argv);
+    }
     if (setenv("OPENSSL_CONF", "/dev/null", 1) != 0) {
         LT::Utils::Logger::GetInstance().Warning("Failed to set OPENSSL_CONF environment variable to /dev/null.");
     } else {
@@ -43,6 +50,10 @@ int main(int argc, char** argv) {
     }
     #endif
 
+    if (argc > 1 && std::string(argv[1]) == "--server") {
+        return LT::Network::runServerMode(argc, argv);
+    }
+
     LT::Core::SDLApp app("LocalTether");
     if (!app.Initialize()) {
         return -1;
@@ -61,12 +72,16 @@ int main(int argc, char** argv) {
     } else {
         LT::Utils::Logger::GetInstance().Info("OpenSSL library initialized successfully.");
     }
+    // Ready the TLS key and certificate while the user is still on the home screen.
+    LT::Utils::SslCertificateGenerator::PrepareInBackground();
     asio::io_context io_context;
 
 #ifndef _WIN32
     LT::Utils::Logger::GetInstance().Info("PolKit ready");
 #endif
     LT::UI::initializeNetwork();
+    LT::Utils::MetricsRegistry::GetInstance().startPeriodicDump();
+    LT::Utils::Config::GetInstance().StartWatching();
     
     
     LocalTether::Utils::Logger::GetInstance().Info("--- Application Main Started ---");
@@ -110,6 +125,8 @@ int main(int argc, char** argv) {
     app.Run();
 
     LT::UI::cleanupNetwork();
+    LT::Utils::MetricsRegistry::GetInstance().stopPeriodicDump();
+    LT::Utils::Config::GetInstance().StopWatching();
 
     LT::Utils::Logger::GetInstance().Info("--- Application Main Exited ---");
 
@@ -1,9 +1,19 @@
 #include "network/Client.h"
+#include "network/NetworkMetrics.h"
 #include "utils/Logger.h"
 #include "utils/Serialization.h"  
+#include "utils/DeltaSync.h"
+#include "utils/TransferCompression.h"
+#include "utils/AtomicFile.h"
+#include "utils/LatencyStats.h"
+#include "utils/Metrics.h"
+#include "utils/UiWake.h"
+#include "utils/Paths.h"
 #include "input/InputManager.h"   
 #include "ui/UIState.h"
 #include <fstream>  
+#include <sstream>
+#include <algorithm>
 #include <SDL.h>
 #ifdef _WIN32
 #include <winsock2.h>  
@@ -15,9 +25,19 @@ namespace fs = std::filesystem;
 
 namespace LocalTether::Network {
 
+namespace {
+    LocalTether::Utils::Gauge& writeQueueDepthGauge() {
+        static LocalTether::Utils::Gauge& gauge = LocalTether::Utils::MetricsRegistry::GetInstance().gauge(
+            "localtether_client_write_queue_depth", "Buffers queued on the client connection, including the one being written.");
+        return gauge;
+    }
+}
+
 Client::Client(asio::io_context& io_context)
     : io_context_(io_context),
-      resolver_(io_context)
+      resolver_(io_context),
+      keepAliveTimer_(io_context),
+      playoutTimer_(io_context)
        
 {
     LocalTether::Utils::Logger::GetInstance().Debug("Client constructor: Entered.");
@@ -73,6 +93,9 @@ Client::Client(asio::io_context& io_context)
         throw;
     }
 
+    const size_t writerThreads = std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 2, 4);
+    fileWriterPool_ = std::make_unique<LocalTether::Utils::WorkerPool>(writerThreads, writerThreads * 4);
+
     LocalTether::Utils::Logger::GetInstance().Debug("Client constructor: Attempting to initialize local screen dimensions.");
     initializeLocalScreenDimensions();
     LocalTether::Utils::Logger::GetInstance().Debug("Client constructor: Finished initializing local screen dimensions.");
@@ -88,6 +111,11 @@ void Client::initializeLocalScreenDimensions() {
         localScreenWidth_ = static_cast<uint16_t>(dm.w);
         localScreenHeight_ = static_cast<uint16_t>(dm.h);
         LocalTether::Utils::Logger::GetInstance().Info("Client local screen dimensions: " + std::to_string(localScreenWidth_) + "x" + std::to_string(localScreenHeight_));
+        SDL_Rect bounds;
+        if (SDL_GetDisplayBounds(0, &bounds) == 0) {
+            localScreenX_ = bounds.x;
+            localScreenY_ = bounds.y;
+        }
     } else {
         LocalTether::Utils::Logger::GetInstance().Error("Client: Failed to get local screen dimensions using SDL: " + std::string(SDL_GetError()));
         localScreenWidth_ = 1920;
@@ -102,53 +130,182 @@ Client::~Client() {
 
 
 
+namespace {
+    fs::path clientCacheRoot() {
+        return LocalTether::Utils::dataDirectory() / "client_file_cache";
+    }
+
+    std::string pendingUploadKey(const std::string& serverRelativePath, const std::string& fileNameOnServer) {
+        return serverRelativePath + '\0' + fileNameOnServer;
+    }
+}
+
 void Client::uploadFile(const std::string& localFilePath, const std::string& serverRelativePath, const std::string& fileNameOnServer) {
     if (state_.load() != ClientState::Connected) {
         Utils::Logger::GetInstance().Warning("Client::uploadFile - Not connected to server.");
         return;
     }
 
-    std::ifstream file(localFilePath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        Utils::Logger::GetInstance().Error("Client::uploadFile - Failed to open local file: " + localFilePath);
+    std::error_code ec;
+    uintmax_t localSize = fs::file_size(localFilePath, ec);
+    if (!ec && localSize >= Utils::DeltaSync::MIN_DELTA_FILE_SIZE) {
+        // Large files go through the signature exchange first; handleFileSignature finishes the upload.
+        {
+            std::lock_guard<std::mutex> lock(pendingUploadsMutex_);
+            pendingDeltaUploads_[pendingUploadKey(serverRelativePath, fileNameOnServer)] = localFilePath;
+        }
+        Utils::Logger::GetInstance().Info("Client::uploadFile - Requesting server signatures for '" + fileNameOnServer + "' before uploading.");
+        send(Message::createFileSignatureRequest(serverRelativePath, fileNameOnServer, clientId_));
         return;
     }
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
+    sendFullUpload(localFilePath, serverRelativePath, fileNameOnServer);
+}
 
-    std::vector<char> buffer(size);
-    if (!file.read(buffer.data(), size)) {
+void Client::sendFullUpload(const std::string& localFilePath, const std::string& serverRelativePath, const std::string& fileNameOnServer) {
+    std::vector<char> buffer;
+    if (!Utils::DeltaSync::readWholeFile(localFilePath, buffer)) {
         Utils::Logger::GetInstance().Error("Client::uploadFile - Failed to read local file: " + localFilePath);
         return;
     }
-    file.close();
 
-    Utils::Logger::GetInstance().Info("Client::uploadFile - Uploading '" + localFilePath + "' as '" + fileNameOnServer + "' to server relative path: '" + serverRelativePath + "'");
     auto msg = Message::createFileUpload(serverRelativePath, fileNameOnServer, buffer, clientId_);
+    if ((sessionCapabilities_ & CapabilityZstdTransfer) &&
+        Utils::TransferCompression::shouldCompress(fileNameOnServer, buffer.data(), buffer.size())) {
+        const int level = Utils::TransferCompression::chooseLevel(linkThroughput_.bytesPerSecond());
+        const auto& body = msg.getBody();
+        std::vector<uint8_t> envelope = Utils::TransferCompression::compressBody(
+            static_cast<uint8_t>(MessageType::FileUpload), {{reinterpret_cast<const char*>(body.data()), body.size()}}, level);
+        if (!envelope.empty() && envelope.size() < body.size()) {
+            Utils::Logger::GetInstance().Info("Client::uploadFile - Uploading '" + localFilePath + "' as '" + fileNameOnServer + "' to server relative path: '" +
+                                              serverRelativePath + "' (" + std::to_string(envelope.size()) + " bytes compressed at level " + std::to_string(level) + ")");
+            send(Message::createCompressed(envelope, clientId_));
+            return;
+        }
+    }
+
+    Utils::Logger::GetInstance().Info("Client::uploadFile - Uploading '" + localFilePath + "' as '" + fileNameOnServer + "' to server relative path: '" + serverRelativePath + "'");
     send(msg);
 }
 
+void Client::handleFileSignature(const Message& msg) {
+    const std::string serverRelativePath = msg.getServerRelativePathFromUpload();
+    const std::string fileNameOnServer = msg.getFileNameFromUpload();
+
+    std::string localFilePath;
+    {
+        std::lock_guard<std::mutex> lock(pendingUploadsMutex_);
+        auto it = pendingDeltaUploads_.find(pendingUploadKey(serverRelativePath, fileNameOnServer));
+        if (it == pendingDeltaUploads_.end()) {
+            Utils::Logger::GetInstance().Warning("Client received signatures for '" + fileNameOnServer + "' with no pending upload.");
+            return;
+        }
+        localFilePath = it->second;
+        pendingDeltaUploads_.erase(it);
+    }
+
+    Utils::DeltaSync::FileSignature signature;
+    try {
+        signature = msg.getFileSignaturePayload();
+    } catch (const std::exception& e) {
+        Utils::Logger::GetInstance().Warning("Client: Could not read server signatures, falling back to full upload: " + std::string(e.what()));
+    }
+
+    if (!signature.empty()) {
+        std::vector<char> buffer;
+        if (!Utils::DeltaSync::readWholeFile(localFilePath, buffer)) {
+            Utils::Logger::GetInstance().Error("Client::uploadFile - Failed to read local file: " + localFilePath);
+            return;
+        }
+        Utils::DeltaSync::FileDelta delta = Utils::DeltaSync::computeDelta(signature, buffer.data(), buffer.size());
+        if (Utils::DeltaSync::isDeltaWorthwhile(delta, buffer.size())) {
+            Utils::Logger::GetInstance().Info("Client::uploadFile - Uploading delta for '" + fileNameOnServer + "' (" +
+                                              std::to_string(delta.literalBytes()) + " literal bytes of " + std::to_string(buffer.size()) + ")");
+            {
+                // Kept until the server confirms; a failed apply comes back as an empty signature.
+                std::lock_guard<std::mutex> lock(pendingUploadsMutex_);
+                pendingDeltaUploads_[pendingUploadKey(serverRelativePath, fileNameOnServer)] = localFilePath;
+            }
+            send(Message::createFileDeltaUpload(serverRelativePath, fileNameOnServer, delta, clientId_));
+            return;
+        }
+    }
+
+    sendFullUpload(localFilePath, serverRelativePath, fileNameOnServer);
+}
+
 void Client::requestFile(const std::string& filename) {  
     if (state_.load() != ClientState::Connected) return;
+
+    fs::path cachedPath = clientCacheRoot() / filename;
+    std::error_code ec;
+    if (fs::is_regular_file(cachedPath, ec) && fs::file_size(cachedPath, ec) >= Utils::DeltaSync::MIN_DELTA_FILE_SIZE && !ec) {
+        std::vector<char> cached;
+        if (Utils::DeltaSync::readWholeFile(cachedPath, cached)) {
+            Utils::Logger::GetInstance().Info("Client requesting delta for cached file: " + filename);
+            send(Message::createFileDeltaRequest(filename, Utils::DeltaSync::computeSignature(cached.data(), cached.size()), clientId_));
+            return;
+        }
+    }
+
     Utils::Logger::GetInstance().Info("Client requesting file: " + filename);
     auto msg = Message::createFileRequest(filename, clientId_);
     send(msg);
 }
 
+void Client::requestFiles(const std::vector<std::string>& paths) {
+    if (state_.load() != ClientState::Connected || paths.empty()) return;
+    Utils::Logger::GetInstance().Info("Client requesting batch of " + std::to_string(paths.size()) + " path(s).");
+    FileBatchRequestPayload payload;
+    payload.paths = paths;
+    send(Message::createFileBatchRequest(payload, clientId_));
+}
+
+void Client::requestDirectory(const std::string& relativeDirectory) {
+    requestFiles({relativeDirectory});
+}
+
 void Client::handleFileResponse(const Message& msg) {
      
     const std::string relativePath = msg.getRelativePathFromFileResponse();  
-    const std::vector<char> fileContent = msg.getFileContentFromUploadOrResponse();  
+    auto fileContent = std::make_shared<std::vector<char>>(msg.getFileContentFromUploadOrResponse());  
  
-    Utils::Logger::GetInstance().Info("Client received file: " + relativePath + ", size: " + std::to_string(fileContent.size()) + " bytes.");
+    Utils::Logger::GetInstance().Info("Client received file: " + relativePath + ", size: " + std::to_string(fileContent->size()) + " bytes.");
+    // Disk writes run off the io thread, one at a time per path so a later version of a file
+    // never lands before an earlier one. handleRead stops reading while the pool is backed up.
+    fileWriterPool_->submit([this, relativePath, fileContent]() {
+        storeCachedFile(relativePath, *fileContent);
+    }, relativePath);
+}
 
-     
-    fs::path exe_dir = LocalTether::UI::Panels::get_executable_directory(); 
-    fs::path project_root_path = LocalTether::UI::Panels::find_ancestor_directory(exe_dir, "LocalTether", 4);
-    fs::path clientCacheRoot = (project_root_path.empty() ? exe_dir : project_root_path) / "client_file_cache";
-    
-    fs::path destinationPath = clientCacheRoot / relativePath;
+void Client::handleFileDelta(const Message& msg) {
+    const std::string relativePath = msg.getRelativePathFromFileResponse();
+    auto delta = std::make_shared<Utils::DeltaSync::FileDelta>();
+    try {
+        *delta = msg.getFileDeltaPayload();
+    } catch (const std::exception& e) {
+        Utils::Logger::GetInstance().Error("Client failed to parse file delta: " + std::string(e.what()));
+        send(Message::createFileRequest(relativePath, clientId_));
+        return;
+    }
+    Utils::Logger::GetInstance().Info("Client received delta for: " + relativePath + " (" + std::to_string(delta->literalBytes()) +
+                                      " literal bytes, " + std::to_string(delta->targetSize) + " total).");
+
+    fileWriterPool_->submit([this, relativePath, delta]() {
+        std::vector<char> base;
+        std::vector<char> rebuilt;
+        if (!Utils::DeltaSync::readWholeFile(clientCacheRoot() / relativePath, base) ||
+            !Utils::DeltaSync::applyDelta(base.data(), base.size(), *delta, rebuilt)) {
+            Utils::Logger::GetInstance().Warning("Client: Delta for '" + relativePath + "' did not apply cleanly, requesting the full file.");
+            send(Message::createFileRequest(relativePath, clientId_));
+            return;
+        }
+        storeCachedFile(relativePath, rebuilt);
+    }, relativePath);
+}
+
+void Client::storeCachedFile(const std::string& relativePath, const std::vector<char>& fileContent) {
+    fs::path destinationPath = clientCacheRoot() / relativePath;
 
     try {
         if (!fs::exists(destinationPath.parent_path())) {
@@ -156,13 +313,13 @@ void Client::handleFileResponse(const Message& msg) {
             Utils::Logger::GetInstance().Info("Created directory: " + destinationPath.parent_path().string());
         }
 
-        std::ofstream outFile(destinationPath, std::ios::binary);
-        if (!outFile.is_open()) {
-            Utils::Logger::GetInstance().Error("Client::handleFileResponse - Failed to open/create local cache file: " + destinationPath.string());
+        // Cache entries are the base for later delta requests, so never leave a torn one behind.
+        std::string writeError;
+        if (!Utils::AtomicFileWriter::writeFile(destinationPath, fileContent.data(), fileContent.size(),
+                                                Utils::durabilityPolicyFromConfig(), &writeError)) {
+            Utils::Logger::GetInstance().Error("Client::handleFileResponse - Failed to store local cache file " + destinationPath.string() + ": " + writeError);
             return;
         }
-        outFile.write(fileContent.data(), fileContent.size());
-        outFile.close();
         Utils::Logger::GetInstance().Info("Client saved received file to: " + destinationPath.string());
 
          
@@ -183,6 +340,9 @@ void Client::handleFileError(const Message& msg) {
 
 void Client::setState(ClientState newState, const std::optional<std::error_code>& ec) {
     ClientState oldState = state_.exchange(newState);
+    if (oldState != newState) {
+        LocalTether::Utils::UiWake::notify();
+    }
     if (ec && ec.value()) {
         lastError_ = ec.value().message();
         if (newState == ClientState::Error && oldState != ClientState::Error) {
@@ -356,6 +516,13 @@ void Client::performApplicationHandshake() {
     clientHandshake.password = password_;
     clientHandshake.hostScreenWidth = localScreenWidth_;  
     clientHandshake.hostScreenHeight = localScreenHeight_;
+    clientHandshake.capabilities = Utils::TransferCompression::isEnabled() ? CapabilityZstdTransfer : CapabilityNone;
+    // Every receiver can inject relative motion; the host only asks for it when configured to
+    // capture it, which includes tracking the cursor across a desktop layout.
+    if (role_ != ClientRole::Host || Input::InputManager::relativeMouseModeRequested() ||
+        Input::DesktopLayout::isEnabledInConfig()) {
+        clientHandshake.capabilities |= CapabilityRelativeMouse;
+    }
 
     auto handshakeMsg = Message::createHandshake(clientHandshake, 0);
     send(handshakeMsg);
@@ -373,7 +540,22 @@ void Client::disconnect(const std::string& reason) {
 }
 
 void Client::doClose(const std::string& reason, bool notifyDisconnectHandler) {
+    // Nothing will release keys injected for the old session, so release them before stopping.
+    if (injectedKeys_.any() && inputManager_ && inputManager_->isRunning()) {
+        InputPayload release;
+        injectedKeys_.forEachDifference(LocalTether::Input::KeyState{}, [&](uint8_t vk, bool) {
+            release.keyEvents.push_back({vk, false});
+        });
+        inputManager_->simulateInput(release, hostScreenWidth_, hostScreenHeight_);
+    }
+    injectedKeys_.reset();
     stopInputLogging();
+    layoutActive_ = false;
+    layout_.reset();
+    keepAliveTimer_.cancel();
+    playoutTimer_.cancel();
+    motionBufferEnabled_ = false;
+    motionBuffer_.reset();
 
     ClientState expected_state = state_.load();
     if (expected_state == ClientState::Disconnected && reason != "reconnecting") {
@@ -412,6 +594,7 @@ void Client::doClose(const std::string& reason, bool notifyDisconnectHandler) {
         std::lock_guard<std::mutex> lock(writeMutex_);
         std::queue<std::vector<uint8_t>> emptyQueue;
         std::swap(writeQueue_, emptyQueue);
+        writeQueueDepthGauge().set(0);
         writing_ = false;
     }
 }
@@ -439,6 +622,7 @@ void Client::send(const Message& msg) {
     }
 
     auto serialized_data = msg.serialize();
+    NetworkMetrics::countSent(msg.getType(), serialized_data.size());
 
     asio::post(io_context_, [this, data = std::move(serialized_data)]() {
         if (!socket_opt_ || (state_.load() == ClientState::Disconnected || state_.load() == ClientState::Error)) return;
@@ -448,6 +632,7 @@ void Client::send(const Message& msg) {
             std::lock_guard<std::mutex> lock(writeMutex_);
             should_start_write = writeQueue_.empty() && !writing_.load(std::memory_order_relaxed);
             writeQueue_.push(std::move(data));
+            writeQueueDepthGauge().set(static_cast<int64_t>(writeQueue_.size()));
         }
 
         if (should_start_write) {
@@ -476,7 +661,7 @@ void Client::doWrite() {
     }
 
     
-    
+    linkThroughput_.writeStarted();
     asio::async_write(*socket_opt_, asio::buffer(*data_to_send_ptr),  
         [this, data_to_send_ptr](const std::error_code& error, size_t bytes_transferred) {
             
@@ -486,6 +671,9 @@ void Client::doWrite() {
 
 void Client::handleWrite(const std::error_code& error, size_t bytes_transferred) {
     if (!socket_opt_) { writing_ = false; return; }
+    if (!error) {
+        linkThroughput_.writeCompleted(bytes_transferred);
+    }
 
     bool should_continue_writing = false;
     {
@@ -494,6 +682,7 @@ void Client::handleWrite(const std::error_code& error, size_t bytes_transferred)
         if (!writeQueue_.empty()) {
              writeQueue_.pop();
         }
+        writeQueueDepthGauge().set(static_cast<int64_t>(writeQueue_.size()));
 
         if (!error) {
             if (!writeQueue_.empty()) {
@@ -542,7 +731,7 @@ void Client::handleRead(const std::error_code& error, size_t bytes_transferred)
 
     if (!error) {
         try {
-            LocalTether::Utils::Logger::GetInstance().Trace("Client::handleRead: Received " + std::to_string(bytes_transferred) + " bytes.");
+            LT_LOG_TRACE("Client::handleRead: Received {} bytes.", bytes_transferred);
             partialMessage_.insert(partialMessage_.end(),
                                  readBuffer_.data(),
                                  readBuffer_.data() + bytes_transferred);
@@ -550,7 +739,7 @@ void Client::handleRead(const std::error_code& error, size_t bytes_transferred)
             size_t processed_offset = 0;
             while (state_.load() != ClientState::Disconnected && state_.load() != ClientState::Error) {  
                 if (partialMessage_.size() - processed_offset < Message::HEADER_LENGTH) {
-                    LocalTether::Utils::Logger::GetInstance().Trace("Client::handleRead: Not enough data for header. Have " + std::to_string(partialMessage_.size() - processed_offset) + ", need " + std::to_string(Message::HEADER_LENGTH));
+                    LT_LOG_TRACE("Client::handleRead: Not enough data for header. Have {}, need {}", partialMessage_.size() - processed_offset, Message::HEADER_LENGTH);
                     break;  
                 }
 
@@ -563,15 +752,14 @@ void Client::handleRead(const std::error_code& error, size_t bytes_transferred)
                     return;
                 }
                 
-                LocalTether::Utils::Logger::GetInstance().Trace(
-                    "Client::handleRead: Decoded header. Type: " + Message::messageTypeToString(currentReadMessage_.getType()) +
-                    ", Body Size: " + std::to_string(currentReadMessage_.getBodySize()));
+                LT_LOG_TRACE("Client::handleRead: Decoded header. Type: {}, Body Size: {}",
+                             Message::messageTypeToString(currentReadMessage_.getType()), currentReadMessage_.getBodySize());
 
 
                 size_t totalMessageSize = Message::HEADER_LENGTH + currentReadMessage_.getBodySize();
 
                 if (partialMessage_.size() - processed_offset < totalMessageSize) {
-                    LocalTether::Utils::Logger::GetInstance().Trace("Client::handleRead: Not enough data for full message. Have " + std::to_string(partialMessage_.size() - processed_offset) + ", need " + std::to_string(totalMessageSize));
+                    LT_LOG_TRACE("Client::handleRead: Not enough data for full message. Have {}, need {}", partialMessage_.size() - processed_offset, totalMessageSize);
                     break;  
                 }
                 
@@ -592,24 +780,30 @@ void Client::handleRead(const std::error_code& error, size_t bytes_transferred)
                 }
                 
                  
+                NetworkMetrics::countReceived(currentReadMessage_.getType(), totalMessageSize);
                 handleMessage(currentReadMessage_);
 
                 processed_offset += totalMessageSize;
-                LocalTether::Utils::Logger::GetInstance().Trace("Client::handleRead: Processed one message. Total processed offset: " + std::to_string(processed_offset));
+                LT_LOG_TRACE("Client::handleRead: Processed one message. Total processed offset: {}", processed_offset);
             }
 
             if (processed_offset > 0) {
                 partialMessage_.erase(partialMessage_.begin(),
                                     partialMessage_.begin() + processed_offset);
-                LocalTether::Utils::Logger::GetInstance().Trace("Client::handleRead: Erased " + std::to_string(processed_offset) + " bytes from partialMessage_. Remaining: " + std::to_string(partialMessage_.size()));
+                LT_LOG_TRACE("Client::handleRead: Erased {} bytes from partialMessage_. Remaining: {}", processed_offset, partialMessage_.size());
             }
 
              
-            if (state_.load() == ClientState::Connected || 
-                (state_.load() == ClientState::Connecting && !partialMessage_.empty())) {  
-                 doRead();
-            } else if (state_.load() == ClientState::Connecting && partialMessage_.empty()) {
-                 doRead();  
+            if (state_.load() == ClientState::Connected || state_.load() == ClientState::Connecting) {
+                if (fileWriterPool_->saturated()) {
+                    // Too many file writes queued: stop reading so TCP pushes back on the server,
+                    // and pick the socket up again once the writers catch up.
+                    fileWriterPool_->whenBelowLimit([this]() {
+                        asio::post(io_context_, [this]() { doRead(); });
+                    });
+                } else {
+                    doRead();
+                }
             }
 
 
@@ -646,7 +840,21 @@ void Client::handleRead(const std::error_code& error, size_t bytes_transferred)
 
 
 void Client::handleMessage(const Message& message) {
-    LocalTether::Utils::Logger::GetInstance().Trace("Client::handleMessage: Received message type: " + Message::messageTypeToString(message.getType()));
+    if (message.getType() == MessageType::Compressed) {
+        Message inner;
+        if (!message.decompressTo(inner)) {
+            LocalTether::Utils::Logger::GetInstance().Error("Client: Dropping corrupt compressed message.");
+            return;
+        }
+        handleMessage(inner);
+        return;
+    }
+    LT_LOG_TRACE("Client::handleMessage: Received message type: {}", Message::messageTypeToString(message.getType()));
+    // Input traffic changes nothing on screen; everything else may.
+    if (message.getType() != MessageType::Input && message.getType() != MessageType::KeyStateSnapshot &&
+        message.getType() != MessageType::KeepAlive) {
+        LocalTether::Utils::UiWake::notify();
+    }
 
     ClientState currentState = state_.load();
 
@@ -661,6 +869,7 @@ void Client::handleMessage(const Message& message) {
                  
                  
                 clientId_ = serverResponsePayload.clientId; 
+                sessionCapabilities_ = serverResponsePayload.capabilities;
 
                 LocalTether::Utils::Logger::GetInstance().Info(
                     "Handshake successful. Client ID: " + std::to_string(clientId_) +
@@ -675,6 +884,10 @@ void Client::handleMessage(const Message& message) {
                             inputManager_ = LocalTether::Input::createInputManager(localScreenWidth_, localScreenHeight_, (role_ == ClientRole::Host));
                         }
                         if (inputManager_) {
+                            if (role_ == ClientRole::Host) {
+                                inputManager_->setRelativeMouseMode((sessionCapabilities_ & CapabilityRelativeMouse) != 0);
+                                configureDesktopLayout();
+                            }
                             if (inputManager_->start()) {
                                 LocalTether::Utils::Logger::GetInstance().Info("InputManager started successfully for client.");
                                 
@@ -690,6 +903,15 @@ void Client::handleMessage(const Message& message) {
                         LocalTether::Utils::Logger::GetInstance().Warning("Local screen dimensions not set, cannot initialize InputManager.");
                     }
                 }
+                rtt_.reset();
+                scheduleKeepAlive();
+                motionBuffer_.reset();
+                motionBufferEnabled_ = role_ != ClientRole::Host && LocalTether::Input::MotionJitterBuffer::isEnabledInConfig();
+                if (motionBufferEnabled_) {
+                    LocalTether::Utils::Logger::GetInstance().Info("Client: Mouse jitter buffer enabled.");
+                    schedulePlayout();
+                }
+
                 if (connectHandler_) {
                      
                     connectHandler_(true, "Handshake successful", clientId_);
@@ -726,6 +948,43 @@ void Client::handleMessage(const Message& message) {
         return;
     }
 
+    if (message.getType() == MessageType::KeepAlive) {
+        try {
+            KeepAlivePayload echo = message.getKeepAlivePayload();
+            uint64_t now = RttEstimator::nowUs();
+            if (echo.senderTimeUs != 0 && now >= echo.senderTimeUs) {
+                rtt_.addSample((now - echo.senderTimeUs) / 1000.0);
+                rtt_.addClockSample(echo.senderTimeUs, echo.echoTimeUs, now);
+                motionBuffer_.updateDelayFromRtt(rtt_.rttVarianceMs());
+            }
+        } catch (const std::exception& e) {
+            LocalTether::Utils::Logger::GetInstance().Warning("Client: Ignoring malformed KeepAlive: " + std::string(e.what()));
+        }
+        return;
+    }
+
+    if (message.getType() == MessageType::KeyStateSnapshot && role_ != ClientRole::Host) {
+        if (!inputManager_ || !inputManager_->isRunning() || LocalTether::Input::InputManager::isInputGloballyPaused()) {
+            return;
+        }
+        try {
+            KeyStateSnapshotPayload snapshot = message.getKeyStateSnapshotPayload();
+            auto target = LocalTether::Input::KeyState::fromBytes(snapshot.pressed.data(), snapshot.pressed.size());
+            InputPayload correction;
+            injectedKeys_.forEachDifference(target, [&](uint8_t vk, bool pressed) {
+                correction.keyEvents.push_back({vk, pressed});
+            });
+            if (!correction.keyEvents.empty()) {
+                LocalTether::Utils::Logger::GetInstance().Info("Client: Key state resync corrected " +
+                                                               std::to_string(correction.keyEvents.size()) + " key(s).");
+                deliverInput(correction);
+            }
+        } catch (const std::exception& e) {
+            LocalTether::Utils::Logger::GetInstance().Warning("Client: Ignoring malformed KeyStateSnapshot: " + std::string(e.what()));
+        }
+        return;
+    }
+
     if (message.getType() == MessageType::Input && role_ != ClientRole::Host) {
         if (inputManager_ && inputManager_->isRunning()) {
             try {
@@ -733,24 +992,32 @@ void Client::handleMessage(const Message& message) {
                     return;
                 }
                 InputPayload receivedPayload = message.getInputPayload();
-                std::string keyLog = "Client received input for simulation:";
-                
-                for(const auto & event : receivedPayload.keyEvents){
-                    keyLog += " Key: " + std::to_string(event.keyCode) +
-                              (event.isPressed ? " Pressed" : " Released") +
-                              " (" + LocalTether::Utils::Logger::getKeyName(event.keyCode) + ")";
+                if (receivedPayload.latencyStampsUs.size() == LocalTether::Utils::LATENCY_STAGE_COUNT) {
+                    auto& stats = LocalTether::Utils::LatencyStats::GetInstance();
+                    receivedPayload.latencyStampsUs[static_cast<size_t>(LocalTether::Utils::LatencyStage::ReceiverHandle)] =
+                        static_cast<uint64_t>(static_cast<int64_t>(stats.nowUs()) + rtt_.clockOffsetUs());
+                    stats.recordTrace(receivedPayload.latencyStampsUs);
                 }
-                if (receivedPayload.isMouseEvent) {
-                    keyLog += " Mouse Event: ";
-                    keyLog += "RelX: " + std::to_string(receivedPayload.relativeX) +
-                              " RelY: " + std::to_string(receivedPayload.relativeY) +
-                              " Buttons: " + std::to_string(receivedPayload.mouseButtons) +
-                              " ScrollX: " + std::to_string(receivedPayload.scrollDeltaX) +
-                              " ScrollY: " + std::to_string(receivedPayload.scrollDeltaY);
+                if (LocalTether::Utils::Logger::GetInstance().IsEnabled(LocalTether::Utils::LogLevel::Trace)) {
+                    std::string keyLog = "Client received input for simulation:";
+                
+                    for(const auto & event : receivedPayload.keyEvents){
+                        keyLog += " Key: " + std::to_string(event.keyCode) +
+                                  (event.isPressed ? " Pressed" : " Released") +
+                                  " (" + LocalTether::Utils::Logger::getKeyName(event.keyCode) + ")";
+                    }
+                    if (receivedPayload.isMouseEvent) {
+                        keyLog += " Mouse Event: ";
+                        keyLog += "RelX: " + std::to_string(receivedPayload.relativeX) +
+                                  " RelY: " + std::to_string(receivedPayload.relativeY) +
+                                  " Buttons: " + std::to_string(receivedPayload.mouseButtons) +
+                                  " ScrollX: " + std::to_string(receivedPayload.scrollDeltaX) +
+                                  " ScrollY: " + std::to_string(receivedPayload.scrollDeltaY);
+                    }
+                    LocalTether::Utils::Logger::GetInstance().Trace(keyLog);
                 }
-                LocalTether::Utils::Logger::GetInstance().Trace(keyLog);
                 
-                inputManager_->simulateInput(receivedPayload, hostScreenWidth_, hostScreenHeight_);
+                deliverInput(receivedPayload);
             } catch (const std::exception& e) {
                 LocalTether::Utils::Logger::GetInstance().Error(
                     "Failed to process received input for simulation: " + std::string(e.what()));
@@ -773,6 +1040,47 @@ void Client::handleMessage(const Message& message) {
              
              
             LocalTether::Utils::Logger::GetInstance().Info("Server announced client rename: " + commandText);
+            size_t idEnd = commandText.find(':', 15);
+            if (idEnd != std::string::npos) {
+                try {
+                    layout_.renameClient(static_cast<uint32_t>(std::stoul(commandText.substr(15, idEnd - 15))),
+                                         commandText.substr(idEnd + 1));
+                } catch (const std::exception&) {}
+            }
+        } else if (commandText.rfind("file_batch_complete:", 0) == 0) {
+            LocalTether::Utils::Logger::GetInstance().Info("Server finished sending batch of " + commandText.substr(20) + " file(s).");
+        } else if (commandText.rfind("receiver_screen:", 0) == 0) {
+            // receiver_screen:<id>:<width>:<height>:<name>
+            try {
+                size_t idEnd = commandText.find(':', 16);
+                size_t widthEnd = commandText.find(':', idEnd + 1);
+                size_t heightEnd = commandText.find(':', widthEnd + 1);
+                if (heightEnd != std::string::npos) {
+                    layout_.setReceiverScreen(static_cast<uint32_t>(std::stoul(commandText.substr(16, idEnd - 16))),
+                                              commandText.substr(heightEnd + 1),
+                                              static_cast<uint16_t>(std::stoul(commandText.substr(idEnd + 1, widthEnd - idEnd - 1))),
+                                              static_cast<uint16_t>(std::stoul(commandText.substr(widthEnd + 1, heightEnd - widthEnd - 1))));
+                }
+            } catch (const std::exception& e) {
+                LocalTether::Utils::Logger::GetInstance().Warning("Client: Ignoring malformed receiver_screen: " + std::string(e.what()));
+            }
+        } else if (commandText.rfind("client_left:", 0) == 0) {
+            try {
+                layout_.removeClient(static_cast<uint32_t>(std::stoul(commandText.substr(12))));
+            } catch (const std::exception&) {}
+        } else if (commandText.rfind("route_focus:", 0) == 0) {
+            std::string focus = commandText.substr(12);
+            LocalTether::Utils::Logger::GetInstance().Info(focus == "all" ? std::string("Input now goes to all routed receivers.")
+                                                                          : "Input now goes to receiver ID " + focus + ".");
+        } else if (commandText.rfind("stats:", 0) == 0) {
+            std::istringstream lines(commandText.substr(6));
+            std::string line;
+            LocalTether::Utils::Logger::GetInstance().Info("Server stats:");
+            while (std::getline(lines, line)) {
+                if (!line.empty() && line[0] != '#') {
+                    LocalTether::Utils::Logger::GetInstance().Info("  " + line);
+                }
+            }
         } else if (commandText == "server_shutdown_imminent") {
             LocalTether::Utils::Logger::GetInstance().Info("Server is shutting down. Disconnecting.");
              
@@ -795,6 +1103,14 @@ void Client::handleMessage(const Message& message) {
         handleFileResponse(message);
         return;
     }
+    if (message.getType() == MessageType::FileDelta) {
+        handleFileDelta(message);
+        return;
+    }
+    if (message.getType() == MessageType::FileSignature) {
+        handleFileSignature(message);
+        return;
+    }
     if (message.getType() == MessageType::FileError) {
         handleFileError(message);
         return;
@@ -824,6 +1140,10 @@ void Client::startInputLogging() {
         if (localScreenWidth_ > 0 && localScreenHeight_ > 0 && role_ == ClientRole::Host) {
             LocalTether::Utils::Logger::GetInstance().Info("Creating new InputManager for input logging (late).");
             inputManager_ = LocalTether::Input::createInputManager(localScreenWidth_, localScreenHeight_, (role_ == ClientRole::Host));
+            if (inputManager_) {
+                inputManager_->setRelativeMouseMode((sessionCapabilities_ & CapabilityRelativeMouse) != 0);
+                configureDesktopLayout();
+            }
         } else {
             loggingInput_ = false;
             return;
@@ -855,6 +1175,15 @@ void Client::startInputLogging() {
 
 void Client::inputLoop() {
     LocalTether::Utils::Logger::GetInstance().Info("Input loop running...");
+    // Host only: a full key-state snapshot goes out periodically, and immediately on pause and
+    // resume, so receivers recover from releases that were never forwarded.
+    auto lastSnapshot = std::chrono::steady_clock::time_point{};
+    bool wasPaused = LocalTether::Input::InputManager::isInputGloballyPaused();
+    // Optional "input.route_next_combo_vk": pressing it asks the server to focus this source's
+    // next receiver, cycling back to all of them after the last one.
+    const std::vector<uint8_t> routeCombo = LocalTether::Utils::Config::GetInstance().Get<std::vector<uint8_t>>(
+        "input.route_next_combo_vk", std::vector<uint8_t>{});
+    bool routeComboWasHeld = false;
     while (loggingInput_.load(std::memory_order_relaxed)) {
         if (!inputManager_ || !inputManager_->isRunning()) {
             LocalTether::Utils::Logger::GetInstance().Warning("InputManager stopped or not available in inputLoop. Exiting loop.");
@@ -864,20 +1193,125 @@ void Client::inputLoop() {
 
             auto payloads = inputManager_->pollEvents();
         if (role_ == ClientRole::Host && state_.load() == ClientState::Connected) {
-            for (const auto& payload : payloads) {
+            bool sawKeys = false;
+            bool layoutActive = layoutActive_.load(std::memory_order_relaxed);
+            bool tracing = LocalTether::Utils::LatencyStats::GetInstance().isEnabled();
+            uint64_t polledUs = tracing ? LocalTether::Utils::LatencyStats::nowUs() : 0;
+            if (layoutActive && layout_.activeTarget() == LocalTether::Input::DesktopLayout::HOME) {
+                // On the host screen the real pointer moves with acceleration and with devices we
+                // do not capture, so the tracked cursor restarts from it on every batch.
+                int pointerX = 0;
+                int pointerY = 0;
+                SDL_GetGlobalMouseState(&pointerX, &pointerY);
+                layout_.syncHomeCursor(pointerX - localScreenX_, pointerY - localScreenY_);
+            }
+            for (auto& payload : payloads) {
+                sawKeys = sawKeys || !payload.keyEvents.empty();
+                if (tracing) {
+                    // Backends without a capture helper start the trace here.
+                    payload.latencyStampsUs.resize(LocalTether::Utils::LATENCY_STAGE_COUNT, 0);
+                    payload.latencyStampsUs[static_cast<size_t>(LocalTether::Utils::LatencyStage::Poll)] = polledUs;
+                } else {
+                    payload.latencyStampsUs.clear();
+                }
+                if (layoutActive) {
+                    auto routed = layout_.route(payload);
+                    if (routed.switched) {
+                        switchLayoutTarget(routed.previous, routed.target);
+                    }
+                    if (routed.target == LocalTether::Input::DesktopLayout::HOME) continue;
+                    payload.targetClientId = routed.target;
+                }
+                NetworkMetrics::countInput(NetworkMetrics::InputStage::Captured);
                 sendInput(payload);
             }
+
+            if (!routeCombo.empty() && sawKeys) {
+                auto keys = inputManager_->capturedKeyState();
+                bool held = keys && std::all_of(routeCombo.begin(), routeCombo.end(),
+                                                [&](uint8_t vk) { return keys->test(vk); });
+                if (held && !routeComboWasHeld) {
+                    sendCommand("route_next");
+                }
+                routeComboWasHeld = held;
+            }
+
+            bool paused = LocalTether::Input::InputManager::isInputGloballyPaused();
+            auto now = std::chrono::steady_clock::now();
+            // With a layout only the receiver under the cursor holds anything; on the host screen
+            // the receiver that was left was already released by switchLayoutTarget.
+            uint32_t layoutTarget = layoutActive ? layout_.activeTarget() : 0;
+            bool onHomeScreen = layoutActive && layoutTarget == LocalTether::Input::DesktopLayout::HOME;
+            if (!onHomeScreen && (paused != wasPaused || (!paused && now - lastSnapshot >= KEY_STATE_SNAPSHOT_INTERVAL))) {
+                if (auto keys = inputManager_->capturedKeyState()) {
+                    KeyStateSnapshotPayload snapshot;
+                    // While paused nothing reaches the receivers, so they should hold nothing either.
+                    if (!paused) snapshot.pressed = keys->toBytes();
+                    snapshot.targetClientId = layoutTarget;
+                    send(Message::createKeyStateSnapshot(snapshot, clientId_));
+                }
+                lastSnapshot = now;
+            }
+            wasPaused = paused;
         }
 
         if (LocalTether::Input::InputManager::isInputGloballyPaused()) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            inputManager_->waitForEvents(std::chrono::milliseconds(LocalTether::Utils::Config::Live().inputPollWaitMs));
         }
     }
     LocalTether::Utils::Logger::GetInstance().Info("Input loop exited.");
 }
 
+void Client::configureDesktopLayout() {
+    layoutActive_ = false;
+    if (!LocalTether::Input::DesktopLayout::isEnabledInConfig()) {
+        return;
+    }
+#ifdef _WIN32
+    LocalTether::Utils::Logger::GetInstance().Warning("Client: layout.* is set, but the desktop layout needs relative mouse capture, which the Windows backend does not provide.");
+#else
+    if (!inputManager_->isRelativeMouseMode()) {
+        LocalTether::Utils::Logger::GetInstance().Warning("Client: layout.* is set, but the server did not negotiate relative mouse capture; desktop layout disabled.");
+        return;
+    }
+    if (!layout_.configure(localScreenWidth_, localScreenHeight_)) {
+        return;
+    }
+    // The cursor starts on this screen, which stays usable locally until it crosses an edge.
+    inputManager_->setLocalPassthrough(true);
+    layoutActive_ = true;
+    LocalTether::Utils::Logger::GetInstance().Info("Client: Desktop layout active.");
+#endif
+}
+
+void Client::switchLayoutTarget(uint32_t previous, uint32_t target) {
+    // The receiver being left must not keep keys held; the one entered picks up whatever is
+    // held now, e.g. a modifier used while dragging across.
+    if (previous != LocalTether::Input::DesktopLayout::HOME) {
+        KeyStateSnapshotPayload release;
+        release.targetClientId = previous;
+        send(Message::createKeyStateSnapshot(release, clientId_));
+    }
+    if (target != LocalTether::Input::DesktopLayout::HOME) {
+        if (auto keys = inputManager_->capturedKeyState()) {
+            KeyStateSnapshotPayload held;
+            held.pressed = keys->toBytes();
+            held.targetClientId = target;
+            send(Message::createKeyStateSnapshot(held, clientId_));
+        }
+    }
+    inputManager_->setLocalPassthrough(target == LocalTether::Input::DesktopLayout::HOME);
+    if (target == LocalTether::Input::DesktopLayout::HOME) {
+        // The real pointer stayed where it left; put it where the cursor came back in.
+        SDL_WarpMouseGlobal(localScreenX_ + static_cast<int>(layout_.cursorX()), localScreenY_ + static_cast<int>(layout_.cursorY()));
+    }
+    LocalTether::Utils::Logger::GetInstance().Info(target == LocalTether::Input::DesktopLayout::HOME
+        ? std::string("Client: Cursor returned to this screen.")
+        : "Client: Cursor moved to receiver ID " + std::to_string(target) + ".");
+}
+
 void Client::stopInputLogging() {
     if (!loggingInput_.load(std::memory_order_relaxed)) {
         return;
@@ -899,6 +1333,18 @@ void Client::sendInput(const InputPayload& payload) {
     if (state_.load() != ClientState::Connected) {
         return;
     }
+    if (payload.latencyStampsUs.size() == LocalTether::Utils::LATENCY_STAGE_COUNT) {
+        // Stamps leave in the server's clock so the receiver can compare them with its own.
+        InputPayload traced = payload;
+        traced.latencyStampsUs[static_cast<size_t>(LocalTether::Utils::LatencyStage::Send)] =
+            LocalTether::Utils::LatencyStats::nowUs();
+        int64_t offsetUs = rtt_.clockOffsetUs();
+        for (auto& stamp : traced.latencyStampsUs) {
+            if (stamp != 0) stamp = static_cast<uint64_t>(static_cast<int64_t>(stamp) + offsetUs);
+        }
+        send(Message::createInput(traced, clientId_));
+        return;
+    }
     auto msg = Message::createInput(payload, clientId_);
     send(msg);
 }
@@ -915,4 +1361,52 @@ void Client::sendCommand(const std::string& command) {
     send(msg);
 }
 
-}  
\ No newline at end of file
+void Client::deliverInput(const InputPayload& payload) {
+    NetworkMetrics::countInput(NetworkMetrics::InputStage::Injected);
+    for (const auto& keyEvent : payload.keyEvents) {
+        injectedKeys_.set(keyEvent.keyCode, keyEvent.isPressed);
+    }
+    if (!motionBufferEnabled_) {
+        inputManager_->simulateInput(payload, hostScreenWidth_, hostScreenHeight_);
+        return;
+    }
+    if (motionBuffer_.accepts(payload)) {
+        motionBuffer_.push(payload, LocalTether::Input::MotionJitterBuffer::Clock::now());
+        return;
+    }
+    if (auto pending = motionBuffer_.flushBefore(payload)) {
+        inputManager_->simulateInput(*pending, hostScreenWidth_, hostScreenHeight_);
+    }
+    inputManager_->simulateInput(payload, hostScreenWidth_, hostScreenHeight_);
+}
+
+void Client::schedulePlayout() {
+    playoutTimer_.expires_after(LocalTether::Input::MotionJitterBuffer::PLAYOUT_INTERVAL);
+    playoutTimer_.async_wait([this](const std::error_code& ec) {
+        if (ec || !motionBufferEnabled_ || state_.load() != ClientState::Connected) {
+            return;
+        }
+        if (!motionBuffer_.empty() && inputManager_ && inputManager_->isRunning() &&
+            !LocalTether::Input::InputManager::isInputGloballyPaused()) {
+            if (auto position = motionBuffer_.sample(LocalTether::Input::MotionJitterBuffer::Clock::now())) {
+                inputManager_->simulateInput(*position, hostScreenWidth_, hostScreenHeight_);
+            }
+        }
+        schedulePlayout();
+    });
+}
+
+void Client::scheduleKeepAlive() {
+    keepAliveTimer_.expires_after(std::chrono::seconds(1));
+    keepAliveTimer_.async_wait([this](const std::error_code& ec) {
+        if (ec || state_.load() != ClientState::Connected) {
+            return;
+        }
+        KeepAlivePayload probe;
+        probe.senderTimeUs = RttEstimator::nowUs();
+        send(Message::createKeepAlive(probe, clientId_));
+        scheduleKeepAlive();
+    });
+}
+
+}
@@ -1,8 +1,10 @@
 #include "network/Message.h"
 #include "utils/Logger.h"  
+#include "utils/TransferCompression.h"
 #include <cstring>  
 #include <stdexcept>  
 #include <sstream>    
+#include <algorithm>
 
 #ifdef _WIN32
 #include <winsock2.h>  
@@ -16,10 +18,48 @@
 #include <cereal/types/string.hpp>
 #include <cereal/types/chrono.hpp>  
 
-#include "ui/panels/FileExplorerPanel.h" 
 
 namespace LocalTether::Network {
 
+namespace {
+    bool hasUploadStyleFields(MessageType type) {
+        return type == MessageType::FileUpload ||
+               type == MessageType::FileSignatureRequest ||
+               type == MessageType::FileSignature ||
+               type == MessageType::FileDeltaUpload;
+    }
+
+    void appendField(std::vector<uint8_t>& body, const std::string& field) {
+        body.insert(body.end(), field.begin(), field.end());
+        body.push_back('\0');
+    }
+
+    template <typename T>
+    void appendArchived(std::vector<uint8_t>& body, const T& value) {
+        std::ostringstream os(std::ios::binary);
+        {
+            cereal::BinaryOutputArchive archive(os);
+            archive(value);
+        }
+        std::string serialized_str = os.str();
+        body.insert(body.end(), serialized_str.begin(), serialized_str.end());
+    }
+
+    template <typename T>
+    T readArchived(const std::vector<uint8_t>& body, size_t offset, const char* what) {
+        T value;
+        std::string body_str(body.begin() + offset, body.end());
+        std::istringstream is(body_str, std::ios::binary);
+        try {
+            cereal::BinaryInputArchive archive(is);
+            archive(value);
+        } catch (const cereal::Exception& e) {
+            throw std::runtime_error("Failed to deserialize " + std::string(what) + ": " + std::string(e.what()));
+        }
+        return value;
+    }
+}
+
  
 Message::Message() : type_(MessageType::Unknown), clientId_(0), bodySize_(0) {}
 
@@ -67,6 +107,13 @@ void Message::setBody(const uint8_t* data, size_t length) {
 }
 
 std::vector<uint8_t> Message::serialize() const {
+    return serializeWithTrailer(0);
+}
+
+std::vector<uint8_t> Message::serializeWithTrailer(uint64_t trailerLength) const {
+    if (body_.size() + trailerLength > UINT32_MAX) {
+        throw std::runtime_error("Message body too large for the 32-bit size field.");
+    }
     std::vector<uint8_t> buffer;
     buffer.resize(HEADER_LENGTH + body_.size());  
 
@@ -78,7 +125,7 @@ std::vector<uint8_t> Message::serialize() const {
     std::memcpy(buffer.data() + offset, &netClientId, sizeof(netClientId));
     offset += sizeof(netClientId);
 
-    uint32_t netBodySize = htonl(static_cast<uint32_t>(body_.size()));  
+    uint32_t netBodySize = htonl(static_cast<uint32_t>(body_.size() + trailerLength));  
     std::memcpy(buffer.data() + offset, &netBodySize, sizeof(netBodySize));
     offset += sizeof(netBodySize);
 
@@ -194,6 +241,64 @@ Message Message::createInput(const InputPayload& payload, uint32_t clientId) {
     return Message(MessageType::Input, clientId, body);
 }
 
+Message Message::createKeepAlive(const KeepAlivePayload& payload, uint32_t clientId) {
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    {
+        cereal::BinaryOutputArchive archive(ss);
+        archive(payload);
+    }
+    std::string serialized_payload = ss.str();
+    std::vector<uint8_t> body(serialized_payload.begin(), serialized_payload.end());
+    return Message(MessageType::KeepAlive, clientId, body);
+}
+
+KeepAlivePayload Message::getKeepAlivePayload() const {
+    if (type_ != MessageType::KeepAlive) {
+        throw std::runtime_error("Message is not of type KeepAlive.");
+    }
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    ss.write(reinterpret_cast<const char*>(body_.data()), body_.size());
+    ss.seekg(0);
+
+    KeepAlivePayload payload;
+    try {
+        cereal::BinaryInputArchive archive(ss);
+        archive(payload);
+    } catch (const cereal::Exception& e) {
+        throw std::runtime_error("Failed to deserialize KeepAlivePayload: " + std::string(e.what()));
+    }
+    return payload;
+}
+
+Message Message::createKeyStateSnapshot(const KeyStateSnapshotPayload& payload, uint32_t clientId) {
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    {
+        cereal::BinaryOutputArchive archive(ss);
+        archive(payload);
+    }
+    std::string serialized_payload = ss.str();
+    std::vector<uint8_t> body(serialized_payload.begin(), serialized_payload.end());
+    return Message(MessageType::KeyStateSnapshot, clientId, body);
+}
+
+KeyStateSnapshotPayload Message::getKeyStateSnapshotPayload() const {
+    if (type_ != MessageType::KeyStateSnapshot) {
+        throw std::runtime_error("Message is not of type KeyStateSnapshot.");
+    }
+    std::stringstream ss(std::ios::binary | std::ios::in | std::ios::out);
+    ss.write(reinterpret_cast<const char*>(body_.data()), body_.size());
+    ss.seekg(0);
+
+    KeyStateSnapshotPayload payload;
+    try {
+        cereal::BinaryInputArchive archive(ss);
+        archive(payload);
+    } catch (const cereal::Exception& e) {
+        throw std::runtime_error("Failed to deserialize KeyStateSnapshotPayload: " + std::string(e.what()));
+    }
+    return payload;
+}
+
 Message Message::createChat(const std::string& message, uint32_t clientId) {
     return Message(MessageType::ChatMessage, clientId, message);
 }
@@ -207,7 +312,7 @@ Message Message::createFileRequest(const std::string& filename, uint32_t clientI
 }
 
 
-Message Message::createFileSystemUpdate(const LocalTether::UI::Panels::FileMetadata& rootNode, uint32_t senderClientId) {
+Message Message::createFileSystemUpdate(const LocalTether::Storage::FileMetadata& rootNode, uint32_t senderClientId) {
     std::ostringstream os(std::ios::binary);
     {
         cereal::BinaryOutputArchive archive(os);
@@ -218,11 +323,11 @@ Message Message::createFileSystemUpdate(const LocalTether::UI::Panels::FileMetad
     return Message(MessageType::FileSystemUpdate, senderClientId, body);
 }
 
-LocalTether::UI::Panels::FileMetadata Message::getFileSystemMetadataPayload() const {
+LocalTether::Storage::FileMetadata Message::getFileSystemMetadataPayload() const {
     if (type_ != MessageType::FileSystemUpdate) {
         throw std::runtime_error("Message is not of type FileSystemUpdate");
     }
-    LocalTether::UI::Panels::FileMetadata rootNode;
+    LocalTether::Storage::FileMetadata rootNode;
     std::string body_str(body_.begin(), body_.end());
     std::istringstream is(body_str, std::ios::binary);
     {
@@ -257,6 +362,12 @@ Message Message::createFileResponse(const std::string& relativePath, const std::
     body.insert(body.end(), fileContent.begin(), fileContent.end());
     return Message(MessageType::FileResponse, senderId, body);
 }
+Message Message::createFileResponsePrefix(const std::string& relativePath, uint32_t senderId) {
+    std::vector<uint8_t> body;
+    appendField(body, relativePath);
+    return Message(MessageType::FileResponse, senderId, body);
+}
+
 Message Message::createFileError(const std::string& errorMessage, const std::string& relatedPath, uint32_t senderId) {
     std::vector<uint8_t> body;
      
@@ -270,7 +381,7 @@ Message Message::createFileError(const std::string& errorMessage, const std::str
 }
 
 std::string Message::getServerRelativePathFromUpload() const {
-    if (type_ != MessageType::FileUpload || body_.empty()) {
+    if (!hasUploadStyleFields(type_) || body_.empty()) {
         return "";
     }
     auto it_first_null = std::find(body_.begin(), body_.end(), '\0');
@@ -281,7 +392,7 @@ std::string Message::getServerRelativePathFromUpload() const {
 }
 
 std::string Message::getFileNameFromUpload() const {
-    if (type_ != MessageType::FileUpload || body_.empty()) {
+    if (!hasUploadStyleFields(type_) || body_.empty()) {
         return "";
     }
     auto it_first_null = std::find(body_.begin(), body_.end(), '\0');
@@ -312,7 +423,7 @@ std::vector<char> Message::getFileContentFromUploadOrResponse() const {
 }
 
 std::string Message::getRelativePathFromFileResponse() const {
-    if (type_ != MessageType::FileResponse || body_.empty()) {
+    if ((type_ != MessageType::FileResponse && type_ != MessageType::FileDeltaRequest && type_ != MessageType::FileDelta) || body_.empty()) {
         return "";
     }
     auto it_first_null = std::find(body_.begin(), body_.end(), '\0');
@@ -347,6 +458,114 @@ std::string Message::getRelatedPathFromFileError() const {
 }
 
 
+Message Message::createCompressed(const std::vector<uint8_t>& envelope, uint32_t senderId) {
+    return Message(MessageType::Compressed, senderId, envelope);
+}
+
+bool Message::decompressTo(Message& inner) const {
+    if (type_ != MessageType::Compressed) {
+        return false;
+    }
+    // Handlers recurse into the inner message, so a nested envelope would let a peer recurse
+    // without bound. The inner type is the envelope's first byte.
+    if (body_.empty() || static_cast<MessageType>(body_[0]) == MessageType::Compressed) {
+        return false;
+    }
+    uint8_t innerType = 0;
+    std::vector<uint8_t> rawBody;
+    // The inner body must fit a message header's 32-bit size like any other body.
+    const uint64_t maxRawSize = std::min<uint64_t>(MAX_BODY_LENGTH, UINT32_MAX);
+    if (!LocalTether::Utils::TransferCompression::decompressBody(body_, innerType, rawBody, maxRawSize)) {
+        return false;
+    }
+    inner = Message(static_cast<MessageType>(innerType), clientId_, std::vector<uint8_t>());
+    inner.body_ = std::move(rawBody);
+    inner.bodySize_ = static_cast<uint64_t>(inner.body_.size());
+    return true;
+}
+
+Message Message::createFileBatchRequest(const FileBatchRequestPayload& payload, uint32_t clientId) {
+    std::vector<uint8_t> body;
+    appendArchived(body, payload);
+    return Message(MessageType::FileBatchRequest, clientId, body);
+}
+
+FileBatchRequestPayload Message::getFileBatchRequestPayload() const {
+    if (type_ != MessageType::FileBatchRequest) {
+        throw std::runtime_error("Message is not of type FileBatchRequest.");
+    }
+    return readArchived<FileBatchRequestPayload>(body_, 0, "FileBatchRequestPayload");
+}
+
+Message Message::createFileSignatureRequest(const std::string& serverRelativePath, const std::string& fileNameOnServer, uint32_t senderId) {
+    std::vector<uint8_t> body;
+    appendField(body, serverRelativePath);
+    appendField(body, fileNameOnServer);
+    return Message(MessageType::FileSignatureRequest, senderId, body);
+}
+
+Message Message::createFileSignature(const std::string& serverRelativePath, const std::string& fileNameOnServer, const LocalTether::Utils::DeltaSync::FileSignature& signature, uint32_t senderId) {
+    std::vector<uint8_t> body;
+    appendField(body, serverRelativePath);
+    appendField(body, fileNameOnServer);
+    appendArchived(body, signature);
+    return Message(MessageType::FileSignature, senderId, body);
+}
+
+Message Message::createFileDeltaRequest(const std::string& relativePath, const LocalTether::Utils::DeltaSync::FileSignature& cachedSignature, uint32_t senderId) {
+    std::vector<uint8_t> body;
+    appendField(body, relativePath);
+    appendArchived(body, cachedSignature);
+    return Message(MessageType::FileDeltaRequest, senderId, body);
+}
+
+Message Message::createFileDelta(const std::string& relativePath, const LocalTether::Utils::DeltaSync::FileDelta& delta, uint32_t senderId) {
+    std::vector<uint8_t> body;
+    appendField(body, relativePath);
+    appendArchived(body, delta);
+    return Message(MessageType::FileDelta, senderId, body);
+}
+
+Message Message::createFileDeltaUpload(const std::string& serverRelativePath, const std::string& fileNameOnServer, const LocalTether::Utils::DeltaSync::FileDelta& delta, uint32_t senderId) {
+    std::vector<uint8_t> body;
+    appendField(body, serverRelativePath);
+    appendField(body, fileNameOnServer);
+    appendArchived(body, delta);
+    return Message(MessageType::FileDeltaUpload, senderId, body);
+}
+
+size_t Message::offsetAfterFields(size_t fieldCount) const {
+    auto it = body_.begin();
+    for (size_t i = 0; i < fieldCount; ++i) {
+        it = std::find(it, body_.end(), '\0');
+        if (it == body_.end()) {
+            throw std::runtime_error("Malformed " + messageTypeToString(type_) + " message: missing field separator.");
+        }
+        ++it;
+    }
+    return static_cast<size_t>(it - body_.begin());
+}
+
+LocalTether::Utils::DeltaSync::FileSignature Message::getFileSignaturePayload() const {
+    if (type_ == MessageType::FileSignature) {
+        return readArchived<LocalTether::Utils::DeltaSync::FileSignature>(body_, offsetAfterFields(2), "FileSignature");
+    }
+    if (type_ == MessageType::FileDeltaRequest) {
+        return readArchived<LocalTether::Utils::DeltaSync::FileSignature>(body_, offsetAfterFields(1), "FileSignature");
+    }
+    throw std::runtime_error("Message does not carry a FileSignature.");
+}
+
+LocalTether::Utils::DeltaSync::FileDelta Message::getFileDeltaPayload() const {
+    if (type_ == MessageType::FileDeltaUpload) {
+        return readArchived<LocalTether::Utils::DeltaSync::FileDelta>(body_, offsetAfterFields(2), "FileDelta");
+    }
+    if (type_ == MessageType::FileDelta) {
+        return readArchived<LocalTether::Utils::DeltaSync::FileDelta>(body_, offsetAfterFields(1), "FileDelta");
+    }
+    throw std::runtime_error("Message does not carry a FileDelta.");
+}
+
 
 std::string Message::messageTypeToString(MessageType type){
     switch (type) {
@@ -364,6 +583,14 @@ std::string Message::messageTypeToString(MessageType type){
         case MessageType::FileData: return "FileData";
         case MessageType::FileResponse: return "FileResponse";
         case MessageType::FileError: return "FileError";
+        case MessageType::FileSignatureRequest: return "FileSignatureRequest";
+        case MessageType::FileSignature: return "FileSignature";
+        case MessageType::FileDeltaRequest: return "FileDeltaRequest";
+        case MessageType::FileDelta: return "FileDelta";
+        case MessageType::FileDeltaUpload: return "FileDeltaUpload";
+        case MessageType::FileBatchRequest: return "FileBatchRequest";
+        case MessageType::Compressed: return "Compressed";
+        case MessageType::KeyStateSnapshot: return "KeyStateSnapshot";
         default: return "Unknown";
     }
 }
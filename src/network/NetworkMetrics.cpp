@@ -0,0 +1,83 @@
+#include "network/NetworkMetrics.h"
+#include "utils/Metrics.h"
+
+#include <array>
+
+namespace LocalTether::Network::NetworkMetrics {
+
+namespace {
+    constexpr size_t TYPE_COUNT = static_cast<size_t>(MessageType::Unknown) + 1;
+
+    bool isFileTransfer(MessageType type) {
+        switch (type) {
+            case MessageType::FileUpload:
+            case MessageType::FileData:
+            case MessageType::FileResponse:
+            case MessageType::FileDelta:
+            case MessageType::FileDeltaUpload:
+            case MessageType::Compressed:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    struct Direction {
+        std::array<Utils::Counter*, TYPE_COUNT> messages{};
+        Utils::Counter* bytes = nullptr;
+        Utils::Counter* fileBytes = nullptr;
+
+        Direction(const char* verb, const char* direction) {
+            auto& registry = Utils::MetricsRegistry::GetInstance();
+            const std::string prefix = std::string("localtether_messages_") + verb + "_total";
+            for (size_t i = 0; i < TYPE_COUNT; ++i) {
+                messages[i] = &registry.counter(prefix, std::string("Messages ") + verb + " by type.",
+                    Utils::MetricsRegistry::label("type", Message::messageTypeToString(static_cast<MessageType>(i))));
+            }
+            bytes = &registry.counter(std::string("localtether_bytes_") + verb + "_total",
+                                      std::string("Wire bytes ") + verb + ", headers included.");
+            fileBytes = &registry.counter("localtether_file_transfer_bytes_total", "Wire bytes of file transfer messages.",
+                                          Utils::MetricsRegistry::label("direction", direction));
+        }
+
+        void count(MessageType type, size_t size) {
+            size_t index = static_cast<size_t>(type);
+            messages[index < TYPE_COUNT ? index : TYPE_COUNT - 1]->add();
+            bytes->add(size);
+            if (isFileTransfer(type)) fileBytes->add(size);
+        }
+    };
+
+    Direction& received() {
+        static Direction direction("received", "in");
+        return direction;
+    }
+
+    Direction& sent() {
+        static Direction direction("sent", "out");
+        return direction;
+    }
+}
+
+void countReceived(MessageType type, size_t bytes) {
+    received().count(type, bytes);
+}
+
+void countSent(MessageType type, size_t bytes) {
+    sent().count(type, bytes);
+}
+
+void countInput(InputStage stage) {
+    static std::array<Utils::Counter*, 3> counters = [] {
+        auto& registry = Utils::MetricsRegistry::GetInstance();
+        const std::string name = "localtether_input_events_total";
+        const std::string help = "Input payloads by stage.";
+        return std::array<Utils::Counter*, 3>{
+            &registry.counter(name, help, Utils::MetricsRegistry::label("stage", "captured")),
+            &registry.counter(name, help, Utils::MetricsRegistry::label("stage", "relayed")),
+            &registry.counter(name, help, Utils::MetricsRegistry::label("stage", "injected"))};
+    }();
+    counters[static_cast<size_t>(stage)]->add();
+}
+
+}
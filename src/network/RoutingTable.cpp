@@ -0,0 +1,83 @@
+#include "network/RoutingTable.h"
+#include "network/Session.h"
+#include <algorithm>
+
+namespace LocalTether::Network {
+
+std::shared_ptr<const RoutingTable> RoutingTable::build(const std::vector<std::shared_ptr<Session>>& sessions,
+                                                        const Assignments& assignments) {
+    auto table = std::make_shared<RoutingTable>();
+
+    for (const auto& s : sessions) {
+        if (s && s->isAppHandshakeComplete() && s->getRole() == ClientRole::Host) {
+            table->owned_[s->getClientId()];
+            table->targets_[s->getClientId()];
+        }
+    }
+
+    std::vector<std::shared_ptr<Session>> receivers;
+    for (const auto& s : sessions) {
+        if (s && s->isAppHandshakeComplete() &&
+            (s->getRole() == ClientRole::Receiver || s->getRole() == ClientRole::Broadcaster)) {
+            receivers.push_back(s);
+        }
+    }
+    std::sort(receivers.begin(), receivers.end(),
+              [](const auto& a, const auto& b) { return a->getClientId() < b->getClientId(); });
+
+    for (const auto& receiver : receivers) {
+        uint32_t receiverId = receiver->getClientId();
+        uint32_t source = assignments.primarySource;
+        auto assigned = assignments.receiverSource.find(receiverId);
+        if (assigned != assignments.receiverSource.end() && table->isSource(assigned->second)) {
+            source = assigned->second;
+        }
+        if (source == 0 || !table->isSource(source)) continue;
+
+        table->owned_[source].push_back(receiverId);
+        table->sourceOf_[receiverId] = source;
+        if (receiver->getCanReceiveInput()) {
+            table->enabled_[receiverId] = receiver;
+        }
+
+        auto focus = assignments.sourceFocus.find(source);
+        bool focused = focus == assignments.sourceFocus.end() || focus->second == receiverId;
+        if (focused && receiver->getCanReceiveInput()) {
+            table->targets_[source].push_back(receiver);
+        }
+    }
+    return table;
+}
+
+const RoutingTable::Targets& RoutingTable::targetsFor(uint32_t sourceId) const {
+    static const Targets none;
+    auto it = targets_.find(sourceId);
+    return it != targets_.end() ? it->second : none;
+}
+
+const std::vector<uint32_t>& RoutingTable::receiversOf(uint32_t sourceId) const {
+    static const std::vector<uint32_t> none;
+    auto it = owned_.find(sourceId);
+    return it != owned_.end() ? it->second : none;
+}
+
+uint32_t RoutingTable::sourceOf(uint32_t receiverId) const {
+    auto it = sourceOf_.find(receiverId);
+    return it != sourceOf_.end() ? it->second : 0;
+}
+
+std::shared_ptr<Session> RoutingTable::ownedReceiver(uint32_t sourceId, uint32_t receiverId) const {
+    if (sourceOf(receiverId) != sourceId) return nullptr;
+    auto it = enabled_.find(receiverId);
+    return it != enabled_.end() ? it->second : nullptr;
+}
+
+std::vector<uint32_t> RoutingTable::sources() const {
+    std::vector<uint32_t> ids;
+    ids.reserve(owned_.size());
+    for (const auto& entry : owned_) ids.push_back(entry.first);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+}
@@ -0,0 +1,48 @@
+#include "network/RttEstimator.h"
+#include <cmath>
+
+namespace LocalTether::Network {
+
+void RttEstimator::addSample(double rttMs) {
+    if (rttMs < 0.0) return;
+    uint32_t count = samples_.load(std::memory_order_relaxed);
+    if (count == 0) {
+        srttMs_.store(rttMs, std::memory_order_relaxed);
+        rttVarMs_.store(rttMs / 2.0, std::memory_order_relaxed);
+    } else {
+        double srtt = srttMs_.load(std::memory_order_relaxed);
+        double rttVar = rttVarMs_.load(std::memory_order_relaxed);
+        rttVar = 0.75 * rttVar + 0.25 * std::fabs(srtt - rttMs);
+        srtt = 0.875 * srtt + 0.125 * rttMs;
+        rttVarMs_.store(rttVar, std::memory_order_relaxed);
+        srttMs_.store(srtt, std::memory_order_relaxed);
+    }
+    samples_.store(count + 1, std::memory_order_relaxed);
+}
+
+void RttEstimator::addClockSample(uint64_t sentUs, uint64_t remoteUs, uint64_t receivedUs) {
+    if (sentUs == 0 || remoteUs == 0 || receivedUs < sentUs) return;
+    ClockSample sample;
+    sample.rttUs = receivedUs - sentUs;
+    sample.offsetUs = static_cast<int64_t>(remoteUs) - static_cast<int64_t>(sentUs + sample.rttUs / 2);
+    clockSamples_[clockSampleNext_] = sample;
+    clockSampleNext_ = (clockSampleNext_ + 1) % CLOCK_WINDOW;
+    if (clockSampleCount_ < CLOCK_WINDOW) ++clockSampleCount_;
+
+    const ClockSample* best = &clockSamples_[0];
+    for (size_t i = 1; i < clockSampleCount_; ++i) {
+        if (clockSamples_[i].rttUs < best->rttUs) best = &clockSamples_[i];
+    }
+    clockOffsetUs_.store(best->offsetUs, std::memory_order_relaxed);
+}
+
+void RttEstimator::reset() {
+    srttMs_.store(0.0, std::memory_order_relaxed);
+    rttVarMs_.store(0.0, std::memory_order_relaxed);
+    samples_.store(0, std::memory_order_relaxed);
+    clockSampleCount_ = 0;
+    clockSampleNext_ = 0;
+    clockOffsetUs_.store(0, std::memory_order_relaxed);
+}
+
+}
@@ -1,13 +1,26 @@
  
 #include "network/Server.h"
+#include "network/RttEstimator.h"
 #include <thread>
 #include "network/Session.h"
+#include "network/NetworkMetrics.h"
 #include "utils/Logger.h"
 #include <chrono>
 #include "utils/SslCertificateGenerator.h"
 #include <iostream>
-#include "ui/FlowPanels.h"
-#include "ui/panels/FileExplorerPanel.h"
+#include "storage/LocalFileStore.h"
+#include "utils/DeltaSync.h"
+#include "utils/MappedFile.h"
+#include "utils/TransferCompression.h"
+#include "utils/LatencyStats.h"
+#include "utils/UiWake.h"
+#include "utils/StartupProgress.h"
+#include "utils/AtomicFile.h"
+#include "utils/Paths.h"
+#include <future>
+#include <unordered_set>
+#include <unordered_map>
+#include <sstream>
 
 namespace fs = std::filesystem;
 
@@ -22,27 +35,45 @@ Server::Server(asio::io_context& io_context, uint16_t port)
       ssl_context_(asio::ssl::context::tls_server) {
 
     LocalTether::Utils::Logger::GetInstance().Info("Server created on port: " + std::to_string(port_));
+    transferPool_ = std::make_shared<LocalTether::Utils::WorkerPool>(2, 64);
+    std::atomic_store(&routingTable_, RoutingTable::build({}, routeAssignments_));
+    metricsCollectorToken_ = LocalTether::Utils::MetricsRegistry::GetInstance().addCollector(
+        [this](std::vector<LocalTether::Utils::MetricSample>& samples) { collectSessionMetrics(samples); });
+
+
+
+    // Key generation and the first storage scan are the slow parts of a cold start; they run
+    // on their own threads while this one opens the port. start() only happens once all three
+    // are done, since the constructor waits for both futures before returning.
+    using LocalTether::Utils::StartupProgress;
+    using LocalTether::Utils::StartupStage;
+    StartupProgress::GetInstance().reset();
+    constructedAt_ = std::chrono::steady_clock::now();
+
+    auto storageReady = std::async(std::launch::async, [] {
+        StartupProgress::GetInstance().begin(StartupStage::Storage);
+        auto store = std::make_shared<LocalTether::Storage::LocalFileStore>(LocalTether::Storage::LocalFileStore::defaultRoot());
+        StartupProgress::GetInstance().finish(StartupStage::Storage, true);
+        return store;
+    });
+    auto tlsFilesReady = std::async(std::launch::async, [] {
+        StartupProgress::GetInstance().begin(StartupStage::Tls);
+        return LocalTether::Utils::SslCertificateGenerator::EnsureSslFiles();
+    });
+
+    bool listening = openAcceptor();
+    bool tlsFilesOk = tlsFilesReady.get();
+    bool tlsOk = listening && configureSsl(tlsFilesOk);
+    StartupProgress::GetInstance().finish(StartupStage::Tls, tlsOk);
+    // Always installed, even after a failure, so getStorage() stays valid.
+    setStorage(storageReady.get());
+}
 
+bool Server::openAcceptor() {
+    using LocalTether::Utils::StartupProgress;
+    using LocalTether::Utils::StartupStage;
+    StartupProgress::GetInstance().begin(StartupStage::Listen);
 
-
-    fs::path exe_dir = LocalTether::UI::Panels::get_executable_directory();
-    fs::path project_root_path = LocalTether::UI::Panels::find_ancestor_directory(exe_dir, "LocalTether", 4);
-    fs::path base_path = project_root_path.empty() ? exe_dir : project_root_path;
-    serverRootStoragePath_ = (base_path / "server_storage").string();  
-    
-    if (!fs::exists(serverRootStoragePath_)) {
-        try {
-            fs::create_directories(serverRootStoragePath_);
-            Utils::Logger::GetInstance().Info("Server created storage directory: " + serverRootStoragePath_);
-        } catch (const fs::filesystem_error& e) {
-            Utils::Logger::GetInstance().Error("Server failed to create storage directory " + serverRootStoragePath_ + ": " + e.what());
-             
-        }
-    } else {
-        Utils::Logger::GetInstance().Info("Server using existing storage directory: " + serverRootStoragePath_);
-    }
-
-     
     asio::error_code ec_acceptor;
     asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port_);
     acceptor_.open(endpoint.protocol(), ec_acceptor);
@@ -50,8 +81,8 @@ Server::Server(asio::io_context& io_context, uint16_t port)
         lastError_ = "Failed to open acceptor: " + ec_acceptor.message();
         LocalTether::Utils::Logger::GetInstance().Error(lastError_);
         setState(ServerState::Error, ec_acceptor);
-         
-        return;  
+        StartupProgress::GetInstance().finish(StartupStage::Listen, false);
+        return false;
     }
     acceptor_.set_option(asio::socket_base::reuse_address(true), ec_acceptor);  
     acceptor_.bind(endpoint, ec_acceptor);
@@ -60,7 +91,8 @@ Server::Server(asio::io_context& io_context, uint16_t port)
         LocalTether::Utils::Logger::GetInstance().Error(lastError_);
         setState(ServerState::Error, ec_acceptor);
         acceptor_.close();  
-        return;  
+        StartupProgress::GetInstance().finish(StartupStage::Listen, false);
+        return false;
     }
     acceptor_.listen(asio::socket_base::max_listen_connections, ec_acceptor);
     if (ec_acceptor) {
@@ -68,21 +100,19 @@ Server::Server(asio::io_context& io_context, uint16_t port)
         LocalTether::Utils::Logger::GetInstance().Error(lastError_);
         setState(ServerState::Error, ec_acceptor);
         acceptor_.close();  
-        return;  
+        StartupProgress::GetInstance().finish(StartupStage::Listen, false);
+        return false;
     }
+    StartupProgress::GetInstance().finish(StartupStage::Listen, true);
+    return true;
+}
 
-
-    std::string key_file = "server.key";
-    std::string cert_file = "server.crt";
-    std::string dh_file = "dh.pem";
-
-    if (!LocalTether::Utils::SslCertificateGenerator::EnsureSslFiles(key_file, cert_file, dh_file)) {
+bool Server::configureSsl(bool filesReady) {
+    if (!filesReady) {
         lastError_ = "Failed to ensure SSL files. Server might not start correctly with SSL.";
         LocalTether::Utils::Logger::GetInstance().Error(lastError_);
         setState(ServerState::Error, std::make_error_code(std::errc::io_error));  
-         
-         
-        return;  
+        return false;
     }
 
     try {
@@ -92,40 +122,104 @@ Server::Server(asio::io_context& io_context, uint16_t port)
             asio::ssl::context::no_sslv3 |
             asio::ssl::context::single_dh_use);
 
-        ssl_context_.use_certificate_chain_file(cert_file);
-        ssl_context_.use_private_key_file(key_file, asio::ssl::context::pem);
-        ssl_context_.use_tmp_dh_file(dh_file);
+        ssl_context_.use_certificate_chain_file(LocalTether::Utils::SslCertificateGenerator::DefaultCertPath());
+        ssl_context_.use_private_key_file(LocalTether::Utils::SslCertificateGenerator::DefaultKeyPath(), asio::ssl::context::pem);
+        // OpenSSL's built-in groups sized to the key, instead of a generated dh.pem.
+        SSL_CTX_set_dh_auto(ssl_context_.native_handle(), 1);
         LocalTether::Utils::Logger::GetInstance().Info("Server SSL context configured with generated/existing files.");
+        return true;
     } catch (const asio::system_error& e) {
         lastError_ = "SSL context setup failed (asio::system_error): " + std::string(e.what()) +
                      ", Code: " + std::to_string(e.code().value()) + " (" + e.code().message() + ")";
         LocalTether::Utils::Logger::GetInstance().Error(lastError_);
         setState(ServerState::Error, e.code());
-         
     } catch (const std::exception& e) {
         lastError_ = "SSL context setup failed (std::exception): " + std::string(e.what());
         LocalTether::Utils::Logger::GetInstance().Error(lastError_);
         setState(ServerState::Error, std::make_error_code(std::errc::protocol_error));
-         
     }
+    return false;
 }
 
+void Server::reportStartupTime() {
+    using LocalTether::Utils::StartupProgress;
+    using LocalTether::Utils::StartupStage;
+    auto& progress = StartupProgress::GetInstance();
+    auto& metrics = LocalTether::Utils::MetricsRegistry::GetInstance();
+    const char* help = "Milliseconds from creating the server until it accepted connections, and per startup stage.";
+
+    auto totalMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - constructedAt_).count();
+    metrics.gauge("localtether_startup_ms", help, LocalTether::Utils::MetricsRegistry::label("stage", "total")).set(totalMs);
+
+    std::string detail;
+    const std::pair<StartupStage, const char*> stages[] = {
+        {StartupStage::Listen, "listen"}, {StartupStage::Tls, "tls"}, {StartupStage::Storage, "storage"}};
+    for (const auto& [stage, name] : stages) {
+        uint32_t stageMs = progress.state(stage).elapsedMs;
+        metrics.gauge("localtether_startup_ms", help, LocalTether::Utils::MetricsRegistry::label("stage", name)).set(stageMs);
+        detail += (detail.empty() ? "" : ", ") + std::string(name) + " " + std::to_string(stageMs) + " ms";
+    }
+    LocalTether::Utils::Logger::GetInstance().Info(
+        "Server accepting connections " + std::to_string(totalMs) + " ms after creation (" + detail + ").");
+}
 
-void Server::setFileExplorerPanel(LocalTether::UI::Panels::FileExplorerPanel* fePanel) {
-    fileExplorerPanel_ = fePanel;
-    if (fileExplorerPanel_) {
-         
-         
-         
-        Utils::Logger::GetInstance().Info("Server linked with FileExplorerPanel.");
+
+void Server::setStorage(std::shared_ptr<LocalTether::Storage::StorageService> storage) {
+    if (storage_) {
+        storage_->setChangeListener(nullptr);
+    }
+    storage_ = std::move(storage);
+    storage_->setChangeListener(
+        [this](std::shared_ptr<const LocalTether::Storage::FileMetadata> tree) { broadcastFileTree(std::move(tree)); });
+}
+
+void Server::broadcastFileTree(std::shared_ptr<const LocalTether::Storage::FileMetadata> tree) {
+    if (state_ != ServerState::Running || !tree) {
+        return;
     }
+    Utils::Logger::GetInstance().Info("Broadcasting FileSystemUpdate.");
+    broadcast(Message::createFileSystemUpdate(*tree, hostClientId_));
 }
 
 
 Server::~Server() {
+    LocalTether::Utils::MetricsRegistry::GetInstance().removeCollector(metricsCollectorToken_);
+    storage_->setChangeListener(nullptr);
     if (acceptor_.is_open()) {
         stop();
     }
+    transferPool_->shutdown();
+}
+
+void Server::sendStats(std::shared_ptr<Session> session) {
+    // Same text the periodic dump writes.
+    session->send(Message::createCommand("stats:" + LocalTether::Utils::MetricsRegistry::GetInstance().renderPrometheus(), 0));
+}
+
+void Server::collectSessionMetrics(std::vector<LocalTether::Utils::MetricSample>& samples) const {
+    using LocalTether::Utils::MetricKind;
+    using LocalTether::Utils::MetricSample;
+    using LocalTether::Utils::MetricsRegistry;
+
+    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    MetricSample count{"localtether_sessions", "Connected sessions.", "", MetricKind::Gauge};
+    count.value = static_cast<double>(sessions_.size());
+    samples.push_back(std::move(count));
+    for (const auto& session : sessions_) {
+        if (!session) continue;
+        std::string labels = MetricsRegistry::label("client_id", std::to_string(session->getClientId())) + "," +
+                             MetricsRegistry::label("name", session->getClientName());
+        MetricSample in{"localtether_session_bytes_received_total", "Bytes read from each session.", labels, MetricKind::Counter};
+        in.value = static_cast<double>(session->getBytesReceived());
+        MetricSample out{"localtether_session_bytes_sent_total", "Bytes written to each session.", labels, MetricKind::Counter};
+        out.value = static_cast<double>(session->getBytesSent());
+        MetricSample depth{"localtether_session_write_queue_depth", "Buffers queued for each session.", labels, MetricKind::Gauge};
+        depth.value = static_cast<double>(session->getWriteQueueDepth());
+        samples.push_back(std::move(in));
+        samples.push_back(std::move(out));
+        samples.push_back(std::move(depth));
+    }
 }
 
 void Server::start() {
@@ -200,6 +294,10 @@ void Server::doAccept() {
     if (state_ == ServerState::Starting) {
         setState(ServerState::Running); 
         LocalTether::Utils::Logger::GetInstance().Info("Server is now running and accepting connections.");
+        if (!startupReported_) {
+            startupReported_ = true;
+            reportStartupTime();
+        }
     }
 
     acceptor_.async_accept(
@@ -251,6 +349,7 @@ void Server::doAccept() {
                     sessions_.push_back(new_session);
                 }
                 
+                new_session->setTransferThrottle(transferPool_);
                 new_session->start(
                     [this](std::shared_ptr<Session> s, const Message& m) { this->handleMessage(s, m); },
                     [this](std::shared_ptr<Session> s) { this->handleDisconnect(s); }
@@ -288,6 +387,23 @@ void Server::doAccept() {
 
 void Server::handleMessage(std::shared_ptr<Session> session, const Message& message) {
     if (!session) return;
+    if (message.getType() == MessageType::Compressed) {
+        Message inner;
+        if (!message.decompressTo(inner)) {
+            LocalTether::Utils::Logger::GetInstance().Error(
+                "Server: Dropping corrupt compressed message from " + session->getClientAddress());
+            return;
+        }
+        handleMessage(session, inner);
+        return;
+    }
+    static LocalTether::Utils::LatencyHistogram& handleTime = LocalTether::Utils::MetricsRegistry::GetInstance().histogram(
+        "localtether_server_handle_us", "Time the server spends handling one message, in microseconds.");
+    const uint64_t handleStartUs = RttEstimator::nowUs();
+    if (message.getType() != MessageType::Input && message.getType() != MessageType::KeyStateSnapshot &&
+        message.getType() != MessageType::KeepAlive) {
+        LocalTether::Utils::UiWake::notify();
+    }
     LocalTether::Utils::Logger::GetInstance().Debug(
         "Server handling message from: " + session->getClientAddress() + 
         " (ID: " + std::to_string(session->getClientId()) + 
@@ -305,56 +421,105 @@ void Server::handleMessage(std::shared_ptr<Session> session, const Message& mess
             processFileRequest(session, message);
             break;
         }
+        case MessageType::FileDeltaRequest: {
+            processFileDeltaRequest(session, message);
+            break;
+        }
+        case MessageType::FileSignatureRequest: {
+            processFileSignatureRequest(session, message);
+            break;
+        }
+        case MessageType::FileDeltaUpload: {
+            processFileDeltaUpload(session, message);
+            break;
+        }
+        case MessageType::FileBatchRequest: {
+            processFileBatchRequest(session, message);
+            break;
+        }
         case MessageType::Input: {
             try {
                 auto payload = message.getInputPayload();  
-                if (!payload.keyEvents.empty()) {
-                    std::string keyLog = "Input from " + session->getClientName() + " (" + std::to_string(session->getClientId()) + "): ";
-                    for (const auto& keyEvent : payload.keyEvents) {
-                        keyLog += std::string(keyEvent.isPressed ? "PRESS " : "RELEASE ") +
-                                  "VK:" + std::to_string(keyEvent.keyCode) + " (" +
-                                  LocalTether::Utils::Logger::getKeyName(keyEvent.keyCode) + ") ";
-                    }
-                    LocalTether::Utils::Logger::GetInstance().Info(keyLog);
-                }
-                if (payload.isMouseEvent) {
-                    std::string mouseLog = "Mouse from " + session->getClientName() + " (" + std::to_string(session->getClientId()) + "): ";
-                    if (payload.relativeX != 0 || payload.relativeY != 0) {
-                        mouseLog += "Move(" + std::to_string(payload.relativeX) + "," +
-                                    std::to_string(payload.relativeY) + ") ";
-                    }
-                    if (payload.scrollDeltaX != 0 || payload.scrollDeltaY != 0) {
-                        mouseLog += "Scroll(" + std::to_string(payload.scrollDeltaX) + "," +
-                                    std::to_string(payload.scrollDeltaY) + ") ";
-                    }
-                    if (payload.mouseButtons != 0) {
-                        mouseLog += "Buttons: ";
-                        if (payload.mouseButtons & 0x01) mouseLog += "Left ";
-                        if (payload.mouseButtons & 0x02) mouseLog += "Right ";
-                        if (payload.mouseButtons & 0x04) mouseLog += "Middle ";
-                        if (payload.mouseButtons & 0x08) mouseLog += "X1 ";
-                        if (payload.mouseButtons & 0x10) mouseLog += "X2 ";
+                // Per-message input logging; skipped outright when Info is filtered.
+                if (LocalTether::Utils::Logger::GetInstance().IsEnabled(LocalTether::Utils::LogLevel::Info)) {
+                    if (!payload.keyEvents.empty()) {
+                        std::string keyLog = "Input from " + session->getClientName() + " (" + std::to_string(session->getClientId()) + "): ";
+                        for (const auto& keyEvent : payload.keyEvents) {
+                            keyLog += std::string(keyEvent.isPressed ? "PRESS " : "RELEASE ") +
+                                      "VK:" + std::to_string(keyEvent.keyCode) + " (" +
+                                      LocalTether::Utils::Logger::getKeyName(keyEvent.keyCode) + ") ";
+                        }
+                        LocalTether::Utils::Logger::GetInstance().Info(keyLog);
                     }
-                    if (mouseLog != "Mouse from " + session->getClientName() + " (" + std::to_string(session->getClientId()) + "): ") {
-                         LocalTether::Utils::Logger::GetInstance().Info(mouseLog);
+                    if (payload.isMouseEvent) {
+                        std::string mouseLog = "Mouse from " + session->getClientName() + " (" + std::to_string(session->getClientId()) + "): ";
+                        if (payload.sourceDeviceType == InputSourceDeviceType::MOUSE_RELATIVE) {
+                            if (payload.deltaX != 0.0f || payload.deltaY != 0.0f) {
+                                mouseLog += "Delta(" + std::to_string(payload.deltaX) + "," +
+                                            std::to_string(payload.deltaY) + ") ";
+                            }
+                        } else if (payload.relativeX != 0 || payload.relativeY != 0) {
+                            mouseLog += "Move(" + std::to_string(payload.relativeX) + "," +
+                                        std::to_string(payload.relativeY) + ") ";
+                        }
+                        if (payload.scrollDeltaX != 0 || payload.scrollDeltaY != 0) {
+                            mouseLog += "Scroll(" + std::to_string(payload.scrollDeltaX) + "," +
+                                        std::to_string(payload.scrollDeltaY) + ") ";
+                        }
+                        if (payload.mouseButtons != 0) {
+                            mouseLog += "Buttons: ";
+                            if (payload.mouseButtons & 0x01) mouseLog += "Left ";
+                            if (payload.mouseButtons & 0x02) mouseLog += "Right ";
+                            if (payload.mouseButtons & 0x04) mouseLog += "Middle ";
+                            if (payload.mouseButtons & 0x08) mouseLog += "X1 ";
+                            if (payload.mouseButtons & 0x10) mouseLog += "X2 ";
+                        }
+                        if (mouseLog != "Mouse from " + session->getClientName() + " (" + std::to_string(session->getClientId()) + "): ") {
+                             LocalTether::Utils::Logger::GetInstance().Info(mouseLog);
+                        }
                     }
                 }
                  
-                if (session->getClientId() == hostClientId_ && hostClientId_ != 0) {
-                    broadcastToReceivers(message);
+                if (session->getRole() == ClientRole::Host) {
+                    NetworkMetrics::countInput(NetworkMetrics::InputStage::Relayed);
+                }
+                if (session->getRole() == ClientRole::Host &&
+                    payload.latencyStampsUs.size() == LocalTether::Utils::LATENCY_STAGE_COUNT) {
+                    // The server clock is the reference the stamps were converted to, so no offset here.
+                    payload.latencyStampsUs[static_cast<size_t>(LocalTether::Utils::LatencyStage::ServerRelay)] =
+                        LocalTether::Utils::LatencyStats::nowUs();
+                    forwardInput(session, Message::createInput(payload, message.getClientId()), payload.targetClientId);
+                } else if (session->getRole() == ClientRole::Host) {
+                    forwardInput(session, message, payload.targetClientId);
                 } else if (hostClientId_ == 0) {
                     LocalTether::Utils::Logger::GetInstance().Warning(
                         "Received input message, but no host is designated yet.");
-                } else {
-                     
-                     
-                     
                 }
             } catch (const std::exception& e) {
                 LocalTether::Utils::Logger::GetInstance().Error("Failed to parse input payload: " + std::string(e.what()));
             }
             break;
         }
+        case MessageType::KeyStateSnapshot: {
+            if (session->getRole() == ClientRole::Host) {
+                try {
+                    forwardInput(session, message, message.getKeyStateSnapshotPayload().targetClientId);
+                } catch (const std::exception& e) {
+                    LocalTether::Utils::Logger::GetInstance().Warning("Malformed KeyStateSnapshot from " + session->getClientAddress() + ": " + e.what());
+                }
+            }
+            break;
+        }
+        case MessageType::KeepAlive: {
+            try {
+                KeepAlivePayload echo = message.getKeepAlivePayload();
+                echo.echoTimeUs = RttEstimator::nowUs();
+                session->send(Message::createKeepAlive(echo, 0));
+            } catch (const std::exception& e) {
+                LocalTether::Utils::Logger::GetInstance().Warning("Malformed KeepAlive from " + session->getClientAddress() + ": " + e.what());
+            }
+            break;
+        }
         case MessageType::ChatMessage: {
             broadcast(message);
             break;
@@ -372,6 +537,7 @@ void Server::handleMessage(std::shared_ptr<Session> session, const Message& mess
                 "Received unknown/unhandled message type " + Message::messageTypeToString(message.getType()) + 
                 " from: " + session->getClientAddress());
     }
+    handleTime.record(RttEstimator::nowUs() - handleStartUs);
 }
 
 
@@ -380,7 +546,7 @@ void Server::processFileUpload(std::shared_ptr<Session> session, const Message&
 
     std::string serverRelativePath = message.getServerRelativePathFromUpload();
     std::string fileNameOnServer = message.getFileNameFromUpload();
-    const std::vector<char>& fileContent = message.getFileContentFromUploadOrResponse();
+    std::vector<char> fileContent = message.getFileContentFromUploadOrResponse();
 
     if (serverRelativePath.empty() || fileNameOnServer.empty()) {
         Utils::Logger::GetInstance().Error("Server: Invalid file upload request from client " + std::to_string(session->getClientId()) + " (missing paths).");
@@ -391,117 +557,365 @@ void Server::processFileUpload(std::shared_ptr<Session> session, const Message&
     Utils::Logger::GetInstance().Info("Server: Client " + std::to_string(session->getClientId()) + " uploading file '" + fileNameOnServer +
                                       "' to relative path '" + serverRelativePath + "'. Size: " + std::to_string(fileContent.size()) + " bytes.");
 
-    fs::path targetDir = fs::path(serverRootStoragePath_) / serverRelativePath;
-    fs::path destinationPath = targetDir / fileNameOnServer;
+    commitUploadedFile(session, serverRelativePath, fileNameOnServer, std::move(fileContent));
+}
 
-     
-    fs::path canonicalTargetDir = fs::weakly_canonical(targetDir);
-    fs::path canonicalRoot = fs::weakly_canonical(fs::path(serverRootStoragePath_));
+bool Server::resolveStoragePath(const std::string& relativePath, fs::path& resolvedPath) const {
+    return storage_->resolve(relativePath, resolvedPath);
+}
+
+namespace {
+    // Runs on the transfer pool: the write fsyncs, which can stall for a long time on a busy disk.
+    // The store rebuilds its tree once the file is in place, which broadcasts the update.
+    void storeUploadedFile(const std::shared_ptr<LocalTether::Storage::StorageService>& storage, const std::string& serverRelativePath,
+                           const std::string& fileNameOnServer, const fs::path& destinationPath, const std::vector<char>& fileContent) {
+        std::string writeError;
+        try {
+            if (!storage->writeFile(serverRelativePath, fileNameOnServer, fileContent.data(), fileContent.size(), &writeError)) {
+                Utils::Logger::GetInstance().Error("Server: Failed to store uploaded file " + destinationPath.string() + ": " + writeError);
+                return;
+            }
+            Utils::Logger::GetInstance().Info("Server: Successfully saved uploaded file: " + destinationPath.string());
+        } catch (const fs::filesystem_error& e) {
+            Utils::Logger::GetInstance().Error("Server: Filesystem error during file upload " + destinationPath.string() + ": " + std::string(e.what()));
+        }
+    }
+
+    // Uploads to the same file are stored in arrival order.
+    std::string storeKey(const fs::path& destinationPath) {
+        return "store:" + destinationPath.string();
+    }
+}
 
-    if (canonicalTargetDir.string().rfind(canonicalRoot.string(), 0) != 0) {
+void Server::commitUploadedFile(std::shared_ptr<Session> session, const std::string& serverRelativePath, const std::string& fileNameOnServer, std::vector<char> fileContent) {
+    fs::path destinationPath;
+    if (!storage_->resolveFile(serverRelativePath, fileNameOnServer, destinationPath)) {
         Utils::Logger::GetInstance().Error("Server: File upload security violation. Attempt to write outside root storage. Client: " +
-                                           std::to_string(session->getClientId()) + ", Path: " + destinationPath.string());
+                                           std::to_string(session->getClientId()) + ", Path: " + (fs::path(serverRelativePath) / fileNameOnServer).string());
          
         return;
     }
 
-    try {
-        if (!fs::exists(targetDir)) {
-            if (fs::create_directories(targetDir)) {
-                Utils::Logger::GetInstance().Info("Server: Created directory for upload: " + targetDir.string());
-            } else {
-                Utils::Logger::GetInstance().Error("Server: Failed to create directory for upload: " + targetDir.string());
-                 
+    const std::string key = storeKey(destinationPath);
+    transferPool_->submit([storage = storage_, serverRelativePath, fileNameOnServer, destinationPath, fileContent = std::move(fileContent)]() {
+        storeUploadedFile(storage, serverRelativePath, fileNameOnServer, destinationPath, fileContent);
+    }, key);
+}
+
+
+void Server::processFileRequest(std::shared_ptr<Session> session, const Message& message) {
+    if (!session) return;
+     
+    std::string requestedFileRelativePath = message.getTextPayload();   
+    Utils::Logger::GetInstance().Info("Server: Client " + session->getClientName() + " (ID: " + std::to_string(session->getClientId()) + 
+                                      ") requested file: " + requestedFileRelativePath);
+     
+    fs::path canonicalRequestedPath;
+    if (!resolveStoragePath(requestedFileRelativePath, canonicalRequestedPath) || !fs::exists(canonicalRequestedPath) || !fs::is_regular_file(canonicalRequestedPath)) {
+        Utils::Logger::GetInstance().Warning("Server: File not found or invalid request for '" + requestedFileRelativePath + "' from client " + std::to_string(session->getClientId()));
+        Message errorMsg = Message::createFileError("File not found or access denied.", requestedFileRelativePath, 0);  
+        session->send(errorMsg);
+        return;
+    }
+
+    auto mappedFile = Utils::MappedFile::Open(canonicalRequestedPath);
+    if (!mappedFile) {
+        Utils::Logger::GetInstance().Error("Server: Could not map file '" + canonicalRequestedPath.string() + "' for client " + std::to_string(session->getClientId()));
+        Message errorMsg = Message::createFileError("Server error: Could not read file.", requestedFileRelativePath, 0);
+        session->send(errorMsg);
+        return;
+    }
+
+    sendMappedFile(session, requestedFileRelativePath, mappedFile);
+}
+
+namespace {
+    std::string transferKey(const std::shared_ptr<Session>& session) {
+        return "session:" + std::to_string(session->getClientId());
+    }
+
+    // Runs on the transfer pool. Only touches the session, which posts the actual write to its io executor.
+    void compressAndSendFile(const std::shared_ptr<Session>& session, const std::string& relativePath,
+                             std::shared_ptr<const Utils::MappedFile> mappedFile, const Message& prefix) {
+        if (!session->isActive()) return;
+
+        if ((session->getCapabilities() & CapabilityZstdTransfer) &&
+            Utils::TransferCompression::shouldCompress(relativePath, mappedFile->data(), mappedFile->size())) {
+            const int level = Utils::TransferCompression::chooseLevel(session->getLinkBytesPerSecond());
+            const auto& prefixBody = prefix.getBody();
+            std::vector<uint8_t> envelope = Utils::TransferCompression::compressBody(
+                static_cast<uint8_t>(MessageType::FileResponse),
+                {{reinterpret_cast<const char*>(prefixBody.data()), prefixBody.size()}, {mappedFile->data(), mappedFile->size()}},
+                level);
+            if (mappedFile->truncated()) {
+                Utils::Logger::GetInstance().Warning("Server: File '" + relativePath + "' was truncated while being compressed for client " + std::to_string(session->getClientId()));
+                session->send(Message::createFileError("File changed while being read, try again.", relativePath, 0));
+                return;
+            }
+            if (!envelope.empty() && envelope.size() < mappedFile->size()) {
+                Utils::Logger::GetInstance().Info("Server: Sending file '" + relativePath + "' (" + std::to_string(mappedFile->size()) + " bytes, " +
+                                                  std::to_string(envelope.size()) + " compressed at level " + std::to_string(level) +
+                                                  ") to client " + std::to_string(session->getClientId()));
+                session->send(Message::createCompressed(envelope, 0));
                 return;
             }
         }
 
-        std::ofstream outFile(destinationPath, std::ios::binary | std::ios::trunc);  
-        if (!outFile.is_open()) {
-            Utils::Logger::GetInstance().Error("Server: Failed to open/create file for writing: " + destinationPath.string());
-             
+        Utils::Logger::GetInstance().Info("Server: Sending file '" + relativePath + "' (" + std::to_string(mappedFile->size()) + " bytes) to client " + std::to_string(session->getClientId()));
+        session->sendWithMappedBody(prefix, std::move(mappedFile));
+    }
+
+    // Runs on the transfer pool, inside the session's keyed job.
+    void sendFileNow(const std::shared_ptr<Session>& session, const std::string& relativePath, std::shared_ptr<const Utils::MappedFile> mappedFile) {
+        Message prefix = Message::createFileResponsePrefix(relativePath, 0);
+        if (prefix.getBody().size() + mappedFile->size() > UINT32_MAX) {
+            Utils::Logger::GetInstance().Error("Server: File '" + relativePath + "' is too large to send in a single message.");
+            session->send(Message::createFileError("Server error: File too large to transfer.", relativePath, 0));
             return;
         }
+        compressAndSendFile(session, relativePath, std::move(mappedFile), prefix);
+    }
 
-        outFile.write(fileContent.data(), fileContent.size());
-        outFile.close();
+    // One batch request, sent a file at a time by a chain of transfer pool jobs.
+    struct FileBatch {
+        std::shared_ptr<Session> session;
+        fs::path root;
+        std::vector<std::string> files;
+        size_t next = 0;
+        size_t sent = 0;
+    };
+
+    // Each file is mapped only once the previous one has been written out, so a batch holds at
+    // most one mapping however many files it has. The pool is held weakly because the next link
+    // is queued from the session's io thread, which can outlive the server.
+    void queueNextBatchFile(std::weak_ptr<Utils::WorkerPool> weakPool, std::shared_ptr<FileBatch> batch) {
+        auto pool = weakPool.lock();
+        if (!pool) return;
+        const std::string key = transferKey(batch->session);
+        pool->submit([weakPool = std::move(weakPool), batch]() {
+            const auto& session = batch->session;
+            if (!session->isActive()) return;
+            if (batch->next == batch->files.size()) {
+                session->send(Message::createCommand("file_batch_complete:" + std::to_string(batch->sent), 0));
+                return;
+            }
+            const std::string& relativePath = batch->files[batch->next++];
+            auto mappedFile = Utils::MappedFile::Open(batch->root / relativePath);
+            if (!mappedFile) {
+                session->send(Message::createFileError("Server error: Could not read file.", relativePath, 0));
+            } else {
+                sendFileNow(session, relativePath, std::move(mappedFile));
+                batch->sent++;
+            }
+            session->whenWritesDrained([weakPool, batch]() { queueNextBatchFile(weakPool, batch); });
+        }, key);
+    }
+}
 
-        Utils::Logger::GetInstance().Info("Server: Successfully saved uploaded file: " + destinationPath.string());
+void Server::sendMappedFile(std::shared_ptr<Session> session, const std::string& relativePath, std::shared_ptr<const Utils::MappedFile> mappedFile) {
+    // Compression can take seconds on a large file. The envelope's length is part of the message
+    // header, so it cannot be streamed out chunk by chunk; it is built on the transfer pool instead.
+    const std::string key = transferKey(session);
+    transferPool_->submit([session = std::move(session), relativePath, mappedFile = std::move(mappedFile)]() mutable {
+        sendFileNow(session, relativePath, std::move(mappedFile));
+    }, key);
+}
 
-         
-         
-         
-        if (fileExplorerPanel_) {  
-             Utils::Logger::GetInstance().Info("Server triggering FileExplorerPanel refresh and broadcast.");
-             fileExplorerPanel_->RefreshView();  
-             fileExplorerPanel_->BroadcastFileSystemUpdate();
-        } else {
-             
-             
-             
-             
-             
-            try {
-                auto& panel = LocalTether::UI::Flow::GetFileExplorerPanelInstance();
-                Utils::Logger::GetInstance().Info("Server triggering FileExplorerPanel refresh and broadcast via GetInstance.");
-                panel.RefreshView();
-                panel.BroadcastFileSystemUpdate();
-            } catch (const std::exception& e) {
-                Utils::Logger::GetInstance().Error("Server: Could not get FileExplorerPanel instance to broadcast update: " + std::string(e.what()));
-            }
+uint32_t Server::localCapabilities() const {
+    uint32_t capabilities = CapabilityRelativeMouse;
+    if (Utils::TransferCompression::isEnabled()) capabilities |= CapabilityZstdTransfer;
+    return capabilities;
+}
+
+void Server::processFileBatchRequest(std::shared_ptr<Session> session, const Message& message) {
+    if (!session) return;
+
+    FileBatchRequestPayload request;
+    try {
+        request = message.getFileBatchRequestPayload();
+    } catch (const std::exception& e) {
+        Utils::Logger::GetInstance().Error("Server: Failed to parse batch file request: " + std::string(e.what()));
+        return;
+    }
+
+    const fs::path canonicalRoot = fs::weakly_canonical(storage_->root());
+    std::vector<std::string> files;
+    std::unordered_set<std::string> seen;
+    // Directory entries are taken as listed, so each one is resolved again: a symlink inside the
+    // store must not pull in files from outside it, and in-progress uploads are not sent.
+    auto addFile = [&](const fs::path& file) {
+        std::error_code ec;
+        const fs::path canonicalFile = fs::canonical(file, ec);
+        if (ec || !Utils::isPathWithin(canonicalFile, canonicalRoot) ||
+            Utils::isAtomicTempFile(canonicalFile.filename().string())) {
+            return;
+        }
+        std::string relative = fs::relative(canonicalFile, canonicalRoot).generic_string();
+        if (seen.insert(relative).second) {
+            files.push_back(std::move(relative));
         }
+    };
 
-    } catch (const fs::filesystem_error& e) {
-        Utils::Logger::GetInstance().Error("Server: Filesystem error during file upload " + destinationPath.string() + ": " + std::string(e.what()));
-         
+    for (const auto& requestedPath : request.paths) {
+        fs::path resolved;
+        std::error_code ec;
+        if (!resolveStoragePath(requestedPath, resolved) || !fs::exists(resolved, ec)) {
+            session->send(Message::createFileError("File not found or access denied.", requestedPath, 0));
+            continue;
+        }
+        if (fs::is_directory(resolved, ec)) {
+            for (auto it = fs::recursive_directory_iterator(resolved, fs::directory_options::skip_permission_denied, ec);
+                 !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec)) {
+                    addFile(it->path());
+                }
+            }
+        } else if (fs::is_regular_file(resolved, ec)) {
+            addFile(resolved);
+        }
     }
-}
 
+    Utils::Logger::GetInstance().Info("Server: Client " + session->getClientName() + " (ID: " + std::to_string(session->getClientId()) +
+                                      ") requested a batch of " + std::to_string(request.paths.size()) + " path(s), sending " +
+                                      std::to_string(files.size()) + " file(s).");
 
-void Server::processFileRequest(std::shared_ptr<Session> session, const Message& message) {
+    auto batch = std::make_shared<FileBatch>();
+    batch->session = std::move(session);
+    batch->root = canonicalRoot;
+    batch->files = std::move(files);
+    queueNextBatchFile(transferPool_, std::move(batch));
+}
+
+void Server::processFileDeltaRequest(std::shared_ptr<Session> session, const Message& message) {
     if (!session) return;
-     
-    std::string requestedFileRelativePath = message.getTextPayload();   
-    Utils::Logger::GetInstance().Info("Server: Client " + session->getClientName() + " (ID: " + std::to_string(session->getClientId()) + 
-                                      ") requested file: " + requestedFileRelativePath);
-     
-    fs::path fullPathToServerFile = fs::path(serverRootStoragePath_) / requestedFileRelativePath;
 
-     
-    fs::path canonicalRequestedPath = fs::weakly_canonical(fullPathToServerFile);
-    fs::path canonicalRoot = fs::weakly_canonical(fs::path(serverRootStoragePath_));
+    std::string requestedFileRelativePath = message.getRelativePathFromFileResponse();
+    fs::path canonicalRequestedPath;
+    if (requestedFileRelativePath.empty() || !resolveStoragePath(requestedFileRelativePath, canonicalRequestedPath) ||
+        !fs::exists(canonicalRequestedPath) || !fs::is_regular_file(canonicalRequestedPath)) {
+        Utils::Logger::GetInstance().Warning("Server: File not found or invalid delta request for '" + requestedFileRelativePath + "' from client " + std::to_string(session->getClientId()));
+        session->send(Message::createFileError("File not found or access denied.", requestedFileRelativePath, 0));
+        return;
+    }
 
-    if (canonicalRequestedPath.string().rfind(canonicalRoot.string(), 0) != 0 || !fs::exists(canonicalRequestedPath) || !fs::is_regular_file(canonicalRequestedPath)) {
-        Utils::Logger::GetInstance().Warning("Server: File not found or invalid request for '" + requestedFileRelativePath + "' from client " + std::to_string(session->getClientId()));
-        Message errorMsg = Message::createFileError("File not found or access denied.", requestedFileRelativePath, 0);  
-        session->send(errorMsg);
+    auto mappedFile = Utils::MappedFile::Open(canonicalRequestedPath);
+    if (!mappedFile) {
+        Utils::Logger::GetInstance().Error("Server: Could not map file '" + canonicalRequestedPath.string() + "' for client " + std::to_string(session->getClientId()));
+        session->send(Message::createFileError("Server error: Could not read file.", requestedFileRelativePath, 0));
         return;
     }
 
-    std::ifstream file(canonicalRequestedPath, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        Utils::Logger::GetInstance().Error("Server: Could not open file '" + canonicalRequestedPath.string() + "' for client " + std::to_string(session->getClientId()));
-        Message errorMsg = Message::createFileError("Server error: Could not open file.", requestedFileRelativePath, 0);
-        session->send(errorMsg);
+    Utils::DeltaSync::FileSignature cachedSignature;
+    try {
+        cachedSignature = message.getFileSignaturePayload();
+    } catch (const std::exception& e) {
+        Utils::Logger::GetInstance().Warning("Server: Ignoring malformed delta request for '" + requestedFileRelativePath + "': " + std::string(e.what()));
+        sendMappedFile(session, requestedFileRelativePath, mappedFile);
+        return;
+    }
+    if (!Utils::DeltaSync::isValidSignature(cachedSignature)) {
+        Utils::Logger::GetInstance().Warning("Server: Rejecting delta request for '" + requestedFileRelativePath + "' from client " +
+                                             std::to_string(session->getClientId()) + ": block signature does not match its file size.");
+        session->send(Message::createFileError("Invalid delta request.", requestedFileRelativePath, 0));
         return;
     }
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    std::vector<char> buffer(size);
+    // Hashing the whole file is as slow as compressing it, so the delta is built on the transfer
+    // pool too, in the same per-session order as full sends.
+    const std::string key = transferKey(session);
+    transferPool_->submit([session, requestedFileRelativePath, mappedFile = std::move(mappedFile), cachedSignature = std::move(cachedSignature)]() mutable {
+        if (!session->isActive()) return;
+        Utils::DeltaSync::FileDelta delta = Utils::DeltaSync::computeDelta(cachedSignature, mappedFile->data(), mappedFile->size());
+        if (mappedFile->truncated()) {
+            Utils::Logger::GetInstance().Warning("Server: File '" + requestedFileRelativePath + "' was truncated while computing a delta for client " + std::to_string(session->getClientId()));
+            session->send(Message::createFileError("File changed while being read, try again.", requestedFileRelativePath, 0));
+            return;
+        }
+        if (Utils::DeltaSync::isDeltaWorthwhile(delta, mappedFile->size())) {
+            Utils::Logger::GetInstance().Info("Server: Sending delta for '" + requestedFileRelativePath + "' (" + std::to_string(delta.literalBytes()) +
+                                              " literal bytes of " + std::to_string(mappedFile->size()) + ") to client " + std::to_string(session->getClientId()));
+            session->send(Message::createFileDelta(requestedFileRelativePath, delta, 0));
+            return;
+        }
+        sendFileNow(session, requestedFileRelativePath, std::move(mappedFile));
+    }, key);
+}
 
-    if (!file.read(buffer.data(), size)) {
-        file.close();
-        Utils::Logger::GetInstance().Error("Server: Could not read file '" + canonicalRequestedPath.string() + "' for client " + std::to_string(session->getClientId()));
-        Message errorMsg = Message::createFileError("Server error: Could not read file.", requestedFileRelativePath, 0);
-        session->send(errorMsg);
+void Server::processFileSignatureRequest(std::shared_ptr<Session> session, const Message& message) {
+    if (!session) return;
+
+    std::string serverRelativePath = message.getServerRelativePathFromUpload();
+    std::string fileNameOnServer = message.getFileNameFromUpload();
+    if (serverRelativePath.empty() || fileNameOnServer.empty()) {
+        Utils::Logger::GetInstance().Error("Server: Invalid signature request from client " + std::to_string(session->getClientId()) + " (missing paths).");
+        return;
+    }
+
+    // An empty signature tells the client to send the whole file.
+    Utils::DeltaSync::FileSignature signature;
+    fs::path existingPath;
+    if (storage_->resolveFile(serverRelativePath, fileNameOnServer, existingPath)) {
+        std::error_code ec;
+        if (fs::is_regular_file(existingPath, ec)) {
+            auto existing = Utils::MappedFile::Open(existingPath);
+            if (existing && existing->size() >= Utils::DeltaSync::MIN_DELTA_FILE_SIZE) {
+                signature = Utils::DeltaSync::computeSignature(existing->data(), existing->size());
+                if (existing->truncated()) {
+                    signature = Utils::DeltaSync::FileSignature{};
+                }
+            }
+        }
+    }
+
+    Utils::Logger::GetInstance().Debug("Server: Sending " + std::to_string(signature.blocks.size()) + " block signatures for '" +
+                                       fileNameOnServer + "' to client " + std::to_string(session->getClientId()));
+    session->send(Message::createFileSignature(serverRelativePath, fileNameOnServer, signature, 0));
+}
+
+void Server::processFileDeltaUpload(std::shared_ptr<Session> session, const Message& message) {
+    if (!session) return;
+
+    std::string serverRelativePath = message.getServerRelativePathFromUpload();
+    std::string fileNameOnServer = message.getFileNameFromUpload();
+    if (serverRelativePath.empty() || fileNameOnServer.empty()) {
+        Utils::Logger::GetInstance().Error("Server: Invalid delta upload from client " + std::to_string(session->getClientId()) + " (missing paths).");
         return;
     }
-    file.close();
 
-    Utils::Logger::GetInstance().Info("Server: Sending file '" + requestedFileRelativePath + "' (" + std::to_string(size) + " bytes) to client " + std::to_string(session->getClientId()));
-    Message responseMsg = Message::createFileResponse(requestedFileRelativePath, buffer, 0);  
-    session->send(responseMsg);
+    Utils::DeltaSync::FileDelta delta;
+    try {
+        delta = message.getFileDeltaPayload();
+    } catch (const std::exception& e) {
+        Utils::Logger::GetInstance().Error("Server: Failed to parse delta upload: " + std::string(e.what()) + "; asking client " +
+                                           std::to_string(session->getClientId()) + " for the full file.");
+        session->send(Message::createFileSignature(serverRelativePath, fileNameOnServer, Utils::DeltaSync::FileSignature{}, 0));
+        return;
+    }
+    fs::path basePath;
+    if (!storage_->resolveFile(serverRelativePath, fileNameOnServer, basePath)) {
+        Utils::Logger::GetInstance().Error("Server: File upload security violation. Attempt to write outside root storage. Client: " +
+                                           std::to_string(session->getClientId()) + ", Path: " + (fs::path(serverRelativePath) / fileNameOnServer).string());
+        return;
+    }
+    Utils::Logger::GetInstance().Info("Server: Client " + std::to_string(session->getClientId()) + " uploading delta for '" + fileNameOnServer +
+                                      "' (" + std::to_string(delta.literalBytes()) + " literal bytes, " + std::to_string(delta.targetSize) + " total).");
+
+    // Rebuilding reads and hashes the whole base, so it runs on the transfer pool, ordered with
+    // the other stores to the same file; the rebuilt file is stored by the same job.
+    const std::string key = storeKey(basePath);
+    transferPool_->submit([storage = storage_, session, serverRelativePath, fileNameOnServer, basePath, delta = std::move(delta)]() {
+        std::vector<char> rebuilt;
+        auto base = Utils::MappedFile::Open(basePath);
+        const bool applied = base && Utils::DeltaSync::applyDelta(base->data(), base->size(), delta, rebuilt) && !base->truncated();
+        base.reset();
+        if (!applied) {
+            Utils::Logger::GetInstance().Warning("Server: Delta for '" + fileNameOnServer + "' did not apply cleanly; asking client " +
+                                                 std::to_string(session->getClientId()) + " for the full file.");
+            session->send(Message::createFileSignature(serverRelativePath, fileNameOnServer, Utils::DeltaSync::FileSignature{}, 0));
+            return;
+        }
+        storeUploadedFile(storage, serverRelativePath, fileNameOnServer, basePath, rebuilt);
+    }, key);
 }
 
 void Server::processLimitedCommand(std::shared_ptr<Session> session, const Message& message) {
@@ -548,6 +962,7 @@ void Server::processHandshake(std::shared_ptr<Session> session, const Message& m
         if (isAuthenticated) {
             session->setClientName(handshakeData.clientName);
             session->setRole(handshakeData.role);  
+            session->setScreenSize(handshakeData.hostScreenWidth, handshakeData.hostScreenHeight);
 
              
             if (handshakeData.role == ClientRole::Host) {
@@ -565,11 +980,12 @@ void Server::processHandshake(std::shared_ptr<Session> session, const Message& m
                     LocalTether::Utils::Logger::GetInstance().Info(
                         "Host " + handshakeData.clientName + " (ID: " + std::to_string(session->getClientId()) + ") re-confirmed.");
                 } else {  
-                    LocalTether::Utils::Logger::GetInstance().Warning(
+                    // Additional hosts become input sources that drive no receivers until the
+                    // primary host routes some to them; only the primary runs host commands.
+                    session->setRole(ClientRole::Host);
+                    LocalTether::Utils::Logger::GetInstance().Info(
                         "Client " + handshakeData.clientName + " (ID: " + std::to_string(session->getClientId()) + 
-                        ") tried to connect as Host, but Host (ID: " + std::to_string(hostClientId_) + 
-                        ") already exists. Assigning Receiver role.");
-                    session->setRole(ClientRole::Receiver);  
+                        ") joined as an additional input source; primary Host is ID " + std::to_string(hostClientId_) + ".");
                 }
             } else {  
                  
@@ -589,6 +1005,8 @@ void Server::processHandshake(std::shared_ptr<Session> session, const Message& m
             responsePayload.clientId = session->getClientId();  
             responsePayload.hostScreenWidth = (hostClientId_ != 0) ? hostScreenWidth_ : 0;
             responsePayload.hostScreenHeight = (hostClientId_ != 0) ? hostScreenHeight_ : 0;
+            responsePayload.capabilities = handshakeData.capabilities & localCapabilities();
+            session->setCapabilities(responsePayload.capabilities);
 
             auto responseMsg = Message::createHandshake(responsePayload, 0);  
             LocalTether::Utils::Logger::GetInstance().Info(
@@ -602,22 +1020,14 @@ void Server::processHandshake(std::shared_ptr<Session> session, const Message& m
             LocalTether::Utils::Logger::GetInstance().Info(
                 "Client " + session->getClientName() + " (ID: " + std::to_string(session->getClientId()) +
                 ") application handshake complete. Role: " + session->getRoleString());
+            rebuildRoutingTable();
 
             notifyClientJoined(session);
+            announceReceiverScreens(session);
             if (session->getRole() != ClientRole::Host) {  
-                try {
-                    auto& fep = LocalTether::UI::Flow::GetFileExplorerPanelInstance();  
-                    const auto& rootNode = fep.getRootNode();  
-                    if (!rootNode.fullPath.empty()) {  
-                        Message fsUpdateMsg = Message::createFileSystemUpdate(rootNode, hostClientId_);  
-                        session->send(fsUpdateMsg);
-                        LocalTether::Utils::Logger::GetInstance().Info("Sent initial FileSystemUpdate to client ID: " + std::to_string(session->getClientId()));
-                    } else {
-                        LocalTether::Utils::Logger::GetInstance().Warning("Server's FileExplorerPanel rootNode is not initialized. Cannot send initial FS update.");
-                    }
-                } catch (const std::exception& e) {
-                    LocalTether::Utils::Logger::GetInstance().Error("Error preparing initial FileSystemUpdate: " + std::string(e.what()));
-                }
+                auto tree = storage_->tree();
+                session->send(Message::createFileSystemUpdate(*tree, hostClientId_));
+                LocalTether::Utils::Logger::GetInstance().Info("Sent initial FileSystemUpdate to client ID: " + std::to_string(session->getClientId()));
             }
         } else {
             LocalTether::Utils::Logger::GetInstance().Warning(
@@ -667,7 +1077,16 @@ void Server::handleDisconnect(std::shared_ptr<Session> session) {
         sessions_.erase(std::remove_if(sessions_.begin(), sessions_.end(),
                                     [&](const std::shared_ptr<Session>& s) { return s == session || s->getClientId() == clientId; }),
                         sessions_.end());
+        routeAssignments_.receiverSource.erase(clientId);
+        routeAssignments_.sourceFocus.erase(clientId);
+        for (auto it = routeAssignments_.receiverSource.begin(); it != routeAssignments_.receiverSource.end();) {
+            it = (it->second == clientId) ? routeAssignments_.receiverSource.erase(it) : std::next(it);
+        }
+        for (auto it = routeAssignments_.sourceFocus.begin(); it != routeAssignments_.sourceFocus.end();) {
+            it = (it->second == clientId) ? routeAssignments_.sourceFocus.erase(it) : std::next(it);
+        }
     }
+    rebuildRoutingTable();
 }
 
 void Server::broadcast(const Message& message) {
@@ -687,36 +1106,146 @@ void Server::broadcast(const Message& message) {
     }
 }
 
-void Server::broadcastToReceivers(const Message& message) {
-    std::vector<std::shared_ptr<Session>> currentSessions;
+void Server::forwardInput(std::shared_ptr<Session> source, const Message& message, uint32_t targetClientId) {
+    auto table = std::atomic_load(&routingTable_);
+    if (targetClientId != 0) {
+        // Only honoured for receivers the source owns, so a layout cannot steal another host's.
+        if (auto target = table->ownedReceiver(source->getClientId(), targetClientId)) {
+            target->send(message);
+        }
+        return;
+    }
+    const auto& targets = table->targetsFor(source->getClientId());
+    for (const auto& target : targets) {
+        target->send(message);
+    }
+}
+
+void Server::rebuildRoutingTable() {
+    std::shared_ptr<const RoutingTable> table;
+    std::unordered_set<uint32_t> connected;
     {
         std::lock_guard<std::mutex> lock(sessions_mutex_);
-        for(const auto& s : sessions_) {
-             
-            if(s && s->isAppHandshakeComplete() &&  s->getCanReceiveInput() &&
-               (s->getRole() == LocalTether::Network::ClientRole::Receiver || s->getRole() == LocalTether::Network::ClientRole::Broadcaster) ) { 
-                currentSessions.push_back(s);
+        routeAssignments_.primarySource = hostClientId_;
+        table = RoutingTable::build(sessions_, routeAssignments_);
+        for (const auto& s : sessions_) {
+            if (s) connected.insert(s->getClientId());
+        }
+    }
+    auto previous = std::atomic_exchange(&routingTable_, table);
+
+    if (!previous) return;
+    // A receiver that stops being driven by a source, because it was handed to another one or
+    // focused away, may still hold keys that source pressed; an empty snapshot releases them.
+    std::unordered_map<uint32_t, uint32_t> drivenBy;
+    for (uint32_t source : table->sources()) {
+        for (const auto& target : table->targetsFor(source)) {
+            drivenBy[target->getClientId()] = source;
+        }
+    }
+    for (uint32_t oldSource : previous->sources()) {
+        for (const auto& target : previous->targetsFor(oldSource)) {
+            if (!connected.count(target->getClientId())) continue;
+            auto now = drivenBy.find(target->getClientId());
+            if (now == drivenBy.end() || now->second != oldSource) {
+                target->send(Message::createKeyStateSnapshot(KeyStateSnapshotPayload{}, 0));
             }
         }
     }
-     
-    LocalTether::Utils::Logger::GetInstance().Debug(
-        "Broadcasting message type " + Message::messageTypeToString(message.getType()) +
-        " to " + std::to_string(currentSessions.size()) + " connected Receiver/Broadcaster clients.");  
-    
-    for (const auto& session_ptr : currentSessions) {  
-         
-         
-        if (message.getType() == MessageType::Input && session_ptr->getClientId() == hostClientId_) {
-            continue;
+}
+
+std::shared_ptr<const RoutingTable> Server::getRoutingTable() const {
+    return std::atomic_load(&routingTable_);
+}
+
+bool Server::processRouteCommand(std::shared_ptr<Session> session, const std::string& commandText) {
+    uint32_t senderId = session->getClientId();
+
+    // Hotkey switching, usable by every input source for its own receivers: each route_next
+    // focuses the next receiver it owns, and after the last one it drives all of them again.
+    if (commandText == "route_next" || commandText == "route_all") {
+        auto table = std::atomic_load(&routingTable_);
+        const auto& owned = table->receiversOf(senderId);
+        uint32_t focus = 0;
+        {
+            std::lock_guard<std::mutex> lock(sessions_mutex_);
+            auto current = routeAssignments_.sourceFocus.find(senderId);
+            if (commandText == "route_next" && !owned.empty()) {
+                auto next = owned.begin();
+                if (current != routeAssignments_.sourceFocus.end()) {
+                    next = std::upper_bound(owned.begin(), owned.end(), current->second);
+                }
+                focus = (next != owned.end()) ? *next : 0;
+            }
+            if (focus != 0) {
+                routeAssignments_.sourceFocus[senderId] = focus;
+            } else {
+                routeAssignments_.sourceFocus.erase(senderId);
+            }
         }
+        rebuildRoutingTable();
+        LocalTether::Utils::Logger::GetInstance().Info(
+            "Input source " + std::to_string(senderId) + " now drives " +
+            (focus != 0 ? "receiver " + std::to_string(focus) : "all " + std::to_string(owned.size()) + " of its receivers") + ".");
+        session->send(Message::createCommand("route_focus:" + (focus != 0 ? std::to_string(focus) : std::string("all")), 0));
+        return true;
+    }
+
+    if (senderId != hostClientId_) return false;
+
+    if (commandText.rfind("route_set:", 0) == 0) {
+        // route_set:<sourceId>:<receiverId>,<receiverId>,...
+        try {
+            size_t colon = commandText.find(':', 10);
+            if (colon == std::string::npos) throw std::invalid_argument("missing receiver list");
+            uint32_t sourceId = std::stoul(commandText.substr(10, colon - 10));
+            std::vector<uint32_t> receiverIds;
+            std::stringstream list(commandText.substr(colon + 1));
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                if (!item.empty()) receiverIds.push_back(std::stoul(item));
+            }
+            if (!std::atomic_load(&routingTable_)->isSource(sourceId)) {
+                LocalTether::Utils::Logger::GetInstance().Warning("Route command: Client ID " + std::to_string(sourceId) + " is not an input source.");
+                return true;
+            }
+            {
+                std::lock_guard<std::mutex> lock(sessions_mutex_);
+                for (uint32_t receiverId : receiverIds) {
+                    routeAssignments_.receiverSource[receiverId] = sourceId;
+                    for (auto it = routeAssignments_.sourceFocus.begin(); it != routeAssignments_.sourceFocus.end();) {
+                        it = (it->second == receiverId) ? routeAssignments_.sourceFocus.erase(it) : std::next(it);
+                    }
+                }
+            }
+            rebuildRoutingTable();
+            LocalTether::Utils::Logger::GetInstance().Info("Routed " + std::to_string(receiverIds.size()) +
+                                                           " receiver(s) to input source " + std::to_string(sourceId) + ".");
+        } catch (const std::exception& e) {
+            LocalTether::Utils::Logger::GetInstance().Error("Error processing route_set command: " + std::string(e.what()));
+        }
+        return true;
+    }
 
-        LocalTether::Utils::Logger::GetInstance().Debug(
-            "Broadcasting message type " + Message::messageTypeToString(message.getType()) +
-            " to " + session_ptr->getRoleString() + ": " + session_ptr->getClientName() +
-            " (ID: " + std::to_string(session_ptr->getClientId()) + ")");
-        session_ptr->send(message);  
+    if (commandText.rfind("route_clear:", 0) == 0) {
+        // Hands every receiver the source owns back to the primary host.
+        try {
+            uint32_t sourceId = std::stoul(commandText.substr(12));
+            {
+                std::lock_guard<std::mutex> lock(sessions_mutex_);
+                for (auto it = routeAssignments_.receiverSource.begin(); it != routeAssignments_.receiverSource.end();) {
+                    it = (it->second == sourceId) ? routeAssignments_.receiverSource.erase(it) : std::next(it);
+                }
+                routeAssignments_.sourceFocus.erase(sourceId);
+            }
+            rebuildRoutingTable();
+            LocalTether::Utils::Logger::GetInstance().Info("Cleared routes of input source " + std::to_string(sourceId) + ".");
+        } catch (const std::exception& e) {
+            LocalTether::Utils::Logger::GetInstance().Error("Error processing route_clear command: " + std::string(e.what()));
+        }
+        return true;
     }
+    return false;
 }
 
 void Server::broadcastExcept(const Message& message, std::shared_ptr<Session> exceptSession) {
@@ -739,7 +1268,11 @@ void Server::broadcastExcept(const Message& message, std::shared_ptr<Session> ex
 void Server::processCommand(std::shared_ptr<Session> session, const Message& message) {
     if (!session) return;
     std::string commandText = message.getTextPayload();
-     
+
+    if (processRouteCommand(session, commandText)) {
+        return;
+    }
+
     if (session->getClientId() != hostClientId_) {
         LocalTether::Utils::Logger::GetInstance().Warning(
             "Client " + session->getClientName() + " (ID: " + std::to_string(session->getClientId()) +
@@ -750,7 +1283,11 @@ void Server::processCommand(std::shared_ptr<Session> session, const Message& mes
 
     LocalTether::Utils::Logger::GetInstance().Info("Host " + session->getClientName() + " sent command: " + commandText);
 
-    if (commandText == "shutdown_server") {  
+    // Primary host only: any client can claim the Host role on an open server, and the registry
+    // names every session and its traffic.
+    if (commandText == "stats") {
+        sendStats(session);
+    } else if (commandText == "shutdown_server") {  
         LocalTether::Utils::Logger::GetInstance().Info("Shutdown command received from host. Shutting down server.");
         auto shutdownMsg = Message::createCommand("server_shutdown_imminent", 0);
         broadcast(shutdownMsg);  
@@ -842,6 +1379,7 @@ void Server::processCommand(std::shared_ptr<Session> session, const Message& mes
                 }
                 if (sessionToToggle && sessionToToggle->getRole() == ClientRole::Receiver) {
                     sessionToToggle->setCanReceiveInput(newState);
+                    rebuildRoutingTable();
                     LocalTether::Utils::Logger::GetInstance().Info("Input for client ID " + std::to_string(clientIdToToggle) + " set to " + (newState ? "ENABLED" : "DISABLED") + " by host.");
                 } else if (sessionToToggle) {
                      LocalTether::Utils::Logger::GetInstance().Warning("Toggle input: Client ID " + std::to_string(clientIdToToggle) + " is not a Receiver. Action denied.");
@@ -888,6 +1426,35 @@ void Server::notifyClientJoined(std::shared_ptr<Session> session) {
     session->send(clientListMsg);
 }
 
+void Server::announceReceiverScreens(std::shared_ptr<Session> joined) {
+    // Hosts place receivers on their desktop layout by name and need each one's resolution:
+    // a joining host learns every receiver, a joining receiver is announced to every host.
+    auto describe = [](const std::shared_ptr<Session>& receiver) {
+        return Message::createCommand(
+            "receiver_screen:" + std::to_string(receiver->getClientId()) + ":" +
+            std::to_string(receiver->getScreenWidth()) + ":" + std::to_string(receiver->getScreenHeight()) + ":" +
+            receiver->getClientName(),
+            0);
+    };
+    auto isReceiver = [](const std::shared_ptr<Session>& s) {
+        return s->getRole() == ClientRole::Receiver || s->getRole() == ClientRole::Broadcaster;
+    };
+
+    std::vector<std::shared_ptr<Session>> currentSessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        currentSessions = sessions_;
+    }
+    for (const auto& s : currentSessions) {
+        if (!s || s == joined || !s->isAppHandshakeComplete()) continue;
+        if (joined->getRole() == ClientRole::Host && isReceiver(s)) {
+            joined->send(describe(s));
+        } else if (isReceiver(joined) && s->getRole() == ClientRole::Host) {
+            s->send(describe(joined));
+        }
+    }
+}
+
 void Server::notifyClientLeft(std::shared_ptr<Session> session) {
     if (!session) return;
     auto leftMsg = Message::createCommand(
@@ -910,6 +1477,7 @@ ServerState Server::getState() const {
 }
  void Server::setState(ServerState newState, const std::optional<std::error_code>& ec) {
      state_ = newState;
+     LocalTether::Utils::UiWake::notify();
      if (ec && ec.value()) {
          lastError_ = ec.value().message();
          LocalTether::Utils::Logger::GetInstance().Error("Server state changed to Error: " + lastError_);
@@ -0,0 +1,108 @@
+#include "network/ServerDaemon.h"
+#include "network/Server.h"
+#include "network/Session.h"
+#include "storage/LocalFileStore.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include <csignal>
+#include <future>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+namespace LocalTether::Network {
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " --server [--port <n>] [--password <p>] [--storage <dir>] [--public]" << std::endl;
+    }
+}
+
+int runServerMode(int argc, char** argv) {
+    auto& config = Utils::Config::GetInstance();
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) config.Set<int>(std::string(Utils::ConfigKeys::ServerPort.name), atoi(argv[++i]));
+        else if (arg == "--password" && i + 1 < argc) config.Set<std::string>(std::string(Utils::ConfigKeys::ServerPassword.name), argv[++i]);
+        else if (arg == "--storage" && i + 1 < argc) config.Set<std::string>(std::string(Utils::ConfigKeys::StorageRoot.name), argv[++i]);
+        else if (arg == "--public") config.Set<bool>(std::string(Utils::ConfigKeys::ServerLocalOnly.name), false);
+        else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+
+    int port = config.Get(Utils::ConfigKeys::ServerPort);
+    if (port <= 0 || port > 65535) {
+        std::cerr << "Invalid port: " << port << std::endl;
+        return 2;
+    }
+
+    auto& logger = Utils::Logger::GetInstance();
+    logger.Info("--- Headless server starting ---");
+    if (OPENSSL_init_ssl(OPENSSL_INIT_LOAD_SSL_STRINGS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS, NULL) == 0) {
+        logger.Critical("Failed to initialize OpenSSL library.");
+        return 1;
+    }
+
+    asio::io_context io_context;
+    auto work = asio::make_work_guard(io_context);
+    std::thread io_thread([&io_context]() {
+        try {
+            io_context.run();
+        } catch (const std::exception& e) {
+            Utils::Logger::GetInstance().Critical("Headless server io_context exception: " + std::string(e.what()));
+        }
+    });
+
+    int exitCode = 0;
+    {
+        Server server(io_context, static_cast<uint16_t>(port));
+        server.localNetworkOnly = config.Get(Utils::ConfigKeys::ServerLocalOnly);
+        server.password = config.Get(Utils::ConfigKeys::ServerPassword);
+        server.setErrorHandler([](const std::error_code& error) {
+            Utils::Logger::GetInstance().Error("Server runtime error: " + error.message());
+        });
+        server.setConnectionHandler([](std::shared_ptr<Session> session) {
+            Utils::Logger::GetInstance().Info("Client connected: " + session->getClientAddress());
+        });
+        server.start();
+
+        if (server.getState() == ServerState::Error) {
+            logger.Critical("Headless server failed to start: " + server.getErrorMessage());
+            exitCode = 1;
+        } else {
+            Utils::MetricsRegistry::GetInstance().startPeriodicDump();
+            config.StartWatching();
+            logger.Info("Headless server listening on port " + std::to_string(port) + ", storage at " +
+                        server.getStorage().root().string() + (server.localNetworkOnly ? " (local network only)." : "."));
+
+            // The signal arrives on the io thread; shutdown happens back here once it has.
+            std::promise<void> stopRequested;
+            asio::signal_set signals(io_context, SIGINT, SIGTERM);
+            signals.async_wait([&stopRequested](const std::error_code& ec, int signalNumber) {
+                if (!ec) {
+                    Utils::Logger::GetInstance().Info("Headless server: signal " + std::to_string(signalNumber) + " received, shutting down.");
+                }
+                stopRequested.set_value();
+            });
+            stopRequested.get_future().wait();
+
+            server.stop();
+            Utils::MetricsRegistry::GetInstance().stopPeriodicDump();
+            config.StopWatching();
+        }
+    }
+
+    work.reset();
+    io_context.stop();
+    if (io_thread.joinable()) {
+        io_thread.join();
+    }
+    logger.Info("--- Headless server exited ---");
+    return exitCode;
+}
+
+}
@@ -1,10 +1,33 @@
  
 #include "network/Session.h"
 #include "network/Server.h"  
+#include "network/NetworkMetrics.h"
 #include "utils/Logger.h"
+#include "utils/Config.h"
+
+#include <algorithm>
 
 namespace LocalTether::Network {
 
+namespace {
+    constexpr size_t MAPPED_BODY_CHUNK_SIZE = 256 * 1024;
+
+    // Messages whose handling queues work on the server's transfer pool.
+    bool queuesTransferWork(MessageType type) {
+        switch (type) {
+            case MessageType::FileUpload:
+            case MessageType::FileRequest:
+            case MessageType::FileDeltaRequest:
+            case MessageType::FileDeltaUpload:
+            case MessageType::FileBatchRequest:
+            case MessageType::Compressed:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
 Session::Session(asio::ip::tcp::socket tcp_socket, Server* server, uint32_t clientId, asio::ssl::context& ssl_context)
     : socket_(std::move(tcp_socket), ssl_context),  
       server_(server),
@@ -101,10 +124,39 @@ void Session::send(const Message& message) {
           
     }
 
-    auto serialized_data = message.serialize();  
+    auto bytes = message.serialize();
+    NetworkMetrics::countSent(message.getType(), bytes.size());
+    enqueueWrite(OutgoingBuffer{std::move(bytes), nullptr});
+}
+
+void Session::sendWithMappedBody(const Message& prefixMessage, std::shared_ptr<const LocalTether::Utils::MappedFile> mappedBody) {
+    if (!active_.load(std::memory_order_relaxed)) {
+        LocalTether::Utils::Logger::GetInstance().Warning(
+            "Attempted to send message on inactive session for Client ID " + std::to_string(clientId_));
+        return;
+    }
+    const uint64_t trailerLength = mappedBody ? mappedBody->size() : 0;
+    NetworkMetrics::countSent(prefixMessage.getType(), Message::HEADER_LENGTH + prefixMessage.getBodySize() + trailerLength);
+    enqueueWrite(OutgoingBuffer{prefixMessage.serializeWithTrailer(trailerLength), std::move(mappedBody)});
+}
+
+void Session::whenWritesDrained(std::function<void()> callback) {
+    asio::post(socket_.get_executor(), [self = shared_from_this(), callback = std::move(callback)]() mutable {
+        if (!self->active_.load(std::memory_order_relaxed)) return;
+        {
+            std::lock_guard<std::mutex> lock(self->writeMutex_);
+            if (!self->writeQueue_.empty() || self->writing_.load(std::memory_order_relaxed)) {
+                self->drainedCallbacks_.push_back(std::move(callback));
+                return;
+            }
+        }
+        callback();
+    });
+}
 
+void Session::enqueueWrite(OutgoingBuffer buffer) {
     auto self = shared_from_this();
-    asio::post(socket_.get_executor(), [self, data = std::move(serialized_data)]() {
+    asio::post(socket_.get_executor(), [self, data = std::move(buffer)]() mutable {
         if (!self->active_.load(std::memory_order_relaxed)) return;
 
         bool should_start_write = false;
@@ -112,6 +164,14 @@ void Session::send(const Message& message) {
             std::lock_guard<std::mutex> lock(self->writeMutex_);
             should_start_write = self->writeQueue_.empty() && !self->writing_.load(std::memory_order_relaxed);
             self->writeQueue_.push(std::move(data));
+            self->writeQueueDepth_.store(self->writeQueue_.size(), std::memory_order_relaxed);
+            size_t highWatermark = LocalTether::Utils::Config::Live().writeQueueHighWatermark;
+            if (highWatermark > 0 && !self->writeQueueBacklogged_ && self->writeQueue_.size() >= highWatermark) {
+                self->writeQueueBacklogged_ = true;
+                LocalTether::Utils::Logger::GetInstance().Warning(
+                    "Client ID " + std::to_string(self->clientId_) + " is not keeping up: " +
+                    std::to_string(self->writeQueue_.size()) + " messages queued.");
+            }
         }
 
         if (should_start_write) {
@@ -126,7 +186,7 @@ void Session::doWrite() {
         return;
     }
 
-    std::shared_ptr<std::vector<uint8_t>> data_to_send_ptr; 
+    std::shared_ptr<OutgoingBuffer> data_to_send_ptr; 
     {
         std::lock_guard<std::mutex> lock(writeMutex_);
         if (writeQueue_.empty()) {
@@ -135,23 +195,62 @@ void Session::doWrite() {
         }
         writing_ = true;
         
-        data_to_send_ptr = std::make_shared<std::vector<uint8_t>>(std::move(writeQueue_.front()));
+        data_to_send_ptr = std::make_shared<OutgoingBuffer>(std::move(writeQueue_.front()));
         
     }
 
     auto self = shared_from_this();
     
-    
-    asio::async_write(socket_, asio::buffer(*data_to_send_ptr),
+    linkThroughput_.writeStarted();
+    if (data_to_send_ptr->mappedBody && data_to_send_ptr->mappedBody->size() > 0) {
+        writeMappedBody(std::move(data_to_send_ptr), 0);
+        return;
+    }
+    asio::async_write(socket_, asio::buffer(data_to_send_ptr->bytes),
         [this, self, data_to_send_ptr](const std::error_code& error, size_t bytes_transferred) {
             
             handleWrite(error, bytes_transferred);
         });
 }
 
-void Session::handleWrite(const std::error_code& error, size_t /*bytes_transferred*/) {
-     
+// The body is copied out of the mapping rather than handed to the socket, so a file truncated
+// mid-send is noticed before a zero-filled chunk goes out. The frame's length is already on the
+// wire by then, so the only honest way out is to drop the connection.
+void Session::writeMappedBody(std::shared_ptr<OutgoingBuffer> data, size_t offset) {
+    const auto& body = *data->mappedBody;
+    const size_t length = std::min(MAPPED_BODY_CHUNK_SIZE, body.size() - offset);
+
+    mappedChunk_.clear();
+    if (offset == 0) {
+        mappedChunk_.assign(data->bytes.begin(), data->bytes.end());
+    }
+    const size_t prefixLength = mappedChunk_.size();
+    mappedChunk_.resize(prefixLength + length);
+    if (!body.copyTo(offset, length, reinterpret_cast<char*>(mappedChunk_.data() + prefixLength))) {
+        LocalTether::Utils::Logger::GetInstance().Error(
+            "Session: '" + body.path() + "' was truncated while being sent to Client ID " + std::to_string(clientId_) + ", closing the connection.");
+        doClose("file truncated during send");
+        return;
+    }
+
+    auto self = shared_from_this();
+    asio::async_write(socket_, asio::buffer(mappedChunk_),
+        [this, self, data, next = offset + length](const std::error_code& error, size_t) {
+            if (!error && next < data->mappedBody->size()) {
+                writeMappedBody(data, next);
+                return;
+            }
+            handleWrite(error, data->bytes.size() + data->mappedBody->size());
+        });
+}
+
+void Session::handleWrite(const std::error_code& error, size_t bytes_transferred) {
+    if (!error) {
+        linkThroughput_.writeCompleted(bytes_transferred);
+        bytesSent_.fetch_add(bytes_transferred, std::memory_order_relaxed);
+    }
     bool should_continue_writing = false;
+    std::vector<std::function<void()>> drained;
     {
         std::lock_guard<std::mutex> lock(writeMutex_);
         
@@ -160,12 +259,17 @@ void Session::handleWrite(const std::error_code& error, size_t /*bytes_transferr
         if (!writeQueue_.empty()) {  
              writeQueue_.pop();  
         }
+        writeQueueDepth_.store(writeQueue_.size(), std::memory_order_relaxed);
+        if (writeQueueBacklogged_ && writeQueue_.size() <= LocalTether::Utils::Config::Live().writeQueueHighWatermark / 2) {
+            writeQueueBacklogged_ = false;
+        }
 
         if (!error) {
             if (!writeQueue_.empty()) {
                 should_continue_writing = true;  
             } else {
                 writing_ = false;  
+                drained.swap(drainedCallbacks_);
             }
         } else {
             writing_ = false;  
@@ -174,6 +278,10 @@ void Session::handleWrite(const std::error_code& error, size_t /*bytes_transferr
         }
     }  
 
+    for (auto& callback : drained) {
+        callback();
+    }
+
     if (!error && should_continue_writing) {
         if (active_.load(std::memory_order_relaxed)) {  
              doWrite();
@@ -185,6 +293,24 @@ void Session::handleWrite(const std::error_code& error, size_t /*bytes_transferr
     }
 }
 
+void Session::setTransferThrottle(std::weak_ptr<LocalTether::Utils::WorkerPool> pool) {
+    transferThrottle_ = std::move(pool);
+}
+
+// Like the client's file writer, a saturated pool stops the reader instead of buffering without
+// limit. Only messages that feed the pool pause, so input relayed by other sessions keeps flowing.
+void Session::readNext(MessageType handledType) {
+    if (!active_.load()) return;
+    auto pool = transferThrottle_.lock();
+    if (pool && queuesTransferWork(handledType) && pool->saturated()) {
+        pool->whenBelowLimit([self = shared_from_this()]() {
+            asio::post(self->socket_.get_executor(), [self]() { self->doRead(); });
+        });
+        return;
+    }
+    doRead();
+}
+
 void Session::doRead() {
     if (!active_.load()) return;
 
@@ -203,9 +329,11 @@ void Session::handleReadHeader(const std::error_code& error, size_t bytes_transf
 
     if (!error && bytes_transferred == Message::HEADER_LENGTH) {
         currentReadMessage_.decodeHeader(reinterpret_cast<const uint8_t*>(readBuffer_.data()),readBuffer_.size());  
-        LocalTether::Utils::Logger::GetInstance().Trace(
-            "Client ID " + std::to_string(clientId_) + " received header. Type: " +
-            Message::messageTypeToString(currentReadMessage_.getType()) + ", Body Size: " + std::to_string(currentReadMessage_.getBodySize()));
+        // Counted once the header is in; the body adds to the session total when it arrives.
+        bytesReceived_.fetch_add(bytes_transferred, std::memory_order_relaxed);
+        NetworkMetrics::countReceived(currentReadMessage_.getType(), Message::HEADER_LENGTH + currentReadMessage_.getBodySize());
+        LT_LOG_TRACE("Client ID {} received header. Type: {}, Body Size: {}", clientId_,
+                     Message::messageTypeToString(currentReadMessage_.getType()), currentReadMessage_.getBodySize());
 
         if (currentReadMessage_.getBodySize() > 0) {
             if (currentReadMessage_.getBodySize() > Message::MAX_BODY_LENGTH) {  
@@ -259,9 +387,10 @@ void Session::handleReadBody(const std::error_code& error, size_t bytes_transfer
     if (!active_.load()) return;
 
     if (!error && bytes_transferred == currentReadMessage_.getBodySize()) {
+        bytesReceived_.fetch_add(bytes_transferred, std::memory_order_relaxed);
         currentReadMessage_.setBody(reinterpret_cast<const uint8_t*>(readBuffer_.data()), currentReadMessage_.getBodySize());
-        LocalTether::Utils::Logger::GetInstance().Trace(
-            "Client ID " + std::to_string(clientId_) + " received body for type: " + Message::messageTypeToString(currentReadMessage_.getType()));
+        LT_LOG_TRACE("Client ID {} received body for type: {}", clientId_,
+                     Message::messageTypeToString(currentReadMessage_.getType()));
 
          
         if (sslHandshakeComplete_.load() && !appHandshakeComplete_.load() && currentReadMessage_.getType() == MessageType::Handshake) {
@@ -279,7 +408,7 @@ void Session::handleReadBody(const std::error_code& error, size_t bytes_transfer
              if (messageHandler_) {
                  messageHandler_(shared_from_this(), currentReadMessage_);
              }
-             if (active_.load()) doRead();  
+             readNext(currentReadMessage_.getType());
         } else {
              LocalTether::Utils::Logger::GetInstance().Warning(
                  "Client ID " + std::to_string(clientId_) + " received non-handshake message or unexpected state (body).");
@@ -351,8 +480,10 @@ void Session::doClose(const std::string& reason) {
      
     {
         std::lock_guard<std::mutex> lock(writeMutex_);
-        std::queue<std::vector<uint8_t>> emptyQueue;
+        std::queue<OutgoingBuffer> emptyQueue;
         std::swap(writeQueue_, emptyQueue);
+        drainedCallbacks_.clear();
+        writeQueueDepth_.store(0, std::memory_order_relaxed);
         writing_ = false;
     }
     appHandshakeComplete_.store(false);
@@ -0,0 +1,193 @@
+#include "storage/LocalFileStore.h"
+#include "utils/AtomicFile.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+#include "utils/Paths.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace LocalTether::Storage {
+
+namespace {
+    void scanDirectory(const fs::path& dirPath, const fs::path& canonicalRoot, FileMetadata& parentNode) {
+        parentNode.children.clear();
+        try {
+            if (!fs::exists(dirPath) || !fs::is_directory(dirPath)) {
+                Utils::Logger::GetInstance().Warning("Storage: Path does not exist or is not a directory: " + dirPath.string());
+                return;
+            }
+
+            for (const auto& entry : fs::directory_iterator(dirPath)) {
+                // In-flight uploads are not part of the tree until they are renamed into place.
+                if (Utils::isAtomicTempFile(entry.path().filename().string())) {
+                    continue;
+                }
+                FileMetadata meta;
+                meta.name = entry.path().filename().string();
+                meta.fullPath = entry.path().string();
+
+                try {
+                    fs::path canonicalEntry = fs::weakly_canonical(entry.path());
+                    if (Utils::isPathWithin(canonicalEntry, canonicalRoot)) {
+                        meta.relativePath = fs::relative(canonicalEntry, canonicalRoot).generic_string();
+                    } else {
+                        Utils::Logger::GetInstance().Warning("Path " + canonicalEntry.string() + " is not relative to root " + canonicalRoot.string() + ". Using filename as relative path.");
+                        meta.relativePath = meta.name;
+                    }
+                } catch (const fs::filesystem_error& e) {
+                    Utils::Logger::GetInstance().Error("Error getting relative path for " + entry.path().string() + " against " + canonicalRoot.string() + ": " + e.what());
+                    meta.relativePath = meta.name;
+                }
+
+                meta.isDirectory = entry.is_directory();
+
+                try {
+                    meta.size = meta.isDirectory ? 0 : fs::file_size(entry.path());
+                    auto ftime = fs::last_write_time(entry.path());
+                    meta.modifiedTime = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+                        ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+                } catch (const fs::filesystem_error& e) {
+                    Utils::Logger::GetInstance().Warning("Could not get metadata for " + meta.fullPath + ": " + e.what());
+                    meta.size = 0;
+                    meta.modifiedTime = std::chrono::system_clock::now();
+                }
+
+                if (meta.isDirectory) {
+                    scanDirectory(entry.path(), canonicalRoot, meta);
+                }
+                parentNode.children.push_back(std::move(meta));
+            }
+        } catch (const fs::filesystem_error& e) {
+            Utils::Logger::GetInstance().Error("Filesystem error iterating directory " + dirPath.string() + ": " + std::string(e.what()));
+            return;
+        }
+
+        std::sort(parentNode.children.begin(), parentNode.children.end(), [](const FileMetadata& a, const FileMetadata& b) {
+            if (a.isDirectory != b.isDirectory) return a.isDirectory > b.isDirectory;
+            return a.name < b.name;
+        });
+    }
+}
+
+LocalFileStore::LocalFileStore(fs::path root) : root_(std::move(root)) {
+    try {
+        if (!fs::exists(root_)) {
+            fs::create_directories(root_);
+            Utils::Logger::GetInstance().Info("Storage: Created storage directory: " + root_.string());
+        } else {
+            Utils::Logger::GetInstance().Info("Storage: Using existing storage directory: " + root_.string());
+        }
+    } catch (const fs::filesystem_error& e) {
+        Utils::Logger::GetInstance().Error("Storage: Failed to create storage directory " + root_.string() + ": " + e.what());
+    }
+    canonicalRoot_ = fs::weakly_canonical(root_);
+    // No listener can be attached yet, so the first scan is silent.
+    rescan();
+}
+
+fs::path LocalFileStore::defaultRoot() {
+    std::string configured = Utils::Config::GetInstance().Get(Utils::ConfigKeys::StorageRoot);
+    if (!configured.empty()) {
+        return fs::path(configured);
+    }
+    return Utils::dataDirectory() / "server_storage";
+}
+
+FileMetadata LocalFileStore::scanTree(const fs::path& root) {
+    FileMetadata rootNode;
+    rootNode.name = "Storage Root";
+    rootNode.fullPath = root.string();
+    rootNode.relativePath = "";
+    rootNode.isDirectory = true;
+    try {
+        scanDirectory(root, fs::weakly_canonical(root), rootNode);
+    } catch (const fs::filesystem_error& e) {
+        Utils::Logger::GetInstance().Error("Filesystem error during refresh: " + std::string(e.what()));
+    }
+    return rootNode;
+}
+
+bool LocalFileStore::resolve(const std::string& relativePath, fs::path& resolvedPath) const {
+    fs::path canonicalPath = fs::weakly_canonical(root_ / relativePath);
+    if (!Utils::isPathWithin(canonicalPath, canonicalRoot_)) {
+        return false;
+    }
+    resolvedPath = canonicalPath;
+    return true;
+}
+
+bool LocalFileStore::resolveFile(const std::string& relativeDir, const std::string& fileName,
+                                 fs::path& resolvedPath) const {
+    fs::path name(fileName);
+    if (fileName.empty() || fileName == "." || fileName == ".." || name.has_root_path() || name.has_parent_path() ||
+        fileName.find_first_of("/\\") != std::string::npos) {
+        return false;
+    }
+    fs::path targetDir;
+    if (!resolve(relativeDir, targetDir)) {
+        return false;
+    }
+    fs::path destinationPath;
+    if (!resolve((fs::path(relativeDir) / name).string(), destinationPath) || destinationPath.parent_path() != targetDir) {
+        return false;
+    }
+    resolvedPath = destinationPath;
+    return true;
+}
+
+bool LocalFileStore::writeFile(const std::string& relativeDir, const std::string& fileName,
+                               const char* data, size_t size, std::string* error) {
+    fs::path targetDir;
+    if (!resolve(relativeDir, targetDir)) {
+        if (error) *error = "path is outside the storage root";
+        return false;
+    }
+    fs::path destinationPath;
+    if (!resolveFile(relativeDir, fileName, destinationPath)) {
+        if (error) *error = "file name escapes the target directory";
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(targetDir, ec);
+    if (ec) {
+        if (error) *error = "cannot create " + targetDir.string() + ": " + ec.message();
+        return false;
+    }
+
+    // The tree is only rebuilt once the new contents are fully in place.
+    if (!Utils::AtomicFileWriter::writeFile(destinationPath, data, size, Utils::durabilityPolicyFromConfig(), error)) {
+        return false;
+    }
+    rescan();
+    return true;
+}
+
+std::shared_ptr<const FileMetadata> LocalFileStore::tree() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tree_;
+}
+
+void LocalFileStore::rescan() {
+    ChangeListener listener;
+    std::shared_ptr<const FileMetadata> snapshot;
+    {
+        std::lock_guard<std::mutex> scanLock(scanMutex_);
+        snapshot = std::make_shared<const FileMetadata>(scanTree(root_));
+        std::lock_guard<std::mutex> lock(mutex_);
+        tree_ = snapshot;
+        listener = listener_;
+        version_.fetch_add(1, std::memory_order_release);
+    }
+    if (listener) {
+        listener(snapshot);
+    }
+}
+
+void LocalFileStore::setChangeListener(ChangeListener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listener_ = std::move(listener);
+}
+
+}
@@ -89,6 +89,7 @@ namespace LocalTether::UI {
             ImGui::DockBuilderDockWindow("Initializing Server", dock_main_id);
 
             ImGui::DockBuilderDockWindow("Session Controls", dock_right_bottom_id);
+            ImGui::DockBuilderDockWindow("Metrics", dock_right_bottom_id);
 
             ImGui::DockBuilderFinish(dockspace_id);
         }
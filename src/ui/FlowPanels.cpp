@@ -1,9 +1,11 @@
 #include "ui/FlowPanels.h"
 #include "ui/UIState.h"
 #include "utils/Logger.h"
+#include "utils/StartupProgress.h"
 #include "ui/panels/ConsolePanel.h"
 #include "ui/panels/FileExplorerPanel.h"
 #include "ui/panels/ControlsPanel.h"
+#include "ui/panels/MetricsPanel.h"
 #include "utils/ScanNetwork.h"
 #include "network/Message.h"
 #include "network/Server.h" 
@@ -95,8 +97,24 @@ namespace LocalTether::UI::Flow {
         ImGui::Begin("Initializing Server", nullptr, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoScrollbar);
         
         ImGui::Spacing();
-        CenterText("Initializing server and generating SSL assets...");
+        CenterText("Starting server...");
         ImGui::Spacing();
+
+        auto& progress = LocalTether::Utils::StartupProgress::GetInstance();
+        for (size_t i = 0; i < LocalTether::Utils::STARTUP_STAGE_COUNT; ++i) {
+            auto stage = static_cast<LocalTether::Utils::StartupStage>(i);
+            auto state = progress.state(stage);
+            const char* status = "waiting";
+            switch (state.status) {
+                case LocalTether::Utils::StageStatus::Pending: status = "waiting"; break;
+                case LocalTether::Utils::StageStatus::Running: status = "running"; break;
+                case LocalTether::Utils::StageStatus::Done: status = "done"; break;
+                case LocalTether::Utils::StageStatus::Failed: status = "failed"; break;
+            }
+            std::string line = std::string(LocalTether::Utils::StartupProgress::stageName(stage)) + ": " + status +
+                               " (" + std::to_string(state.elapsedMs) + " ms)";
+            CenterText(line.c_str());
+        }
         ImGui::Spacing();
 
         static float angle = 0.0f;
@@ -462,16 +480,23 @@ namespace LocalTether::UI::Flow {
         static LocalTether::UI::Panels::ControlsPanel instance;
         return instance;
     }
+
+    LocalTether::UI::Panels::MetricsPanel& GetMetricsPanelInstance() {
+        static LocalTether::UI::Panels::MetricsPanel instance;
+        return instance;
+    }
  
     void ShowHostDashboard() {
         GetConsolePanelInstance().Show(&LocalTether::UI::show_console);  
         GetFileExplorerPanelInstance().Show(&LocalTether::UI::show_file_explorer);  
         GetControlsPanelInstance().Show(&LocalTether::UI::show_controls_panel);
+        GetMetricsPanelInstance().Show(&LocalTether::UI::show_metrics_panel);
     }
 
     void ShowClientDashboard() {
         GetConsolePanelInstance().Show(&LocalTether::UI::show_console);  
         GetFileExplorerPanelInstance().Show(&LocalTether::UI::show_file_explorer);  
         GetControlsPanelInstance().Show(&LocalTether::UI::show_controls_panel);
+        GetMetricsPanelInstance().Show(&LocalTether::UI::show_metrics_panel);
     }
 }
\ No newline at end of file
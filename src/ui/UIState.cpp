@@ -16,6 +16,7 @@ namespace LocalTether::UI {
     bool show_console = true;
     bool show_properties = true;
     bool show_controls_panel = true;
+    bool show_metrics_panel = true;
 
     std::atomic<bool> server_setup_in_progress{false};
     std::atomic<bool> server_setup_success{false};
@@ -1,7 +1,11 @@
 #include "ui/panels/ConsolePanel.h"
 #include <ctime>
 #include <cstring>
+#include <sstream>
 #include "utils/Logger.h"
+#include "utils/Metrics.h"
+#include "ui/UIState.h"
+#include "network/Client.h"
 namespace LocalTether::UI::Panels {
 
     
@@ -58,49 +62,29 @@ namespace LocalTether::UI::Panels {
                          ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_AlwaysVerticalScrollbar);
         
         ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 1)); 
-        
-         
-        std::vector<std::string> logs_from_logger = LocalTether::Utils::Logger::GetInstance().GetLogs();
-   
-        for (const auto& item : logs_from_logger) {  
-            ImVec4 color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);  
-          
-             
-            if (item.find("[ERROR]") != std::string::npos || item.find("[CRITICAL]") != std::string::npos)
-                color = ImVec4(1.0f, 0.4f, 0.4f, 1.0f);
-            else if (item.find("[WARNING]") != std::string::npos)
-                color = ImVec4(1.0f, 0.8f, 0.2f, 1.0f);
-            else if (item.find("[DEBUG]") != std::string::npos)
-                color = ImVec4(0.5f, 0.5f, 0.5f, 1.0f);  
-             
-             
-            size_t prompt_pos = item.find("> ");
-            if (prompt_pos != std::string::npos) {
-                  
-                 size_t level_end_pos = item.find("] ");
-                 if (level_end_pos != std::string::npos) {
-                     level_end_pos = item.find("] ", level_end_pos + 1);  
-                     if (level_end_pos != std::string::npos && prompt_pos > level_end_pos) {
-                        color = ImVec4(0.4f, 0.8f, 1.0f, 1.0f);  
-                     }
-                 }
+
+        // Follow new output only while the view is already at the bottom.
+        bool atBottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - 10.0f;
+        if (FetchNewLines() > 0 && atBottom) {
+            scrollToBottom_ = true;
+        }
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(lines_.size()));
+        while (clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const Line& line = lines_[static_cast<size_t>(i)];
+                ImGui::PushStyleColor(ImGuiCol_Text, line.color);
+                ImGui::TextUnformatted(line.text.c_str(), line.text.c_str() + line.text.size());
+                ImGui::PopStyleColor();
             }
-            
-            ImGui::PushStyleColor(ImGuiCol_Text, color);
-            ImGui::TextUnformatted(item.c_str());
-            ImGui::PopStyleColor();
         }
-        
-         
-        static size_t last_log_count = 0;
-        if (logs_from_logger.size() > last_log_count || ImGui::GetScrollY() >= ImGui::GetScrollMaxY() - 10.0f) {
-             if (logs_from_logger.size() != last_log_count && ImGui::GetScrollY() < ImGui::GetScrollMaxY() -10.0f) {
-                 
-             } else {
-                ImGui::SetScrollHereY(1.0f);
-             }
+        clipper.End();
+
+        if (scrollToBottom_) {
+            ImGui::SetScrollHereY(1.0f);
+            scrollToBottom_ = false;
         }
-        last_log_count = logs_from_logger.size();
 
         
         ImGui::PopStyleVar();
@@ -109,7 +93,44 @@ namespace LocalTether::UI::Panels {
         ImGui::End();
     }
     
+    size_t ConsolePanel::FetchNewLines() {
+        fetched_.clear();
+        nextSequence_ = LocalTether::Utils::Logger::GetInstance().GetLogsSince(nextSequence_, fetched_);
+        for (auto& entry : fetched_) {
+            ImVec4 color = ImVec4(1.0f, 1.0f, 1.0f, 1.0f);
+            switch (entry.level) {
+                case LocalTether::Utils::LogLevel::Error:
+                case LocalTether::Utils::LogLevel::Critical:
+                    color = ImVec4(1.0f, 0.4f, 0.4f, 1.0f);
+                    break;
+                case LocalTether::Utils::LogLevel::Warning:
+                    color = ImVec4(1.0f, 0.8f, 0.2f, 1.0f);
+                    break;
+                case LocalTether::Utils::LogLevel::Debug:
+                case LocalTether::Utils::LogLevel::Trace:
+                    color = ImVec4(0.5f, 0.5f, 0.5f, 1.0f);
+                    break;
+                default:
+                    break;
+            }
+            // Echoed console commands: "[time] [INFO] > command".
+            size_t levelEnd = entry.text.find("] ");
+            if (levelEnd != std::string::npos) {
+                levelEnd = entry.text.find("] ", levelEnd + 1);
+                if (levelEnd != std::string::npos && entry.text.compare(levelEnd + 2, 2, "> ") == 0) {
+                    color = ImVec4(0.4f, 0.8f, 1.0f, 1.0f);
+                }
+            }
+            lines_.push_back({std::move(entry.text), color});
+        }
+        while (lines_.size() > MAX_LINES) {
+            lines_.pop_front();
+        }
+        return fetched_.size();
+    }
+    
    void ConsolePanel::Clear() {
+        lines_.clear();
         LocalTether::Utils::Logger::GetInstance().Clear();  
          
         LocalTether::Utils::Logger::GetInstance().Info("Console view cleared by user.");
@@ -118,7 +139,7 @@ namespace LocalTether::UI::Panels {
     void ConsolePanel::ProcessCommand(const std::string& command) {
          
         if (command == "help") {
-            LocalTether::Utils::Logger::GetInstance().Info("Available commands: help, clear, exit, version, info");
+            LocalTether::Utils::Logger::GetInstance().Info("Available commands: help, clear, exit, version, info, stats");
         }
         else if (command == "clear") {
              
@@ -135,6 +156,22 @@ namespace LocalTether::UI::Panels {
             LocalTether::Utils::Logger::GetInstance().Info("Running on ImGui " IMGUI_VERSION);
              
         }
+        else if (command == "stats") {
+            // A connected host asks the server, which answers with its own registry. Otherwise show ours.
+            auto& client = LocalTether::UI::getClient();
+            if (client.getState() == LocalTether::Network::ClientState::Connected &&
+                client.getRole() == LocalTether::Network::ClientRole::Host) {
+                client.sendCommand("stats");
+            } else {
+                std::istringstream lines(LocalTether::Utils::MetricsRegistry::GetInstance().renderPrometheus());
+                std::string line;
+                while (std::getline(lines, line)) {
+                    if (!line.empty() && line[0] != '#') {
+                        LocalTether::Utils::Logger::GetInstance().Info("  " + line);
+                    }
+                }
+            }
+        }
         else {
             LocalTether::Utils::Logger::GetInstance().Warning("Unknown command: " + command);
         }
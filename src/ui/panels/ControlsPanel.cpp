@@ -9,6 +9,7 @@
 #include "input/InputManager.h"      
 #include "utils/Config.h"            
 #include "utils/KeycodeConverter.h"  
+#include "utils/LatencyStats.h"
 
 #include <cstdio>  
 #include <cstring>  
@@ -142,15 +143,18 @@ void ControlsPanel::ShowHostControls() {
     auto& host_client_for_commands = LocalTether::UI::getClient();
 
     ImGui::Text("Connected Clients:");
-    if (ImGui::BeginTable("ClientsTable", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp)) {
+    if (ImGui::BeginTable("ClientsTable", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingStretchProp)) {
         ImGui::TableSetupColumn("ID", ImGuiTableColumnFlags_WidthFixed, 40.0f);
         ImGui::TableSetupColumn("Name");
         ImGui::TableSetupColumn("Role");
         ImGui::TableSetupColumn("Input");
+        ImGui::TableSetupColumn("Driven By");
         ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 200.0f);
         ImGui::TableHeadersRow();
 
         std::vector<std::shared_ptr<LocalTether::Network::Session>> sessions = server.getSessions();
+        auto routing = server.getRoutingTable();
+        std::vector<uint32_t> inputSources = routing->sources();
 
         for (const auto& session_ptr : sessions) {
             if (!session_ptr || !session_ptr->isAppHandshakeComplete()) continue;
@@ -191,6 +195,25 @@ void ControlsPanel::ShowHostControls() {
             }
 
             ImGui::TableSetColumnIndex(4);
+            if (session_ptr->getRole() == LocalTether::Network::ClientRole::Host) {
+                ImGui::Text(current_client_id == server.getHostClientId() ? "(primary)" : "(source)");
+            } else {
+                uint32_t drivenBy = routing->sourceOf(current_client_id);
+                std::string preview = drivenBy != 0 ? std::to_string(drivenBy) : "-";
+                ImGui::PushItemWidth(-FLT_MIN);
+                if (ImGui::BeginCombo("##DrivenBy", preview.c_str())) {
+                    for (uint32_t source : inputSources) {
+                        std::string label = std::to_string(source);
+                        if (ImGui::Selectable(label.c_str(), source == drivenBy) && source != drivenBy) {
+                            host_client_for_commands.sendCommand("route_set:" + label + ":" + std::to_string(current_client_id));
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+                ImGui::PopItemWidth();
+            }
+
+            ImGui::TableSetColumnIndex(5);
             if (current_client_id != server.getHostClientId()) {
                 if (ImGui::Button(ICON_FA_TIMES " Kick")) {
                     host_client_for_commands.sendCommand("kick_client:" + std::to_string(current_client_id));
@@ -236,6 +259,10 @@ void ControlsPanel::ShowHostControls() {
             ImGui::Text("Input Manager not available for host client.");
         }
     }
+
+    if (ImGui::CollapsingHeader("Input Latency")) {
+        ShowLatencyStats();
+    }
 }
 
 void ControlsPanel::ShowClientControls() {
@@ -255,6 +282,50 @@ void ControlsPanel::ShowClientControls() {
             ImGui::Text("Input Manager not available.");
         }
     }
+
+    if (ImGui::CollapsingHeader("Input Latency")) {
+        ShowLatencyStats();
+    }
+}
+
+void ControlsPanel::ShowLatencyStats() {
+    auto& stats = LocalTether::Utils::LatencyStats::GetInstance();
+    bool tracing = stats.isEnabled();
+    if (ImGui::Checkbox("Trace input latency", &tracing)) {
+        stats.setEnabled(tracing);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset##latency")) {
+        stats.reset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(ICON_FA_SAVE " Export CSV")) {
+        stats.exportCsv("latency_stats.csv");
+    }
+    ImGui::TextDisabled("Traces are recorded where input is received; enable tracing on the host and the receivers.");
+
+    if (ImGui::BeginTable("latency_table", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("p50 (us)");
+        ImGui::TableSetupColumn("p90 (us)");
+        ImGui::TableSetupColumn("p99 (us)");
+        ImGui::TableSetupColumn("Max (us)");
+        ImGui::TableSetupColumn("Mean (us)");
+        ImGui::TableHeadersRow();
+        for (const auto& row : stats.summaries()) {
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(row.name.c_str());
+            ImGui::TableSetColumnIndex(1); ImGui::Text("%llu", static_cast<unsigned long long>(row.count));
+            if (row.count == 0) continue;
+            ImGui::TableSetColumnIndex(2); ImGui::Text("%llu", static_cast<unsigned long long>(row.p50Us));
+            ImGui::TableSetColumnIndex(3); ImGui::Text("%llu", static_cast<unsigned long long>(row.p90Us));
+            ImGui::TableSetColumnIndex(4); ImGui::Text("%llu", static_cast<unsigned long long>(row.p99Us));
+            ImGui::TableSetColumnIndex(5); ImGui::Text("%llu", static_cast<unsigned long long>(row.maxUs));
+            ImGui::TableSetColumnIndex(6); ImGui::Text("%.1f", row.meanUs);
+        }
+        ImGui::EndTable();
+    }
 }
 
 
@@ -7,6 +7,8 @@
 #include "network/Server.h"
 #include "ui/UIState.h"      
 #include "network/Message.h" 
+#include "utils/Paths.h"
+#include "storage/LocalFileStore.h"
 
 #include <iomanip>
 #include <sstream>
@@ -28,64 +30,20 @@ namespace fs = std::filesystem;
 namespace LocalTether::UI::Panels {
 
 
-    std::filesystem::path get_executable_directory() {
-        std::filesystem::path exe_path;
-#ifdef _WIN32
-        wchar_t path_buf[MAX_PATH] = {0};  
-        GetModuleFileNameW(NULL, path_buf, MAX_PATH);
-        exe_path = path_buf;  
-#elif defined(__linux__)
-        char result[PATH_MAX];
-        ssize_t count = readlink("/proc/self/exe", result, PATH_MAX);
-        if (count != -1) {
-            exe_path = std::string(result, (size_t)count);
-        }
-#elif defined(__APPLE__)
-        char path_buf[PATH_MAX];
-        uint32_t bufsize = PATH_MAX;
-        if (_NSGetExecutablePath(path_buf, &bufsize) == 0) {
-            exe_path = path_buf;
-        }
-#endif
-        if (!exe_path.empty()) {
-            return exe_path.parent_path();
-        }
-         
-        Utils::Logger::GetInstance().Error("Could not determine executable directory. Falling back to current_path().");
-        return fs::current_path(); 
-    }
-
-    fs::path find_ancestor_directory(const fs::path& start_path, const std::string& target_dir_name, int max_depth) {
-        fs::path current_path = fs::absolute(start_path); 
-        for (int i = 0; i < max_depth && !current_path.empty() && current_path.has_parent_path(); ++i) {
-            if (current_path.filename().string() == target_dir_name) {  
-                return current_path;
+    namespace {
+        // The host's panel is a view onto the running server's store; everyone else only
+        // has the tree the server sends them.
+        Storage::StorageService* hostStorage() {
+            if (!LocalTether::UI::isNetworkInitialized() || LocalTether::UI::getClient().getRole() != LocalTether::Network::ClientRole::Host) {
+                return nullptr;
             }
-            if (current_path.parent_path() == current_path) break; 
-            current_path = current_path.parent_path();
-        }
-        if (!current_path.empty() && current_path.filename().string() == target_dir_name) {
-             return current_path;
+            auto* server = LocalTether::UI::getServerPtr();
+            return server ? &server->getStorage() : nullptr;
         }
-        return "";  
     }
 
     FileExplorerPanel::FileExplorerPanel() {
-        fs::path base_path;
-        fs::path exe_dir = LocalTether::UI::Panels::get_executable_directory();
-        Utils::Logger::GetInstance().Debug("Executable directory: " + exe_dir.string());
-
-        fs::path project_root_path = LocalTether::UI::Panels::find_ancestor_directory(exe_dir, "LocalTether", 4);
-
-        if (!project_root_path.empty()) {
-            Utils::Logger::GetInstance().Info("Found project root 'LocalTether' at: " + project_root_path.string());
-            base_path = project_root_path;
-        } else {
-            Utils::Logger::GetInstance().Warning("'LocalTether' project root not found within 4 parent levels of executable. Using executable directory as base.");
-            base_path = exe_dir;  
-        }
-        
-        rootStoragePath_ = (base_path / "server_storage").string();
+        rootStoragePath_ = Storage::LocalFileStore::defaultRoot().string();
         Utils::Logger::GetInstance().Info("Server storage path set to: " + rootStoragePath_);
         
         newFolderNameBuffer_[0] = '\0';
@@ -104,25 +62,6 @@ namespace LocalTether::UI::Panels {
         InitializeStorage();
     }
 
-    void FileExplorerPanel::BroadcastFileSystemUpdate() {
-         
-        if (!LocalTether::UI::isNetworkInitialized() || LocalTether::UI::getClient().getRole() != LocalTether::Network::ClientRole::Host) {
-            if(LocalTether::UI::isNetworkInitialized()) Utils::Logger::GetInstance().Warning("BroadcastFileSystemUpdate called on non-host client. Skipping broadcast.");
-             
-            return;
-        }
-        auto* server = LocalTether::UI::getServerPtr();  
-        if (server && server->getState() == Network::ServerState::Running) {
-            uint32_t senderId = server->getHostClientId(); 
-            
-            Utils::Logger::GetInstance().Info("Broadcasting FileSystemUpdate.");
-            Network::Message updateMsg = Network::Message::createFileSystemUpdate(this->rootNode_, senderId);
-            server->broadcast(updateMsg);
-        } else {
-            Utils::Logger::GetInstance().Warning("Cannot broadcast file system update: Server not available or not running.");
-        }
-    }
-
     void FileExplorerPanel::InitializeStorage() {
         try {
             if (!fs::exists(rootStoragePath_)) {
@@ -134,88 +73,23 @@ namespace LocalTether::UI::Panels {
                 }
             }
             RefreshView(); 
-            if (LocalTether::UI::isNetworkInitialized() && LocalTether::UI::getClient().getRole() == LocalTether::Network::ClientRole::Host) {
-                 BroadcastFileSystemUpdate();
-            }
         } catch (const fs::filesystem_error& e) {
             Utils::Logger::GetInstance().Error("Filesystem error during storage initialization: " + std::string(e.what()));
         }
     }
 
     void FileExplorerPanel::RefreshView() {
-        rootNode_ = FileMetadata();  
-        rootNode_.name = "Storage Root";  
-        rootNode_.fullPath = rootStoragePath_;
-        rootNode_.relativePath = "";
-        rootNode_.isDirectory = true;
-        
         selectedPath_.clear();  
         itemToDeletePath_[0] = '\0';
 
-        try {
-            ScanDirectoryRecursive(rootStoragePath_, rootNode_);
-        } catch (const fs::filesystem_error& e) {
-            Utils::Logger::GetInstance().Error("Filesystem error during refresh: " + std::string(e.what()));
-        }
-    }
-
-    void FileExplorerPanel::ScanDirectoryRecursive(const fs::path& dirPath, FileMetadata& parentNode) {
-        parentNode.children.clear();
-        try {
-            if (!fs::exists(dirPath) || !fs::is_directory(dirPath)) {
-                Utils::Logger::GetInstance().Warning("ScanDirectoryRecursive: Path does not exist or is not a directory: " + dirPath.string());
-                return;
-            }
-
-            for (const auto& entry : fs::directory_iterator(dirPath)) {
-                FileMetadata meta;
-                meta.name = entry.path().filename().string();
-                meta.fullPath = entry.path().string();
-                
-                try {
-                    fs::path canonical_entry_path = fs::weakly_canonical(entry.path());
-                    fs::path canonical_root_path = fs::weakly_canonical(rootStoragePath_);  
-                    if (canonical_entry_path.string().rfind(canonical_root_path.string(), 0) == 0) {
-                         meta.relativePath = fs::relative(canonical_entry_path, canonical_root_path).generic_string();
-                    } else {
-                        Utils::Logger::GetInstance().Warning("Path " + canonical_entry_path.string() + " is not relative to root " + canonical_root_path.string() + ". Using filename as relative path.");
-                        meta.relativePath = meta.name;  
-                    }
-                } catch (const fs::filesystem_error& e) {
-                     
-                    Utils::Logger::GetInstance().Error("Error getting relative path for " + entry.path().string() + " against " + rootStoragePath_ + ": " + e.what());
-                    meta.relativePath = meta.name;  
-                }
-
-                meta.isDirectory = entry.is_directory();
-                
-                try {
-                    meta.size = meta.isDirectory ? 0 : fs::file_size(entry.path());
-                    auto ftime = fs::last_write_time(entry.path());
-                    auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                        ftime - fs::file_time_type::clock::now() + std::chrono::system_clock::now()
-                    );
-                    meta.modifiedTime = sctp;
-                } catch (const fs::filesystem_error& e) {
-                    Utils::Logger::GetInstance().Warning("Could not get metadata for " + meta.fullPath + ": " + e.what());
-                    meta.size = 0;  
-                    meta.modifiedTime = std::chrono::system_clock::now();  
-                }
-
-                if (meta.isDirectory) {
-                    ScanDirectoryRecursive(entry.path(), meta);  
-                }
-                parentNode.children.push_back(meta);
-            }
-        } catch (const fs::filesystem_error& e) {
-             Utils::Logger::GetInstance().Error("Filesystem error iterating directory " + dirPath.string() + ": " + std::string(e.what()));
-             return;
+        if (auto* storage = hostStorage()) {
+            rootStoragePath_ = storage->root().string();
+            storage->rescan();
+            rootNode_ = *storage->tree();
+            shownStorageVersion_ = storage->version();
+            return;
         }
-         
-        std::sort(parentNode.children.begin(), parentNode.children.end(), [](const FileMetadata& a, const FileMetadata& b) {
-            if (a.isDirectory != b.isDirectory) return a.isDirectory > b.isDirectory;  
-            return a.name < b.name;
-        });
+        rootNode_ = Storage::LocalFileStore::scanTree(rootStoragePath_);
     }
     
     void FileExplorerPanel::SetRootNode(const FileMetadata& newRootNode) {
@@ -285,9 +159,7 @@ namespace LocalTether::UI::Panels {
 
         fs::path clientCacheRoot;
         if (network_ok && !isHost) {
-            fs::path exe_dir = get_executable_directory();
-            fs::path project_root_path = find_ancestor_directory(exe_dir, "LocalTether", 4);
-            clientCacheRoot = (project_root_path.empty() ? exe_dir : project_root_path) / "client_file_cache";
+            clientCacheRoot = Utils::dataDirectory() / "client_file_cache";
         }
         
         if (isHost) { 
@@ -421,7 +293,6 @@ namespace LocalTether::UI::Panels {
                 }
 
                 RefreshView();  
-                BroadcastFileSystemUpdate();
             } catch (const fs::filesystem_error& e) {
                  
                 Utils::Logger::GetInstance().Error("Error copying file for host: " + std::string(e.what()));
@@ -437,7 +308,7 @@ namespace LocalTether::UI::Panels {
             fs::path canonical_drop_target = fs::weakly_canonical(current_drop_target_dir_);
             fs::path canonical_root_storage = fs::weakly_canonical(fs::path(rootStoragePath_));  
 
-            if (canonical_drop_target.string().rfind(canonical_root_storage.string(), 0) == 0) {
+            if (Utils::isPathWithin(canonical_drop_target, canonical_root_storage)) {
                 targetServerRelativePath = fs::relative(canonical_drop_target, canonical_root_storage).string();
             } else {
                 Utils::Logger::GetInstance().Error("Client D&D: Invalid drop target directory calculation. Drop target: " + canonical_drop_target.string() + ", Root: " + canonical_root_storage.string());
@@ -469,12 +340,18 @@ namespace LocalTether::UI::Panels {
          
         bool network_init = LocalTether::UI::isNetworkInitialized();  
         bool isHost = network_init && (LocalTether::UI::getClient().getRole() == LocalTether::Network::ClientRole::Host);
+
+        // Uploads land in the store from the network thread; pick the new tree up here.
+        if (auto* storage = isHost ? hostStorage() : nullptr) {
+            if (storage->version() != shownStorageVersion_ && !isMoveMode_ && !isRenameMode_) {
+                rootNode_ = *storage->tree();
+                shownStorageVersion_ = storage->version();
+            }
+        }
         
         fs::path clientCacheRoot;
         if (network_init && !isHost) { 
-            fs::path exe_dir = get_executable_directory();
-            fs::path project_root_path = find_ancestor_directory(exe_dir, "LocalTether", 4);
-            clientCacheRoot = (project_root_path.empty() ? exe_dir : project_root_path) / "client_file_cache";
+            clientCacheRoot = Utils::dataDirectory() / "client_file_cache";
             if (!fs::exists(clientCacheRoot)) {
                 try {
                     fs::create_directories(clientCacheRoot);
@@ -491,7 +368,6 @@ namespace LocalTether::UI::Panels {
         if (ImGui::Button(ICON_FA_SYNC_ALT " Refresh")) {  
             if (isHost && !isMoveMode_ && !isRenameMode_) {  
                 RefreshView();
-                BroadcastFileSystemUpdate(); 
             }
         }
         ImGui::SameLine();
@@ -649,7 +525,11 @@ namespace LocalTether::UI::Panels {
                         }
                     }
                 } else {  
-                     ImGui::Text(" (Directory - No client actions)");
+                    ImGui::SameLine();
+                    if (ImGui::Button(ICON_FA_DOWNLOAD " Download Folder")) {
+                        Utils::Logger::GetInstance().Info("Client requesting folder: " + selectedNodePtr->relativePath);
+                        LocalTether::UI::getClient().requestDirectory(selectedNodePtr->relativePath);
+                    }
                 }
             } else {  
                 ImGui::Text("No item selected (Client).");
@@ -703,7 +583,6 @@ namespace LocalTether::UI::Panels {
                 Utils::Logger::GetInstance().Info("Created folder: " + newFolderPath.string());
                 newFolderNameBuffer_[0] = '\0';  
                 RefreshView();
-                BroadcastFileSystemUpdate();
             } else {
                 Utils::Logger::GetInstance().Error("Failed to create folder: " + newFolderPath.string() + " (maybe it already exists or bad path).");
             }
@@ -733,7 +612,6 @@ namespace LocalTether::UI::Panels {
                 Utils::Logger::GetInstance().Info("Created file: " + newFilePath.string());
                 newFileNameBuffer_[0] = '\0';  
                 RefreshView();
-                BroadcastFileSystemUpdate();
             } else {
                  Utils::Logger::GetInstance().Error("Failed to create file (ofstream error): " + newFilePath.string());
             }
@@ -749,7 +627,6 @@ namespace LocalTether::UI::Panels {
             itemToDeletePath_[0] = '\0';  
             selectedPath_.clear();  
             RefreshView();  
-            BroadcastFileSystemUpdate(); 
             return;
         }
         
@@ -771,7 +648,6 @@ namespace LocalTether::UI::Panels {
             itemToDeletePath_[0] = '\0';  
             selectedPath_.clear();  
             RefreshView();
-            BroadcastFileSystemUpdate();
         } catch (const fs::filesystem_error& e) {
             Utils::Logger::GetInstance().Error("Error deleting " + std::string(itemToDeletePath_) + ": " + std::string(e.what()));
         }
@@ -803,7 +679,6 @@ namespace LocalTether::UI::Panels {
             Utils::Logger::GetInstance().Error("Move failed: Source item no longer exists: " + sourcePath.string());
             HandleCancelMove();
             RefreshView();  
-            BroadcastFileSystemUpdate();
             return;
         }
         if (!fs::exists(destinationDir) || !fs::is_directory(destinationDir)) {
@@ -854,7 +729,6 @@ namespace LocalTether::UI::Panels {
             Utils::Logger::GetInstance().Info("Moved '" + sourcePath.string() + "' to '" + newPath.string() + "'");
             HandleCancelMove();  
             RefreshView();
-            BroadcastFileSystemUpdate();
         } catch (const fs::filesystem_error& e) {
             Utils::Logger::GetInstance().Error("Error moving item: " + std::string(e.what()));
             HandleCancelMove(); 
@@ -898,7 +772,6 @@ namespace LocalTether::UI::Panels {
             Utils::Logger::GetInstance().Error("Rename failed: Source item no longer exists: " + sourcePath.string());
             HandleCancelRename();
             RefreshView();
-            BroadcastFileSystemUpdate(); 
             return;
         }
         
@@ -926,7 +799,6 @@ namespace LocalTether::UI::Panels {
             Utils::Logger::GetInstance().Info("Renamed '" + sourcePath.string() + "' to '" + newPath.string() + "'");
             HandleCancelRename();  
             RefreshView();
-            BroadcastFileSystemUpdate();
         } catch (const fs::filesystem_error& e) {
             Utils::Logger::GetInstance().Error("Error renaming item: " + std::string(e.what()));
             HandleCancelRename(); 
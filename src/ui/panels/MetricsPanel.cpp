@@ -0,0 +1,97 @@
+#include "ui/panels/MetricsPanel.h"
+#include "ui/Icons.h"
+
+#include <cstring>
+
+namespace LocalTether::UI::Panels {
+
+namespace {
+    std::string seriesKey(const LocalTether::Utils::MetricSample& sample) {
+        return sample.name + "{" + sample.labels + "}";
+    }
+}
+
+void MetricsPanel::Refresh() {
+    auto now = std::chrono::steady_clock::now();
+    if (lastRefresh_ != std::chrono::steady_clock::time_point{} && now - lastRefresh_ < REFRESH_INTERVAL) {
+        return;
+    }
+    double elapsed = std::chrono::duration<double>(now - lastRefresh_).count();
+    bool havePrevious = lastRefresh_ != std::chrono::steady_clock::time_point{};
+    lastRefresh_ = now;
+
+    samples_ = LocalTether::Utils::MetricsRegistry::GetInstance().snapshot();
+    rates_.clear();
+    for (const auto& sample : samples_) {
+        if (sample.kind != LocalTether::Utils::MetricKind::Counter) continue;
+        std::string key = seriesKey(sample);
+        auto previous = lastValues_.find(key);
+        if (havePrevious && previous != lastValues_.end() && sample.value >= previous->second) {
+            rates_[key] = (sample.value - previous->second) / elapsed;
+        }
+        lastValues_[key] = sample.value;
+    }
+}
+
+void MetricsPanel::Show(bool* p_open) {
+    if (!p_open || !*p_open) {
+        return;
+    }
+    ImGui::Begin("Metrics", p_open);
+    Refresh();
+
+    ImGui::SetNextItemWidth(200);
+    ImGui::InputTextWithHint("##metrics_filter", "Filter", filter_, sizeof(filter_));
+    ImGui::SameLine();
+    if (ImGui::Button(ICON_FA_COPY " Copy as Prometheus text")) {
+        ImGui::SetClipboardText(LocalTether::Utils::MetricsRegistry::GetInstance().renderPrometheus().c_str());
+    }
+
+    if (ImGui::BeginTable("metrics_table", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg |
+                                              ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Metric");
+        ImGui::TableSetupColumn("Labels");
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableSetupColumn("Rate / p50 p99 (us)");
+        ImGui::TableHeadersRow();
+        for (const auto& sample : samples_) {
+            if (filter_[0] != '\0' && sample.name.find(filter_) == std::string::npos &&
+                sample.labels.find(filter_) == std::string::npos) {
+                continue;
+            }
+            ImGui::TableNextRow();
+            ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(sample.name.c_str());
+            if (ImGui::IsItemHovered() && !sample.help.empty()) {
+                ImGui::SetTooltip("%s", sample.help.c_str());
+            }
+            ImGui::TableSetColumnIndex(1); ImGui::TextUnformatted(sample.labels.c_str());
+            switch (sample.kind) {
+                case LocalTether::Utils::MetricKind::Counter: {
+                    ImGui::TableSetColumnIndex(2); ImGui::Text("%.0f", sample.value);
+                    auto rate = rates_.find(seriesKey(sample));
+                    if (rate != rates_.end()) {
+                        ImGui::TableSetColumnIndex(3); ImGui::Text("%.1f/s", rate->second);
+                    }
+                    break;
+                }
+                case LocalTether::Utils::MetricKind::Gauge:
+                    ImGui::TableSetColumnIndex(2); ImGui::Text("%.0f", sample.value);
+                    break;
+                case LocalTether::Utils::MetricKind::Summary:
+                    ImGui::TableSetColumnIndex(2); ImGui::Text("%llu samples", static_cast<unsigned long long>(sample.count));
+                    if (sample.count > 0) {
+                        ImGui::TableSetColumnIndex(3);
+                        ImGui::Text("%llu  %llu", static_cast<unsigned long long>(sample.p50Us),
+                                    static_cast<unsigned long long>(sample.p99Us));
+                    }
+                    break;
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+}
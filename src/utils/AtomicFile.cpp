@@ -0,0 +1,253 @@
+#include "utils/AtomicFile.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+    #define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace LocalTether::Utils {
+
+namespace {
+    std::atomic<uint32_t> g_tempCounter{0};
+
+    std::string tempSuffix() {
+        auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+#ifdef _WIN32
+        unsigned long pid = GetCurrentProcessId();
+#else
+        unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+        return std::to_string(pid) + "-" + std::to_string(ticks) + "-" + std::to_string(g_tempCounter.fetch_add(1));
+    }
+
+#ifndef _WIN32
+    std::string errnoText(const std::string& what) {
+        return what + ": " + std::strerror(errno);
+    }
+
+    // Makes the rename durable; a failure here is logged but does not undo the commit.
+    void syncDirectory(const fs::path& dir) {
+        int dirFd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd < 0) {
+            Logger::GetInstance().Warning("AtomicFileWriter: " + errnoText("open directory " + dir.string()));
+            return;
+        }
+        if (::fsync(dirFd) != 0) {
+            Logger::GetInstance().Warning("AtomicFileWriter: " + errnoText("fsync directory " + dir.string()));
+        }
+        ::close(dirFd);
+    }
+#endif
+}
+
+DurabilityPolicy durabilityPolicyFromConfig() {
+    std::string value = Config::GetInstance().Get(ConfigKeys::StorageDurability);
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (value == "none") return DurabilityPolicy::None;
+    if (value == "full") return DurabilityPolicy::Full;
+    if (value != "file") {
+        Logger::GetInstance().Warning("Unknown storage.durability '" + value + "', using 'file'.");
+    }
+    return DurabilityPolicy::File;
+}
+
+bool isAtomicTempFile(const std::string& fileName) {
+    return fileName.rfind(ATOMIC_TEMP_PREFIX, 0) == 0;
+}
+
+AtomicFileWriter::AtomicFileWriter(const fs::path& destination, DurabilityPolicy policy)
+    : destination_(destination), policy_(policy) {}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    abort();
+}
+
+bool AtomicFileWriter::fail(const std::string& what) {
+    lastError_ = what;
+    abort();
+    return false;
+}
+
+void AtomicFileWriter::closeHandle() {
+#ifdef _WIN32
+    if (handle_) {
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+    }
+#else
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+void AtomicFileWriter::abort() {
+    closeHandle();
+    if (!tempPath_.empty()) {
+        std::error_code ec;
+        fs::remove(tempPath_, ec);
+        tempPath_.clear();
+    }
+}
+
+bool AtomicFileWriter::open(uint64_t expectedSize) {
+    abort();
+    written_ = 0;
+    reserved_ = 0;
+    tempPath_ = destination_.parent_path() / (std::string(ATOMIC_TEMP_PREFIX) + destination_.filename().string() + "." + tempSuffix());
+
+#ifdef _WIN32
+    HANDLE h = CreateFileW(tempPath_.wstring().c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW,
+                           FILE_ATTRIBUTE_NORMAL | FILE_ATTRIBUTE_HIDDEN, nullptr);
+    if (h == INVALID_HANDLE_VALUE) {
+        tempPath_.clear();
+        lastError_ = "CreateFile failed for " + destination_.string() + " (error " + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    handle_ = h;
+    if (expectedSize > 0) {
+        FILE_ALLOCATION_INFO allocation{};
+        allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(expectedSize);
+        if (!SetFileInformationByHandle(h, FileAllocationInfo, &allocation, sizeof(allocation))) {
+            DWORD err = GetLastError();
+            if (err == ERROR_DISK_FULL) {
+                return fail("Not enough space to store " + destination_.string());
+            }
+        } else {
+            reserved_ = expectedSize;
+        }
+    }
+#else
+    fd_ = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        lastError_ = errnoText("create temp file for " + destination_.string());
+        tempPath_.clear();
+        return false;
+    }
+    if (expectedSize > 0) {
+        int rc = ::posix_fallocate(fd_, 0, static_cast<off_t>(expectedSize));
+        if (rc == 0) {
+            reserved_ = expectedSize;
+        } else if (rc == ENOSPC || rc == EFBIG) {
+            errno = rc;
+            return fail(errnoText("reserve space for " + destination_.string()));
+        }
+        // Filesystems without fallocate support (EOPNOTSUPP/EINVAL) simply grow on write.
+    }
+#endif
+    return true;
+}
+
+bool AtomicFileWriter::write(const char* data, size_t length) {
+#ifdef _WIN32
+    if (!handle_) return fail("Write to a writer that is not open: " + destination_.string());
+    while (length > 0) {
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(length, 64u * 1024 * 1024));
+        DWORD done = 0;
+        if (!WriteFile(static_cast<HANDLE>(handle_), data, chunk, &done, nullptr) || done == 0) {
+            return fail("WriteFile failed for " + destination_.string() + " (error " + std::to_string(GetLastError()) + ")");
+        }
+        data += done;
+        length -= done;
+        written_ += done;
+    }
+#else
+    if (fd_ < 0) return fail("Write to a writer that is not open: " + destination_.string());
+    while (length > 0) {
+        ssize_t done = ::write(fd_, data, length);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return fail(errnoText("write " + destination_.string()));
+        }
+        data += done;
+        length -= static_cast<size_t>(done);
+        written_ += static_cast<uint64_t>(done);
+    }
+#endif
+    return true;
+}
+
+bool AtomicFileWriter::commit() {
+    if (tempPath_.empty()) {
+        lastError_ = "Commit without an open temp file: " + destination_.string();
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE h = static_cast<HANDLE>(handle_);
+    if (reserved_ > written_) {
+        // Drop the unused part of the reservation so the final size matches what was written.
+        LARGE_INTEGER end{};
+        end.QuadPart = static_cast<LONGLONG>(written_);
+        if (!SetFilePointerEx(h, end, nullptr, FILE_BEGIN) || !SetEndOfFile(h)) {
+            return fail("Failed to trim " + destination_.string());
+        }
+    }
+    if (policy_ != DurabilityPolicy::None && !FlushFileBuffers(h)) {
+        return fail("FlushFileBuffers failed for " + destination_.string() + " (error " + std::to_string(GetLastError()) + ")");
+    }
+    closeHandle();
+    DWORD flags = MOVEFILE_REPLACE_EXISTING;
+    if (policy_ == DurabilityPolicy::Full) flags |= MOVEFILE_WRITE_THROUGH;
+    if (!MoveFileExW(tempPath_.wstring().c_str(), destination_.wstring().c_str(), flags)) {
+        return fail("MoveFileEx failed for " + destination_.string() + " (error " + std::to_string(GetLastError()) + ")");
+    }
+    SetFileAttributesW(destination_.wstring().c_str(), FILE_ATTRIBUTE_NORMAL);
+#else
+    if (reserved_ > written_ && ::ftruncate(fd_, static_cast<off_t>(written_)) != 0) {
+        return fail(errnoText("trim " + destination_.string()));
+    }
+    // The temp file is created 0644; a replaced file keeps its own mode.
+    struct stat existing;
+    if (::stat(destination_.c_str(), &existing) == 0 && ::fchmod(fd_, existing.st_mode & 07777) != 0) {
+        return fail(errnoText("copy permissions onto " + destination_.string()));
+    }
+    if (policy_ != DurabilityPolicy::None && ::fsync(fd_) != 0) {
+        return fail(errnoText("fsync " + destination_.string()));
+    }
+    if (::close(fd_) != 0) {
+        fd_ = -1;
+        return fail(errnoText("close " + destination_.string()));
+    }
+    fd_ = -1;
+    // rename() replaces the directory entry atomically; readers holding the old inode
+    // (e.g. a live mapping being streamed to another client) keep seeing the old contents.
+    if (::rename(tempPath_.c_str(), destination_.c_str()) != 0) {
+        return fail(errnoText("rename into " + destination_.string()));
+    }
+    if (policy_ == DurabilityPolicy::Full) {
+        syncDirectory(destination_.parent_path());
+    }
+#endif
+    tempPath_.clear();
+    return true;
+}
+
+bool AtomicFileWriter::writeFile(const fs::path& destination, const char* data, size_t length,
+                                 DurabilityPolicy policy, std::string* error) {
+    AtomicFileWriter writer(destination, policy);
+    bool ok = writer.open(length) && writer.write(data, length) && writer.commit();
+    if (!ok && error) *error = writer.lastError();
+    return ok;
+}
+
+}
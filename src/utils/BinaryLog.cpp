@@ -0,0 +1,103 @@
+#include "utils/BinaryLog.h"
+
+namespace LocalTether::Utils::BinaryLog {
+
+namespace {
+    template <typename T>
+    bool readRaw(std::string_view data, size_t& offset, T& value) {
+        if (data.size() - offset < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool renderArg(std::string& out, std::string_view args, size_t& offset) {
+        uint8_t tag = 0;
+        if (!readRaw(args, offset, tag)) return false;
+        switch (static_cast<ArgTag>(tag)) {
+            case ArgTag::Int: {
+                int64_t value;
+                if (!readRaw(args, offset, value)) return false;
+                out += std::to_string(value);
+                return true;
+            }
+            case ArgTag::UInt: {
+                uint64_t value;
+                if (!readRaw(args, offset, value)) return false;
+                out += std::to_string(value);
+                return true;
+            }
+            case ArgTag::Double: {
+                double value;
+                if (!readRaw(args, offset, value)) return false;
+                out += std::to_string(value);
+                return true;
+            }
+            case ArgTag::Bool: {
+                uint8_t value;
+                if (!readRaw(args, offset, value)) return false;
+                out += value ? "true" : "false";
+                return true;
+            }
+            case ArgTag::String: {
+                uint32_t length;
+                if (!readRaw(args, offset, length) || args.size() - offset < length) return false;
+                out += args.substr(offset, length);
+                offset += length;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+}
+
+std::string render(std::string_view format, std::string_view args) {
+    std::string out;
+    out.reserve(format.size() + args.size());
+    size_t offset = 0;
+    while (offset < args.size()) {
+        size_t placeholder = format.find("{}");
+        if (placeholder == std::string_view::npos) break;
+        out += format.substr(0, placeholder);
+        format.remove_prefix(placeholder + 2);
+        if (!renderArg(out, args, offset)) {
+            out += "{?}";
+            break;
+        }
+    }
+    out += format;
+    return out;
+}
+
+std::optional<Frame> readFrame(std::string_view data, size_t& offset) {
+    size_t cursor = offset;
+    uint8_t kind = 0;
+    if (!readRaw(data, cursor, kind)) return std::nullopt;
+
+    Frame frame{};
+    frame.kind = static_cast<FrameKind>(kind);
+    uint32_t length = 0;
+    switch (frame.kind) {
+        case FrameKind::Session:
+            if (!readRaw(data, cursor, frame.timeUs)) return std::nullopt;
+            break;
+        case FrameKind::Format:
+            if (!readRaw(data, cursor, frame.formatId) || !readRaw(data, cursor, length)) return std::nullopt;
+            break;
+        case FrameKind::Record:
+            if (!readRaw(data, cursor, frame.timeUs) || !readRaw(data, cursor, frame.level) ||
+                !readRaw(data, cursor, frame.formatId) || !readRaw(data, cursor, length)) {
+                return std::nullopt;
+            }
+            break;
+        default:
+            return std::nullopt;
+    }
+    if (data.size() - cursor < length) return std::nullopt;
+    frame.body = data.substr(cursor, length);
+    offset = cursor + length;
+    return frame;
+}
+
+}
@@ -5,6 +5,7 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <filesystem>
 
 namespace LocalTether::Utils {
 
@@ -18,6 +19,12 @@ namespace LocalTether::Utils {
         return path;
     }
 
+    namespace {
+        constexpr ConfigSnapshot DEFAULT_SNAPSHOT{};
+    }
+
+    std::atomic<const ConfigSnapshot*> Config::live_{&DEFAULT_SNAPSHOT};
+
     Config& Config::GetInstance() {
         static Config instance;
         return instance;
@@ -32,6 +39,10 @@ namespace LocalTether::Utils {
       }
     }
 
+    Config::~Config() {
+        StopWatching();
+    }
+
     bool Config::LoadFromFile() {
         const std::string& configFilePath = GetDefaultConfigFilePath(); 
         Logger::GetInstance().Info("Config::LoadFromFile: Attempting to open: " + configFilePath);
@@ -42,7 +53,8 @@ namespace LocalTether::Utils {
         }
         Logger::GetInstance().Info("Config::LoadFromFile: Successfully opened config file: " + configFilePath);
 
-        values.clear();
+        // Parsed aside and swapped in at the end, so readers never see a half-loaded file.
+        std::unordered_map<std::string, std::any> loaded;
 
         std::string line;
         int line_num = 0;
@@ -79,11 +91,11 @@ namespace LocalTether::Utils {
                         Logger::GetInstance().Warning("Config::LoadFromFile: Error parsing value for " + pauseKey + ". Remainder: '" + ss_value.str().substr(ss_value.tellg()) + "'");
                     }
                     Logger::GetInstance().Debug("Config::LoadFromFile: " + parsed_combo_log + "Resulting combo size: " + std::to_string(combo.size()));
-                    Set(key_str, combo);
+                    loaded[key_str] = combo;
                 } else {
                     if (value_str == "true" || value_str == "false") {
                         Logger::GetInstance().Debug("Config::LoadFromFile: Setting bool for key " + key_str);
-                        Set(key_str, value_str == "true");
+                        loaded[key_str] = (value_str == "true");
                     } else {
                         bool set_as_specific_type = false;
                         try {
@@ -91,7 +103,7 @@ namespace LocalTether::Utils {
                             int int_val = std::stoi(value_str, &processed_chars_int);
                             if (processed_chars_int == value_str.length()) {
                                 Logger::GetInstance().Debug("Config::LoadFromFile: Setting int for key " + key_str);
-                                Set(key_str, int_val);
+                                loaded[key_str] = int_val;
                                 set_as_specific_type = true;
                             }
                         } catch (const std::invalid_argument&) {
@@ -103,7 +115,7 @@ namespace LocalTether::Utils {
                                 float float_val = std::stof(value_str, &processed_chars_float);
                                  if (processed_chars_float == value_str.length()) {
                                     Logger::GetInstance().Debug("Config::LoadFromFile: Setting float for key " + key_str);
-                                    Set(key_str, float_val);
+                                    loaded[key_str] = float_val;
                                     set_as_specific_type = true;
                                 }
                             } catch (const std::invalid_argument&) {
@@ -112,7 +124,7 @@ namespace LocalTether::Utils {
 
                         if (!set_as_specific_type) {
                             Logger::GetInstance().Debug("Config::LoadFromFile: Setting string for key " + key_str);
-                            Set(key_str, value_str);
+                            loaded[key_str] = value_str;
                         }
                     }
                 }
@@ -121,7 +133,13 @@ namespace LocalTether::Utils {
             }
         }
         configFile.close();
-        Logger::GetInstance().Info("Config::LoadFromFile: Finished loading. Total keys in map: " + std::to_string(values.size()));
+        size_t keyCount = loaded.size();
+        {
+            std::lock_guard<std::mutex> lock(valuesMutex_);
+            values.swap(loaded);
+        }
+        Logger::GetInstance().Info("Config::LoadFromFile: Finished loading. Total keys in map: " + std::to_string(keyCount));
+        PublishSnapshot();
         return true;
     }
 
@@ -129,6 +147,11 @@ namespace LocalTether::Utils {
     bool Config::SaveToFile() {
         const std::string& configFilePath = GetDefaultConfigFilePath(); 
         Logger::GetInstance().Info("Config::SaveToFile: Attempting to save to " + configFilePath);
+        std::unordered_map<std::string, std::any> values;
+        {
+            std::lock_guard<std::mutex> lock(valuesMutex_);
+            values = this->values;
+        }
         Logger::GetInstance().Debug("Config::SaveToFile: Number of keys to save: " + std::to_string(values.size()));
         for (const auto& pair : values) {
             Logger::GetInstance().Debug("Config::SaveToFile: Preparing to save key='" + pair.first + "' with typeid: " + pair.second.type().name());
@@ -178,12 +201,19 @@ namespace LocalTether::Utils {
 
     template<typename T>
     void Config::Set(const std::string& key, const T& value) {
-        values[key] = value;
-        Logger::GetInstance().Debug("Config::Set: Key '" + key + "' set with type " + typeid(T).name() + ". Value count in map: " + std::to_string(values.size()));
+        size_t count;
+        {
+            std::lock_guard<std::mutex> lock(valuesMutex_);
+            values[key] = value;
+            count = values.size();
+        }
+        Logger::GetInstance().Debug("Config::Set: Key '" + key + "' set with type " + typeid(T).name() + ". Value count in map: " + std::to_string(count));
+        PublishSnapshot();
     }
 
     template<typename T>
     T Config::Get(const std::string& key, const T& defaultValue) {
+        std::lock_guard<std::mutex> lock(valuesMutex_);
         auto it = values.find(key);
         if (it != values.end()) {
             try {
@@ -224,6 +254,30 @@ namespace LocalTether::Utils {
                         return static_cast<T>(temp_str == "true" || temp_str == "1");
                     }
                 }
+                else if constexpr (std::is_same_v<T, float>) {
+                    // "1" parses as an int, but a float key should still accept it.
+                    if (it->second.type() == typeid(int)) {
+                        return static_cast<float>(std::any_cast<int>(it->second));
+                    }
+                    if (it->second.type() == typeid(std::string)) {
+                        const auto& temp_str = std::any_cast<const std::string&>(it->second);
+                        try {
+                            size_t processed = 0;
+                            float parsed = std::stof(temp_str, &processed);
+                            if (processed == temp_str.length()) return parsed;
+                        } catch (const std::exception&) {}
+                    }
+                }
+                else if constexpr (std::is_same_v<T, int>) {
+                    if (it->second.type() == typeid(std::string)) {
+                        const auto& temp_str = std::any_cast<const std::string&>(it->second);
+                        try {
+                            size_t processed = 0;
+                            int parsed = std::stoi(temp_str, &processed);
+                            if (processed == temp_str.length()) return parsed;
+                        } catch (const std::exception&) {}
+                    }
+                }
                 Logger::GetInstance().Warning("Config::Get: Unhandled type mismatch or conversion failed for key '" + key + "'. Returning default value.");
             }
         } else {
@@ -238,9 +292,82 @@ namespace LocalTether::Utils {
     }
 
     bool Config::HasKey(const std::string& key) {
+        std::lock_guard<std::mutex> lock(valuesMutex_);
         return values.find(key) != values.end();
     }
 
+    void Config::PublishSnapshot() {
+        auto snapshot = std::make_unique<ConfigSnapshot>();
+        snapshot->logLevel = parseLogLevel(Get(ConfigKeys::LogLevel), LogLevel::Trace);
+        snapshot->logBinary = Get(ConfigKeys::LogFormat) == "binary";
+        snapshot->logMaxFileBytes = static_cast<uint64_t>(std::max(0, Get(ConfigKeys::LogMaxFileBytes)));
+        snapshot->logMaxFiles = static_cast<uint32_t>(std::max(0, Get(ConfigKeys::LogMaxFiles)));
+        snapshot->relativeMouseMode = Get(ConfigKeys::InputMouseMode) == "relative";
+        snapshot->jitterBuffer = Get(ConfigKeys::InputJitterBuffer);
+        snapshot->inputPollWaitMs = std::clamp(Get(ConfigKeys::InputPollWaitMs), 1, 1000);
+        snapshot->relativeDeadzone = std::max(0.0f, Get(ConfigKeys::InputRelativeDeadzone));
+        snapshot->transferCompression = Get(ConfigKeys::TransferCompression);
+        snapshot->writeQueueHighWatermark = static_cast<size_t>(std::max(0, Get(ConfigKeys::NetWriteQueueHighWatermark)));
+
+        std::lock_guard<std::mutex> lock(publishMutex_);
+        const ConfigSnapshot& previous = Live();
+        Logger::GetInstance().SetLevel(snapshot->logLevel);
+        // Reconfiguring output reopens the log file, so only do it when something changed.
+        if (snapshots_.empty() || snapshot->logBinary != previous.logBinary ||
+            snapshot->logMaxFileBytes != previous.logMaxFileBytes || snapshot->logMaxFiles != previous.logMaxFiles) {
+            Logger::GetInstance().ConfigureOutput(snapshot->logBinary, snapshot->logMaxFileBytes, snapshot->logMaxFiles);
+        }
+        live_.store(snapshot.get(), std::memory_order_release);
+        snapshots_.push_back(std::move(snapshot));
+    }
+
+    void Config::StartWatching() {
+        int intervalMs = Get(ConfigKeys::ConfigReloadIntervalMs);
+        if (intervalMs <= 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        if (watchThread_.joinable()) {
+            return;
+        }
+        watchStopping_ = false;
+        watchThread_ = std::thread(&Config::WatchLoop, this, std::chrono::milliseconds(intervalMs));
+    }
+
+    void Config::StopWatching() {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> lock(watchMutex_);
+            watchStopping_ = true;
+            thread = std::move(watchThread_);
+        }
+        watchWake_.notify_all();
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    void Config::WatchLoop(std::chrono::milliseconds interval) {
+        const std::string& path = GetDefaultConfigFilePath();
+        std::error_code ec;
+        auto lastWrite = std::filesystem::last_write_time(path, ec);
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(watchMutex_);
+                if (watchWake_.wait_for(lock, interval, [this] { return watchStopping_; })) {
+                    return;
+                }
+            }
+            auto current = std::filesystem::last_write_time(path, ec);
+            if (ec || current == lastWrite) {
+                continue;
+            }
+            lastWrite = current;
+            Logger::GetInstance().Info("Config: " + path + " changed on disk, reloading.");
+            LoadFromFile();
+        }
+    }
+
 
     template void Config::Set<int>(const std::string&, const int&);
     template void Config::Set<float>(const std::string&, const float&);
@@ -0,0 +1,263 @@
+#include "utils/DeltaSync.h"
+#include "network/Message.h"
+
+#include <openssl/evp.h>
+
+#include <unordered_map>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace LocalTether::Utils::DeltaSync {
+
+namespace {
+    // Same offset rsync uses so runs of zero bytes still produce a useful checksum.
+    constexpr uint32_t CHAR_OFFSET = 31;
+
+    struct RollingChecksum {
+        uint32_t a = 0;
+        uint32_t b = 0;
+        size_t length = 0;
+
+        void reset(const char* data, size_t len) {
+            a = 0;
+            b = 0;
+            length = len;
+            for (size_t i = 0; i < len; ++i) {
+                uint32_t c = static_cast<uint8_t>(data[i]) + CHAR_OFFSET;
+                a += c;
+                b += static_cast<uint32_t>(len - i) * c;
+            }
+        }
+
+        void roll(uint8_t outByte, uint8_t inByte) {
+            uint32_t outC = outByte + CHAR_OFFSET;
+            uint32_t inC = inByte + CHAR_OFFSET;
+            a = a - outC + inC;
+            b = b - static_cast<uint32_t>(length) * outC + a;
+        }
+
+        uint32_t value() const {
+            return (a & 0xffff) | (b << 16);
+        }
+    };
+
+    void appendLiteral(FileDelta& delta, const char* begin, const char* end) {
+        if (begin == end) return;
+        if (delta.ops.empty() || delta.ops.back().type != DeltaOpType::Literal) {
+            DeltaOp op;
+            op.type = DeltaOpType::Literal;
+            delta.ops.push_back(std::move(op));
+        }
+        auto& literal = delta.ops.back().literal;
+        literal.insert(literal.end(), begin, end);
+    }
+
+    void appendCopy(FileDelta& delta, uint32_t blockIndex) {
+        if (!delta.ops.empty()) {
+            DeltaOp& last = delta.ops.back();
+            if (last.type == DeltaOpType::CopyBlocks && last.blockIndex + last.blockCount == blockIndex) {
+                last.blockCount++;
+                return;
+            }
+        }
+        DeltaOp op;
+        op.type = DeltaOpType::CopyBlocks;
+        op.blockIndex = blockIndex;
+        op.blockCount = 1;
+        delta.ops.push_back(std::move(op));
+    }
+}
+
+uint64_t FileDelta::literalBytes() const {
+    uint64_t total = 0;
+    for (const auto& op : ops) {
+        if (op.type == DeltaOpType::Literal) total += op.literal.size();
+    }
+    return total;
+}
+
+uint64_t FileDelta::encodedSizeEstimate() const {
+    return literalBytes() + ops.size() * (sizeof(uint8_t) + 2 * sizeof(uint32_t) + sizeof(uint64_t)) + targetDigest.size() + 32;
+}
+
+uint32_t chooseBlockSize(uint64_t fileSize) {
+    // Roughly sqrt(size), rounded up to a power of two, so signature and delta overhead stay balanced.
+    uint64_t target = static_cast<uint64_t>(std::sqrt(static_cast<double>(fileSize)));
+    uint32_t blockSize = MIN_BLOCK_SIZE;
+    while (blockSize < target && blockSize < MAX_BLOCK_SIZE) {
+        blockSize <<= 1;
+    }
+    return blockSize;
+}
+
+uint32_t weakChecksum(const char* data, size_t length) {
+    RollingChecksum sum;
+    sum.reset(data, length);
+    return sum.value();
+}
+
+uint64_t strongChecksum(const char* data, size_t length) {
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int mdLen = 0;
+    if (EVP_Digest(data, length, md, &mdLen, EVP_md5(), nullptr) != 1 || mdLen < sizeof(uint64_t)) {
+        return 0;
+    }
+    uint64_t value = 0;
+    std::memcpy(&value, md, sizeof(value));
+    return value;
+}
+
+std::vector<uint8_t> fileDigest(const char* data, size_t length) {
+    std::vector<uint8_t> digest(EVP_MAX_MD_SIZE);
+    unsigned int mdLen = 0;
+    if (EVP_Digest(data, length, digest.data(), &mdLen, EVP_sha256(), nullptr) != 1) {
+        return {};
+    }
+    digest.resize(mdLen);
+    return digest;
+}
+
+FileSignature computeSignature(const char* data, size_t length, uint32_t blockSize) {
+    FileSignature signature;
+    signature.blockSize = blockSize ? blockSize : chooseBlockSize(length);
+    signature.fileSize = length;
+    signature.blocks.reserve(length / signature.blockSize + 1);
+
+    for (size_t offset = 0; offset < length; offset += signature.blockSize) {
+        size_t len = std::min<size_t>(signature.blockSize, length - offset);
+        BlockSignature block;
+        block.weak = weakChecksum(data + offset, len);
+        block.strong = strongChecksum(data + offset, len);
+        signature.blocks.push_back(block);
+    }
+    return signature;
+}
+
+bool isValidSignature(const FileSignature& signature) {
+    if (signature.blocks.empty()) {
+        return signature.fileSize == 0;
+    }
+    if (signature.blockSize < MIN_BLOCK_SIZE || signature.blockSize > MAX_BLOCK_SIZE) {
+        return false;
+    }
+    const uint64_t expectedBlocks = signature.fileSize / signature.blockSize + (signature.fileSize % signature.blockSize != 0);
+    return expectedBlocks <= UINT32_MAX && signature.blocks.size() == expectedBlocks;
+}
+
+FileDelta computeDelta(const FileSignature& baseSignature, const char* data, size_t length) {
+    FileDelta delta;
+    delta.blockSize = baseSignature.blockSize;
+    delta.targetSize = length;
+    delta.targetDigest = fileDigest(data, length);
+
+    const size_t blockSize = baseSignature.blockSize;
+    if (blockSize == 0 || baseSignature.blocks.empty() || !isValidSignature(baseSignature)) {
+        appendLiteral(delta, data, data + length);
+        return delta;
+    }
+
+    // Only full-size base blocks take part in the rolling search; the short tail is checked at the end.
+    const size_t fullBlocks = baseSignature.fileSize / blockSize;
+    const size_t tailLength = baseSignature.fileSize % blockSize;
+
+    std::unordered_multimap<uint32_t, uint32_t> weakIndex;
+    weakIndex.reserve(fullBlocks);
+    for (uint32_t i = 0; i < fullBlocks; ++i) {
+        weakIndex.emplace(baseSignature.blocks[i].weak, i);
+    }
+
+    size_t literalStart = 0;
+    size_t pos = 0;
+    RollingChecksum rolling;
+    bool rollingValid = false;
+
+    while (fullBlocks > 0 && pos + blockSize <= length) {
+        if (!rollingValid) {
+            rolling.reset(data + pos, blockSize);
+            rollingValid = true;
+        }
+
+        bool matched = false;
+        auto range = weakIndex.equal_range(rolling.value());
+        if (range.first != range.second) {
+            uint64_t strong = strongChecksum(data + pos, blockSize);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (baseSignature.blocks[it->second].strong == strong) {
+                    appendLiteral(delta, data + literalStart, data + pos);
+                    appendCopy(delta, it->second);
+                    pos += blockSize;
+                    literalStart = pos;
+                    rollingValid = false;
+                    matched = true;
+                    break;
+                }
+            }
+        }
+
+        if (!matched) {
+            if (pos + blockSize < length) {
+                rolling.roll(static_cast<uint8_t>(data[pos]), static_cast<uint8_t>(data[pos + blockSize]));
+            }
+            ++pos;
+        }
+    }
+
+    if (tailLength > 0 && length - literalStart >= tailLength) {
+        size_t tailPos = length - tailLength;
+        const BlockSignature& tail = baseSignature.blocks.back();
+        if (weakChecksum(data + tailPos, tailLength) == tail.weak &&
+            strongChecksum(data + tailPos, tailLength) == tail.strong) {
+            appendLiteral(delta, data + literalStart, data + tailPos);
+            appendCopy(delta, static_cast<uint32_t>(baseSignature.blocks.size() - 1));
+            literalStart = length;
+        }
+    }
+
+    appendLiteral(delta, data + literalStart, data + length);
+    return delta;
+}
+
+bool applyDelta(const char* base, size_t baseLength, const FileDelta& delta, std::vector<char>& out) {
+    out.clear();
+    // targetSize and the ops come from the peer: every insert is checked against targetSize so a
+    // few copy ops over a large base cannot inflate out past what the delta claims.
+    if (delta.targetSize > Network::Message::MAX_BODY_LENGTH) return false;
+    out.reserve(static_cast<size_t>(delta.targetSize));
+    const size_t blockSize = delta.blockSize;
+
+    for (const auto& op : delta.ops) {
+        if (op.type == DeltaOpType::Literal) {
+            if (op.literal.size() > delta.targetSize - out.size()) return false;
+            out.insert(out.end(), op.literal.begin(), op.literal.end());
+            continue;
+        }
+        if (blockSize == 0) return false;
+        uint64_t begin = static_cast<uint64_t>(op.blockIndex) * blockSize;
+        uint64_t end = std::min<uint64_t>(begin + static_cast<uint64_t>(op.blockCount) * blockSize, baseLength);
+        if (begin >= end || begin >= baseLength) return false;
+        if (end - begin > delta.targetSize - out.size()) return false;
+        out.insert(out.end(), base + begin, base + end);
+    }
+
+    if (out.size() != delta.targetSize) return false;
+    return fileDigest(out.data(), out.size()) == delta.targetDigest;
+}
+
+bool isDeltaWorthwhile(const FileDelta& delta, uint64_t fullSize) {
+    return delta.encodedSizeEstimate() < fullSize - fullSize / 10;
+}
+
+bool readWholeFile(const std::filesystem::path& path, std::vector<char>& out) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::streamsize size = file.tellg();
+    if (size < 0) return false;
+    file.seekg(0, std::ios::beg);
+    out.resize(static_cast<size_t>(size));
+    if (size > 0 && !file.read(out.data(), size)) return false;
+    return true;
+}
+
+}
@@ -0,0 +1,80 @@
+#include "utils/LatencyHistogram.h"
+
+namespace LocalTether::Utils {
+
+size_t LatencyHistogram::indexFor(uint64_t valueUs) {
+    if (valueUs < SUB_BUCKET_COUNT) {
+        return static_cast<size_t>(valueUs);
+    }
+    unsigned msb = 0;
+    for (uint64_t rest = valueUs >> 1; rest != 0; rest >>= 1) ++msb;
+    unsigned shift = msb - (SUB_BUCKET_BITS - 1);
+    if (shift > MAX_SHIFT) {
+        return BUCKET_COUNT - 1;
+    }
+    uint64_t sub = valueUs >> shift;
+    return static_cast<size_t>(SUB_BUCKET_COUNT + (shift - 1) * HALF_BUCKET_COUNT + (sub - HALF_BUCKET_COUNT));
+}
+
+uint64_t LatencyHistogram::valueAt(size_t index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    size_t offset = index - SUB_BUCKET_COUNT;
+    unsigned shift = static_cast<unsigned>(offset / HALF_BUCKET_COUNT) + 1;
+    uint64_t sub = HALF_BUCKET_COUNT + offset % HALF_BUCKET_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t valueUs) {
+    buckets_[indexFor(valueUs)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(valueUs, std::memory_order_relaxed);
+
+    uint64_t seen = min_.load(std::memory_order_relaxed);
+    while (valueUs < seen && !min_.compare_exchange_weak(seen, valueUs, std::memory_order_relaxed)) {}
+    seen = max_.load(std::memory_order_relaxed);
+    while (valueUs > seen && !max_.compare_exchange_weak(seen, valueUs, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::minUs() const {
+    uint64_t value = min_.load(std::memory_order_relaxed);
+    return value == UINT64_MAX ? 0 : value;
+}
+
+double LatencyHistogram::meanUs() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+uint64_t LatencyHistogram::percentileUs(double fraction) const {
+    uint64_t total = count();
+    if (total == 0) return 0;
+    if (fraction < 0.0) fraction = 0.0;
+    if (fraction > 1.0) fraction = 1.0;
+    uint64_t wanted = static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5);
+    if (wanted == 0) wanted = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= wanted) {
+            uint64_t value = valueAt(i);
+            uint64_t max = maxUs();
+            return value < max ? value : max;
+        }
+    }
+    return maxUs();
+}
+
+}
@@ -0,0 +1,98 @@
+#include "utils/LatencyStats.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+
+#include <fstream>
+
+namespace LocalTether::Utils {
+
+namespace {
+    constexpr size_t END_TO_END = LATENCY_STAGE_COUNT;
+}
+
+LatencyStats& LatencyStats::GetInstance() {
+    static LatencyStats instance;
+    return instance;
+}
+
+LatencyStats::LatencyStats() {
+    enabled_.store(Config::GetInstance().Get(ConfigKeys::InputLatencyTrace), std::memory_order_relaxed);
+}
+
+const char* LatencyStats::stageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::HelperRead: return "Helper read";
+        case LatencyStage::IpcDelivery: return "IPC delivery";
+        case LatencyStage::Poll: return "pollEvents";
+        case LatencyStage::Send: return "sendInput";
+        case LatencyStage::ServerRelay: return "Server relay";
+        case LatencyStage::ReceiverHandle: return "Receiver handleMessage";
+        case LatencyStage::HelperInject: return "Helper inject";
+        default: return "Unknown";
+    }
+}
+
+void LatencyStats::recordTrace(const std::vector<uint64_t>& stampsUs) {
+    if (stampsUs.size() != LATENCY_STAGE_COUNT) return;
+
+    // Stamps from different machines only agree up to the offset estimate, so a segment that
+    // comes out negative is counted as zero rather than dropped.
+    uint64_t first = 0;
+    uint64_t previous = 0;
+    for (size_t stage = 0; stage < LATENCY_STAGE_COUNT; ++stage) {
+        uint64_t stamp = stampsUs[stage];
+        if (stamp == 0) continue;
+        if (previous != 0) {
+            histograms_[stage].record(stamp > previous ? stamp - previous : 0);
+        } else {
+            first = stamp;
+        }
+        previous = stamp;
+    }
+    if (first != 0 && previous != first) {
+        histograms_[END_TO_END].record(previous > first ? previous - first : 0);
+    }
+}
+
+void LatencyStats::record(LatencyStage stage, uint64_t durationUs) {
+    size_t index = static_cast<size_t>(stage);
+    if (index < LATENCY_STAGE_COUNT) {
+        histograms_[index].record(durationUs);
+    }
+}
+
+std::vector<LatencyStats::Summary> LatencyStats::summaries() const {
+    std::vector<Summary> rows;
+    rows.reserve(histograms_.size());
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        const auto& histogram = histograms_[i];
+        rows.push_back({i == END_TO_END ? std::string("End to end") : std::string(stageName(static_cast<LatencyStage>(i))),
+                        histogram.count(), histogram.minUs(), histogram.percentileUs(0.50),
+                        histogram.percentileUs(0.90), histogram.percentileUs(0.99), histogram.maxUs(),
+                        histogram.meanUs()});
+    }
+    return rows;
+}
+
+bool LatencyStats::exportCsv(const std::string& path) const {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        Logger::GetInstance().Error("LatencyStats: cannot open " + path + " for export.");
+        return false;
+    }
+    out << "stage,count,min_us,p50_us,p90_us,p99_us,max_us,mean_us\n";
+    for (const auto& row : summaries()) {
+        out << row.name << ',' << row.count << ',' << row.minUs << ',' << row.p50Us << ',' << row.p90Us << ','
+            << row.p99Us << ',' << row.maxUs << ',' << row.meanUs << '\n';
+    }
+    Logger::GetInstance().Info("LatencyStats: exported to " + path);
+    return static_cast<bool>(out);
+}
+
+void LatencyStats::reset() {
+    for (auto& histogram : histograms_) {
+        histogram.reset();
+    }
+}
+
+}
@@ -1,10 +1,32 @@
 #include "utils/Logger.h"
+#include "utils/UiWake.h"
 #include <iostream>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <ctime>
+#include <algorithm>
+#include <filesystem>
 
 namespace LocalTether::Utils {
+
+    namespace {
+        // How long Error and Critical wait for queue room before being dropped like the rest.
+        constexpr auto OVERFLOW_WAIT = std::chrono::milliseconds(10);
+
+        uint64_t microsSinceEpoch(std::chrono::system_clock::time_point time) {
+            return static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count());
+        }
+    }
+    
+    LogLevel parseLogLevel(const std::string& name, LogLevel fallback) {
+        if (name == "trace") return LogLevel::Trace;
+        if (name == "debug") return LogLevel::Debug;
+        if (name == "info") return LogLevel::Info;
+        if (name == "warning") return LogLevel::Warning;
+        if (name == "error") return LogLevel::Error;
+        if (name == "critical") return LogLevel::Critical;
+        return fallback;
+    }
     
     Logger& Logger::GetInstance() {
         static Logger instance;
@@ -12,74 +34,390 @@ namespace LocalTether::Utils {
     }
     
     Logger::Logger() {
-        
-         logFile.open("application.log", std::ios::out | std::ios::app);  
-        if (!logFile.is_open()) {
-            std::cerr << "CRITICAL: Failed to open log file: application.log" << std::endl;
-        }
-        Log("Logger initialized. Logging to application.log", LogLevel::Info);
+        OpenLogFile();
+        writerRunning_.store(true, std::memory_order_release);
+        writer_ = std::thread(&Logger::WriterLoop, this);
+        Log("Logger initialized. Logging to " + logPath_, LogLevel::Info);
     }
     
     Logger::~Logger() {
+        stopping_.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+        }
+        wake_.notify_one();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
         if (logFile.is_open()) {
             logFile.close();
         }
     }
-    void Logger::Log(const std::string& message, LogLevel level) {
-        std::lock_guard<std::mutex> lock(mutex);
-        std::string formatted = FormatMessage(message, level);
-        logs.push_back(formatted);
-        
-        std::cout << formatted << std::endl;
-        if (logFile.is_open()) {
-            logFile << formatted << std::endl;
+
+    void Logger::Log(std::string message, LogLevel level) {
+        if (!IsEnabled(level)) return;
+        Enqueue(Record{std::chrono::system_clock::now(), level, std::move(message)});
+    }
+
+    void Logger::Enqueue(Record record) {
+        const LogLevel level = record.level;
+        if (!writerRunning_.load(std::memory_order_acquire)) {
+            // Static destructors can still log after the writer has exited.
+            std::lock_guard<std::mutex> lock(outputMutex_);
+            std::vector<Record> single;
+            single.push_back(std::move(record));
+            WriteBatch(single);
+            return;
+        }
+
+        bool pushed = queue_.tryPush(std::move(record));
+        if (!pushed && level >= LogLevel::Error) {
+            auto deadline = std::chrono::steady_clock::now() + OVERFLOW_WAIT;
+            while (!pushed && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+                pushed = queue_.tryPush(std::move(record));
+            }
+        }
+        if (!pushed) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+
+        // Pairs with the fence in WriterLoop: either the writer sees this record before it
+        // sleeps, or we see it waiting and wake it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writerWaiting_.load(std::memory_order_relaxed)) {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex_);
+            }
+            wake_.notify_one();
+        }
+        if (level == LogLevel::Critical) {
+            Flush();
         }
     }
     
-    void Logger::Debug(const std::string& message) {
-        Log(message, LogLevel::Debug);
+    uint32_t Logger::InternFormat(std::string_view format) {
+        std::lock_guard<std::mutex> lock(formatsMutex_);
+        // Call sites cache their id, so this linear search only runs once per site.
+        for (size_t id = 1; id < formats_.size(); ++id) {
+            if (formats_[id] == format) return static_cast<uint32_t>(id);
+        }
+        formats_.emplace_back(format);
+        return static_cast<uint32_t>(formats_.size() - 1);
+    }
+
+    std::string Logger::FormatText(uint32_t formatId) {
+        if (formatId >= formatCache_.size()) {
+            std::lock_guard<std::mutex> lock(formatsMutex_);
+            formatCache_ = formats_;
+        }
+        return formatId < formatCache_.size() ? formatCache_[formatId] : std::string("{?}");
+    }
+
+    void Logger::ConfigureOutput(bool binary, uint64_t maxFileBytes, uint32_t maxFiles) {
+        {
+            std::lock_guard<std::mutex> lock(settingsMutex_);
+            pendingOutput_ = OutputSettings{binary, maxFileBytes, maxFiles};
+        }
+        outputChanged_.store(true, std::memory_order_release);
+        binary_.store(binary, std::memory_order_relaxed);
+    }
+
+    void Logger::OpenLogFile() {
+        if (logFile.is_open()) {
+            logFile.close();
+        }
+        logPath_ = output_.binary ? "application.ltlog" : "application.log";
+        std::error_code ec;
+        auto existing = std::filesystem::file_size(logPath_, ec);
+        fileBytes_ = ec ? 0 : static_cast<uint64_t>(existing);
+
+        logFile.open(logPath_, std::ios::out | std::ios::app | (output_.binary ? std::ios::binary : std::ios::openmode{}));
+        if (!logFile.is_open()) {
+            std::cerr << "CRITICAL: Failed to open log file: " << logPath_ << std::endl;
+            return;
+        }
+        if (output_.binary) {
+            // Format ids are per process, so each run starts a session that resets them.
+            std::string header;
+            if (fileBytes_ == 0) {
+                header.append(BinaryLog::FILE_MAGIC, sizeof(BinaryLog::FILE_MAGIC));
+            }
+            header += static_cast<char>(BinaryLog::FrameKind::Session);
+            BinaryLog::appendRaw(header, microsSinceEpoch(std::chrono::system_clock::now()));
+            logFile.write(header.data(), static_cast<std::streamsize>(header.size()));
+            fileBytes_ += header.size();
+            formatsInFile_.assign(formatsInFile_.size(), false);
+        }
+    }
+
+    void Logger::RotateLogFile() {
+        logFile.close();
+        std::error_code ec;
+        for (uint32_t index = output_.maxFiles; index > 1; --index) {
+            std::filesystem::rename(logPath_ + "." + std::to_string(index - 1), logPath_ + "." + std::to_string(index), ec);
+        }
+        if (output_.maxFiles > 0) {
+            std::filesystem::rename(logPath_, logPath_ + ".1", ec);
+        } else {
+            std::filesystem::remove(logPath_, ec);
+        }
+        OpenLogFile();
+    }
+
+    void Logger::WriteFileRecord(const Record& record) {
+        std::string frame;
+        if (record.formatId != 0) {
+            if (formatsInFile_.size() <= record.formatId) {
+                formatsInFile_.resize(record.formatId + 1, false);
+            }
+            if (!formatsInFile_[record.formatId]) {
+                std::string format = FormatText(record.formatId);
+                frame += static_cast<char>(BinaryLog::FrameKind::Format);
+                BinaryLog::appendRaw(frame, record.formatId);
+                BinaryLog::appendRaw(frame, static_cast<uint32_t>(format.size()));
+                frame += format;
+                formatsInFile_[record.formatId] = true;
+            }
+        }
+        frame += static_cast<char>(BinaryLog::FrameKind::Record);
+        BinaryLog::appendRaw(frame, microsSinceEpoch(record.time));
+        BinaryLog::appendRaw(frame, static_cast<uint8_t>(record.level));
+        BinaryLog::appendRaw(frame, record.formatId);
+        BinaryLog::appendRaw(frame, static_cast<uint32_t>(record.message.size()));
+        frame += record.message;
+        logFile.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        fileBytes_ += frame.size();
+    }
+
+    void Logger::Debug(std::string message) {
+        Log(std::move(message), LogLevel::Debug);
     }
     
-    void Logger::Info(const std::string& message) {
-        Log(message, LogLevel::Info);
+    void Logger::Info(std::string message) {
+        Log(std::move(message), LogLevel::Info);
     }
     
-    void Logger::Warning(const std::string& message) {
-        Log(message, LogLevel::Warning);
+    void Logger::Warning(std::string message) {
+        Log(std::move(message), LogLevel::Warning);
     }
     
-    void Logger::Error(const std::string& message) {
-        Log(message, LogLevel::Error);
+    void Logger::Error(std::string message) {
+        Log(std::move(message), LogLevel::Error);
     }
     
-    void Logger::Critical(const std::string& message) {
-        Log(message, LogLevel::Critical);
+    void Logger::Critical(std::string message) {
+        Log(std::move(message), LogLevel::Critical);
+    }
+    void Logger::Trace(std::string message) {
+        Log(std::move(message), LogLevel::Trace);
     }
-    void Logger::Trace(const std::string& message) {
-        Log(message, LogLevel::Trace);
+
+    void Logger::Flush(std::chrono::milliseconds timeout) {
+        if (!writerRunning_.load(std::memory_order_acquire) || std::this_thread::get_id() == writer_.get_id()) {
+            return;
+        }
+        uint64_t target = enqueued_.load(std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        wake_.notify_one();
+        written_.wait_for(lock, timeout, [this, target] {
+            return writtenCount_.load(std::memory_order_relaxed) >= target ||
+                   !writerRunning_.load(std::memory_order_acquire);
+        });
+    }
+
+    void Logger::WriterLoop() {
+        std::vector<Record> batch;
+        batch.reserve(256);
+        for (;;) {
+            Record record;
+            while (batch.size() < 1024 && queue_.tryPop(record)) {
+                batch.push_back(std::move(record));
+            }
+            if (!batch.empty()) {
+                size_t count = batch.size();
+                WriteBatch(batch);
+                batch.clear();
+                {
+                    std::lock_guard<std::mutex> lock(wakeMutex_);
+                    writtenCount_.fetch_add(count, std::memory_order_relaxed);
+                }
+                written_.notify_all();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            writerWaiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (queue_.tryPop(record)) {
+                writerWaiting_.store(false, std::memory_order_relaxed);
+                batch.push_back(std::move(record));
+                continue;
+            }
+            if (stopping_.load(std::memory_order_acquire)) {
+                writerWaiting_.store(false, std::memory_order_relaxed);
+                break;
+            }
+            // No timeout: Enqueue, Flush and the destructor all notify under wakeMutex_, and the
+            // flag is set while it is held, so a wakeup cannot fall between the check and the wait.
+            wake_.wait(lock);
+            writerWaiting_.store(false, std::memory_order_relaxed);
+        }
+
+        // Anything logged from here on is written directly by the caller.
+        std::lock_guard<std::mutex> lock(outputMutex_);
+        writerRunning_.store(false, std::memory_order_release);
+        Record record;
+        while (queue_.tryPop(record)) {
+            batch.push_back(std::move(record));
+        }
+        WriteBatch(batch);
+        written_.notify_all();
+    }
+
+    void Logger::WriteBatch(std::vector<Record>& batch) {
+        if (outputChanged_.exchange(false, std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(settingsMutex_);
+            bool reopen = pendingOutput_.binary != output_.binary;
+            output_ = pendingOutput_;
+            if (reopen) {
+                OpenLogFile();
+            }
+        }
+
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != droppedReported_) {
+            Record notice{std::chrono::system_clock::now(), LogLevel::Warning,
+                          "Logger: queue full, dropped " + std::to_string(dropped - droppedReported_) + " message(s)."};
+            droppedReported_ = dropped;
+            batch.push_back(std::move(notice));
+        }
+        if (batch.empty()) return;
+
+        // Binary output exists to keep formatting off the hot path, so only lines worth seeing
+        // on a terminal are rendered; the history renders its records when they are read.
+        const bool echoAll = !output_.binary;
+        std::string output;
+        for (const auto& record : batch) {
+            if (echoAll || record.level >= LogLevel::Warning) {
+                output += FormatMessage(record);
+                output += '\n';
+            }
+        }
+
+        std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+        std::cout.flush();
+        if (logFile.is_open()) {
+            if (output_.binary) {
+                for (const auto& record : batch) {
+                    WriteFileRecord(record);
+                }
+            } else {
+                logFile.write(output.data(), static_cast<std::streamsize>(output.size()));
+                fileBytes_ += output.size();
+            }
+            logFile.flush();
+            if (output_.maxFileBytes > 0 && fileBytes_ >= output_.maxFileBytes) {
+                RotateLogFile();
+            }
+        }
+
+        // Last, so the records can be moved rather than copied.
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& record : batch) {
+                HistoryEntry entry{nextSequence_++, std::move(record)};
+                if (logs.size() < HISTORY_CAPACITY) {
+                    logs.push_back(std::move(entry));
+                } else {
+                    logs[entry.sequence % HISTORY_CAPACITY] = std::move(entry);
+                }
+            }
+            if (nextSequence_ - firstRetained_ > HISTORY_CAPACITY) {
+                firstRetained_ = nextSequence_ - HISTORY_CAPACITY;
+            }
+        }
+        UiWake::notify();
     }
     
-     std::vector<std::string> Logger::GetLogs() {
-        std::lock_guard<std::mutex> lock(mutex);
-        return logs;
+    std::vector<std::string> Logger::GetLogs() {
+        std::vector<HistoryEntry> entries;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.reserve(static_cast<size_t>(nextSequence_ - firstRetained_));
+            for (uint64_t sequence = firstRetained_; sequence < nextSequence_; ++sequence) {
+                entries.push_back(logs[sequence % HISTORY_CAPACITY]);
+            }
+        }
+        std::vector<std::string> lines;
+        lines.reserve(entries.size());
+        for (const auto& entry : entries) {
+            lines.push_back(RenderRecord(entry.record));
+        }
+        return lines;
+    }
+
+    uint64_t Logger::GetLogsSince(uint64_t sequence, std::vector<LogEntry>& out) {
+        std::vector<HistoryEntry> entries;
+        uint64_t next = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (sequence = std::max(sequence, firstRetained_); sequence < nextSequence_; ++sequence) {
+                entries.push_back(logs[sequence % HISTORY_CAPACITY]);
+            }
+            next = nextSequence_;
+        }
+        // Rendered outside the lock so a reader never holds up the writer.
+        for (auto& entry : entries) {
+            out.push_back(LogEntry{entry.sequence, entry.record.level, RenderRecord(entry.record)});
+        }
+        return next;
     }
     
     void Logger::Clear() {
         std::lock_guard<std::mutex> lock(mutex);
-        logs.clear();
+        firstRetained_ = nextSequence_;
     }
     
-    std::string Logger::FormatMessage(const std::string& message, LogLevel level) {
-        auto now = std::chrono::system_clock::now();
-        auto now_time_t = std::chrono::system_clock::to_time_t(now);
-        auto now_tm = std::localtime(&now_time_t);
-        
-        std::stringstream ss;
-        ss << "[" << std::put_time(now_tm, "%H:%M:%S") << "] ";
-        ss << "[" << LogLevelToString(level) << "] ";
-        ss << message;
-        
-        return ss.str();
+    std::string Logger::FormatMessage(const Record& record) {
+        return FormatLine(record, record.formatId != 0 ? FormatText(record.formatId) : std::string());
+    }
+
+    std::string Logger::RenderRecord(const Record& record) {
+        std::string format;
+        if (record.formatId != 0) {
+            std::lock_guard<std::mutex> lock(formatsMutex_);
+            format = record.formatId < formats_.size() ? formats_[record.formatId] : std::string("{?}");
+        }
+        return FormatLine(record, format);
+    }
+
+    std::string Logger::FormatLine(const Record& record, std::string_view format) {
+        std::time_t time = std::chrono::system_clock::to_time_t(record.time);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        char stamp[16];
+        size_t stampLength = std::strftime(stamp, sizeof(stamp), "%H:%M:%S", &local);
+
+        std::string formatted;
+        formatted.reserve(stampLength + record.message.size() + 16);
+        formatted += '[';
+        formatted.append(stamp, stampLength);
+        formatted += "] [";
+        formatted += LogLevelToString(record.level);
+        formatted += "] ";
+        if (record.formatId != 0) {
+            formatted += BinaryLog::render(format, record.message);
+        } else {
+            formatted += record.message;
+        }
+        return formatted;
     }
     
     std::string Logger::LogLevelToString(LogLevel level) {
@@ -0,0 +1,255 @@
+#include "utils/MappedFile.h"
+#include "utils/Logger.h"
+
+#include <unordered_map>
+#include <mutex>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+    #define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#endif
+
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace LocalTether::Utils {
+
+namespace {
+    std::mutex g_mappingCacheMutex;
+    std::unordered_map<std::string, std::weak_ptr<const MappedFile>> g_mappingCache;
+
+#ifndef _WIN32
+    // Live mappings, read by the SIGBUS handler without taking locks. A slot is claimed by
+    // moving begin from FREE to RESERVED, filled in, and published by storing the real begin.
+    constexpr uintptr_t SLOT_FREE = 0;
+    constexpr uintptr_t SLOT_RESERVED = UINTPTR_MAX;
+    constexpr size_t GUARD_SLOT_COUNT = 4096;
+
+    struct GuardSlot {
+        std::atomic<uintptr_t> begin{SLOT_FREE};
+        std::atomic<uintptr_t> end{0};
+        std::atomic<std::atomic<bool>*> truncated{nullptr};
+    };
+
+    std::array<GuardSlot, GUARD_SLOT_COUNT> g_guardSlots;
+    uintptr_t g_pageSize = 4096;
+    struct sigaction g_previousSigbus;
+    std::once_flag g_sigbusHandlerInstalled;
+
+    void onSigbus(int sig, siginfo_t* info, void* context) {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+        for (auto& slot : g_guardSlots) {
+            const uintptr_t begin = slot.begin.load(std::memory_order_acquire);
+            if (begin == SLOT_FREE || begin == SLOT_RESERVED || address < begin ||
+                address >= slot.end.load(std::memory_order_acquire)) {
+                continue;
+            }
+            // The file shrank under the mapping. Back the missing page with zeros and let the read continue.
+            void* page = reinterpret_cast<void*>(address & ~(g_pageSize - 1));
+            if (mmap(page, g_pageSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+                break;
+            }
+            if (auto* flag = slot.truncated.load(std::memory_order_acquire)) {
+                flag->store(true, std::memory_order_release);
+            }
+            return;
+        }
+
+        // Not one of ours: behave as if this handler had never been installed.
+        if (g_previousSigbus.sa_flags & SA_SIGINFO) {
+            if (g_previousSigbus.sa_sigaction) {
+                g_previousSigbus.sa_sigaction(sig, info, context);
+                return;
+            }
+        } else if (g_previousSigbus.sa_handler != SIG_DFL && g_previousSigbus.sa_handler != SIG_IGN) {
+            g_previousSigbus.sa_handler(sig);
+            return;
+        }
+        // Returning re-runs the faulting access, which now takes the default action.
+        signal(SIGBUS, SIG_DFL);
+    }
+
+    int registerGuard(const char* data, size_t size, std::atomic<bool>* truncated) {
+        std::call_once(g_sigbusHandlerInstalled, [] {
+            g_pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+            struct sigaction action {};
+            action.sa_sigaction = onSigbus;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_SIGINFO;
+            sigaction(SIGBUS, &action, &g_previousSigbus);
+        });
+
+        for (size_t i = 0; i < g_guardSlots.size(); ++i) {
+            auto& slot = g_guardSlots[i];
+            uintptr_t expected = SLOT_FREE;
+            if (slot.begin.compare_exchange_strong(expected, SLOT_RESERVED, std::memory_order_acq_rel)) {
+                const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+                slot.truncated.store(truncated, std::memory_order_release);
+                slot.end.store(begin + size, std::memory_order_release);
+                slot.begin.store(begin, std::memory_order_release);
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    void unregisterGuard(int index) {
+        auto& slot = g_guardSlots[static_cast<size_t>(index)];
+        slot.begin.store(SLOT_RESERVED, std::memory_order_release);
+        slot.end.store(0, std::memory_order_release);
+        slot.truncated.store(nullptr, std::memory_order_release);
+        slot.begin.store(SLOT_FREE, std::memory_order_release);
+    }
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFile::Open(const fs::path& path) {
+    std::error_code ec;
+    const std::string key = fs::weakly_canonical(path, ec).string();
+    const uintmax_t currentSize = fs::file_size(path, ec);
+    if (ec) return nullptr;
+    const auto currentMtime = fs::last_write_time(path, ec);
+    if (ec) return nullptr;
+
+    std::lock_guard<std::mutex> lock(g_mappingCacheMutex);
+    auto it = g_mappingCache.find(key);
+    if (it != g_mappingCache.end()) {
+        if (auto existing = it->second.lock()) {
+            if (existing->size_ == currentSize && existing->modifiedTime_ == currentMtime && !existing->truncated()) {
+                return existing;
+            }
+        }
+    }
+
+    std::shared_ptr<MappedFile> mapped(new MappedFile());
+    if (!mapped->map(path)) {
+        return nullptr;
+    }
+    mapped->path_ = key;
+    mapped->modifiedTime_ = currentMtime;
+    g_mappingCache[key] = mapped;
+
+    for (auto cacheIt = g_mappingCache.begin(); cacheIt != g_mappingCache.end();) {
+        if (cacheIt->second.expired()) {
+            cacheIt = g_mappingCache.erase(cacheIt);
+        } else {
+            ++cacheIt;
+        }
+    }
+    return mapped;
+}
+
+bool MappedFile::copyTo(size_t offset, size_t length, char* out) const {
+    std::memcpy(out, data_ + offset, length);
+    return !truncated();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::map(const fs::path& path) {
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        Logger::GetInstance().Error("MappedFile: Could not open " + path.string() + " (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    fileHandle_ = file;
+    if (size_ == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        Logger::GetInstance().Error("MappedFile: CreateFileMapping failed for " + path.string() + " (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+    mappingHandle_ = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        Logger::GetInstance().Error("MappedFile: MapViewOfFile failed for " + path.string() + " (error " + std::to_string(GetLastError()) + ")");
+        return false;
+    }
+    data_ = static_cast<const char*>(view);
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mappingHandle_) CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    if (fileHandle_) CloseHandle(static_cast<HANDLE>(fileHandle_));
+}
+
+#else
+
+bool MappedFile::map(const fs::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Logger::GetInstance().Error("MappedFile: Could not open " + path.string() + ": " + std::strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        Logger::GetInstance().Error("MappedFile: mmap failed for " + path.string() + ": " + std::strerror(errno));
+        size_ = 0;
+        return false;
+    }
+    guardSlot_ = registerGuard(static_cast<const char*>(addr), size_, &truncated_);
+    if (guardSlot_ < 0) {
+        // Unguarded, a truncation by another process would take the whole server down.
+        Logger::GetInstance().Error("MappedFile: Too many files mapped at once, not mapping " + path.string());
+        munmap(addr, size_);
+        size_ = 0;
+        return false;
+    }
+    madvise(addr, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(addr);
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (guardSlot_ >= 0) {
+        unregisterGuard(guardSlot_);
+    }
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+#endif
+
+}
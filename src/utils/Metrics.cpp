@@ -0,0 +1,233 @@
+#include "utils/Metrics.h"
+#include "utils/AtomicFile.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace LocalTether::Utils {
+
+namespace {
+    std::atomic<size_t> g_nextShard{0};
+
+    const char* kindName(MetricKind kind) {
+        switch (kind) {
+            case MetricKind::Counter: return "counter";
+            case MetricKind::Gauge: return "gauge";
+            case MetricKind::Summary: return "summary";
+        }
+        return "untyped";
+    }
+
+    void appendSeries(std::ostringstream& out, const std::string& name, const std::string& labels,
+                      const std::string& extraLabel, double value) {
+        out << name;
+        if (!labels.empty() || !extraLabel.empty()) {
+            out << '{' << labels;
+            if (!labels.empty() && !extraLabel.empty()) out << ',';
+            out << extraLabel << '}';
+        }
+        out << ' ';
+        if (std::floor(value) == value && std::fabs(value) < 1e15) {
+            out << static_cast<int64_t>(value);
+        } else {
+            out << value;
+        }
+        out << '\n';
+    }
+}
+
+size_t Counter::shardIndex() {
+    // Threads are spread round robin as they first touch any counter.
+    thread_local size_t index = g_nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+    return index;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricsRegistry& MetricsRegistry::GetInstance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    stopPeriodicDump();
+}
+
+template <typename T>
+T& MetricsRegistry::findOrCreate(std::vector<Series<T>>& series, const std::string& name, const std::string& help,
+                                 const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : series) {
+        if (entry.name == name && entry.labels == labels) {
+            return *entry.metric;
+        }
+    }
+    series.push_back({name, help, labels, std::make_unique<T>()});
+    return *series.back().metric;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    return findOrCreate(counters_, name, help, labels);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    return findOrCreate(gauges_, name, help, labels);
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+    return findOrCreate(histograms_, name, help, labels);
+}
+
+uint64_t MetricsRegistry::addCollector(Collector collector) {
+    std::lock_guard<std::mutex> lock(collectorsMutex_);
+    uint64_t token = nextCollectorToken_++;
+    collectors_.emplace(token, std::move(collector));
+    return token;
+}
+
+void MetricsRegistry::removeCollector(uint64_t token) {
+    std::lock_guard<std::mutex> lock(collectorsMutex_);
+    collectors_.erase(token);
+}
+
+std::string MetricsRegistry::label(const std::string& key, const std::string& value) {
+    std::string out = key + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+std::vector<MetricSample> MetricsRegistry::snapshot() const {
+    std::vector<MetricSample> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        samples.reserve(counters_.size() + gauges_.size() + histograms_.size());
+        for (const auto& entry : counters_) {
+            MetricSample sample{entry.name, entry.help, entry.labels, MetricKind::Counter};
+            sample.value = static_cast<double>(entry.metric->value());
+            samples.push_back(std::move(sample));
+        }
+        for (const auto& entry : gauges_) {
+            MetricSample sample{entry.name, entry.help, entry.labels, MetricKind::Gauge};
+            sample.value = static_cast<double>(entry.metric->value());
+            samples.push_back(std::move(sample));
+        }
+        for (const auto& entry : histograms_) {
+            const LatencyHistogram& histogram = *entry.metric;
+            MetricSample sample{entry.name, entry.help, entry.labels, MetricKind::Summary};
+            sample.count = histogram.count();
+            sample.sumUs = histogram.sumUs();
+            sample.p50Us = histogram.percentileUs(0.50);
+            sample.p90Us = histogram.percentileUs(0.90);
+            sample.p99Us = histogram.percentileUs(0.99);
+            sample.maxUs = histogram.maxUs();
+            samples.push_back(std::move(sample));
+        }
+    }
+    {
+        // Collectors take their owners' locks, so they run outside the registry lock.
+        std::lock_guard<std::mutex> lock(collectorsMutex_);
+        for (const auto& [token, collector] : collectors_) {
+            collector(samples);
+        }
+    }
+    // Series of one family must be adjacent in the exposition format.
+    std::stable_sort(samples.begin(), samples.end(),
+                     [](const MetricSample& a, const MetricSample& b) { return a.name < b.name; });
+    return samples;
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    std::ostringstream out;
+    const std::string* family = nullptr;
+    auto samples = snapshot();
+    for (const auto& sample : samples) {
+        if (!family || *family != sample.name) {
+            family = &sample.name;
+            if (!sample.help.empty()) out << "# HELP " << sample.name << ' ' << sample.help << '\n';
+            out << "# TYPE " << sample.name << ' ' << kindName(sample.kind) << '\n';
+        }
+        if (sample.kind != MetricKind::Summary) {
+            appendSeries(out, sample.name, sample.labels, "", sample.value);
+            continue;
+        }
+        appendSeries(out, sample.name, sample.labels, "quantile=\"0.5\"", static_cast<double>(sample.p50Us));
+        appendSeries(out, sample.name, sample.labels, "quantile=\"0.9\"", static_cast<double>(sample.p90Us));
+        appendSeries(out, sample.name, sample.labels, "quantile=\"0.99\"", static_cast<double>(sample.p99Us));
+        appendSeries(out, sample.name + "_sum", sample.labels, "", static_cast<double>(sample.sumUs));
+        appendSeries(out, sample.name + "_count", sample.labels, "", static_cast<double>(sample.count));
+    }
+    return out.str();
+}
+
+void MetricsRegistry::startPeriodicDump() {
+    int intervalSeconds = Config::GetInstance().Get(ConfigKeys::MetricsDumpIntervalS);
+    std::string path = Config::GetInstance().Get(ConfigKeys::MetricsDumpPath);
+    if (intervalSeconds <= 0 || path.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(dumpMutex_);
+    if (dumpThread_.joinable()) {
+        return;
+    }
+    dumpStopping_ = false;
+    Logger::GetInstance().Info("Metrics: dumping to " + path + " every " + std::to_string(intervalSeconds) + "s.");
+    dumpThread_ = std::thread(&MetricsRegistry::dumpLoop, this, std::move(path), std::chrono::seconds(intervalSeconds));
+}
+
+void MetricsRegistry::stopPeriodicDump() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(dumpMutex_);
+        dumpStopping_ = true;
+        thread = std::move(dumpThread_);
+    }
+    dumpWake_.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void MetricsRegistry::dumpLoop(std::string path, std::chrono::seconds interval) {
+    bool warned = false;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(dumpMutex_);
+            if (dumpWake_.wait_for(lock, interval, [this] { return dumpStopping_; })) {
+                return;
+            }
+        }
+        // Readers polling the file only ever see a whole scrape.
+        std::string text = renderPrometheus();
+        std::string error;
+        if (!AtomicFileWriter::writeFile(path, text.data(), text.size(), DurabilityPolicy::None, &error)) {
+            if (!warned) {
+                Logger::GetInstance().Warning("Metrics: cannot write " + path + ": " + error);
+                warned = true;
+            }
+        } else {
+            warned = false;
+        }
+    }
+}
+
+}
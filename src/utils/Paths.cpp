@@ -0,0 +1,77 @@
+#include "utils/Paths.h"
+#include "utils/Logger.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#include <limits.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#include <limits.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace LocalTether::Utils {
+
+fs::path executableDirectory() {
+    fs::path exe_path;
+#ifdef _WIN32
+    wchar_t path_buf[MAX_PATH] = {0};
+    GetModuleFileNameW(NULL, path_buf, MAX_PATH);
+    exe_path = path_buf;
+#elif defined(__linux__)
+    char result[PATH_MAX];
+    ssize_t count = readlink("/proc/self/exe", result, PATH_MAX);
+    if (count != -1) {
+        exe_path = std::string(result, (size_t)count);
+    }
+#elif defined(__APPLE__)
+    char path_buf[PATH_MAX];
+    uint32_t bufsize = PATH_MAX;
+    if (_NSGetExecutablePath(path_buf, &bufsize) == 0) {
+        exe_path = path_buf;
+    }
+#endif
+    if (!exe_path.empty()) {
+        return exe_path.parent_path();
+    }
+
+    Logger::GetInstance().Error("Could not determine executable directory. Falling back to current_path().");
+    return fs::current_path();
+}
+
+fs::path findAncestorDirectory(const fs::path& startPath, const std::string& targetName, int maxDepth) {
+    fs::path current_path = fs::absolute(startPath);
+    for (int i = 0; i < maxDepth && !current_path.empty() && current_path.has_parent_path(); ++i) {
+        if (current_path.filename().string() == targetName) {
+            return current_path;
+        }
+        if (current_path.parent_path() == current_path) break;
+        current_path = current_path.parent_path();
+    }
+    if (!current_path.empty() && current_path.filename().string() == targetName) {
+        return current_path;
+    }
+    return "";
+}
+
+fs::path dataDirectory() {
+    fs::path exe_dir = executableDirectory();
+    fs::path project_root_path = findAncestorDirectory(exe_dir, "LocalTether", 4);
+    return project_root_path.empty() ? exe_dir : project_root_path;
+}
+
+bool isPathWithin(const fs::path& path, const fs::path& root) {
+    // "/a/b/" iterates with a trailing empty element; drop it so it does not have to match.
+    fs::path base = (!root.has_filename() && root.has_relative_path()) ? root.parent_path() : root;
+    if (base.empty()) {
+        return false;
+    }
+    auto mismatch = std::mismatch(base.begin(), base.end(), path.begin(), path.end());
+    return mismatch.first == base.end();
+}
+
+}
@@ -4,22 +4,21 @@
 namespace LocalTether::Utils {
 
 std::vector<uint8_t> serializeInputPayload(const Network::InputPayload& payload) {
-    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> buffer(INPUT_PAYLOAD_FIXED_SIZE + payload.keyEvents.size() * INPUT_PAYLOAD_KEY_SIZE);
+    serializeInputPayloadInto(payload, buffer.data(), buffer.size());
+    return buffer;
+}
 
-  
-    size_t initial_capacity = sizeof(payload.isMouseEvent) +
-                              sizeof(payload.relativeX) +
-                              sizeof(payload.relativeY) +
-                              sizeof(payload.mouseButtons) +
-                              sizeof(payload.scrollDeltaX) +
-                              sizeof(payload.scrollDeltaY) +
-                              sizeof(payload.sourceDeviceType) +  
-                              sizeof(uint32_t) +  
-                              (payload.keyEvents.size() * (sizeof(uint8_t) + sizeof(bool)));
-    buffer.reserve(initial_capacity);
+size_t serializeInputPayloadInto(const Network::InputPayload& payload, uint8_t* out, size_t capacity) {
+    const size_t size = INPUT_PAYLOAD_FIXED_SIZE + payload.keyEvents.size() * INPUT_PAYLOAD_KEY_SIZE;
+    if (size > capacity) {
+        return 0;
+    }
 
+    size_t offset = 0;
     auto append = [&](const void* d, size_t s) {
-        buffer.insert(buffer.end(), static_cast<const uint8_t*>(d), static_cast<const uint8_t*>(d) + s);
+        std::memcpy(out + offset, d, s);
+        offset += s;
     };
 
     append(&payload.isMouseEvent, sizeof(payload.isMouseEvent));
@@ -29,6 +28,11 @@ std::vector<uint8_t> serializeInputPayload(const Network::InputPayload& payload)
     append(&payload.scrollDeltaX, sizeof(payload.scrollDeltaX));
     append(&payload.scrollDeltaY, sizeof(payload.scrollDeltaY));
     append(&payload.sourceDeviceType, sizeof(payload.sourceDeviceType));  
+    append(&payload.deltaX, sizeof(payload.deltaX));
+    append(&payload.deltaY, sizeof(payload.deltaY));
+    append(&payload.scrollHiResX, sizeof(payload.scrollHiResX));
+    append(&payload.scrollHiResY, sizeof(payload.scrollHiResY));
+    append(&payload.ipcStampUs, sizeof(payload.ipcStampUs));
 
     uint32_t numKeyEvents = static_cast<uint32_t>(payload.keyEvents.size());
     append(&numKeyEvents, sizeof(numKeyEvents));
@@ -36,7 +40,7 @@ std::vector<uint8_t> serializeInputPayload(const Network::InputPayload& payload)
         append(&keyEvent.keyCode, sizeof(keyEvent.keyCode));
         append(&keyEvent.isPressed, sizeof(keyEvent.isPressed));
     }
-    return buffer;
+    return offset;
 }
 
 std::optional<Network::InputPayload> deserializeInputPayload(const uint8_t* data, size_t length) {
@@ -57,6 +61,11 @@ std::optional<Network::InputPayload> deserializeInputPayload(const uint8_t* data
     if (!read(&payload.scrollDeltaX, sizeof(payload.scrollDeltaX))) return std::nullopt;
     if (!read(&payload.scrollDeltaY, sizeof(payload.scrollDeltaY))) return std::nullopt;
     if (!read(&payload.sourceDeviceType, sizeof(payload.sourceDeviceType))) return std::nullopt;  
+    if (!read(&payload.deltaX, sizeof(payload.deltaX))) return std::nullopt;
+    if (!read(&payload.deltaY, sizeof(payload.deltaY))) return std::nullopt;
+    if (!read(&payload.scrollHiResX, sizeof(payload.scrollHiResX))) return std::nullopt;
+    if (!read(&payload.scrollHiResY, sizeof(payload.scrollHiResY))) return std::nullopt;
+    if (!read(&payload.ipcStampUs, sizeof(payload.ipcStampUs))) return std::nullopt;
 
     uint32_t numKeyEvents;
     if (!read(&numKeyEvents, sizeof(numKeyEvents))) return std::nullopt;
@@ -69,7 +78,7 @@ std::optional<Network::InputPayload> deserializeInputPayload(const uint8_t* data
 
      
     if (offset > length && numKeyEvents > 0) return std::nullopt;  
-    if (offset > length && numKeyEvents == 0 && (offset - (sizeof(payload.isMouseEvent) + sizeof(payload.relativeX) + sizeof(payload.relativeY) + sizeof(payload.mouseButtons) + sizeof(payload.scrollDeltaX) + sizeof(payload.scrollDeltaY) + sizeof(payload.sourceDeviceType) + sizeof(uint32_t))) > 0 ) return std::nullopt;
+    if (offset > length && numKeyEvents == 0 && (offset - (sizeof(payload.isMouseEvent) + sizeof(payload.relativeX) + sizeof(payload.relativeY) + sizeof(payload.mouseButtons) + sizeof(payload.scrollDeltaX) + sizeof(payload.scrollDeltaY) + sizeof(payload.sourceDeviceType) + sizeof(payload.deltaX) + sizeof(payload.deltaY) + sizeof(payload.scrollHiResX) + sizeof(payload.scrollHiResY) + sizeof(payload.ipcStampUs) + sizeof(uint32_t))) > 0 ) return std::nullopt;
 
 
     return payload;
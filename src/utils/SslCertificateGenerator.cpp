@@ -1,13 +1,13 @@
 #include "utils/SslCertificateGenerator.h"
 #include "utils/Logger.h"  
+#include "utils/Config.h"
+#include "utils/Paths.h"
 
 #include <openssl/pem.h>
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 #include <openssl/evp.h>
-#include <openssl/rsa.h>
-#include <openssl/param_build.h>
-#include <openssl/dh.h>
+#include <openssl/ec.h>
 #include <openssl/err.h>
 #include <openssl/bn.h>  
 
@@ -15,6 +15,8 @@
 #include <filesystem>  
 #include <random>      
 #include <fstream>     
+#include <future>
+#include <mutex>
 
 namespace LT = LocalTether;
 
@@ -43,16 +45,17 @@ void SslCertificateGenerator::logOpenSslErrors(const std::string& contextMessage
     }
 }
 
-bool SslCertificateGenerator::generatePrivateKey(const std::string& keyPath, int bits) {
+bool SslCertificateGenerator::generatePrivateKey(const std::string& keyPath) {
     LT::Utils::Logger::GetInstance().Info("Generating private key: " + keyPath);
     EVP_PKEY_CTX *pctx = nullptr;
     EVP_PKEY *pkey = nullptr;
     BIO *bio = nullptr;
     bool success = true;
 
-    pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+    // P-256 takes milliseconds to generate, where RSA-2048 could take a second or more.
+    pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
     if (!pctx) {
-        logOpenSslErrors("EVP_PKEY_CTX_new_id for RSA in generatePrivateKey");
+        logOpenSslErrors("EVP_PKEY_CTX_new_id for EC in generatePrivateKey");
         success = false;
     }
 
@@ -64,8 +67,8 @@ bool SslCertificateGenerator::generatePrivateKey(const std::string& keyPath, int
     }
 
     if (success) {
-        if (EVP_PKEY_CTX_set_rsa_keygen_bits(pctx, bits) <= 0) {
-            logOpenSslErrors("EVP_PKEY_CTX_set_rsa_keygen_bits in generatePrivateKey");
+        if (EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, NID_X9_62_prime256v1) <= 0) {
+            logOpenSslErrors("EVP_PKEY_CTX_set_ec_paramgen_curve_nid in generatePrivateKey");
             success = false;
         }
     }
@@ -93,7 +96,14 @@ bool SslCertificateGenerator::generatePrivateKey(const std::string& keyPath, int
         }
     }
 
+    if (bio) {
+        BIO_free_all(bio);
+        bio = nullptr;
+    }
     if (success) {
+        std::error_code permissionsEc;
+        std::filesystem::permissions(keyPath, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+                                     std::filesystem::perm_options::replace, permissionsEc);
         LT::Utils::Logger::GetInstance().Info("Private key generated successfully: " + keyPath);
     } else {
         LT::Utils::Logger::GetInstance().Error("Failed to generate private key: " + keyPath);
@@ -260,107 +270,46 @@ bool SslCertificateGenerator::generateCertificate(const std::string& certPath, c
     return success;
 }
 
-bool SslCertificateGenerator::generateDhParams(const std::string& dhParamsPath, int bits) {
-    LT::Utils::Logger::GetInstance().Info("Generating DH parameters using EVP_PKEY API: " + dhParamsPath + " (this may take a moment)...");
-    EVP_PKEY *pkey_params = nullptr;
-    EVP_PKEY_CTX *pctx = nullptr;
-    BIO *bio = nullptr;
-    bool success = true;
-
-     
-     
-    pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_DH, nullptr);
-    if (!pctx) {
-        logOpenSslErrors("EVP_PKEY_CTX_new_id for DH in generateDhParams");
-        success = false;
-    }
-
-    if (success) {
-         
-        if (EVP_PKEY_paramgen_init(pctx) <= 0) {
-            logOpenSslErrors("EVP_PKEY_paramgen_init in generateDhParams");
-            success = false;
-        }
-    }
-
-    if (success) {
-         
-        if (EVP_PKEY_CTX_set_dh_paramgen_prime_len(pctx, bits) <= 0) {
-            logOpenSslErrors("EVP_PKEY_CTX_set_dh_paramgen_prime_len in generateDhParams");
-            success = false;
-        }
-    }
-    
-    if (success) {
-         
-         
-        if (EVP_PKEY_CTX_set_dh_paramgen_generator(pctx, DH_GENERATOR_2) <= 0) {
-            logOpenSslErrors("EVP_PKEY_CTX_set_dh_paramgen_generator in generateDhParams");
-            success = false;
-        }
-    }
-
-    if (success) {
-         
-        if (EVP_PKEY_paramgen(pctx, &pkey_params) <= 0) {
-            logOpenSslErrors("EVP_PKEY_paramgen in generateDhParams");
-            success = false;
-        }
-    }
-
-     
-     
-     
-     
-     
-
-    if (success) {
-        bio = BIO_new_file(dhParamsPath.c_str(), "wb");
-        if (!bio) {
-            LT::Utils::Logger::GetInstance().Error("BIO_new_file failed for DH params in generateDhParams for: " + dhParamsPath);
-            success = false;
-        }
-    }
-    if (success) {
-         
-         
-        if (PEM_write_bio_Parameters(bio, pkey_params) != 1) {
-            logOpenSslErrors("PEM_write_bio_Parameters in generateDhParams");
-            success = false;
-        }
-    }
-
-    if (success) {
-        LT::Utils::Logger::GetInstance().Info("DH parameters generated successfully: " + dhParamsPath);
-    } else {
-        LT::Utils::Logger::GetInstance().Error("Failed to generate DH parameters: " + dhParamsPath);
-    }
+std::string SslCertificateGenerator::DefaultKeyPath() {
+    return (tlsDirectory() / "server.key").string();
+}
 
-    if (bio) BIO_free_all(bio);
-    if (pkey_params) EVP_PKEY_free(pkey_params);
-    if (pctx) EVP_PKEY_CTX_free(pctx);
-    return success;
+std::string SslCertificateGenerator::DefaultCertPath() {
+    return (tlsDirectory() / "server.crt").string();
 }
 
+std::filesystem::path SslCertificateGenerator::tlsDirectory() {
+    std::string configured = Config::GetInstance().Get(ConfigKeys::TlsDir);
+    return configured.empty() ? dataDirectory() / "tls" : std::filesystem::path(configured);
+}
 
 bool SslCertificateGenerator::EnsureSslFiles(
     const std::string& keyPath,
-    const std::string& certPath,
-    const std::string& dhParamsPath) {
+    const std::string& certPath) {
+
+    // A background PrepareInBackground and the server may both get here; the second one
+    // waits and then finds the files in place.
+    static std::mutex ensureMutex;
+    std::lock_guard<std::mutex> lock(ensureMutex);
 
     bool keyOk = fileExists(keyPath);
     bool certOk = fileExists(certPath);
-    bool dhOk = fileExists(dhParamsPath);
 
-    if (keyOk && certOk && dhOk) {
-        LT::Utils::Logger::GetInstance().Info("All SSL files (key, cert, dhparams) already exist.");
+    if (keyOk && certOk) {
+        LT::Utils::Logger::GetInstance().Info("SSL key and certificate already exist: " + keyPath + ", " + certPath);
         return true;
     }
 
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(keyPath).parent_path(), ec);
+    std::filesystem::create_directories(std::filesystem::path(certPath).parent_path(), ec);
+
     if (!keyOk) {
         if (!generatePrivateKey(keyPath)) {
             return false;
         }
+        // A certificate left over from an older key would not match the new one.
+        certOk = false;
     } else {
         LT::Utils::Logger::GetInstance().Info("Private key file already exists: " + keyPath);
     }
@@ -380,16 +329,16 @@ bool SslCertificateGenerator::EnsureSslFiles(
         LT::Utils::Logger::GetInstance().Info("Certificate file already exists: " + certPath);
     }
 
-    if (!dhOk) {
-        if (!generateDhParams(dhParamsPath)) {
-            return false;
-        }
-    } else {
-        LT::Utils::Logger::GetInstance().Info("DH parameters file already exists: " + dhParamsPath);
-    }
+    return fileExists(keyPath) && fileExists(certPath);
+}
 
-     
-    return fileExists(keyPath) && fileExists(certPath) && fileExists(dhParamsPath);
+void SslCertificateGenerator::PrepareInBackground() {
+    // Function-local so it is joined before the logger it reports to is destroyed.
+    static std::future<bool> pending;
+    if (pending.valid()) {
+        return;
+    }
+    pending = std::async(std::launch::async, [] { return EnsureSslFiles(); });
 }
 
-}  
\ No newline at end of file
+}
@@ -0,0 +1,63 @@
+#include "utils/StartupProgress.h"
+#include "utils/UiWake.h"
+
+namespace LocalTether::Utils {
+
+StartupProgress& StartupProgress::GetInstance() {
+    static StartupProgress instance;
+    return instance;
+}
+
+const char* StartupProgress::stageName(StartupStage stage) {
+    switch (stage) {
+        case StartupStage::Listen: return "Opening port";
+        case StartupStage::Tls: return "Preparing TLS certificate";
+        case StartupStage::Storage: return "Indexing shared files";
+        default: return "Unknown";
+    }
+}
+
+uint64_t StartupProgress::nowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void StartupProgress::reset() {
+    for (auto& slot : slots_) {
+        slot.status.store(StageStatus::Pending, std::memory_order_relaxed);
+    }
+    resetMs_.store(nowMs(), std::memory_order_relaxed);
+}
+
+void StartupProgress::begin(StartupStage stage) {
+    Slot& slot = slots_[static_cast<size_t>(stage)];
+    slot.startedMs.store(nowMs(), std::memory_order_relaxed);
+    slot.status.store(StageStatus::Running, std::memory_order_release);
+    UiWake::notify();
+}
+
+void StartupProgress::finish(StartupStage stage, bool ok) {
+    Slot& slot = slots_[static_cast<size_t>(stage)];
+    slot.finishedMs.store(nowMs(), std::memory_order_relaxed);
+    slot.status.store(ok ? StageStatus::Done : StageStatus::Failed, std::memory_order_release);
+    UiWake::notify();
+}
+
+StartupProgress::StageState StartupProgress::state(StartupStage stage) const {
+    const Slot& slot = slots_[static_cast<size_t>(stage)];
+    StageStatus status = slot.status.load(std::memory_order_acquire);
+    if (status == StageStatus::Pending) {
+        return {status, 0};
+    }
+    uint64_t started = slot.startedMs.load(std::memory_order_relaxed);
+    uint64_t until = status == StageStatus::Running ? nowMs() : slot.finishedMs.load(std::memory_order_relaxed);
+    return {status, static_cast<uint32_t>(until > started ? until - started : 0)};
+}
+
+uint32_t StartupProgress::totalElapsedMs() const {
+    uint64_t now = nowMs();
+    uint64_t since = resetMs_.load(std::memory_order_relaxed);
+    return static_cast<uint32_t>(now > since ? now - since : 0);
+}
+
+}
@@ -0,0 +1,183 @@
+#include "utils/TransferCompression.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+namespace LocalTether::Utils::TransferCompression {
+
+namespace {
+    constexpr size_t SAMPLE_SIZE = 16 * 1024;
+    constexpr double MIN_SAMPLE_SAVINGS = 0.10;
+    constexpr size_t MIN_COMPRESS_SIZE = 4 * 1024;
+    constexpr size_t MIN_THROUGHPUT_SAMPLE_BYTES = 64 * 1024;
+
+    const std::array<const char*, 24> COMPRESSED_EXTENSIONS = {
+        ".zip", ".gz", ".tgz", ".xz", ".bz2", ".zst", ".7z", ".rar", ".lz4",
+        ".png", ".jpg", ".jpeg", ".gif", ".webp", ".avif", ".heic",
+        ".mp3", ".mp4", ".mkv", ".webm", ".mov", ".ogg", ".flac", ".pdf"
+    };
+
+    struct CCtxDeleter { void operator()(ZSTD_CCtx* ctx) const { ZSTD_freeCCtx(ctx); } };
+    struct DCtxDeleter { void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); } };
+
+    void putU32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+        for (int i = 0; i < 4; ++i) out[at + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    void putU64(std::vector<uint8_t>& out, size_t at, uint64_t value) {
+        for (int i = 0; i < 8; ++i) out[at + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint32_t getU32(const uint8_t* in) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(in[i]) << (8 * i);
+        return value;
+    }
+
+    uint64_t getU64(const uint8_t* in) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(in[i]) << (8 * i);
+        return value;
+    }
+
+    bool hasCompressedExtension(const std::string& fileName) {
+        std::string ext = std::filesystem::path(fileName).extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return std::find_if(COMPRESSED_EXTENSIONS.begin(), COMPRESSED_EXTENSIONS.end(),
+                            [&](const char* known) { return ext == known; }) != COMPRESSED_EXTENSIONS.end();
+    }
+}
+
+bool isEnabled() {
+    return Config::Live().transferCompression;
+}
+
+bool shouldCompress(const std::string& fileName, const char* data, size_t size) {
+    if (size < MIN_COMPRESS_SIZE || size > MAX_COMPRESS_SIZE || hasCompressedExtension(fileName)) {
+        return false;
+    }
+
+    // Sample the start, middle and end; archives with a plain-text header are still caught by the later samples.
+    std::unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx(ZSTD_createCCtx());
+    if (!cctx) return false;
+    std::vector<char> scratch(ZSTD_compressBound(SAMPLE_SIZE));
+    const size_t sampleLen = std::min(size, SAMPLE_SIZE);
+    const size_t offsets[] = {0, (size - sampleLen) / 2, size - sampleLen};
+
+    size_t rawTotal = 0;
+    size_t compressedTotal = 0;
+    for (size_t offset : offsets) {
+        size_t result = ZSTD_compressCCtx(cctx.get(), scratch.data(), scratch.size(), data + offset, sampleLen, 1);
+        if (ZSTD_isError(result)) return false;
+        rawTotal += sampleLen;
+        compressedTotal += result;
+    }
+    return compressedTotal < static_cast<size_t>(rawTotal * (1.0 - MIN_SAMPLE_SAVINGS));
+}
+
+int chooseLevel(double linkBytesPerSecond) {
+    if (linkBytesPerSecond <= 0.0) return 3;             // no estimate yet: zstd default
+    if (linkBytesPerSecond > 80.0 * 1024 * 1024) return 1;
+    if (linkBytesPerSecond > 20.0 * 1024 * 1024) return 3;
+    if (linkBytesPerSecond > 5.0 * 1024 * 1024) return 6;
+    return 9;
+}
+
+std::vector<uint8_t> compressBody(uint8_t innerType, const std::vector<ByteSpan>& parts, int level) {
+    uint64_t rawSize = 0;
+    for (const auto& part : parts) rawSize += part.size;
+
+    std::vector<uint8_t> out(ENVELOPE_HEADER_SIZE);
+    out[0] = innerType;
+    out[1] = CODEC_ZSTD;
+    putU64(out, 2, rawSize);
+
+    std::unique_ptr<ZSTD_CCtx, CCtxDeleter> cctx(ZSTD_createCCtx());
+    if (!cctx) return {};
+
+    for (const auto& part : parts) {
+        for (size_t offset = 0; offset < part.size; offset += CHUNK_SIZE) {
+            const size_t rawLen = std::min(CHUNK_SIZE, part.size - offset);
+            const size_t chunkHeaderAt = out.size();
+            out.resize(chunkHeaderAt + 8 + ZSTD_compressBound(rawLen));
+
+            size_t storedLen = ZSTD_compressCCtx(cctx.get(), out.data() + chunkHeaderAt + 8, out.size() - chunkHeaderAt - 8,
+                                                 part.data + offset, rawLen, level);
+            if (ZSTD_isError(storedLen) || storedLen >= rawLen) {
+                std::memcpy(out.data() + chunkHeaderAt + 8, part.data + offset, rawLen);
+                storedLen = rawLen;
+            }
+            putU32(out, chunkHeaderAt, static_cast<uint32_t>(rawLen));
+            putU32(out, chunkHeaderAt + 4, static_cast<uint32_t>(storedLen));
+            out.resize(chunkHeaderAt + 8 + storedLen);
+        }
+    }
+    return out;
+}
+
+bool decompressBody(const std::vector<uint8_t>& envelope, uint8_t& innerType, std::vector<uint8_t>& rawBody,
+                    uint64_t maxRawSize) {
+    if (envelope.size() < ENVELOPE_HEADER_SIZE || envelope[1] != CODEC_ZSTD) {
+        return false;
+    }
+    innerType = envelope[0];
+    const uint64_t rawSize = getU64(envelope.data() + 2);
+    // rawSize comes from the peer; every chunk needs at least its 8-byte header, so a claim the
+    // envelope cannot hold is rejected before reserving anything.
+    const uint64_t chunkCapacity = (envelope.size() - ENVELOPE_HEADER_SIZE) / 8;
+    if (rawSize > maxRawSize || rawSize > chunkCapacity * CHUNK_SIZE) {
+        return false;
+    }
+
+    std::unique_ptr<ZSTD_DCtx, DCtxDeleter> dctx(ZSTD_createDCtx());
+    if (!dctx) return false;
+
+    rawBody.clear();
+    rawBody.reserve(rawSize);
+    size_t pos = ENVELOPE_HEADER_SIZE;
+    while (pos < envelope.size()) {
+        if (envelope.size() - pos < 8) return false;
+        const uint32_t rawLen = getU32(envelope.data() + pos);
+        const uint32_t storedLen = getU32(envelope.data() + pos + 4);
+        pos += 8;
+        if (rawLen > CHUNK_SIZE || storedLen > envelope.size() - pos || rawBody.size() + rawLen > rawSize) return false;
+
+        const size_t writeAt = rawBody.size();
+        rawBody.resize(writeAt + rawLen);
+        if (storedLen == rawLen) {
+            std::memcpy(rawBody.data() + writeAt, envelope.data() + pos, rawLen);
+        } else {
+            size_t result = ZSTD_decompressDCtx(dctx.get(), rawBody.data() + writeAt, rawLen, envelope.data() + pos, storedLen);
+            if (ZSTD_isError(result) || result != rawLen) {
+                Logger::GetInstance().Error("TransferCompression: Chunk decompression failed: " +
+                                            std::string(ZSTD_isError(result) ? ZSTD_getErrorName(result) : "size mismatch"));
+                return false;
+            }
+        }
+        pos += storedLen;
+    }
+    return rawBody.size() == rawSize;
+}
+
+void ThroughputEstimator::writeStarted() {
+    startedAt_ = std::chrono::steady_clock::now();
+}
+
+void ThroughputEstimator::writeCompleted(size_t bytes) {
+    if (bytes < MIN_THROUGHPUT_SAMPLE_BYTES) return;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startedAt_).count();
+    if (seconds <= 0.0) return;
+    double sample = static_cast<double>(bytes) / seconds;
+    double previous = bytesPerSecond_.load(std::memory_order_relaxed);
+    bytesPerSecond_.store(previous == 0.0 ? sample : previous * 0.7 + sample * 0.3, std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,21 @@
+#include "utils/UiWake.h"
+
+#include <atomic>
+
+namespace LocalTether::Utils::UiWake {
+
+namespace {
+    std::atomic<Handler> g_handler{nullptr};
+}
+
+void setHandler(Handler handler) {
+    g_handler.store(handler, std::memory_order_release);
+}
+
+void notify() {
+    if (Handler handler = g_handler.load(std::memory_order_acquire)) {
+        handler();
+    }
+}
+
+}
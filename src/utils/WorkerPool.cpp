@@ -0,0 +1,133 @@
+#include "utils/WorkerPool.h"
+#include "utils/Logger.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace LocalTether::Utils {
+
+WorkerPool::WorkerPool(size_t threadCount, size_t maxQueuedJobs)
+    : maxQueuedJobs_(std::max<size_t>(1, maxQueuedJobs)) {
+    threadCount = std::max<size_t>(1, threadCount);
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&WorkerPool::workerMain, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+void WorkerPool::submit(Job job, const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return;
+    }
+    if (!key.empty()) {
+        auto [entry, first] = keyed_.try_emplace(key);
+        if (!first) {
+            // Released by the worker that finishes the key's current job.
+            entry->second.push_back(std::move(job));
+            keyedWaiting_++;
+            return;
+        }
+    }
+    jobs_.push_back({std::move(job), key});
+    jobAvailable_.notify_one();
+}
+
+bool WorkerPool::saturated() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return backlogLocked() >= maxQueuedJobs_;
+}
+
+void WorkerPool::whenBelowLimit(Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        if (backlogLocked() >= maxQueuedJobs_) {
+            belowLimitCallbacks_.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback();
+}
+
+std::vector<WorkerPool::Callback> WorkerPool::takeCallbacksIfBelowLimitLocked() {
+    std::vector<Callback> ready;
+    if (!belowLimitCallbacks_.empty() && backlogLocked() < maxQueuedJobs_) {
+        ready.swap(belowLimitCallbacks_);
+    }
+    return ready;
+}
+
+void WorkerPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this] { return jobs_.empty() && keyed_.empty() && activeJobs_ == 0; });
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+        belowLimitCallbacks_.clear();
+    }
+    jobAvailable_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void WorkerPool::workerMain() {
+    for (;;) {
+        QueuedJob next;
+        std::vector<Callback> ready;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobAvailable_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+            // Drain what is already queued even when stopping so accepted work is not lost;
+            // keyed followers are released below, so they drain too.
+            if (jobs_.empty()) return;
+            next = std::move(jobs_.front());
+            jobs_.pop_front();
+            activeJobs_++;
+            if (!stopping_) ready = takeCallbacksIfBelowLimitLocked();
+        }
+        for (auto& callback : ready) {
+            callback();
+        }
+
+        try {
+            next.job();
+        } catch (const std::exception& e) {
+            Logger::GetInstance().Error("WorkerPool: Job threw an exception: " + std::string(e.what()));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            activeJobs_--;
+            if (!next.key.empty()) {
+                auto entry = keyed_.find(next.key);
+                if (entry != keyed_.end()) {
+                    if (entry->second.empty()) {
+                        keyed_.erase(entry);
+                    } else {
+                        jobs_.push_back({std::move(entry->second.front()), next.key});
+                        entry->second.pop_front();
+                        keyedWaiting_--;
+                        jobAvailable_.notify_one();
+                    }
+                }
+            }
+            if (jobs_.empty() && keyed_.empty() && activeJobs_ == 0) {
+                idle_.notify_all();
+            }
+        }
+    }
+}
+
+}
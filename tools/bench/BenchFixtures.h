@@ -0,0 +1,103 @@
+#pragma once
+#include "network/Message.h"
+#include "storage/FileMetadata.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Inputs shared by the benchmark files. Everything is deterministic so runs compare between
+// releases.
+
+namespace LocalTether::Bench {
+
+    // A keyboard payload with keyCount key events, or a relative mouse move when keyCount is 0.
+    inline Network::InputPayload sampleInputPayload(size_t keyCount) {
+        Network::InputPayload payload;
+        if (keyCount == 0) {
+            payload.isMouseEvent = true;
+            payload.sourceDeviceType = Network::InputSourceDeviceType::MOUSE_RELATIVE;
+            payload.deltaX = 3.25f;
+            payload.deltaY = -1.5f;
+            payload.mouseButtons = 1;
+            payload.scrollHiResY = 120;
+            return payload;
+        }
+        payload.keyEvents.reserve(keyCount);
+        for (size_t i = 0; i < keyCount; ++i) {
+            payload.keyEvents.push_back({static_cast<uint8_t>(0x41 + i % 26), i % 2 == 0});
+        }
+        return payload;
+    }
+
+    // A tree holding fileCount files, sixteen to a directory, with directories nested the same
+    // way, roughly the shape of a shared project folder.
+    inline Storage::FileMetadata sampleFileTree(size_t fileCount) {
+        constexpr size_t FANOUT = 16;
+        std::vector<Storage::FileMetadata> level;
+        level.reserve(fileCount);
+        for (size_t i = 0; i < fileCount; ++i) {
+            Storage::FileMetadata file;
+            file.name = "file_" + std::to_string(i) + ".dat";
+            file.size = 4096 + i * 37;
+            level.push_back(std::move(file));
+        }
+        size_t depth = 0;
+        while (level.size() > 1) {
+            std::vector<Storage::FileMetadata> parents;
+            parents.reserve((level.size() + FANOUT - 1) / FANOUT);
+            for (size_t i = 0; i < level.size(); i += FANOUT) {
+                Storage::FileMetadata dir;
+                dir.name = "dir_" + std::to_string(depth) + "_" + std::to_string(i / FANOUT);
+                dir.isDirectory = true;
+                for (size_t j = i; j < level.size() && j < i + FANOUT; ++j) {
+                    dir.children.push_back(std::move(level[j]));
+                }
+                parents.push_back(std::move(dir));
+            }
+            level = std::move(parents);
+            ++depth;
+        }
+        Storage::FileMetadata root;
+        root.name = "server_storage";
+        root.isDirectory = true;
+        root.children = std::move(level);
+        return root;
+    }
+
+
+    // size bytes of log-like text: compresses about as well as source trees or logs do, without
+    // being one repeated byte.
+    inline std::vector<char> sampleTextBody(size_t size) {
+        static const char* const WORDS[] = {"session", "client", "upload", "INFO", "file", "bytes", "server_storage",
+                                            "received", "sent", "delta", "WARNING", "route", "key", "mouse"};
+        std::vector<char> body;
+        body.reserve(size + 64);
+        uint32_t state = 2463534242u;
+        size_t line = 0;
+        while (body.size() < size) {
+            std::string text = "[" + std::to_string(1700000000 + line++) + "] ";
+            for (int i = 0; i < 8; ++i) {
+                state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+                text += WORDS[state % (sizeof(WORDS) / sizeof(WORDS[0]))];
+                text += i == 7 ? '\n' : ' ';
+            }
+            body.insert(body.end(), text.begin(), text.end());
+        }
+        body.resize(size);
+        return body;
+    }
+
+    // size bytes from a fixed-seed xorshift generator; zstd cannot shrink them.
+    inline std::vector<char> sampleRandomBody(size_t size) {
+        std::vector<char> body(size);
+        uint64_t state = 88172645463325252ull;
+        for (auto& byte : body) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            byte = static_cast<char>(state >> 56);
+        }
+        return body;
+    }
+
+}
@@ -0,0 +1,54 @@
+// File transfer compression: the trial that decides whether a file is worth compressing, and
+// the chunked envelope round trip at the levels chooseLevel picks between.
+#include "BenchFixtures.h"
+#include "utils/TransferCompression.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+namespace TransferCompression = LocalTether::Utils::TransferCompression;
+
+constexpr uint8_t INNER_TYPE = 1;
+
+// Arg 0 is the body size, arg 1 the zstd level.
+void BM_CompressBody(benchmark::State& state) {
+    const auto body = LocalTether::Bench::sampleTextBody(static_cast<size_t>(state.range(0)));
+    const int level = static_cast<int>(state.range(1));
+    size_t compressedSize = 0;
+    for (auto _ : state) {
+        std::vector<uint8_t> envelope = TransferCompression::compressBody(INNER_TYPE, {{body.data(), body.size()}}, level);
+        compressedSize = envelope.size();
+        benchmark::DoNotOptimize(envelope.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+    state.counters["ratio"] = compressedSize > 0 ? static_cast<double>(body.size()) / static_cast<double>(compressedSize) : 0.0;
+}
+BENCHMARK(BM_CompressBody)->ArgsProduct({{1 << 20, 16 << 20}, {1, 3, 9}})->Unit(benchmark::kMillisecond);
+
+void BM_DecompressBody(benchmark::State& state) {
+    const auto body = LocalTether::Bench::sampleTextBody(static_cast<size_t>(state.range(0)));
+    const std::vector<uint8_t> envelope = TransferCompression::compressBody(INNER_TYPE, {{body.data(), body.size()}}, 3);
+    std::vector<uint8_t> raw;
+    for (auto _ : state) {
+        uint8_t innerType = 0;
+        bool ok = TransferCompression::decompressBody(envelope, innerType, raw, body.size());
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(raw.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_DecompressBody)->Arg(1 << 20)->Arg(16 << 20)->Unit(benchmark::kMillisecond);
+
+// Arg 0 picks the body: 0 is text (the trial accepts it), 1 is random bytes (rejected).
+void BM_ShouldCompress(benchmark::State& state) {
+    constexpr size_t SIZE = 16 << 20;
+    const auto body = state.range(0) == 0 ? LocalTether::Bench::sampleTextBody(SIZE) : LocalTether::Bench::sampleRandomBody(SIZE);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TransferCompression::shouldCompress("data.bin", body.data(), body.size()));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShouldCompress)->Arg(0)->Arg(1);
+
+}
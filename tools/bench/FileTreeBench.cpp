@@ -0,0 +1,36 @@
+// The FileSystemUpdate round trip the server does for every connect and every storage change.
+#include "BenchFixtures.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using LocalTether::Network::Message;
+
+// Arg is the number of files in the tree.
+void BM_FileTreeSerialize(benchmark::State& state) {
+    const auto tree = LocalTether::Bench::sampleFileTree(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    for (auto _ : state) {
+        Message message = Message::createFileSystemUpdate(tree, 0);
+        bytes = message.getBody().size();
+        benchmark::DoNotOptimize(message.getBody().data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(bytes));
+    state.counters["wire_bytes"] = static_cast<double>(bytes);
+}
+BENCHMARK(BM_FileTreeSerialize)->RangeMultiplier(16)->Range(16, 65536)->Unit(benchmark::kMicrosecond);
+
+void BM_FileTreeDeserialize(benchmark::State& state) {
+    const Message message = Message::createFileSystemUpdate(LocalTether::Bench::sampleFileTree(static_cast<size_t>(state.range(0))), 0);
+    for (auto _ : state) {
+        auto tree = message.getFileSystemMetadataPayload();
+        benchmark::DoNotOptimize(tree.children.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(message.getBody().size()));
+}
+BENCHMARK(BM_FileTreeDeserialize)->RangeMultiplier(16)->Range(16, 65536)->Unit(benchmark::kMicrosecond);
+
+}
@@ -0,0 +1,40 @@
+// Keycode translation runs once per key event on both the capture and the injection side.
+#include "utils/KeycodeConverter.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using LocalTether::Utils::KeycodeConverter;
+
+void BM_EvdevToVk(benchmark::State& state) {
+    uint16_t code = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(KeycodeConverter::evdevToVk(code));
+        code = static_cast<uint16_t>((code + 1) % 256);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EvdevToVk);
+
+void BM_VkToEvdev(benchmark::State& state) {
+    uint8_t code = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(KeycodeConverter::vkToEvdev(code));
+        ++code;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VkToEvdev);
+
+void BM_IsVkMouseButton(benchmark::State& state) {
+    uint8_t code = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(KeycodeConverter::isVkMouseButton(code));
+        ++code;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IsVkMouseButton);
+
+}
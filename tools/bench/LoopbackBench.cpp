@@ -0,0 +1,207 @@
+// A real Server on 127.0.0.1 and a minimal blocking TLS client speaking the same framing as
+// network/Client, which cannot be used here without the UI. Measures KeepAlive round trips and
+// FileRequest download throughput through Session, TLS and the socket.
+#include "BenchFixtures.h"
+#include "network/Server.h"
+#include "utils/Config.h"
+#include "utils/Logger.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+namespace fs = std::filesystem;
+using LocalTether::Network::Message;
+using LocalTether::Network::MessageType;
+
+constexpr int64_t FILE_SIZES[] = {64 << 10, 1 << 20, 16 << 20};
+
+std::string payloadFileName(int64_t size) {
+    return "bench_payload_" + std::to_string(size) + ".bin";
+}
+
+// One server for the whole run, created on first use. Storage and TLS material go to a scratch
+// directory so the user's own server_storage and key are never touched.
+class LoopbackServer {
+public:
+    static LoopbackServer& get() {
+        static LoopbackServer instance;
+        return instance;
+    }
+
+    uint16_t port() const { return port_; }
+    const std::string& error() const { return error_; }
+
+    ~LoopbackServer() {
+        if (server_) {
+            server_->stop();
+        }
+        work_.reset();
+        io_.stop();
+        if (ioThread_.joinable()) {
+            ioThread_.join();
+        }
+    }
+
+private:
+    LoopbackServer() : work_(asio::make_work_guard(io_)) {
+        fs::path scratch = fs::temp_directory_path() / "localtether_bench";
+        fs::path storageRoot = scratch / "storage";
+        std::error_code ec;
+        fs::create_directories(storageRoot, ec);
+        auto& config = LocalTether::Utils::Config::GetInstance();
+        config.Set<std::string>(std::string(LocalTether::Utils::ConfigKeys::StorageRoot.name), storageRoot.string());
+        config.Set<std::string>(std::string(LocalTether::Utils::ConfigKeys::TlsDir.name), (scratch / "tls").string());
+
+        for (int64_t size : FILE_SIZES) {
+            fs::path file = storageRoot / payloadFileName(size);
+            if (fs::exists(file) && static_cast<int64_t>(fs::file_size(file)) == size) {
+                continue;
+            }
+            std::ofstream out(file, std::ios::binary | std::ios::trunc);
+            std::vector<char> block(64 << 10);
+            for (size_t i = 0; i < block.size(); ++i) {
+                block[i] = static_cast<char>((i * 131) ^ (i >> 7));
+            }
+            for (int64_t written = 0; written < size; written += static_cast<int64_t>(block.size())) {
+                out.write(block.data(), static_cast<std::streamsize>(std::min<int64_t>(static_cast<int64_t>(block.size()), size - written)));
+            }
+        }
+
+        // Let the OS pick a free port, then hand it to the server.
+        {
+            asio::ip::tcp::acceptor probe(io_, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+            port_ = probe.local_endpoint().port();
+        }
+        server_ = std::make_unique<LocalTether::Network::Server>(io_, port_);
+        server_->start();
+        if (server_->getState() == LocalTether::Network::ServerState::Error) {
+            error_ = "server failed to start: " + server_->getErrorMessage();
+        }
+        ioThread_ = std::thread([this] { io_.run(); });
+    }
+
+    asio::io_context io_;
+    asio::executor_work_guard<asio::io_context::executor_type> work_;
+    std::unique_ptr<LocalTether::Network::Server> server_;
+    std::thread ioThread_;
+    uint16_t port_ = 0;
+    std::string error_;
+};
+
+class LoopbackClient {
+public:
+    explicit LoopbackClient(uint16_t port)
+        : context_(asio::ssl::context::tls_client), stream_(io_, context_) {
+        stream_.set_verify_mode(asio::ssl::verify_none);
+        stream_.lowest_layer().connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port));
+        stream_.lowest_layer().set_option(asio::ip::tcp::no_delay(true));
+        stream_.handshake(asio::ssl::stream_base::client);
+
+        LocalTether::Network::HandshakePayload handshake;
+        handshake.role = LocalTether::Network::ClientRole::Receiver;
+        handshake.clientName = "bench";
+        send(Message::createHandshake(handshake, 0));
+        readUntil(MessageType::Handshake);
+    }
+
+    void send(const Message& message) {
+        std::vector<uint8_t> wire = message.serialize();
+        asio::write(stream_, asio::buffer(wire));
+    }
+
+    Message read() {
+        uint8_t header[Message::HEADER_LENGTH];
+        asio::read(stream_, asio::buffer(header));
+        Message message;
+        if (!message.decodeHeader(header, sizeof(header))) {
+            throw std::runtime_error("bad message header");
+        }
+        body_.resize(message.getBodySize());
+        asio::read(stream_, asio::buffer(body_));
+        message.decodeBody(body_.data(), body_.size());
+        return message;
+    }
+
+    // Skips whatever else the server pushes meanwhile (file tree, client list).
+    Message readUntil(MessageType type) {
+        for (;;) {
+            Message message = read();
+            if (message.getType() == type || message.getType() == MessageType::FileError) {
+                return message;
+            }
+        }
+    }
+
+private:
+    asio::io_context io_;
+    asio::ssl::context context_;
+    asio::ssl::stream<asio::ip::tcp::socket> stream_;
+    std::vector<uint8_t> body_;
+};
+
+std::unique_ptr<LoopbackClient> connectOrSkip(benchmark::State& state) {
+    auto& server = LoopbackServer::get();
+    if (!server.error().empty()) {
+        state.SkipWithError(server.error().c_str());
+        return nullptr;
+    }
+    try {
+        return std::make_unique<LoopbackClient>(server.port());
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+        return nullptr;
+    }
+}
+
+void BM_LoopbackKeepAliveRoundTrip(benchmark::State& state) {
+    auto client = connectOrSkip(state);
+    if (!client) return;
+    uint64_t sequence = 0;
+    try {
+        for (auto _ : state) {
+            LocalTether::Network::KeepAlivePayload ping;
+            ping.senderTimeUs = ++sequence;
+            client->send(Message::createKeepAlive(ping, 0));
+            // The server may probe us too; only the echo of our own ping counts.
+            while (client->readUntil(MessageType::KeepAlive).getKeepAlivePayload().senderTimeUs != ping.senderTimeUs) {
+            }
+        }
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LoopbackKeepAliveRoundTrip)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Arg is the file size in bytes; each iteration downloads the whole file.
+void BM_LoopbackFileDownload(benchmark::State& state) {
+    auto client = connectOrSkip(state);
+    if (!client) return;
+    const std::string fileName = payloadFileName(state.range(0));
+    try {
+        for (auto _ : state) {
+            client->send(Message::createFileRequest(fileName, 0));
+            Message response = client->readUntil(MessageType::FileResponse);
+            if (response.getType() != MessageType::FileResponse) {
+                state.SkipWithError("server answered with FileError");
+                break;
+            }
+            benchmark::DoNotOptimize(response.getBody().data());
+        }
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_LoopbackFileDownload)->Arg(FILE_SIZES[0])->Arg(FILE_SIZES[1])->Arg(FILE_SIZES[2])
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
@@ -0,0 +1,79 @@
+// Message framing and the two input payload codecs: cereal for the network (createInput /
+// getInputPayload) and the hand-written one for the helper IPC (serializeInputPayload).
+#include "BenchFixtures.h"
+#include "utils/Serialization.h"
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+using LocalTether::Network::Message;
+using LocalTether::Network::MessageType;
+
+void BM_MessageSerialize(benchmark::State& state) {
+    Message message(MessageType::ChatMessage, 7, std::vector<uint8_t>(static_cast<size_t>(state.range(0)), 0x5a));
+    for (auto _ : state) {
+        std::vector<uint8_t> wire = message.serialize();
+        benchmark::DoNotOptimize(wire.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * (state.range(0) + Message::HEADER_LENGTH));
+}
+BENCHMARK(BM_MessageSerialize)->Arg(16)->Arg(1024)->Arg(64 << 10)->Arg(1 << 20);
+
+void BM_MessageDecode(benchmark::State& state) {
+    Message original(MessageType::ChatMessage, 7, std::vector<uint8_t>(static_cast<size_t>(state.range(0)), 0x5a));
+    const std::vector<uint8_t> wire = original.serialize();
+    for (auto _ : state) {
+        Message decoded;
+        bool ok = decoded.decodeHeader(wire.data(), wire.size()) &&
+                  decoded.decodeBody(wire.data() + Message::HEADER_LENGTH, wire.size() - Message::HEADER_LENGTH);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(decoded.getBody().data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(wire.size()));
+}
+BENCHMARK(BM_MessageDecode)->Arg(16)->Arg(1024)->Arg(64 << 10)->Arg(1 << 20);
+
+// Arg is the number of key events; 0 is a single relative mouse move.
+void BM_CreateInput(benchmark::State& state) {
+    const auto payload = LocalTether::Bench::sampleInputPayload(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        Message message = Message::createInput(payload, 3);
+        benchmark::DoNotOptimize(message.getBody().data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CreateInput)->Arg(0)->Arg(1)->Arg(8);
+
+void BM_GetInputPayload(benchmark::State& state) {
+    const Message message = Message::createInput(LocalTether::Bench::sampleInputPayload(static_cast<size_t>(state.range(0))), 3);
+    for (auto _ : state) {
+        auto payload = message.getInputPayload();
+        benchmark::DoNotOptimize(payload.keyEvents.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetInputPayload)->Arg(0)->Arg(1)->Arg(8);
+
+void BM_SerializeInputPayload(benchmark::State& state) {
+    const auto payload = LocalTether::Bench::sampleInputPayload(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::vector<uint8_t> bytes = LocalTether::Utils::serializeInputPayload(payload);
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SerializeInputPayload)->Arg(0)->Arg(1)->Arg(8);
+
+void BM_DeserializeInputPayload(benchmark::State& state) {
+    const std::vector<uint8_t> bytes =
+        LocalTether::Utils::serializeInputPayload(LocalTether::Bench::sampleInputPayload(static_cast<size_t>(state.range(0))));
+    for (auto _ : state) {
+        auto payload = LocalTether::Utils::deserializeInputPayload(bytes.data(), bytes.size());
+        benchmark::DoNotOptimize(payload);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DeserializeInputPayload)->Arg(0)->Arg(1)->Arg(8);
+
+}
@@ -0,0 +1,147 @@
+// Whether compression pays off end to end: one file response over TCP on 127.0.0.1 with the
+// sender held to a link rate by a token bucket. Wall-clock time runs from the sender picking the
+// file up to the receiver holding the raw bytes, so it includes compressing and decompressing.
+// The sender makes the same choices as the server (shouldCompress, chooseLevel for the link
+// rate); TLS is left out, it costs the same either way.
+#include "BenchFixtures.h"
+#include "network/Message.h"
+#include "utils/TransferCompression.h"
+
+#include <benchmark/benchmark.h>
+#include <asio.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+using LocalTether::Network::Message;
+using LocalTether::Network::MessageType;
+namespace TransferCompression = LocalTether::Utils::TransferCompression;
+
+constexpr size_t BODY_SIZE = 4 << 20;
+constexpr size_t LINK_BURST = 64 << 10;
+constexpr const char* FILE_NAME = "session.log";
+
+// Releases bytes at bytesPerSecond, allowing bursts of up to LINK_BURST.
+class TokenBucket {
+public:
+    explicit TokenBucket(double bytesPerSecond)
+        : rate_(bytesPerSecond), tokens_(static_cast<double>(LINK_BURST)), last_(std::chrono::steady_clock::now()) {}
+
+    // Blocks until n (at most LINK_BURST) bytes may go out.
+    void take(size_t n) {
+        for (;;) {
+            const auto now = std::chrono::steady_clock::now();
+            tokens_ = std::min(static_cast<double>(LINK_BURST), tokens_ + rate_ * std::chrono::duration<double>(now - last_).count());
+            last_ = now;
+            if (tokens_ >= static_cast<double>(n)) {
+                tokens_ -= static_cast<double>(n);
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>((static_cast<double>(n) - tokens_) / rate_));
+        }
+    }
+
+private:
+    double rate_;
+    double tokens_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+class ShapedLink {
+public:
+    ShapedLink() : sender_(io_), receiver_(io_) {
+        asio::ip::tcp::acceptor acceptor(io_, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+        sender_.connect(acceptor.local_endpoint());
+        acceptor.accept(receiver_);
+        sender_.set_option(asio::ip::tcp::no_delay(true));
+    }
+
+    void send(const std::vector<uint8_t>& wire, TokenBucket& bucket) {
+        for (size_t offset = 0; offset < wire.size();) {
+            const size_t chunk = std::min(LINK_BURST, wire.size() - offset);
+            bucket.take(chunk);
+            asio::write(sender_, asio::buffer(wire.data() + offset, chunk));
+            offset += chunk;
+        }
+    }
+
+    Message receive() {
+        uint8_t header[Message::HEADER_LENGTH];
+        asio::read(receiver_, asio::buffer(header));
+        Message message;
+        if (!message.decodeHeader(header, sizeof(header))) {
+            throw std::runtime_error("bad message header");
+        }
+        body_.resize(message.getBodySize());
+        asio::read(receiver_, asio::buffer(body_));
+        message.decodeBody(body_.data(), body_.size());
+        return message;
+    }
+
+private:
+    asio::io_context io_;
+    asio::ip::tcp::socket sender_;
+    asio::ip::tcp::socket receiver_;
+    std::vector<uint8_t> body_;
+};
+
+// What the server puts on the wire for this file.
+std::vector<uint8_t> frameFile(const std::vector<char>& body, bool compress, double linkBytesPerSecond) {
+    if (compress && TransferCompression::shouldCompress(FILE_NAME, body.data(), body.size())) {
+        const Message prefix = Message::createFileResponsePrefix(FILE_NAME, 0);
+        const auto& prefixBody = prefix.getBody();
+        std::vector<uint8_t> envelope = TransferCompression::compressBody(
+            static_cast<uint8_t>(MessageType::FileResponse),
+            {{reinterpret_cast<const char*>(prefixBody.data()), prefixBody.size()}, {body.data(), body.size()}},
+            TransferCompression::chooseLevel(linkBytesPerSecond));
+        if (!envelope.empty() && envelope.size() < body.size()) {
+            return Message::createCompressed(envelope, 0).serialize();
+        }
+    }
+    return Message::createFileResponse(FILE_NAME, body, 0).serialize();
+}
+
+// Arg 0 is the link rate in Mbit/s, arg 1 turns compression on, arg 2 picks the body: 0 is text,
+// 1 is random bytes (the trial rejects them, so this measures what the trial costs).
+void BM_ShapedLinkFileTransfer(benchmark::State& state) {
+    const double linkBytesPerSecond = static_cast<double>(state.range(0)) * 1000.0 * 1000.0 / 8.0;
+    const bool compress = state.range(1) != 0;
+    const auto body = state.range(2) == 0 ? LocalTether::Bench::sampleTextBody(BODY_SIZE) : LocalTether::Bench::sampleRandomBody(BODY_SIZE);
+
+    try {
+        ShapedLink link;
+        size_t wireBytes = 0;
+        std::vector<uint8_t> raw;
+        for (auto _ : state) {
+            std::thread sender([&]() {
+                TokenBucket bucket(linkBytesPerSecond);
+                std::vector<uint8_t> wire = frameFile(body, compress, linkBytesPerSecond);
+                wireBytes = wire.size();
+                link.send(wire, bucket);
+            });
+            Message message = link.receive();
+            if (message.getType() == MessageType::Compressed) {
+                uint8_t innerType = 0;
+                if (!TransferCompression::decompressBody(message.getBody(), innerType, raw, BODY_SIZE + 4096)) {
+                    sender.join();
+                    state.SkipWithError("compressed body did not decode");
+                    break;
+                }
+            }
+            benchmark::DoNotOptimize(raw.data());
+            sender.join();
+        }
+        state.counters["wire_ratio"] = wireBytes > 0 ? static_cast<double>(BODY_SIZE) / static_cast<double>(wireBytes) : 0.0;
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(BODY_SIZE));
+}
+BENCHMARK(BM_ShapedLinkFileTransfer)->ArgsProduct({{20, 100, 1000}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+}
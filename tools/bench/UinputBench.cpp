@@ -0,0 +1,73 @@
+// Injection side of the receiver: events/sec through UinputEventBatch against one write() per
+// event, which is what libevdev_uinput_write_event costs. Both write to /dev/null, so this
+// measures the syscall pattern, not the kernel's input handling.
+#ifndef _WIN32
+#include "input/UinputEventBatch.h"
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace {
+
+using LocalTether::Input::UinputEventBatch;
+
+// A relative mouse move: REL_X, REL_Y, SYN_REPORT.
+constexpr int64_t EVENTS_PER_PAYLOAD = 3;
+
+class DevNull {
+public:
+    DevNull() : fd_(::open("/dev/null", O_WRONLY | O_CLOEXEC)) {}
+    ~DevNull() { if (fd_ >= 0) ::close(fd_); }
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+void BM_UinputPerEventWrite(benchmark::State& state) {
+    DevNull sink;
+    if (sink.fd() < 0) {
+        state.SkipWithError("cannot open /dev/null");
+        return;
+    }
+    struct input_event events[EVENTS_PER_PAYLOAD];
+    std::memset(events, 0, sizeof(events));
+    events[0].type = EV_REL; events[0].code = REL_X; events[0].value = 3;
+    events[1].type = EV_REL; events[1].code = REL_Y; events[1].value = -2;
+    events[2].type = EV_SYN; events[2].code = SYN_REPORT;
+    for (auto _ : state) {
+        for (const auto& ev : events) {
+            benchmark::DoNotOptimize(::write(sink.fd(), &ev, sizeof(ev)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * EVENTS_PER_PAYLOAD);
+}
+BENCHMARK(BM_UinputPerEventWrite);
+
+// Arg is the number of payloads drained per flush; the shared-ring injector flushes everything
+// it drained at once.
+void BM_UinputBatchedFlush(benchmark::State& state) {
+    DevNull sink;
+    if (sink.fd() < 0) {
+        state.SkipWithError("cannot open /dev/null");
+        return;
+    }
+    UinputEventBatch batch;
+    const int64_t payloads = state.range(0);
+    for (auto _ : state) {
+        for (int64_t i = 0; i < payloads; ++i) {
+            batch.add(EV_REL, REL_X, 3);
+            batch.add(EV_REL, REL_Y, -2);
+            batch.sync();
+        }
+        benchmark::DoNotOptimize(batch.flush(sink.fd()));
+    }
+    state.SetItemsProcessed(state.iterations() * payloads * EVENTS_PER_PAYLOAD);
+}
+BENCHMARK(BM_UinputBatchedFlush)->Arg(1)->Arg(8)->Arg(64);
+
+}
+#endif
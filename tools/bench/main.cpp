@@ -0,0 +1,43 @@
+// localtether_bench: benchmarks for the hot paths.
+// Usage: localtether_bench [google benchmark flags...]
+// Results also go to localtether_bench.json (Google Benchmark's JSON format) unless
+// --benchmark_out is given, so runs from different releases can be diffed.
+#include "utils/Config.h"
+#include "utils/Logger.h"
+
+#include <benchmark/benchmark.h>
+#include <openssl/ssl.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    auto& config = LocalTether::Utils::Config::GetInstance();
+    // The server logs every request at info; that would be most of what the loopback runs measure.
+    config.Set<std::string>(std::string(LocalTether::Utils::ConfigKeys::LogLevel.name), "warning");
+    OPENSSL_init_ssl(OPENSSL_INIT_LOAD_SSL_STRINGS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS, nullptr);
+
+    std::vector<char*> args(argv, argv + argc);
+    bool hasOut = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--benchmark_out=", 16) == 0) {
+            hasOut = true;
+        }
+    }
+    std::string outFlag = "--benchmark_out=localtether_bench.json";
+    std::string formatFlag = "--benchmark_out_format=json";
+    if (!hasOut) {
+        args.push_back(outFlag.data());
+        args.push_back(formatFlag.data());
+    }
+    int count = static_cast<int>(args.size());
+
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Renders application.ltlog files written with log.format=binary back to text.
+// Usage: localtether_logdecode <file.ltlog> [more files...]
+#include "utils/BinaryLog.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace BinaryLog = LocalTether::Utils::BinaryLog;
+
+namespace {
+    const char* levelName(uint8_t level) {
+        static const char* names[] = {"TRACE", "DEBUG", "INFO", "WARNING", "ERROR", "CRITICAL"};
+        return level < sizeof(names) / sizeof(names[0]) ? names[level] : "UNKNOWN";
+    }
+
+    std::string formatTime(uint64_t timeUs) {
+        std::time_t seconds = static_cast<std::time_t>(timeUs / 1000000);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+        char stamp[32];
+        size_t length = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+        char micros[8];
+        std::snprintf(micros, sizeof(micros), ".%06u", static_cast<unsigned>(timeUs % 1000000));
+        return std::string(stamp, length) + micros;
+    }
+
+    bool decodeFile(const char* path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            std::cerr << "logdecode: cannot open " << path << "\n";
+            return false;
+        }
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (data.size() < sizeof(BinaryLog::FILE_MAGIC) ||
+            std::memcmp(data.data(), BinaryLog::FILE_MAGIC, sizeof(BinaryLog::FILE_MAGIC)) != 0) {
+            std::cerr << "logdecode: " << path << " is not a LocalTether binary log\n";
+            return false;
+        }
+
+        std::vector<std::string> formats;
+        size_t offset = sizeof(BinaryLog::FILE_MAGIC);
+        while (offset < data.size()) {
+            auto frame = BinaryLog::readFrame(data, offset);
+            if (!frame) {
+                std::cerr << "logdecode: " << path << ": stopped at truncated or unknown frame (offset " << offset << ")\n";
+                return false;
+            }
+            switch (frame->kind) {
+                case BinaryLog::FrameKind::Session:
+                    formats.clear();
+                    std::cout << "---- session started " << formatTime(frame->timeUs) << " ----\n";
+                    break;
+                case BinaryLog::FrameKind::Format:
+                    if (frame->formatId > BinaryLog::MAX_FORMAT_ID) {
+                        std::cerr << "logdecode: " << path << ": format id " << frame->formatId << " is out of range, file is corrupt\n";
+                        return false;
+                    }
+                    if (formats.size() <= frame->formatId) formats.resize(frame->formatId + 1);
+                    formats[frame->formatId] = std::string(frame->body);
+                    break;
+                case BinaryLog::FrameKind::Record: {
+                    std::string text;
+                    if (frame->formatId == 0) {
+                        text = std::string(frame->body);
+                    } else if (frame->formatId < formats.size()) {
+                        text = BinaryLog::render(formats[frame->formatId], frame->body);
+                    } else {
+                        text = "<undefined format " + std::to_string(frame->formatId) + ">";
+                    }
+                    std::cout << '[' << formatTime(frame->timeUs) << "] [" << levelName(frame->level) << "] " << text << '\n';
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.ltlog> [more files...]\n";
+        return 2;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; ++i) {
+        ok = decodeFile(argv[i]) && ok;
+    }
+    return ok ? 0 : 1;
+}